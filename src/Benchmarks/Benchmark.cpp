@@ -0,0 +1,164 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "Examples_PCH.h"
+#include "Benchmark.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+
+namespace
+{
+	static double GetMegabytesPerSecond(const BenchmarkResult& result, double milliSeconds)
+	{
+		return (milliSeconds > 0.0) ? (static_cast<double>(result.work.bytes) / (1024.0 * 1024.0)) / (milliSeconds / 1000.0) : 0.0;
+	}
+
+	static double GetRecordsPerSecond(const BenchmarkResult& result, double milliSeconds)
+	{
+		return (milliSeconds > 0.0) ? static_cast<double>(result.work.records) / (milliSeconds / 1000.0) : 0.0;
+	}
+
+	static void WriteJSONString(FILE* file, const char* string)
+	{
+		fputc('"', file);
+		for (const char* c = string; *c != '\0'; ++c)
+		{
+			if ((*c == '"') || (*c == '\\'))
+			{
+				fputc('\\', file);
+				fputc(*c, file);
+			}
+			else if (static_cast<unsigned char>(*c) < 0x20u)
+			{
+				fprintf(file, "\\u%04x", static_cast<unsigned int>(*c));
+			}
+			else
+			{
+				fputc(*c, file);
+			}
+		}
+		fputc('"', file);
+	}
+}
+
+
+BenchmarkRunner::BenchmarkRunner(const BenchmarkOptions& options)
+	: m_options(options)
+	, m_results()
+{
+	printf("%-32s %10s %10s %10s %10s %10s %12s %14s\n", "Benchmark", "min ms", "p50 ms", "p90 ms", "p99 ms", "max ms", "MB/s", "records/s");
+}
+
+
+bool BenchmarkRunner::WriteJSON(const char* path, const char* pdbPath, uint64_t pdbSize) const
+{
+	FILE* file = fopen(path, "w");
+	if (!file)
+	{
+		return false;
+	}
+
+	fprintf(file, "{\n");
+	fprintf(file, "  \"pdb\": ");
+	WriteJSONString(file, pdbPath);
+	fprintf(file, ",\n");
+	fprintf(file, "  \"pdbSize\": %llu,\n", static_cast<unsigned long long>(pdbSize));
+	fprintf(file, "  \"warmupIterations\": %u,\n", m_options.warmupIterations);
+	fprintf(file, "  \"iterations\": %u,\n", m_options.iterations);
+	fprintf(file, "  \"benchmarks\": [");
+
+	for (size_t i = 0u; i < m_results.size(); ++i)
+	{
+		const BenchmarkResult& result = m_results[i];
+		const double median = GetPercentile(result, 50.0);
+
+		fprintf(file, "%s\n    {\n", (i == 0u) ? "" : ",");
+		fprintf(file, "      \"name\": ");
+		WriteJSONString(file, result.name.c_str());
+		fprintf(file, ",\n");
+		fprintf(file, "      \"iterations\": %zu,\n", result.timings.size());
+		fprintf(file, "      \"bytes\": %llu,\n", static_cast<unsigned long long>(result.work.bytes));
+		fprintf(file, "      \"records\": %llu,\n", static_cast<unsigned long long>(result.work.records));
+		fprintf(file, "      \"minMs\": %.6f,\n", result.timings.front());
+		fprintf(file, "      \"meanMs\": %.6f,\n", result.mean);
+		fprintf(file, "      \"stdDevMs\": %.6f,\n", result.standardDeviation);
+		fprintf(file, "      \"p50Ms\": %.6f,\n", median);
+		fprintf(file, "      \"p90Ms\": %.6f,\n", GetPercentile(result, 90.0));
+		fprintf(file, "      \"p99Ms\": %.6f,\n", GetPercentile(result, 99.0));
+		fprintf(file, "      \"maxMs\": %.6f,\n", result.timings.back());
+		fprintf(file, "      \"megabytesPerSecond\": %.3f,\n", GetMegabytesPerSecond(result, median));
+		fprintf(file, "      \"recordsPerSecond\": %.3f,\n", GetRecordsPerSecond(result, median));
+		fprintf(file, "      \"timingsMs\": [");
+		for (size_t j = 0u; j < result.timings.size(); ++j)
+		{
+			fprintf(file, "%s%.6f", (j == 0u) ? "" : ", ", result.timings[j]);
+		}
+		fprintf(file, "]\n    }");
+	}
+
+	fprintf(file, "\n  ]\n}\n");
+
+	const bool success = (ferror(file) == 0);
+	fclose(file);
+
+	return success;
+}
+
+
+double BenchmarkRunner::GetPercentile(const BenchmarkResult& result, double percentile)
+{
+	const size_t count = result.timings.size();
+	const size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * static_cast<double>(count)));
+
+	return result.timings[(rank == 0u) ? 0u : (rank - 1u)];
+}
+
+
+bool BenchmarkRunner::IsEnabled(const char* name) const
+{
+	return !m_options.filter || (strstr(name, m_options.filter) != nullptr);
+}
+
+
+void BenchmarkRunner::AddResult(const char* name, const BenchmarkWork& work, std::vector<double>&& timings)
+{
+	if (timings.empty())
+	{
+		return;
+	}
+
+	std::sort(timings.begin(), timings.end());
+
+	double sum = 0.0;
+	for (double timing : timings)
+	{
+		sum += timing;
+	}
+
+	const double mean = sum / static_cast<double>(timings.size());
+
+	double squaredDeviations = 0.0;
+	for (double timing : timings)
+	{
+		squaredDeviations += (timing - mean) * (timing - mean);
+	}
+
+	BenchmarkResult result;
+	result.name = name;
+	result.work = work;
+	result.warmupIterations = m_options.warmupIterations;
+	result.timings = std::move(timings);
+	result.mean = mean;
+	result.standardDeviation = std::sqrt(squaredDeviations / static_cast<double>(result.timings.size()));
+
+	// throughput is reported for the median, which is less sensitive to outliers than the mean
+	const double median = GetPercentile(result, 50.0);
+	printf("%-32s %10.3f %10.3f %10.3f %10.3f %10.3f %12.1f %14.0f\n", name,
+		result.timings.front(), median, GetPercentile(result, 90.0), GetPercentile(result, 99.0), result.timings.back(),
+		GetMegabytesPerSecond(result, median), GetRecordsPerSecond(result, median));
+
+	m_results.push_back(std::move(result));
+}
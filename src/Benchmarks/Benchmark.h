@@ -0,0 +1,100 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+// The amount of work done by a single iteration of a benchmark, used for computing throughput.
+// benchmarks derive these numbers from the data they actually touched, which also keeps the compiler from optimizing
+// the work away.
+struct BenchmarkWork
+{
+	uint64_t bytes;
+	uint64_t records;
+};
+
+
+struct BenchmarkOptions
+{
+	unsigned int warmupIterations;
+	unsigned int iterations;
+
+	// only benchmarks containing this string in their name are run, or all of them if nullptr
+	const char* filter;
+};
+
+
+struct BenchmarkResult
+{
+	std::string name;
+	BenchmarkWork work;
+	unsigned int warmupIterations;
+
+	// in milliseconds, sorted in ascending order
+	std::vector<double> timings;
+
+	double mean;
+	double standardDeviation;
+};
+
+
+// Runs benchmarks and collects their results.
+// each benchmark is run for a number of warmup iterations that are not measured, followed by the measured iterations.
+// every iteration is timed individually, so that percentiles and outliers can be reported rather than just an average.
+class BenchmarkRunner
+{
+public:
+	explicit BenchmarkRunner(const BenchmarkOptions& options);
+
+	// Runs the given functor, which has to return the BenchmarkWork done by a single iteration.
+	template <typename F>
+	void Run(const char* name, F&& functor)
+	{
+		if (!IsEnabled(name))
+		{
+			return;
+		}
+
+		BenchmarkWork work = {};
+		for (unsigned int i = 0u; i < m_options.warmupIterations; ++i)
+		{
+			work = functor();
+		}
+
+		std::vector<double> timings;
+		timings.reserve(m_options.iterations);
+		for (unsigned int i = 0u; i < m_options.iterations; ++i)
+		{
+			const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+			work = functor();
+			const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+			timings.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+		}
+
+		AddResult(name, work, std::move(timings));
+	}
+
+	// Writes all results as JSON to the given file, along with the path and size of the benchmarked PDB.
+	bool WriteJSON(const char* path, const char* pdbPath, uint64_t pdbSize) const;
+
+	// Returns the percentile of the given result using the nearest-rank method.
+	static double GetPercentile(const BenchmarkResult& result, double percentile);
+
+private:
+	bool IsEnabled(const char* name) const;
+
+	void AddResult(const char* name, const BenchmarkWork& work, std::vector<double>&& timings);
+
+	const BenchmarkOptions m_options;
+	std::vector<BenchmarkResult> m_results;
+
+	PDB_DISABLE_COPY_MOVE(BenchmarkRunner);
+};
@@ -0,0 +1,555 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "Examples_PCH.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Benchmark.h"
+#include "ExampleMemoryMappedFile.h"
+#include "PDB.h"
+#include "PDB_RawFile.h"
+#include "PDB_InfoStream.h"
+#include "PDB_DBIStream.h"
+#include "PDB_TPIStream.h"
+#include "PDB_IPIStream.h"
+#include "PDB_NamesStream.h"
+#include "PDB_TypeTable.h"
+#include "PDB_LineIndex.h"
+#include "PDB_Util.h"
+
+
+namespace
+{
+	// results of the benchmarked work are folded into this, so that the compiler cannot optimize the work away
+	static volatile uint32_t g_sink = 0u;
+
+	// at most this many names are looked up in the name lookup benchmarks, keeping their run time reasonable
+	static constexpr const size_t MaxLookupCount = 100000u;
+
+	// the standard stream indices, see PDB_Types.h
+	static constexpr const uint32_t TPIStreamIndex = 2u;
+	static constexpr const uint32_t IPIStreamIndex = 4u;
+
+
+	static void PrintUsage(void)
+	{
+		printf("Usage: raw_pdb_bench <PDB path> [--warmup <count>] [--iterations <count>] [--filter <string>] [--json <path>]\n");
+		printf("  --warmup      number of unmeasured iterations run before measuring (default: 2)\n");
+		printf("  --iterations  number of measured iterations (default: 10)\n");
+		printf("  --filter      only run benchmarks whose name contains the given string\n");
+		printf("  --json        write the results as JSON to the given file\n");
+	}
+
+
+	// everything the benchmarks need, opened once up front so that each benchmark only measures its own work
+	struct BenchmarkPDB
+	{
+		const void* data;
+		size_t size;
+
+		const PDB::RawFile* rawFile;
+		const PDB::InfoStream* infoStream;
+		const PDB::DBIStream* dbiStream;
+	};
+
+
+	static void RunFileBenchmarks(BenchmarkRunner& runner, const BenchmarkPDB& pdb)
+	{
+		const PDB::RawFile& rawFile = *pdb.rawFile;
+
+		runner.Run("ValidateFile", [&pdb]()
+		{
+			g_sink = g_sink ^ static_cast<uint32_t>(PDB::ValidateFile(pdb.data, pdb.size));
+			return BenchmarkWork { 0u, 1u };
+		});
+
+		runner.Run("RawFile/Open", [&pdb]()
+		{
+			// opening a file coalesces the stream directory
+			const PDB::RawFile file = PDB::CreateRawFile(pdb.data);
+			g_sink = g_sink ^ file.GetStreamCount();
+			return BenchmarkWork { file.GetSuperBlock()->directorySize, file.GetStreamCount() };
+		});
+
+		runner.Run("RawFile/CoalesceAllStreams", [&rawFile]()
+		{
+			BenchmarkWork work = {};
+			for (uint32_t i = 0u; i < rawFile.GetStreamCount(); ++i)
+			{
+				const uint32_t size = rawFile.GetStreamSize(i);
+				if (size == 0u)
+				{
+					continue;
+				}
+
+				const PDB::CoalescedMSFStream stream = rawFile.CreateMSFStream<PDB::CoalescedMSFStream>(i);
+				g_sink = g_sink ^ *stream.GetDataAtOffset<uint8_t>(size - 1u);
+
+				work.bytes += size;
+				++work.records;
+			}
+
+			return work;
+		});
+
+		runner.Run("InfoStream/Open", [&rawFile]()
+		{
+			const PDB::InfoStream infoStream(rawFile);
+			g_sink = g_sink ^ infoStream.GetHeader()->age;
+			return BenchmarkWork { rawFile.GetStreamSize(1u), infoStream.GetNamedStreams().GetLength() };
+		});
+	}
+
+
+	static void RunDBIBenchmarks(BenchmarkRunner& runner, const BenchmarkPDB& pdb)
+	{
+		const PDB::RawFile& rawFile = *pdb.rawFile;
+		const PDB::DBIStream& dbiStream = *pdb.dbiStream;
+
+		runner.Run("DBI/ModuleWalk", [&rawFile, &dbiStream]()
+		{
+			const PDB::ModuleInfoStream moduleInfoStream = dbiStream.CreateModuleInfoStream(rawFile);
+
+			uint32_t hash = 0u;
+			for (const PDB::ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+			{
+				hash ^= static_cast<uint32_t>(module.GetName().GetLength() + module.GetObjectName().GetLength());
+				hash ^= module.GetInfo()->moduleSymbolStreamIndex;
+			}
+
+			g_sink = g_sink ^ hash;
+			return BenchmarkWork { dbiStream.GetHeader().moduleInfoSize, moduleInfoStream.GetModules().GetLength() };
+		});
+
+		runner.Run("DBI/SymbolRecordStream", [&rawFile, &dbiStream]()
+		{
+			const PDB::CoalescedMSFStream symbolRecordStream = dbiStream.CreateSymbolRecordStream(rawFile);
+			g_sink = g_sink ^ static_cast<uint32_t>(symbolRecordStream.GetSize());
+			return BenchmarkWork { symbolRecordStream.GetSize(), 1u };
+		});
+
+		runner.Run("DBI/ImageSectionStream", [&rawFile, &dbiStream]()
+		{
+			const PDB::ImageSectionStream imageSectionStream = dbiStream.CreateImageSectionStream(rawFile);
+			g_sink = g_sink ^ static_cast<uint32_t>(imageSectionStream.GetImageSections().GetLength());
+			return BenchmarkWork { imageSectionStream.GetImageSections().GetLength() * sizeof(PDB::IMAGE_SECTION_HEADER), imageSectionStream.GetImageSections().GetLength() };
+		});
+
+		runner.Run("DBI/SectionContributionStream", [&rawFile, &dbiStream]()
+		{
+			const PDB::SectionContributionStream sectionContributionStream = dbiStream.CreateSectionContributionStream(rawFile);
+
+			uint32_t hash = 0u;
+			for (const PDB::DBI::SectionContribution& contribution : sectionContributionStream.GetContributions())
+			{
+				hash ^= contribution.offset ^ contribution.size;
+			}
+
+			g_sink = g_sink ^ hash;
+			return BenchmarkWork { dbiStream.GetHeader().sectionContributionSize, sectionContributionStream.GetContributions().GetLength() };
+		});
+
+		const PDB::ModuleInfoStream moduleInfoStream = dbiStream.CreateModuleInfoStream(rawFile);
+		const PDB::CoalescedMSFStream symbolRecordStream = dbiStream.CreateSymbolRecordStream(rawFile);
+
+		runner.Run("Symbols/ModuleScan", [&rawFile, &moduleInfoStream]()
+		{
+			BenchmarkWork work = {};
+			uint32_t hash = 0u;
+			for (const PDB::ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+			{
+				if (!module.HasSymbolStream())
+				{
+					continue;
+				}
+
+				const PDB::ModuleSymbolStream moduleSymbolStream = module.CreateSymbolStream(rawFile);
+				moduleSymbolStream.ForEachSymbol([&work, &hash](const PDB::CodeView::DBI::Record* record)
+				{
+					hash ^= PDB_AS_UNDERLYING(record->header.kind);
+					++work.records;
+				});
+
+				work.bytes += module.GetInfo()->symbolSize;
+			}
+
+			g_sink = g_sink ^ hash;
+			return work;
+		});
+
+		runner.Run("Symbols/PublicScan", [&rawFile, &dbiStream, &symbolRecordStream]()
+		{
+			const PDB::PublicSymbolStream publicSymbolStream = dbiStream.CreatePublicSymbolStream(rawFile);
+
+			uint32_t hash = 0u;
+			for (const PDB::HashRecord& hashRecord : publicSymbolStream.GetRecords())
+			{
+				const PDB::CodeView::DBI::Record* record = publicSymbolStream.GetRecord(symbolRecordStream, hashRecord);
+				hash ^= PDB_AS_UNDERLYING(record->header.kind);
+			}
+
+			g_sink = g_sink ^ hash;
+			return BenchmarkWork { rawFile.GetStreamSize(dbiStream.GetHeader().publicStreamIndex), publicSymbolStream.GetRecords().GetLength() };
+		});
+
+		runner.Run("Symbols/GlobalScan", [&rawFile, &dbiStream, &symbolRecordStream]()
+		{
+			const PDB::GlobalSymbolStream globalSymbolStream = dbiStream.CreateGlobalSymbolStream(rawFile);
+
+			uint32_t hash = 0u;
+			for (const PDB::HashRecord& hashRecord : globalSymbolStream.GetRecords())
+			{
+				const PDB::CodeView::DBI::Record* record = globalSymbolStream.GetRecord(symbolRecordStream, hashRecord);
+				hash ^= PDB_AS_UNDERLYING(record->header.kind);
+			}
+
+			g_sink = g_sink ^ hash;
+			return BenchmarkWork { rawFile.GetStreamSize(dbiStream.GetHeader().globalStreamIndex), globalSymbolStream.GetRecords().GetLength() };
+		});
+
+		runner.Run("Lines/Extract", [&rawFile, &moduleInfoStream]()
+		{
+			BenchmarkWork work = {};
+			uint32_t hash = 0u;
+			for (const PDB::ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+			{
+				if (!module.HasLineStream())
+				{
+					continue;
+				}
+
+				const PDB::ModuleLineStream moduleLineStream = module.CreateLineStream(rawFile);
+				moduleLineStream.ForEachSection([&moduleLineStream, &work, &hash](const PDB::CodeView::DBI::LineSection* section)
+				{
+					if (section->header.kind != PDB::CodeView::DBI::DebugSubsectionKind::S_LINES)
+					{
+						return;
+					}
+
+					moduleLineStream.ForEachLinesBlock(section, [&work, &hash](const PDB::CodeView::DBI::LinesFileBlockHeader* linesBlockHeader, const PDB::CodeView::DBI::Line* blockLines, const PDB::CodeView::DBI::Column*)
+					{
+						for (uint32_t i = 0u; i < linesBlockHeader->numLines; ++i)
+						{
+							hash ^= blockLines[i].offset ^ blockLines[i].linenumStart;
+						}
+
+						work.records += linesBlockHeader->numLines;
+					});
+				});
+
+				work.bytes += module.GetInfo()->c13Size;
+			}
+
+			g_sink = g_sink ^ hash;
+			return work;
+		});
+
+		const PDB::ImageSectionStream imageSectionStream = dbiStream.CreateImageSectionStream(rawFile);
+		runner.Run("Lines/BuildIndex", [&rawFile, &moduleInfoStream, &imageSectionStream]()
+		{
+			const PDB::LineIndex lineIndex = PDB::CreateLineIndex(rawFile, moduleInfoStream, imageSectionStream);
+			g_sink = g_sink ^ static_cast<uint32_t>(lineIndex.GetEncodedSize());
+			return BenchmarkWork { lineIndex.GetEncodedSize(), lineIndex.GetLineCount() };
+		});
+
+		// look up every module by its own name, which is what tools matching modules against build artifacts do
+		std::vector<std::string> moduleNames;
+		for (const PDB::ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+		{
+			if (moduleNames.size() == MaxLookupCount)
+			{
+				break;
+			}
+
+			moduleNames.emplace_back(module.GetName().Decay());
+		}
+
+		runner.Run("Lookup/ModuleByName", [&moduleInfoStream, &moduleNames]()
+		{
+			uint32_t found = 0u;
+			for (const std::string& name : moduleNames)
+			{
+				found += (moduleInfoStream.FindModule(PDB::ModuleInfoStream::Lookup::Name, name.c_str()) != nullptr) ? 1u : 0u;
+			}
+
+			g_sink = g_sink ^ found;
+			return BenchmarkWork { 0u, moduleNames.size() };
+		});
+	}
+
+
+	static void RunNamesBenchmarks(BenchmarkRunner& runner, const BenchmarkPDB& pdb)
+	{
+		const PDB::RawFile& rawFile = *pdb.rawFile;
+		if (!pdb.infoStream->HasNamesStream())
+		{
+			return;
+		}
+
+		runner.Run("Names/Open", [&rawFile, &pdb]()
+		{
+			const PDB::NamesStream namesStream = pdb.infoStream->CreateNamesStream(rawFile);
+			g_sink = g_sink ^ namesStream.GetHeader()->size;
+			return BenchmarkWork { namesStream.GetHeader()->size, 1u };
+		});
+
+		// the filenames referenced by the line information are the strings looked up most often in practice
+		const PDB::NamesStream namesStream = pdb.infoStream->CreateNamesStream(rawFile);
+		const PDB::ModuleInfoStream moduleInfoStream = pdb.dbiStream->CreateModuleInfoStream(rawFile);
+
+		std::vector<const char*> filenames;
+		for (const PDB::ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+		{
+			if (!module.HasLineStream() || (filenames.size() >= MaxLookupCount))
+			{
+				continue;
+			}
+
+			const PDB::ModuleLineStream moduleLineStream = module.CreateLineStream(rawFile);
+			moduleLineStream.ForEachSection([&moduleLineStream, &namesStream, &filenames](const PDB::CodeView::DBI::LineSection* section)
+			{
+				if (section->header.kind != PDB::CodeView::DBI::DebugSubsectionKind::S_FILECHECKSUMS)
+				{
+					return;
+				}
+
+				moduleLineStream.ForEachFileChecksum(section, [&namesStream, &filenames](const PDB::CodeView::DBI::FileChecksumHeader* checksum)
+				{
+					if (filenames.size() < MaxLookupCount)
+					{
+						filenames.push_back(namesStream.GetFilename(checksum->filenameOffset));
+					}
+				});
+			});
+		}
+
+		runner.Run("Lookup/NamesFindOffset", [&namesStream, &filenames]()
+		{
+			uint32_t hash = 0u;
+			for (const char* filename : filenames)
+			{
+				hash ^= namesStream.FindOffset(filename);
+			}
+
+			g_sink = g_sink ^ hash;
+			return BenchmarkWork { 0u, filenames.size() };
+		});
+
+		std::vector<uint32_t> offsets(filenames.size());
+		runner.Run("Lookup/NamesFindOffsets", [&namesStream, &filenames, &offsets]()
+		{
+			namesStream.FindOffsets(filenames.data(), filenames.size(), offsets.data());
+			g_sink = g_sink ^ (offsets.empty() ? 0u : offsets.back());
+			return BenchmarkWork { 0u, filenames.size() };
+		});
+	}
+
+
+	static void RunTypeBenchmarks(BenchmarkRunner& runner, const BenchmarkPDB& pdb)
+	{
+		const PDB::RawFile& rawFile = *pdb.rawFile;
+		if (PDB::HasValidTPIStream(rawFile) == PDB::ErrorCode::Success)
+		{
+			runner.Run("TPI/Index", [&rawFile]()
+			{
+				const PDB::TPIStream tpiStream = PDB::CreateTPIStream(rawFile);
+				g_sink = g_sink ^ tpiStream.GetLastTypeIndex();
+				return BenchmarkWork { rawFile.GetStreamSize(TPIStreamIndex), tpiStream.GetTypeRecordCount() };
+			});
+
+			PDB::TPIStream tpiStream = PDB::CreateTPIStream(rawFile);
+
+			runner.Run("TPI/TypeTableCoalesced", [&rawFile, &tpiStream]()
+			{
+				const PDB::TypeTable typeTable = PDB::CreateTypeTable(tpiStream, PDB::TypeTable::Mode::Coalesced);
+				g_sink = g_sink ^ static_cast<uint32_t>(typeTable.GetTypeRecordCount());
+				return BenchmarkWork { rawFile.GetStreamSize(TPIStreamIndex), typeTable.GetTypeRecordCount() };
+			});
+
+			runner.Run("TPI/TypeTableLazy", [&rawFile, &tpiStream]()
+			{
+				const PDB::TypeTable typeTable = PDB::CreateTypeTable(tpiStream, PDB::TypeTable::Mode::Lazy);
+				g_sink = g_sink ^ static_cast<uint32_t>(typeTable.GetTypeRecordCount());
+				return BenchmarkWork { rawFile.GetStreamSize(TPIStreamIndex), typeTable.GetTypeRecordCount() };
+			});
+
+			// look up the names of user-defined types, as done when resolving forward references by name
+			const PDB::TypeTable typeTable = PDB::CreateTypeTable(tpiStream, PDB::TypeTable::Mode::Coalesced);
+			std::vector<const char*> typeNames;
+			typeTable.ForEachTypeRecord([&typeNames](uint32_t, const PDB::CodeView::TPI::Record* record)
+			{
+				const char* name = record ? PDB::GetUDTName(record) : nullptr;
+				if (name && (typeNames.size() < MaxLookupCount))
+				{
+					typeNames.push_back(name);
+				}
+			});
+
+			runner.Run("TPI/BuildNameIndex", [&rawFile]()
+			{
+				PDB::TPIStream nameIndexStream = PDB::CreateTPIStream(rawFile);
+				nameIndexStream.BuildNameIndex(rawFile);
+				return BenchmarkWork { rawFile.GetStreamSize(TPIStreamIndex), nameIndexStream.GetTypeRecordCount() };
+			});
+
+			tpiStream.BuildNameIndex(rawFile);
+			runner.Run("Lookup/TypeByName", [&tpiStream, &typeNames]()
+			{
+				uint32_t hash = 0u;
+				for (const char* name : typeNames)
+				{
+					hash ^= tpiStream.FindTypeByName(name);
+				}
+
+				g_sink = g_sink ^ hash;
+				return BenchmarkWork { 0u, typeNames.size() };
+			});
+		}
+
+		if (pdb.infoStream->HasIPIStream() && (PDB::HasValidIPIStream(rawFile) == PDB::ErrorCode::Success))
+		{
+			runner.Run("IPI/IndexEager", [&rawFile]()
+			{
+				const PDB::IPIStream ipiStream = PDB::CreateIPIStream(rawFile, PDB::IPIStream::Mode::Eager);
+				g_sink = g_sink ^ ipiStream.GetLastTypeIndex();
+				return BenchmarkWork { rawFile.GetStreamSize(IPIStreamIndex), ipiStream.GetLastTypeIndex() - ipiStream.GetFirstTypeIndex() };
+			});
+
+			runner.Run("IPI/IndexLazy", [&rawFile]()
+			{
+				const PDB::IPIStream ipiStream = PDB::CreateIPIStream(rawFile, PDB::IPIStream::Mode::Lazy);
+				g_sink = g_sink ^ ipiStream.GetLastTypeIndex();
+				return BenchmarkWork { rawFile.GetStreamSize(IPIStreamIndex), ipiStream.GetLastTypeIndex() - ipiStream.GetFirstTypeIndex() };
+			});
+		}
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	const char* pdbPath = argv[1];
+	const char* jsonPath = nullptr;
+	BenchmarkOptions options = { 2u, 10u, nullptr };
+
+	for (int i = 2; i < argc; i += 2)
+	{
+		if (i + 1 >= argc)
+		{
+			PrintUsage();
+			return 1;
+		}
+
+		if (strcmp(argv[i], "--warmup") == 0)
+		{
+			options.warmupIterations = static_cast<unsigned int>(strtoul(argv[i + 1], nullptr, 10));
+		}
+		else if (strcmp(argv[i], "--iterations") == 0)
+		{
+			options.iterations = static_cast<unsigned int>(strtoul(argv[i + 1], nullptr, 10));
+		}
+		else if (strcmp(argv[i], "--filter") == 0)
+		{
+			options.filter = argv[i + 1];
+		}
+		else if (strcmp(argv[i], "--json") == 0)
+		{
+			jsonPath = argv[i + 1];
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (options.iterations == 0u)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	MemoryMappedFile::Handle file = MemoryMappedFile::Open(pdbPath);
+	if (!file.baseAddress)
+	{
+		printf("Cannot memory-map file %s\n", pdbPath);
+		return 1;
+	}
+
+	if (PDB::ValidateFile(file.baseAddress, file.len) != PDB::ErrorCode::Success)
+	{
+		printf("File %s is not a valid PDB\n", pdbPath);
+		MemoryMappedFile::Close(file);
+		return 2;
+	}
+
+	int result = 0;
+	{
+		const PDB::RawFile rawFile = PDB::CreateRawFile(file.baseAddress);
+		if (PDB::HasValidDBIStream(rawFile) != PDB::ErrorCode::Success)
+		{
+			printf("PDB %s has no valid DBI stream\n", pdbPath);
+			MemoryMappedFile::Close(file);
+			return 3;
+		}
+
+		const PDB::InfoStream infoStream(rawFile);
+		if (infoStream.UsesDebugFastLink())
+		{
+			printf("PDB %s was linked using unsupported option /DEBUG:FASTLINK\n", pdbPath);
+			MemoryMappedFile::Close(file);
+			return 4;
+		}
+
+		const PDB::DBIStream dbiStream = PDB::CreateDBIStream(rawFile);
+		const bool hasValidStreams =
+			(dbiStream.HasValidSymbolRecordStream(rawFile) == PDB::ErrorCode::Success) &&
+			(dbiStream.HasValidPublicSymbolStream(rawFile) == PDB::ErrorCode::Success) &&
+			(dbiStream.HasValidGlobalSymbolStream(rawFile) == PDB::ErrorCode::Success) &&
+			(dbiStream.HasValidSectionContributionStream(rawFile) == PDB::ErrorCode::Success) &&
+			(dbiStream.HasValidImageSectionStream(rawFile) == PDB::ErrorCode::Success);
+		if (!hasValidStreams)
+		{
+			printf("PDB %s is missing DBI sub-streams\n", pdbPath);
+			MemoryMappedFile::Close(file);
+			return 5;
+		}
+
+		printf("Benchmarking %s (%.1f MiB, %u streams), %u warmup and %u measured iterations\n\n",
+			pdbPath, static_cast<double>(file.len) / (1024.0 * 1024.0), rawFile.GetStreamCount(), options.warmupIterations, options.iterations);
+
+		const BenchmarkPDB pdb = { file.baseAddress, file.len, &rawFile, &infoStream, &dbiStream };
+
+		BenchmarkRunner runner(options);
+		RunFileBenchmarks(runner, pdb);
+		RunDBIBenchmarks(runner, pdb);
+		RunNamesBenchmarks(runner, pdb);
+		RunTypeBenchmarks(runner, pdb);
+
+		if (jsonPath)
+		{
+			if (runner.WriteJSON(jsonPath, pdbPath, file.len))
+			{
+				printf("\nWrote results to %s\n", jsonPath);
+			}
+			else
+			{
+				printf("\nCannot write results to %s\n", jsonPath);
+				result = 6;
+			}
+		}
+	}
+
+	MemoryMappedFile::Close(file);
+
+	return result;
+}
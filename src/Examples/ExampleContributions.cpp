@@ -93,4 +93,45 @@ void ExampleContributions(const PDB::RawFile& rawPdbFile, const PDB::DBIStream&
 			printf("%zu: %u bytes from %s\n", i + 1u, contribution.size, contribution.objectFile.c_str());
 		}
 	}
+
+	// modules can be looked up by name without walking all of them, e.g. to find all modules built from the same source
+	if (!contributions.empty())
+	{
+		const std::string& name = contributions[0].objectFile;
+		const size_t separator = name.find_last_of("\\/");
+		const std::string basename = (separator != std::string::npos) ? name.substr(separator + 1u) : name;
+
+		printf("Modules named %s:\n", basename.c_str());
+		moduleInfoStream.ForEachModule(PDB::ModuleInfoStream::Lookup::NameBasename, basename.c_str(), [&moduleInfoStream](uint32_t moduleIndex)
+		{
+			printf("  %u: %s\n", moduleIndex, moduleInfoStream.GetModule(moduleIndex).GetObjectName().Decay());
+		});
+	}
+
+	// the section map translates logical segment:offset addresses, as used by older tools, into physical sections
+	{
+		const PDB::SectionMapStream sectionMapStream = dbiStream.CreateSectionMapStream(rawPdbFile);
+		const size_t segmentCount = sectionMapStream.GetEntries().GetLength();
+
+		std::vector<uint16_t> segments(segmentCount);
+		std::vector<uint32_t> offsets(segmentCount, 0u);
+		std::vector<uint32_t> rvas(segmentCount);
+		for (size_t i = 0u; i < segmentCount; ++i)
+		{
+			segments[i] = static_cast<uint16_t>(i + 1u);
+		}
+
+		sectionMapStream.ConvertSegmentOffsetsToRVAs(imageSectionStream, segments.data(), offsets.data(), segmentCount, rvas.data());
+
+		for (size_t i = 0u; i < segmentCount; ++i)
+		{
+			// RVAs can be converted back into physical sections
+			uint16_t section = 0u;
+			uint32_t offset = 0u;
+			if (imageSectionStream.ConvertRVAToSectionOffset(rvas[i], section, offset))
+			{
+				printf("Logical segment %u starts at RVA 0x%08X in section %u at offset 0x%X\n", segments[i], rvas[i], section, offset);
+			}
+		}
+	}
 }
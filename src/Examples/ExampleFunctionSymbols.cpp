@@ -5,6 +5,7 @@
 #include "ExampleTimedScope.h"
 #include "PDB_RawFile.h"
 #include "PDB_DBIStream.h"
+#include "PDB_RecordVisitor.h"
 
 namespace
 {
@@ -258,5 +259,31 @@ void ExampleFunctionSymbols(const PDB::RawFile& rawPdbFile, const PDB::DBIStream
 		computeScope.Done(foundCount);
 	}
 
+	// instead of checking each record's kind by hand, a record visitor only dispatches the kinds we registered handlers for
+	{
+		TimedScope visitorScope("Counting procedures using a record visitor");
+
+		size_t procedureCount = 0u;
+		size_t thunkCount = 0u;
+		auto visitor = PDB::MakeRecordVisitor(
+			PDB::OnSymbol<PDB::CodeView::DBI::SymbolRecordKind::S_GPROC32>([&procedureCount](const PDB::CodeView::DBI::Record*) { ++procedureCount; }),
+			PDB::OnSymbol<PDB::CodeView::DBI::SymbolRecordKind::S_LPROC32>([&procedureCount](const PDB::CodeView::DBI::Record*) { ++procedureCount; }),
+			PDB::OnSymbol<PDB::CodeView::DBI::SymbolRecordKind::S_THUNK32>([&thunkCount](const PDB::CodeView::DBI::Record*) { ++thunkCount; }));
+
+		for (const PDB::ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+		{
+			if (!module.HasSymbolStream())
+			{
+				continue;
+			}
+
+			const PDB::ModuleSymbolStream moduleSymbolStream = module.CreateSymbolStream(rawPdbFile);
+			moduleSymbolStream.ForEachSymbol(visitor);
+		}
+
+		printf("Found %zu procedures and %zu thunks\n", procedureCount, thunkCount);
+		visitorScope.Done(procedureCount + thunkCount);
+	}
+
 	total.Done(functionSymbols.size());
 }
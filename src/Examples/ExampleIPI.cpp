@@ -4,10 +4,14 @@
 #include "Examples_PCH.h"
 #include "ExampleTimedScope.h"
 #include "ExampleTypeTable.h"
+#include "ExampleParallelFor.h"
 #include "PDB_RawFile.h"
 #include "PDB_InfoStream.h"
 #include "PDB_IPIStream.h"
 #include "PDB_TPIStream.h"
+#include "PDB_UDTSourceIndex.h"
+#include "PDB_BuildInfoIndex.h"
+#include "PDB_DBIStream.h"
 
 static std::string GetTypeNameIPI(const TypeTable& typeTable, uint32_t typeIndex)
 {
@@ -26,9 +30,9 @@ static std::string GetTypeNameIPI(const TypeTable& typeTable, uint32_t typeIndex
 	return typeName;
 }
 
-void ExampleIPI(const PDB::RawFile& rawPdbFile, const PDB::InfoStream& infoStream, const PDB::TPIStream& tpiStream, const PDB::IPIStream& ipiStream);
+void ExampleIPI(const PDB::RawFile& rawPdbFile, const PDB::DBIStream& dbiStream, const PDB::InfoStream& infoStream, const PDB::TPIStream& tpiStream, const PDB::IPIStream& ipiStream);
 
-void ExampleIPI(const PDB::RawFile& rawPdbFile, const PDB::InfoStream& infoStream, const PDB::TPIStream& tpiStream, const PDB::IPIStream& ipiStream)
+void ExampleIPI(const PDB::RawFile& rawPdbFile, const PDB::DBIStream& dbiStream, const PDB::InfoStream& infoStream, const PDB::TPIStream& tpiStream, const PDB::IPIStream& ipiStream)
 {
 	if (!infoStream.HasIPIStream())
 	{
@@ -37,6 +41,33 @@ void ExampleIPI(const PDB::RawFile& rawPdbFile, const PDB::InfoStream& infoStrea
 
 	TimedScope total("\nRunning example \"IPI\"");
 
+	{
+		// records can be indexed concurrently, with the caller providing the threads
+		TimedScope parallelScope("Create IPIStream in parallel");
+		const PDB::IPIStream parallelStream = PDB::CreateIPIStream(rawPdbFile, ParallelFor {});
+		parallelScope.Done(parallelStream.GetTypeRecords().GetLength());
+	}
+
+	{
+		// a lazy stream only reads the type index offsets upon construction, and resolves records on demand
+		TimedScope lazyScope("Create lazy IPIStream");
+		PDB::IPIStream lazyStream = PDB::CreateIPIStream(rawPdbFile, PDB::IPIStream::Mode::Lazy);
+		lazyScope.Done();
+
+		TimedScope resolveScope("Resolving every 100th IPI record");
+		size_t matchCount = 0u;
+		for (uint32_t typeIndex = ipiStream.GetFirstTypeIndex(); typeIndex < ipiStream.GetLastTypeIndex(); typeIndex += 100u)
+		{
+			const PDB::CodeView::IPI::Record* record = lazyStream.GetTypeRecord(typeIndex);
+			const PDB::CodeView::IPI::Record* eagerRecord = ipiStream.GetTypeRecords()[typeIndex - ipiStream.GetFirstTypeIndex()];
+			if (record && eagerRecord && (record->header.kind == eagerRecord->header.kind))
+			{
+				++matchCount;
+			}
+		}
+		resolveScope.Done(matchCount);
+	}
+
 	TimedScope typeTableScope("Create TypeTable");
 	TypeTable typeTable(tpiStream);
 	typeTableScope.Done();
@@ -46,6 +77,49 @@ void ExampleIPI(const PDB::RawFile& rawPdbFile, const PDB::InfoStream& infoStrea
 	const PDB::NamesStream namesStream = infoStream.CreateNamesStream(rawPdbFile);
 	namesScope.Done();
 
+	{
+		// the source locations of user-defined types can be indexed once, turning lookups into binary searches
+		TimedScope udtSourceScope("Create UDTSourceIndex");
+		const PDB::UDTSourceIndex udtSourceIndex = PDB::CreateUDTSourceIndex(ipiStream);
+		udtSourceScope.Done(udtSourceIndex.GetEntries().GetLength());
+
+		if (udtSourceIndex.GetEntries().GetLength() != 0u)
+		{
+			const uint32_t typeIndex = udtSourceIndex.GetEntries()[udtSourceIndex.GetEntries().GetLength() / 2u].typeIndex;
+			for (const PDB::UDTSourceIndex::Entry& entry : udtSourceIndex.Find(typeIndex))
+			{
+				const char* filename = PDB::UDTSourceIndex::GetFilename(entry, ipiStream, namesStream);
+				printf("Type %s defined in %s(%u)\n", GetTypeNameIPI(typeTable, typeIndex).c_str(), filename ? filename : "<unknown>", entry.line);
+			}
+		}
+	}
+
+	{
+		// compiler versions, flags and command lines of all modules can be gathered concurrently
+		const PDB::ModuleInfoStream moduleInfoStream = dbiStream.CreateModuleInfoStream(rawPdbFile);
+
+		TimedScope buildInfoScope("Create BuildInfoIndex in parallel");
+		const PDB::BuildInfoIndex buildInfoIndex(rawPdbFile, moduleInfoStream, ipiStream, ParallelFor {});
+		buildInfoScope.Done(buildInfoIndex.GetEntries().GetLength());
+
+		size_t printedCount = 0u;
+		for (const PDB::BuildInfoIndex::Entry& entry : buildInfoIndex.GetEntries())
+		{
+			if (!entry.hasCompileSymbol || !entry.commandLine)
+			{
+				continue;
+			}
+
+			printf("%s %u.%u.%u (language %u): %s\n", entry.compilerName, entry.frontendVersion[0], entry.frontendVersion[1], entry.frontendVersion[2], entry.language, entry.sourceFile ? entry.sourceFile : "<unknown>");
+			printf("  cwd: %s\n  cmd: %s\n", entry.currentDirectory ? entry.currentDirectory : "<unknown>", entry.commandLine);
+
+			if (++printedCount == 3u)
+			{
+				break;
+			}
+		}
+	}
+
 	const uint32_t firstTypeIndex = ipiStream.GetFirstTypeIndex();
 
 	PDB::ArrayView<const PDB::CodeView::IPI::Record*> records = ipiStream.GetTypeRecords();
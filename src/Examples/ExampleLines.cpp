@@ -7,6 +7,11 @@
 #include "PDB_RawFile.h"
 #include "PDB_DBIStream.h"
 #include "PDB_InfoStream.h"
+#include "PDB_FileTable.h"
+#include "PDB_LineIndex.h"
+#include "PDB_SourceLineIndex.h"
+#include "PDB_SourceLinkMap.h"
+#include "PDB_EmbeddedSourceStream.h"
 
 #include <cstring>
 
@@ -265,4 +270,125 @@ void ExampleLines(const PDB::RawFile& rawPdbFile, const PDB::DBIStream& dbiStrea
 		}
 #endif
 	}
+
+	{
+		// the library can also build an address-ordered index of all lines, which answers RVA lookups without
+		// having to gather and sort the lines as done above.
+		TimedScope indexScope("Building line index");
+		const PDB::LineIndex lineIndex = PDB::CreateLineIndex(rawPdbFile, moduleInfoStream, imageSectionStream);
+		indexScope.Done(lineIndex.GetLineCount());
+
+		printf("Line index uses %zu bytes for %zu lines\n", lineIndex.GetEncodedSize(), lineIndex.GetLineCount());
+
+		if (!sections.empty())
+		{
+			const Section& section = sections[sections.size() / 2u];
+			const uint32_t rva = imageSectionStream.ConvertSectionOffsetToRVA(section.index, section.offset);
+
+			PDB::LineIndex::Line line = {};
+			if (lineIndex.FindLine(rva, line))
+			{
+				printf("RVA 0x%08X: %s(%u)\n", rva, namesStream.GetFilename(line.filenameOffset), line.lineNumber);
+			}
+		}
+	}
+
+	{
+		// the reverse index is built per module, so each module could be handled by a different thread.
+		// the module indices are then merged into a single index for lookups.
+		TimedScope indexScope("Building source line index");
+
+		const PDB::ArrayView<PDB::ModuleInfoStream::Module> modules = moduleInfoStream.GetModules();
+
+		std::vector<PDB::SourceLineIndex> moduleIndices;
+		moduleIndices.reserve(modules.GetLength());
+		for (const PDB::ModuleInfoStream::Module& module : modules)
+		{
+			moduleIndices.push_back(PDB::CreateSourceLineIndex(rawPdbFile, module, imageSectionStream));
+		}
+
+		std::vector<const PDB::SourceLineIndex*> moduleIndexPointers;
+		moduleIndexPointers.reserve(moduleIndices.size());
+		for (const PDB::SourceLineIndex& moduleIndex : moduleIndices)
+		{
+			moduleIndexPointers.push_back(&moduleIndex);
+		}
+
+		const PDB::SourceLineIndex sourceLineIndex(PDB::ArrayView<const PDB::SourceLineIndex*>(moduleIndexPointers.data(), moduleIndexPointers.size()));
+		indexScope.Done(sourceLineIndex.GetEntries().GetLength());
+
+		if (sourceLineIndex.GetEntries().GetLength() != 0u)
+		{
+			const PDB::SourceLineIndex::Entry& entry = sourceLineIndex.GetEntries()[sourceLineIndex.GetEntries().GetLength() / 2u];
+
+			// the names stream's hash table turns a filename back into the offset used by the index
+			const uint32_t filenameOffset = namesStream.FindOffset(namesStream.GetFilename(entry.filenameOffset));
+			for (const PDB::SourceLineIndex::Entry& range : sourceLineIndex.FindLine(filenameOffset, entry.lineNumber))
+			{
+				printf("%s(%u): RVA 0x%08X, len = 0x%X\n", namesStream.GetFilename(range.filenameOffset), range.lineNumber, range.rva, range.codeSize);
+			}
+		}
+	}
+
+	{
+		// the file table stores each distinct file once, and maps the checksum offsets used by each module's lines
+		// to dense file ids. this makes it possible to work with files without hashing any strings.
+		TimedScope fileTableScope("Building file table");
+		const PDB::FileTable fileTable = PDB::CreateFileTable(rawPdbFile, moduleInfoStream);
+		fileTableScope.Done(fileTable.GetFiles().GetLength());
+
+		size_t referencedFileCount = 0u;
+		for (uint32_t i = 0u, count = static_cast<uint32_t>(moduleInfoStream.GetModules().GetLength()); i < count; ++i)
+		{
+			for (const uint32_t fileId : fileTable.GetModuleRemap(i))
+			{
+				if (fileId != PDB::FileTable::InvalidFileId)
+				{
+					++referencedFileCount;
+				}
+			}
+		}
+
+		printf("%zu distinct files out of %zu files referenced by modules\n", fileTable.GetFiles().GetLength(), referencedFileCount);
+	}
+
+	{
+		// files referenced by lines can be mapped to URLs using the Source Link mappings, if the PDB has any
+		TimedScope sourceLinkScope("Reading Source Link mappings");
+		const PDB::SourceLinkMap sourceLinkMap = PDB::CreateSourceLinkMap(rawPdbFile, infoStream);
+		sourceLinkScope.Done(sourceLinkMap.GetMappingCount());
+
+		if (!filenames.empty())
+		{
+			const char* filename = namesStream.GetFilename(filenames[filenames.size() / 2u].namesFilenameOffset);
+
+			char url[1024];
+			if (sourceLinkMap.Resolve(filename, url, sizeof(url)) != 0u)
+			{
+				printf("%s -> %s\n", filename, url);
+			}
+		}
+
+		// uncompressed embedded source files are read directly from the memory-mapped file, compressed ones are decompressed on the fly
+		size_t embeddedSourceSize = 0u;
+		PDB::ForEachEmbeddedSource(rawPdbFile, infoStream, namesStream, [&embeddedSourceSize](const char* path, const PDB::EmbeddedSourceStream& embeddedSource)
+		{
+			size_t textSize = 0u;
+			const PDB::ErrorCode errorCode = embeddedSource.ForEachChunk([&textSize](PDB::ArrayView<PDB::Byte> chunk)
+			{
+				textSize += chunk.GetLength();
+			});
+
+			if (errorCode != PDB::ErrorCode::Success)
+			{
+				printf("Embedded source %s (%zu bytes, compression %u) cannot be read\n", path, embeddedSource.GetSize(), static_cast<unsigned int>(embeddedSource.GetCompression()));
+				return;
+			}
+
+			embeddedSourceSize += textSize;
+			printf("Embedded source %s (%zu bytes, %zu bytes of text)\n", path, embeddedSource.GetSize(), textSize);
+		});
+
+		printf("%zu bytes of embedded source text\n", embeddedSourceSize);
+	}
 }
@@ -47,6 +47,22 @@ namespace
 			case PDB::ErrorCode::UnknownVersion:
 				printf("Unknown version\n");
 				return true;
+
+			case PDB::ErrorCode::InvalidChecksum:
+				printf("Invalid checksum\n");
+				return true;
+
+			case PDB::ErrorCode::MismatchingPDB:
+				printf("Mismatching PDB\n");
+				return true;
+
+			case PDB::ErrorCode::UnsupportedCompression:
+				printf("Unsupported compression\n");
+				return true;
+
+			case PDB::ErrorCode::InvalidCompressedData:
+				printf("Invalid compressed data\n");
+				return true;
 		}
 
 		// only ErrorCode::Success means there wasn't an error, so all other paths have to assume there was an error
@@ -95,13 +111,15 @@ extern void ExampleFunctionSymbols(const PDB::RawFile&, const PDB::DBIStream&);
 extern void ExampleFunctionVariables(const PDB::RawFile& rawPdbFile, const PDB::DBIStream& dbiStream, const PDB::TPIStream&);
 extern void ExampleLines(const PDB::RawFile& rawPdbFile, const PDB::DBIStream& dbiStream, const PDB::InfoStream& infoStream);
 extern void ExampleTypes(const PDB::TPIStream&);
-extern void ExampleIPI(const PDB::RawFile& rawPdbFile, const PDB::InfoStream& infoStream, const PDB::TPIStream& tpiStream, const PDB::IPIStream& ipiStream);
+extern void ExampleTypeMerge(const PDB::TPIStream& tpiStream, const PDB::TPIStream& otherTpiStream);
+extern void ExampleSymbolIndexCache(const PDB::RawFile& rawPdbFile, const PDB::DBIStream& dbiStream, const PDB::InfoStream& infoStream);
+extern void ExampleIPI(const PDB::RawFile& rawPdbFile, const PDB::DBIStream& dbiStream, const PDB::InfoStream& infoStream, const PDB::TPIStream& tpiStream, const PDB::IPIStream& ipiStream);
 
 int main(int argc, char** argv)
 {
-	if (argc != 2)
+	if ((argc != 2) && (argc != 3))
 	{
-		printf("Usage: Examples <PDB path>\nError: Incorrect usage\n");
+		printf("Usage: Examples <PDB path> [<PDB path to merge types with>]\nError: Incorrect usage\n");
 
 		return 1;
 	}
@@ -148,6 +166,14 @@ int main(int argc, char** argv)
 		h->guid.Data1, h->guid.Data2, h->guid.Data3,
 		h->guid.Data4[0], h->guid.Data4[1], h->guid.Data4[2], h->guid.Data4[3], h->guid.Data4[4], h->guid.Data4[5], h->guid.Data4[6], h->guid.Data4[7]);
 
+	// named streams can be enumerated, or looked up by name
+	for (const PDB::NamedStreamMap::HashTableEntry& entry : infoStream.GetNamedStreams())
+	{
+		printf("Named stream %s at index %u\n", infoStream.GetNamedStreamName(entry), entry.streamIndex);
+	}
+
+	printf("Stream /LinkInfo at index %u\n", infoStream.FindNamedStream("/LinkInfo"));
+
 	const PDB::DBIStream dbiStream = PDB::CreateDBIStream(rawPdbFile);
 	if (!HasValidDBIStreams(rawPdbFile, dbiStream))
 	{
@@ -162,7 +188,7 @@ int main(int argc, char** argv)
 
 		return 5;
 	}
-	const PDB::TPIStream tpiStream = PDB::CreateTPIStream(rawPdbFile);
+	PDB::TPIStream tpiStream = PDB::CreateTPIStream(rawPdbFile);
 
 	PDB::IPIStream ipiStream;
 
@@ -189,11 +215,49 @@ int main(int argc, char** argv)
 	ExampleFunctionSymbols(rawPdbFile, dbiStream);
 	ExampleFunctionVariables(rawPdbFile, dbiStream, tpiStream);
 	ExampleLines(rawPdbFile, dbiStream, infoStream);
+	tpiStream.BuildNameIndex(rawPdbFile);
 	ExampleTypes(tpiStream);
-	ExampleIPI(rawPdbFile, infoStream, tpiStream, ipiStream);
+	ExampleIPI(rawPdbFile, dbiStream, infoStream, tpiStream, ipiStream);
+	ExampleSymbolIndexCache(rawPdbFile, dbiStream, infoStream);
 	// uncomment to dump type sizes to a CSV
 	// ExampleTPISize(tpiStream, "output.csv");
 
+	// the types of a second PDB can optionally be merged with the ones of the first
+	if (argc == 3)
+	{
+		MemoryMappedFile::Handle otherPdbFile = MemoryMappedFile::Open(argv[2]);
+		if (!otherPdbFile.baseAddress)
+		{
+			printf("Cannot memory-map file %s\n", argv[2]);
+
+			MemoryMappedFile::Close(pdbFile);
+
+			return 1;
+		}
+
+		if (IsError(PDB::ValidateFile(otherPdbFile.baseAddress, otherPdbFile.len)))
+		{
+			MemoryMappedFile::Close(otherPdbFile);
+			MemoryMappedFile::Close(pdbFile);
+
+			return 2;
+		}
+
+		const PDB::RawFile otherRawPdbFile = PDB::CreateRawFile(otherPdbFile.baseAddress);
+		if (IsError(PDB::HasValidTPIStream(otherRawPdbFile)))
+		{
+			MemoryMappedFile::Close(otherPdbFile);
+			MemoryMappedFile::Close(pdbFile);
+
+			return 5;
+		}
+
+		const PDB::TPIStream otherTpiStream = PDB::CreateTPIStream(otherRawPdbFile);
+		ExampleTypeMerge(tpiStream, otherTpiStream);
+
+		MemoryMappedFile::Close(otherPdbFile);
+	}
+
 	MemoryMappedFile::Close(pdbFile);
 
 	return 0;
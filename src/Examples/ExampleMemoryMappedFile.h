@@ -1,6 +1,8 @@
 // Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
 // See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
 
+#pragma once
+
 #ifndef _WIN32
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -0,0 +1,42 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include <thread>
+#include <atomic>
+#include <vector>
+
+
+// A simple parallel-for that can be handed to the library's parallel constructors.
+// tasks are distributed across one thread per hardware thread, and the call returns once all tasks have finished.
+struct ParallelFor
+{
+	template <typename F>
+	void operator()(size_t count, F&& task) const
+	{
+		std::atomic<size_t> nextIndex(0u);
+		const auto worker = [&nextIndex, &task, count]()
+		{
+			for (size_t i = nextIndex++; i < count; i = nextIndex++)
+			{
+				task(i);
+			}
+		};
+
+		const unsigned int threadCount = std::thread::hardware_concurrency();
+		std::vector<std::thread> threads;
+		for (unsigned int i = 1u; i < threadCount; ++i)
+		{
+			threads.emplace_back(worker);
+		}
+
+		// the calling thread helps out as well
+		worker();
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+};
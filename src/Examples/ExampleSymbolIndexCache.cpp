@@ -0,0 +1,61 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "Examples_PCH.h"
+#include "ExampleTimedScope.h"
+#include "PDB_RawFile.h"
+#include "PDB_DBIStream.h"
+#include "PDB_InfoStream.h"
+#include "PDB_SymbolIndexCache.h"
+#include "PDB_SymbolIndexCacheWriter.h"
+
+
+void ExampleSymbolIndexCache(const PDB::RawFile& rawPdbFile, const PDB::DBIStream& dbiStream, const PDB::InfoStream& infoStream);
+void ExampleSymbolIndexCache(const PDB::RawFile& rawPdbFile, const PDB::DBIStream& dbiStream, const PDB::InfoStream& infoStream)
+{
+	TimedScope total("\nRunning example \"SymbolIndexCache\"");
+
+	// building the cache parses all modules, and only needs to be done once per PDB.
+	// the data can be written to disk as is, e.g. into a file named after the PDB's GUID and age.
+	TimedScope writerScope("Building symbol index cache");
+	const PDB::SymbolIndexCacheWriter writer = PDB::CreateSymbolIndexCacheWriter(rawPdbFile, infoStream, dbiStream);
+	const PDB::ArrayView<PDB::Byte> data = writer.GetData();
+	writerScope.Done();
+
+	if (data.GetLength() == 0u)
+	{
+		printf("Symbol index cache would exceed the maximum size of 4 GiB\n");
+		return;
+	}
+
+	// in a later run, the cache would be memory-mapped from disk instead.
+	// it only needs to be validated against the PDB's GUID and age before it can be used without any further parsing.
+	TimedScope cacheScope("Opening symbol index cache");
+	const PDB::Header* header = infoStream.GetHeader();
+	if (PDB::ValidateSymbolIndexCache(data.Decay(), data.GetLength(), header->guid, header->age) != PDB::ErrorCode::Success)
+	{
+		printf("Symbol index cache is invalid\n");
+		return;
+	}
+
+	const PDB::SymbolIndexCache cache = PDB::CreateSymbolIndexCache(data.Decay());
+	cacheScope.Done();
+
+	printf("Symbol index cache of %zu bytes stores %zu functions, %zu lines and %zu contributions\n", data.GetLength(),
+		cache.GetFunctions().GetLength(), cache.GetLineIndex().GetLineCount(), cache.GetContributions().GetLength());
+
+	// symbolicate the first few functions. the cache stores the filenames of all lines, so the "/names" stream is not needed.
+	const PDB::ArrayView<PDB::SymbolIndexCache::Function> functions = cache.GetFunctions();
+	for (size_t i = 0u; i < functions.GetLength() && i < 10u; ++i)
+	{
+		const uint32_t rva = functions[i].rva;
+		const PDB::SymbolIndexCache::Function* function = cache.FindFunction(rva);
+		const PDB::SymbolIndexCache::Contribution* contribution = cache.FindContribution(rva);
+
+		PDB::LineIndex::Line line = {};
+		const bool hasLine = cache.GetLineIndex().FindLine(rva, line);
+
+		printf("RVA 0x%08X: %s, %s(%u), module %u\n", rva, function ? cache.GetFunctionName(*function) : "<unknown>",
+			hasLine ? cache.GetFilename(line) : "<unknown>", hasLine ? line.lineNumber : 0u, contribution ? contribution->moduleIndex : 0u);
+	}
+}
@@ -0,0 +1,91 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "Examples_PCH.h"
+#include "ExampleTimedScope.h"
+#include "PDB_TPIStream.h"
+#include "PDB_TypeTable.h"
+#include "PDB_TypeHasher.h"
+#include "PDB_TypeStore.h"
+#include "PDB_Util.h"
+#include <unordered_map>
+
+
+namespace
+{
+	// Returns the unique name of a user-defined type definition, falling back to its regular name.
+	// Returns nullptr for forward references and all other records.
+	static const char* GetDefinitionName(const PDB::CodeView::TPI::Record* record)
+	{
+		PDB::CodeView::TPI::TypeProperty property = {};
+		if (!record || !PDB::GetUDTProperty(record, property) || property.fwdref)
+		{
+			return nullptr;
+		}
+
+		const char* uniqueName = PDB::GetUDTUniqueName(record, property);
+		return uniqueName ? uniqueName : PDB::GetUDTName(record);
+	}
+}
+
+
+void ExampleTypeMerge(const PDB::TPIStream& tpiStream, const PDB::TPIStream& otherTpiStream);
+void ExampleTypeMerge(const PDB::TPIStream& tpiStream, const PDB::TPIStream& otherTpiStream)
+{
+	TimedScope total("\nRunning example \"TypeMerge\"");
+
+	// type indices are local to each PDB, but structural hashes replace every referenced type index by the hash of the
+	// referenced type. a type defined identically in both PDBs is therefore stored only once, no matter which type
+	// indices the two PDBs assign to it or to the types it refers to, including friend classes and nested types.
+	TimedScope hasherScope("Hashing the types of both PDBs");
+	const PDB::TypeTable typeTable = PDB::CreateTypeTable(tpiStream, PDB::TypeTable::Mode::Coalesced);
+	const PDB::TypeTable otherTypeTable = PDB::CreateTypeTable(otherTpiStream, PDB::TypeTable::Mode::Coalesced);
+	const PDB::TypeHasher typeHasher = PDB::CreateTypeHasher(typeTable);
+	const PDB::TypeHasher otherTypeHasher = PDB::CreateTypeHasher(otherTypeTable);
+	hasherScope.Done(typeTable.GetTypeRecordCount() + otherTypeTable.GetTypeRecordCount());
+
+	TimedScope storeScope("Merging the types of both PDBs into a PDB::TypeStore");
+	PDB::TypeStore typeStore;
+	std::vector<uint32_t> globalTypeIndices(typeTable.GetTypeRecordCount());
+	std::vector<uint32_t> otherGlobalTypeIndices(otherTypeTable.GetTypeRecordCount());
+	const size_t addedCount = typeStore.AddTypes(typeTable, typeHasher, globalTypeIndices.data());
+	const size_t otherAddedCount = typeStore.AddTypes(otherTypeTable, otherTypeHasher, otherGlobalTypeIndices.data());
+	storeScope.Done(typeStore.GetTypeCount());
+
+	printf("Type store holds %zu distinct types (%zu added by the first PDB, %zu by the second), allocating %zu bytes\n",
+		typeStore.GetTypeCount(), addedCount, otherAddedCount, typeStore.GetAllocatedSize());
+
+	// check that user-defined types defined in both PDBs share their global type. this only holds for types whose
+	// definitions really are identical, e.g. for PDBs generated with the same seed but a different number of signatures.
+	std::unordered_map<std::string, uint32_t> globalTypeIndexByName;
+	for (uint32_t typeIndex = typeTable.GetFirstTypeIndex(); typeIndex < typeTable.GetLastTypeIndex(); ++typeIndex)
+	{
+		const char* name = GetDefinitionName(typeTable.GetTypeRecord(typeIndex));
+		if (name)
+		{
+			globalTypeIndexByName.emplace(name, globalTypeIndices[typeIndex - typeTable.GetFirstTypeIndex()]);
+		}
+	}
+
+	size_t commonCount = 0u;
+	size_t sharedCount = 0u;
+	for (uint32_t typeIndex = otherTypeTable.GetFirstTypeIndex(); typeIndex < otherTypeTable.GetLastTypeIndex(); ++typeIndex)
+	{
+		const char* name = GetDefinitionName(otherTypeTable.GetTypeRecord(typeIndex));
+		if (!name)
+		{
+			continue;
+		}
+
+		const auto it = globalTypeIndexByName.find(name);
+		if (it != globalTypeIndexByName.end())
+		{
+			++commonCount;
+			sharedCount += (it->second == otherGlobalTypeIndices[typeIndex - otherTypeTable.GetFirstTypeIndex()]) ? 1u : 0u;
+		}
+	}
+
+	printf("%zu of %zu user-defined types defined in both PDBs share their global type\n", sharedCount, commonCount);
+
+	total.Done(typeStore.GetTypeCount());
+}
@@ -2,6 +2,13 @@
 #include "Examples_PCH.h"
 #include "ExampleTimedScope.h"
 #include "ExampleTypeTable.h"
+#include "ExampleParallelFor.h"
+#include "PDB_TypeTable.h"
+#include "PDB_TypeLayoutEngine.h"
+#include "PDB_ForwardReferenceMap.h"
+#include "PDB_TypeHasher.h"
+#include "PDB_TypeStore.h"
+#include "PDB_FieldList.h"
 #include "PDB_RawFile.h"
 #include "PDB_DBIStream.h"
 #include "PDB_TPIStream.h"
@@ -641,7 +648,7 @@ static const char* GetMethodName(const PDB::CodeView::TPI::FieldList* fieldRecor
 }
 
 
-static void DisplayFields(const TypeTable& typeTable, const PDB::CodeView::TPI::Record* record)
+static void DisplayFields(const TypeTable& typeTable, uint32_t fieldListIndex)
 {
 	const PDB::CodeView::TPI::Record* referencedType = nullptr;
 	const PDB::CodeView::TPI::Record* underlyingType = nullptr;
@@ -651,19 +658,16 @@ static void DisplayFields(const TypeTable& typeTable, const PDB::CodeView::TPI::
 	std::string functionPrototype;
 	uint16_t offset = 0;
 
-	auto maximumSize = record->header.size - sizeof(uint16_t);
-
-	for (size_t i = 0; i < maximumSize;)
+	// split field lists are followed automatically
+	PDB::ForEachField(typeTable, fieldListIndex, [&](const PDB::CodeView::TPI::FieldList* fieldRecord)
 	{
 		uint8_t pointerLevel = 0;
-		auto fieldRecord = reinterpret_cast<const PDB::CodeView::TPI::FieldList*>(reinterpret_cast<const uint8_t*>(&record->data.LF_FIELD.list) + i);
 
 		// Other kinds of records are not implemented
 		PDB_ASSERT(
 			fieldRecord->kind == PDB::CodeView::TPI::TypeRecordKind::LF_BCLASS ||
 			fieldRecord->kind == PDB::CodeView::TPI::TypeRecordKind::LF_VBCLASS ||
 			fieldRecord->kind == PDB::CodeView::TPI::TypeRecordKind::LF_IVBCLASS ||
-			fieldRecord->kind == PDB::CodeView::TPI::TypeRecordKind::LF_INDEX ||
 			fieldRecord->kind == PDB::CodeView::TPI::TypeRecordKind::LF_VFUNCTAB ||
 			fieldRecord->kind == PDB::CodeView::TPI::TypeRecordKind::LF_NESTTYPE ||
 			fieldRecord->kind == PDB::CodeView::TPI::TypeRecordKind::LF_ENUM ||
@@ -681,7 +685,7 @@ static void DisplayFields(const TypeTable& typeTable, const PDB::CodeView::TPI::
 			else
 				offset = *reinterpret_cast<const uint16_t*>(&fieldRecord->data.LF_MEMBER.offset[sizeof(PDB::CodeView::TPI::TypeRecordKind)]);
 
-			leafName = GetLeafName(fieldRecord->data.LF_MEMBER.offset, fieldRecord->data.LF_MEMBER.lfEasy.kind);
+			leafName = PDB::GetFieldName(fieldRecord);
 
 			typeName = GetTypeName(typeTable, fieldRecord->data.LF_MEMBER.index, pointerLevel, &referencedType, &modifierRecord);
 			if (referencedType)
@@ -809,7 +813,7 @@ static void DisplayFields(const TypeTable& typeTable, const PDB::CodeView::TPI::
 
 			auto methodList = typeTable.GetTypeRecord(fieldRecord->data.LF_METHOD.mList);
 			if (!methodList)
-				break;
+				return;
 
 			// https://github.com/microsoft/microsoft-pdb/blob/master/PDB/include/symtypeutils.h#L220
 			size_t offsetInMethodList = 0;
@@ -829,63 +833,19 @@ static void DisplayFields(const TypeTable& typeTable, const PDB::CodeView::TPI::
 		}
 		else if (fieldRecord->kind == PDB::CodeView::TPI::TypeRecordKind::LF_ONEMETHOD)
 		{
-			leafName = GetMethodName(fieldRecord);
+			leafName = PDB::GetFieldName(fieldRecord);
 
 			referencedType = typeTable.GetTypeRecord(fieldRecord->data.LF_ONEMETHOD.index);
 			if (!referencedType)
-				break;
+				return;
 
 			if (!GetMethodPrototype(typeTable, referencedType, functionPrototype))
-				break;
+				return;
 
 			printf(functionPrototype.c_str(), leafName);
 			printf("\n");
 		}
-		else if (fieldRecord->kind == PDB::CodeView::TPI::TypeRecordKind::LF_BCLASS)
-		{
-			leafName = GetLeafName(fieldRecord->data.LF_BCLASS.offset, fieldRecord->data.LF_BCLASS.lfEasy.kind);
-
-			i += static_cast<size_t>(leafName - reinterpret_cast<const char*>(fieldRecord));
-			i = (i + (sizeof(uint32_t) - 1)) & (0 - sizeof(uint32_t));
-			continue;
-		}
-		else if (fieldRecord->kind == PDB::CodeView::TPI::TypeRecordKind::LF_VBCLASS || fieldRecord->kind == PDB::CodeView::TPI::TypeRecordKind::LF_IVBCLASS)
-		{
-			// virtual base pointer offset from address point
-			// followed by virtual base offset from vbtable
-
-			const PDB::CodeView::TPI::TypeRecordKind vbpOffsetAddressPointKind = *(const PDB::CodeView::TPI::TypeRecordKind*)(fieldRecord->data.LF_IVBCLASS.vbpOffset);
-			const uint8_t vbpOffsetAddressPointSize = GetLeafSize(vbpOffsetAddressPointKind);
-
-			const  PDB::CodeView::TPI::TypeRecordKind vbpOffsetVBTableKind = *(const PDB::CodeView::TPI::TypeRecordKind*)(fieldRecord->data.LF_IVBCLASS.vbpOffset + vbpOffsetAddressPointSize);
-			const uint8_t vbpOffsetVBTableSize = GetLeafSize(vbpOffsetVBTableKind);
-
-			i += sizeof(PDB::CodeView::TPI::FieldList::Data::LF_VBCLASS);
-			i += vbpOffsetAddressPointSize + vbpOffsetVBTableSize;
-			i = (i + (sizeof(uint32_t) - 1)) & (0 - sizeof(uint32_t));
-			continue;
-		}
-		else if (fieldRecord->kind == PDB::CodeView::TPI::TypeRecordKind::LF_INDEX)
-		{
-			i += sizeof(PDB::CodeView::TPI::FieldList::Data::LF_INDEX);
-			i = (i + (sizeof(uint32_t) - 1)) & (0 - sizeof(uint32_t));
-			continue;
-		}
-		else if (fieldRecord->kind == PDB::CodeView::TPI::TypeRecordKind::LF_VFUNCTAB)
-		{
-			i += sizeof(PDB::CodeView::TPI::FieldList::Data::LF_VFUNCTAB);
-			i = (i + (sizeof(uint32_t) - 1)) & (0 - sizeof(uint32_t));
-			continue;
-		}
-		else
-		{
-			break;
-		}
-
-		i += static_cast<size_t>(leafName - reinterpret_cast<const char*>(fieldRecord));
-		i += strnlen(leafName, maximumSize - i - 1) + 1;
-		i = (i + (sizeof(uint32_t) - 1)) & (0 - sizeof(uint32_t));
-	}
+	});
 }
 
 // Used in ExamplesFunctionVariables
@@ -968,24 +928,14 @@ std::string GetTypeName(const TypeTable& typeTable, uint32_t typeIndex)
 	return typeName;
 }
 
-static void DisplayEnumerates(const PDB::CodeView::TPI::Record* record, uint8_t underlyingTypeSize)
+static void DisplayEnumerates(const TypeTable& typeTable, uint32_t fieldListIndex, uint8_t underlyingTypeSize)
 {
-	const char* leafName = nullptr;
-	uint64_t value = 0;
-	const char* valuePtr = nullptr;
-
-	auto maximumSize = record->header.size - sizeof(uint16_t);
-
-	for (size_t i = 0; i < maximumSize;)
+	PDB::ForEachField(typeTable, fieldListIndex, [underlyingTypeSize](const PDB::CodeView::TPI::FieldList* fieldRecord)
 	{
-		auto fieldRecord = reinterpret_cast<const PDB::CodeView::TPI::FieldList*>(reinterpret_cast<const uint8_t*>(&record->data.LF_FIELD.list) + i);
+		if (fieldRecord->kind != PDB::CodeView::TPI::TypeRecordKind::LF_ENUMERATE)
+			return;
 
-		leafName = GetLeafName(fieldRecord->data.LF_ENUMERATE.value, fieldRecord->data.LF_ENUMERATE.lfEasy.kind);
-		
-		if (fieldRecord->data.LF_ENUMERATE.lfEasy.kind < PDB::CodeView::TPI::TypeRecordKind::LF_NUMERIC)
-			valuePtr = &fieldRecord->data.LF_ENUMERATE.value[0];
-		else
-			valuePtr = &fieldRecord->data.LF_ENUMERATE.value[sizeof(PDB::CodeView::TPI::TypeRecordKind)];
+		uint64_t value = 0;
 
 		switch (underlyingTypeSize)
 		{
@@ -1005,14 +955,8 @@ static void DisplayEnumerates(const PDB::CodeView::TPI::Record* record, uint8_t
 			break;
 		}
 
-		printf("%s = %" PRIu64 "\n", leafName, value);
-
-		i += static_cast<size_t>(leafName - reinterpret_cast<const char*>(fieldRecord));
-		i += strnlen(leafName, maximumSize - i - 1) + 1;
-		i = (i + (sizeof(uint32_t) - 1)) & (0 - sizeof(uint32_t));
-
-		(void)valuePtr;
-	}
+		printf("%s = %" PRIu64 "\n", PDB::GetFieldName(fieldRecord), value);
+	});
 }
 
 
@@ -1032,15 +976,11 @@ void ExampleTypes(const PDB::TPIStream& tpiStream)
 			if (record->data.LF_CLASS.property.fwdref)
 				continue;
 
-			auto typeRecord = typeTable.GetTypeRecord(record->data.LF_CLASS.field);
-			if (!typeRecord)
-				continue;
-
 			auto leafName = GetLeafName(record->data.LF_CLASS.data, record->data.LF_CLASS.lfEasy.kind);
 
 			printf("struct %s\n{\n", leafName);
 			
-			DisplayFields(typeTable, typeRecord);
+			DisplayFields(typeTable, record->data.LF_CLASS.field);
 
 			printf("}\n");
 		}
@@ -1049,15 +989,11 @@ void ExampleTypes(const PDB::TPIStream& tpiStream)
 			if (record->data.LF_UNION.property.fwdref)
 				continue;
 
-			auto typeRecord = typeTable.GetTypeRecord(record->data.LF_UNION.field);
-			if (!typeRecord)
-				continue;
-
 			auto leafName = GetLeafName(record->data.LF_UNION.data, static_cast<PDB::CodeView::TPI::TypeRecordKind>(0));
 
 			printf("union %s\n{\n", leafName);
 
-			DisplayFields(typeTable, typeRecord);
+			DisplayFields(typeTable, record->data.LF_UNION.field);
 
 			printf("}\n");
 		}
@@ -1066,18 +1002,125 @@ void ExampleTypes(const PDB::TPIStream& tpiStream)
 			if (record->data.LF_ENUM.property.fwdref)
 				continue;
 
-			auto typeRecord = typeTable.GetTypeRecord(record->data.LF_ENUM.field);
-			if (!typeRecord)
-				continue;
-
 			printf("enum %s\n{\n", record->data.LF_ENUM.name);
 
-			DisplayEnumerates(typeRecord, GetLeafSize(static_cast<PDB::CodeView::TPI::TypeRecordKind>(record->data.LF_ENUM.utype)));
+			DisplayEnumerates(typeTable, record->data.LF_ENUM.field, GetLeafSize(static_cast<PDB::CodeView::TPI::TypeRecordKind>(record->data.LF_ENUM.utype)));
 
 			printf("}\n");
 		}
 	}
 
+	{
+		// single records can also be accessed directly from the TPI stream without building a type table first.
+		// the stream seeks to the closest known record offset stored in the hash stream and walks from there.
+		TimedScope randomAccessScope("Random access to type records");
+
+		size_t foundCount = 0u;
+		const uint32_t step = static_cast<uint32_t>(tpiStream.GetTypeRecordCount() / 1000u) + 1u;
+		for (uint32_t typeIndex = tpiStream.GetFirstTypeIndex(); typeIndex < tpiStream.GetLastTypeIndex(); typeIndex += step)
+		{
+			const PDB::CoalescedMSFStream recordStream = tpiStream.GetRecordAtIndex(typeIndex);
+			const PDB::CodeView::TPI::Record* record = recordStream.GetDataAtOffset<const PDB::CodeView::TPI::Record>(0u);
+			if (recordStream.GetSize() != 0u && record->header.kind == typeTable.GetTypeRecord(typeIndex)->header.kind)
+			{
+				++foundCount;
+			}
+		}
+
+		randomAccessScope.Done(foundCount);
+	}
+
+	{
+		// user-defined types can be found by name using the type hash table stored in the hash stream
+		TimedScope nameLookupScope("Looking up types by name");
+
+		size_t foundCount = 0u;
+		for (const PDB::CodeView::TPI::Record* record : typeTable.GetTypeRecords())
+		{
+			PDB::CodeView::TPI::TypeProperty property = {};
+			if (!PDB::GetUDTProperty(record, property) || property.fwdref)
+			{
+				continue;
+			}
+
+			const uint32_t typeIndex = tpiStream.FindTypeByName(PDB::GetUDTName(record));
+			if (typeIndex != 0u)
+			{
+				++foundCount;
+			}
+
+			if (foundCount == 1000u)
+			{
+				break;
+			}
+		}
+
+		nameLookupScope.Done(foundCount);
+	}
+
+	{
+		// the library's type table can either coalesce the whole stream, or only store offsets and access records lazily
+		TimedScope coalescedScope("Create coalesced PDB::TypeTable");
+		const PDB::TypeTable coalescedTable = PDB::CreateTypeTable(tpiStream, PDB::TypeTable::Mode::Coalesced);
+		coalescedScope.Done(coalescedTable.GetTypeRecordCount());
+
+		TimedScope lazyScope("Create lazy PDB::TypeTable");
+		const PDB::TypeTable lazyTable = PDB::CreateTypeTable(tpiStream, PDB::TypeTable::Mode::Lazy);
+		lazyScope.Done(lazyTable.GetTypeRecordCount());
+
+		printf("Coalesced type table allocates %zu bytes, lazy type table allocates %zu bytes\n", coalescedTable.GetAllocatedSize(), lazyTable.GetAllocatedSize());
+
+		// tables can also be built concurrently, with the caller providing the threads
+		TimedScope parallelScope("Create lazy PDB::TypeTable in parallel");
+		const PDB::TypeTable parallelTable(tpiStream, PDB::TypeTable::Mode::Lazy, ParallelFor {});
+		parallelScope.Done(parallelTable.GetTypeRecordCount());
+
+		// forward references to user-defined types are resolved to their definition once, after which following them is O(1)
+		TimedScope forwardScope("Create PDB::ForwardReferenceMap in parallel");
+		const PDB::ForwardReferenceMap forwardReferenceMap(parallelTable, ParallelFor {});
+		forwardScope.Done(forwardReferenceMap.GetResolvedCount());
+
+		// the layout engine computes flattened layouts of all user-defined types up front
+		TimedScope layoutScope("Create PDB::TypeLayoutEngine");
+		const PDB::TypeLayoutEngine layoutEngine = PDB::CreateTypeLayoutEngine(parallelTable, forwardReferenceMap);
+		layoutScope.Done(layoutEngine.GetLayouts().GetLength());
+
+		const PDB::TypeLayoutEngine::Layout* largestLayout = nullptr;
+		for (const PDB::TypeLayoutEngine::Layout& layout : layoutEngine.GetLayouts())
+		{
+			if (!largestLayout || (layout.memberCount > largestLayout->memberCount))
+			{
+				largestLayout = &layout;
+			}
+		}
+
+		if (largestLayout)
+		{
+			printf("Layout of '%s' (%u bytes):\n", largestLayout->name, largestLayout->size);
+			for (const PDB::TypeLayoutEngine::Member& member : layoutEngine.GetMembers(*largestLayout))
+			{
+				printf("  [0x%X] %s (%u bytes)\n", member.offset, member.name ? member.name : "<vfptr>", layoutEngine.GetTypeSize(member.typeIndex));
+			}
+		}
+
+		printf("Type layout engine allocates %zu bytes\n", layoutEngine.GetAllocatedSize());
+
+		// structural hashes do not depend on type indices, so a store can deduplicate the types of many PDBs.
+		// adding the same PDB a second time does not add any types.
+		TimedScope hasherScope("Create PDB::TypeHasher");
+		const PDB::TypeHasher typeHasher = PDB::CreateTypeHasher(parallelTable);
+		hasherScope.Done(typeHasher.GetHashes().GetLength());
+
+		TimedScope storeScope("Adding types to PDB::TypeStore twice");
+		PDB::TypeStore typeStore;
+		std::vector<uint32_t> globalTypeIndices(parallelTable.GetTypeRecordCount());
+		const size_t firstAddedCount = typeStore.AddTypes(parallelTable, typeHasher, globalTypeIndices.data());
+		const size_t secondAddedCount = typeStore.AddTypes(parallelTable, typeHasher, globalTypeIndices.data());
+		storeScope.Done(typeStore.GetTypeCount());
+
+		printf("Type store holds %zu distinct types (%zu added, then %zu), allocating %zu bytes\n", typeStore.GetTypeCount(), firstAddedCount, secondAddedCount, typeStore.GetAllocatedSize());
+	}
+
 	total.Done(tpiStream.GetTypeRecordCount());
 }
 
@@ -69,5 +69,17 @@ namespace PDB
 
 			return result;
 		}
+
+
+		// Returns the number of set bits in the given value.
+		// This operation is also known as POPCNT.
+		PDB_NO_DISCARD inline uint32_t CountSetBits(uint32_t value) PDB_NO_EXCEPT
+		{
+			value = value - ((value >> 1u) & 0x55555555u);
+			value = (value & 0x33333333u) + ((value >> 2u) & 0x33333333u);
+			value = (value + (value >> 4u)) & 0x0F0F0F0Fu;
+
+			return (value * 0x01010101u) >> 24u;
+		}
 	}
 }
@@ -0,0 +1,93 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "PDB_Macros.h"
+
+
+namespace PDB
+{
+	namespace Hash
+	{
+		static constexpr const uint32_t FNV1aOffsetBasis = 2166136261u;
+		static constexpr const uint32_t FNV1aPrime = 16777619u;
+
+		// Hashes any number of bytes using 32-bit FNV-1a. Pass the result of a previous call as seed to hash several
+		// non-contiguous pieces of data.
+		PDB_NO_DISCARD inline uint32_t FNV1a(const void* data, size_t size, uint32_t seed = FNV1aOffsetBasis) PDB_NO_EXCEPT
+		{
+			const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+			uint32_t hash = seed;
+			for (size_t i = 0u; i < size; ++i)
+			{
+				hash ^= bytes[i];
+				hash *= FNV1aPrime;
+			}
+
+			return hash;
+		}
+
+		// Hashes a string the same way the PDB does for type names and hash tables using hash version 1.
+		// https://github.com/microsoft/microsoft-pdb/blob/master/PDB/include/misc.h#L15
+		PDB_NO_DISCARD inline uint32_t HashStringV1(const char* string, size_t length) PDB_NO_EXCEPT
+		{
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(string);
+
+			uint32_t hash = 0u;
+
+			// xor all 4-byte words, followed by a remaining 2-byte word and byte
+			size_t i = 0u;
+			for (/* nothing */; i + 4u <= length; i += 4u)
+			{
+				hash ^= static_cast<uint32_t>(bytes[i]) | (static_cast<uint32_t>(bytes[i + 1u]) << 8u) | (static_cast<uint32_t>(bytes[i + 2u]) << 16u) | (static_cast<uint32_t>(bytes[i + 3u]) << 24u);
+			}
+
+			if (i + 2u <= length)
+			{
+				hash ^= static_cast<uint32_t>(bytes[i]) | (static_cast<uint32_t>(bytes[i + 1u]) << 8u);
+				i += 2u;
+			}
+
+			if (i < length)
+			{
+				hash ^= bytes[i];
+			}
+
+			// make the hash case-insensitive
+			hash |= 0x20202020u;
+			hash ^= (hash >> 11u);
+
+			return hash ^ (hash >> 16u);
+		}
+
+		// Hashes a string the same way the PDB does for the names stream using hash version 2.
+		// https://github.com/microsoft/microsoft-pdb/blob/master/PDB/include/misc.h#L76
+		PDB_NO_DISCARD inline uint32_t HashStringV2(const char* string, size_t length) PDB_NO_EXCEPT
+		{
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(string);
+
+			uint32_t hash = 0xB170A1BFu;
+
+			// add all 4-byte words, followed by the remaining bytes
+			size_t i = 0u;
+			for (/* nothing */; i + 4u <= length; i += 4u)
+			{
+				hash += static_cast<uint32_t>(bytes[i]) | (static_cast<uint32_t>(bytes[i + 1u]) << 8u) | (static_cast<uint32_t>(bytes[i + 2u]) << 16u) | (static_cast<uint32_t>(bytes[i + 3u]) << 24u);
+				hash += (hash << 10u);
+				hash ^= (hash >> 6u);
+			}
+
+			for (/* nothing */; i < length; ++i)
+			{
+				// remaining bytes are added as signed chars
+				hash += static_cast<uint32_t>(static_cast<int32_t>(static_cast<signed char>(bytes[i])));
+				hash += (hash << 10u);
+				hash ^= (hash >> 6u);
+			}
+
+			return hash * 1664525u + 1013904223u;
+		}
+	}
+}
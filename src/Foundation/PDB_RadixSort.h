@@ -0,0 +1,68 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "PDB_Macros.h"
+#include "PDB_CRT.h"
+
+
+namespace PDB
+{
+	namespace RadixSort
+	{
+		// Sorts an array of indices by the keys they refer to, using a stable LSD radix sort with 8-bit digits.
+		// The indices array must be initialized by the caller, e.g. to 0..count-1. Because the sort is stable,
+		// composite keys can be sorted by calling this function once per key, starting with the least significant one.
+		// The scratch array must be able to hold count elements.
+		template <typename Key>
+		inline void SortIndices(const Key* keys, uint32_t* indices, uint32_t* scratch, size_t count) PDB_NO_EXCEPT
+		{
+			if (count == 0u)
+			{
+				return;
+			}
+
+			uint32_t* source = indices;
+			uint32_t* destination = scratch;
+
+			for (uint32_t shift = 0u; shift < sizeof(Key) * 8u; shift += 8u)
+			{
+				size_t histogram[256u] = {};
+				for (size_t i = 0u; i < count; ++i)
+				{
+					++histogram[(keys[source[i]] >> shift) & 0xFFu];
+				}
+
+				// skip passes where all keys share the same digit, which is common for small key ranges
+				if (histogram[(keys[source[0u]] >> shift) & 0xFFu] == count)
+				{
+					continue;
+				}
+
+				size_t sum = 0u;
+				for (size_t& bucket : histogram)
+				{
+					const size_t bucketCount = bucket;
+					bucket = sum;
+					sum += bucketCount;
+				}
+
+				for (size_t i = 0u; i < count; ++i)
+				{
+					const uint32_t index = source[i];
+					destination[histogram[(keys[index] >> shift) & 0xFFu]++] = index;
+				}
+
+				uint32_t* temp = source;
+				source = destination;
+				destination = temp;
+			}
+
+			if (source != indices)
+			{
+				memcpy(indices, source, sizeof(uint32_t) * count);
+			}
+		}
+	}
+}
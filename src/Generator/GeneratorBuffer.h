@@ -0,0 +1,101 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+
+// A growable buffer used for building the contents of a stream, with helpers for writing CodeView records.
+class GeneratorBuffer
+{
+public:
+	// most buffers end up holding at least a few records
+	GeneratorBuffer(void)
+		: m_data()
+	{
+		m_data.reserve(4096u);
+	}
+
+	template <typename T>
+	void Write(const T& value)
+	{
+		WriteBytes(&value, sizeof(T));
+	}
+
+	void WriteBytes(const void* data, size_t size)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		m_data.insert(m_data.end(), bytes, bytes + size);
+	}
+
+	// writes a string including its null terminator
+	void WriteString(const char* string)
+	{
+		WriteBytes(string, strlen(string) + 1u);
+	}
+
+	void WriteZeros(size_t count)
+	{
+		m_data.resize(m_data.size() + count, 0u);
+	}
+
+	// pads the buffer with zeros to the given alignment, as done for symbol records and substreams
+	void Align(size_t alignment)
+	{
+		WriteZeros((alignment - m_data.size() % alignment) % alignment);
+	}
+
+	// pads the buffer to a 4-byte boundary with LF_PAD bytes, as done for type records and the members of a field list.
+	// each pad byte stores the number of bytes left until the boundary.
+	void AlignWithLeafPadding(void)
+	{
+		while (m_data.size() % 4u != 0u)
+		{
+			m_data.push_back(static_cast<uint8_t>(0xF0u + (4u - m_data.size() % 4u)));
+		}
+	}
+
+	// writes a value into data that has already been written
+	template <typename T>
+	void Patch(size_t offset, const T& value)
+	{
+		memcpy(m_data.data() + offset, &value, sizeof(T));
+	}
+
+	// Begins a CodeView record of the given kind, returning the offset to be passed to EndRecord.
+	size_t BeginRecord(uint16_t kind)
+	{
+		const size_t offset = m_data.size();
+		Write<uint16_t>(0u);
+		Write<uint16_t>(kind);
+
+		return offset;
+	}
+
+	// Ends a CodeView record, storing its size excluding the 2-byte size field.
+	void EndRecord(size_t recordOffset)
+	{
+		Patch<uint16_t>(recordOffset, static_cast<uint16_t>(m_data.size() - recordOffset - sizeof(uint16_t)));
+	}
+
+	void Clear(void)
+	{
+		m_data.clear();
+	}
+
+	const uint8_t* GetData(void) const
+	{
+		return m_data.data();
+	}
+
+	size_t GetSize(void) const
+	{
+		return m_data.size();
+	}
+
+private:
+	std::vector<uint8_t> m_data;
+};
@@ -0,0 +1,379 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "Examples_PCH.h"
+#include "GeneratorMSFWriter.h"
+#include "GeneratorBuffer.h"
+#include "PDB_Types.h"
+
+#include <cstring>
+
+
+namespace
+{
+	// the number of blocks reserved ahead of the end of the file for fragmented allocations
+	static constexpr const size_t ReservedBlockCount = 64u;
+
+	// the super block stores the indices of the blocks holding the directory block indices right after its fixed fields
+	static constexpr const size_t SuperBlockFixedSize = 52u;
+
+	// a stream size of 0xFFFFFFFF denotes a nil stream
+	static constexpr const uint32_t MaxStreamSize = 0xFFFFFFFEu;
+
+
+	static uint32_t ConvertSizeToBlockCount(uint64_t size, uint32_t blockSize)
+	{
+		return static_cast<uint32_t>((size + blockSize - 1u) / blockSize);
+	}
+}
+
+
+GeneratorMSFWriter::GeneratorMSFWriter(uint32_t blockSize, unsigned int fragmentation, uint64_t seed)
+	: m_blockSize(blockSize)
+	, m_fragmentation(fragmentation)
+	, m_random(seed)
+	, m_file(nullptr)
+	, m_filePosition(0u)
+	, m_streams()
+	// block 0 holds the super block, blocks 1 and 2 the two free block maps
+	, m_blockCount(3u)
+	, m_discontinuityCount(0u)
+	, m_reservedBlocks()
+	, m_error()
+{
+}
+
+
+GeneratorMSFWriter::~GeneratorMSFWriter(void)
+{
+	if (m_file)
+	{
+		fclose(m_file);
+	}
+}
+
+
+bool GeneratorMSFWriter::Open(const char* path)
+{
+	m_file = fopen(path, "wb");
+	if (!m_file)
+	{
+		SetError("Cannot open file \"" + std::string(path) + "\" for writing");
+		return false;
+	}
+
+	setvbuf(m_file, nullptr, _IOFBF, 1u << 20u);
+
+	return true;
+}
+
+
+uint32_t GeneratorMSFWriter::AddStream(void)
+{
+	m_streams.emplace_back();
+	m_streams.back().size = 0u;
+
+	return static_cast<uint32_t>(m_streams.size() - 1u);
+}
+
+
+void GeneratorMSFWriter::Append(uint32_t streamIndex, const void* data, size_t size)
+{
+	Stream& stream = m_streams[streamIndex];
+	if (stream.size + size > MaxStreamSize)
+	{
+		SetError("Stream " + std::to_string(streamIndex) + " exceeds the maximum stream size of 4 GiB");
+		return;
+	}
+
+	stream.size += size;
+
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	while (size != 0u)
+	{
+		// whole blocks can be written without going through the pending data
+		if (stream.pending.empty() && (size >= m_blockSize))
+		{
+			AddBlock(stream, bytes);
+			bytes += m_blockSize;
+			size -= m_blockSize;
+			continue;
+		}
+
+		const size_t count = (size < m_blockSize - stream.pending.size()) ? size : m_blockSize - stream.pending.size();
+		stream.pending.insert(stream.pending.end(), bytes, bytes + count);
+		bytes += count;
+		size -= count;
+
+		if (stream.pending.size() == m_blockSize)
+		{
+			AddBlock(stream, stream.pending.data());
+			stream.pending.clear();
+		}
+	}
+}
+
+
+void GeneratorMSFWriter::Patch(uint32_t streamIndex, uint32_t offset, const void* data, size_t size)
+{
+	Stream& stream = m_streams[streamIndex];
+
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	while (size != 0u)
+	{
+		const size_t blockIndex = offset / m_blockSize;
+		const uint32_t offsetWithinBlock = offset % m_blockSize;
+		const size_t count = (size < m_blockSize - offsetWithinBlock) ? size : m_blockSize - offsetWithinBlock;
+
+		// the data either lives in a block that has already been written, or in the pending data
+		if (blockIndex < stream.blocks.size())
+		{
+			WriteAt(static_cast<uint64_t>(stream.blocks[blockIndex]) * m_blockSize + offsetWithinBlock, bytes, count);
+		}
+		else
+		{
+			memcpy(stream.pending.data() + offsetWithinBlock, bytes, count);
+		}
+
+		bytes += count;
+		offset += static_cast<uint32_t>(count);
+		size -= count;
+	}
+}
+
+
+bool GeneratorMSFWriter::Close(void)
+{
+	if (!m_file)
+	{
+		return false;
+	}
+
+	for (Stream& stream : m_streams)
+	{
+		if (!stream.pending.empty())
+		{
+			stream.pending.resize(m_blockSize, 0u);
+			AddBlock(stream, stream.pending.data());
+			stream.pending.clear();
+		}
+	}
+
+	// the directory stores the stream count, the size of each stream, and the block indices of each stream
+	std::vector<uint32_t> directory;
+	directory.push_back(static_cast<uint32_t>(m_streams.size()));
+	for (const Stream& stream : m_streams)
+	{
+		directory.push_back(static_cast<uint32_t>(stream.size));
+	}
+
+	for (const Stream& stream : m_streams)
+	{
+		directory.insert(directory.end(), stream.blocks.begin(), stream.blocks.end());
+	}
+
+	const uint64_t directorySize = directory.size() * sizeof(uint32_t);
+	const uint32_t directoryBlockCount = ConvertSizeToBlockCount(directorySize, m_blockSize);
+	const uint32_t directoryMapBlockCount = ConvertSizeToBlockCount(directoryBlockCount * sizeof(uint32_t), m_blockSize);
+	if ((directorySize > MaxStreamSize) || (directoryMapBlockCount > (m_blockSize - SuperBlockFixedSize) / sizeof(uint32_t)))
+	{
+		SetError("The stream directory does not fit into a file with a block size of " + std::to_string(m_blockSize) + ", use a larger block size");
+		return false;
+	}
+
+	// the directory and the blocks holding its block indices need not be contiguous either
+	std::vector<uint32_t> directoryBlocks(directoryBlockCount);
+	for (uint32_t& block : directoryBlocks)
+	{
+		block = AllocateBlock();
+	}
+
+	std::vector<uint32_t> directoryMapBlocks(directoryMapBlockCount);
+	for (uint32_t& block : directoryMapBlocks)
+	{
+		block = AllocateBlock();
+	}
+
+	directory.resize(static_cast<size_t>(directoryBlockCount) * m_blockSize / sizeof(uint32_t), 0u);
+	for (uint32_t i = 0u; i < directoryBlockCount; ++i)
+	{
+		WriteBlock(directoryBlocks[i], directory.data() + static_cast<size_t>(i) * m_blockSize / sizeof(uint32_t), m_blockSize);
+	}
+
+	directoryBlocks.resize(static_cast<size_t>(directoryMapBlockCount) * m_blockSize / sizeof(uint32_t), 0u);
+	for (uint32_t i = 0u; i < directoryMapBlockCount; ++i)
+	{
+		WriteBlock(directoryMapBlocks[i], directoryBlocks.data() + static_cast<size_t>(i) * m_blockSize / sizeof(uint32_t), m_blockSize);
+	}
+
+	// reserved blocks that were never handed out stay free, but are still part of the file
+	const std::vector<uint8_t> zeros(m_blockSize, 0u);
+	for (uint32_t block : m_reservedBlocks)
+	{
+		WriteBlock(block, zeros.data(), m_blockSize);
+	}
+
+	// the file always ends after the free block map blocks of its last interval
+	while (IsFreeBlockMapBlock(m_blockCount))
+	{
+		++m_blockCount;
+	}
+
+	WriteFreeBlockMap();
+
+	GeneratorBuffer superBlock;
+	superBlock.WriteBytes(PDB::SuperBlock::MAGIC, sizeof(PDB::SuperBlock::MAGIC));
+	superBlock.WriteZeros(2u);
+	superBlock.Write<uint32_t>(m_blockSize);
+	superBlock.Write<uint32_t>(1u);
+	superBlock.Write<uint32_t>(m_blockCount);
+	superBlock.Write<uint32_t>(static_cast<uint32_t>(directorySize));
+	superBlock.Write<uint32_t>(0u);
+	superBlock.WriteBytes(directoryMapBlocks.data(), directoryMapBlocks.size() * sizeof(uint32_t));
+	superBlock.WriteZeros(m_blockSize - superBlock.GetSize());
+	WriteBlock(0u, superBlock.GetData(), superBlock.GetSize());
+
+	if (fclose(m_file) != 0)
+	{
+		SetError("Cannot write file");
+	}
+
+	m_file = nullptr;
+
+	return m_error.empty();
+}
+
+
+uint32_t GeneratorMSFWriter::AllocateBlock(void)
+{
+	if ((m_fragmentation != 0u) && (m_random() % 100u < m_fragmentation))
+	{
+		while (m_reservedBlocks.size() < ReservedBlockCount)
+		{
+			m_reservedBlocks.push_back(TakeNextBlock());
+		}
+
+		const size_t index = static_cast<size_t>(m_random() % m_reservedBlocks.size());
+		const uint32_t block = m_reservedBlocks[index];
+		m_reservedBlocks[index] = m_reservedBlocks.back();
+		m_reservedBlocks.pop_back();
+
+		return block;
+	}
+
+	return TakeNextBlock();
+}
+
+
+uint32_t GeneratorMSFWriter::TakeNextBlock(void)
+{
+	// the free block maps are spread across the file, occupying the second and third block of every interval
+	while (IsFreeBlockMapBlock(m_blockCount))
+	{
+		++m_blockCount;
+	}
+
+	if (m_blockCount == 0xFFFFFFFFu)
+	{
+		SetError("The file exceeds the maximum number of blocks");
+		return 0u;
+	}
+
+	return m_blockCount++;
+}
+
+
+bool GeneratorMSFWriter::IsFreeBlockMapBlock(uint32_t blockIndex) const
+{
+	const uint32_t indexWithinInterval = blockIndex & (m_blockSize - 1u);
+
+	return (indexWithinInterval == 1u) || (indexWithinInterval == 2u);
+}
+
+
+void GeneratorMSFWriter::AddBlock(Stream& stream, const uint8_t* data)
+{
+	const uint32_t block = AllocateBlock();
+	if (!stream.blocks.empty() && (block != stream.blocks.back() + 1u))
+	{
+		++m_discontinuityCount;
+	}
+
+	stream.blocks.push_back(block);
+	WriteBlock(block, data, m_blockSize);
+}
+
+
+void GeneratorMSFWriter::WriteBlock(uint32_t blockIndex, const void* data, size_t size)
+{
+	WriteAt(static_cast<uint64_t>(blockIndex) * m_blockSize, data, size);
+}
+
+
+void GeneratorMSFWriter::WriteAt(uint64_t fileOffset, const void* data, size_t size)
+{
+	if (!m_file || !m_error.empty())
+	{
+		return;
+	}
+
+	// blocks are mostly written in file order, so only seek when necessary
+	if (fileOffset != m_filePosition)
+	{
+#ifdef _WIN32
+		const int result = _fseeki64(m_file, static_cast<__int64>(fileOffset), SEEK_SET);
+#else
+		const int result = fseeko(m_file, static_cast<off_t>(fileOffset), SEEK_SET);
+#endif
+		if (result != 0)
+		{
+			SetError("Cannot seek in file");
+			return;
+		}
+	}
+
+	if (fwrite(data, 1u, size, m_file) != size)
+	{
+		SetError("Cannot write file");
+		return;
+	}
+
+	m_filePosition = fileOffset + size;
+}
+
+
+void GeneratorMSFWriter::WriteFreeBlockMap(void)
+{
+	// the free block map is a bit vector with a set bit for each free block. each interval of blockSize blocks stores
+	// the next blockSize bytes of the bit vector, so the free block map covers eight times as many blocks as needed.
+	const uint32_t intervalCount = ConvertSizeToBlockCount(m_blockCount, m_blockSize);
+	std::vector<uint8_t> freeBlockMap(static_cast<size_t>(intervalCount) * m_blockSize, 0u);
+
+	for (uint64_t block = m_blockCount; block < freeBlockMap.size() * 8u; ++block)
+	{
+		freeBlockMap[block / 8u] |= static_cast<uint8_t>(1u << (block % 8u));
+	}
+
+	for (uint32_t block : m_reservedBlocks)
+	{
+		freeBlockMap[block / 8u] |= static_cast<uint8_t>(1u << (block % 8u));
+	}
+
+	// both free block maps are written, the super block selects the first one
+	for (uint32_t i = 0u; i < intervalCount; ++i)
+	{
+		const uint8_t* data = freeBlockMap.data() + static_cast<size_t>(i) * m_blockSize;
+		WriteBlock(i * m_blockSize + 1u, data, m_blockSize);
+		WriteBlock(i * m_blockSize + 2u, data, m_blockSize);
+	}
+}
+
+
+void GeneratorMSFWriter::SetError(const std::string& error)
+{
+	// keep the first error, later ones are usually caused by it
+	if (m_error.empty())
+	{
+		m_error = error;
+	}
+}
@@ -0,0 +1,110 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+
+// Writes an MSF file, the container format of PDBs.
+// stream data is written to disk as soon as a block is full, so only the block indices of each stream and the last,
+// partially filled block are kept in memory. this allows writing files much larger than the available memory.
+// https://llvm.org/docs/PDB/MsfFile.html
+class GeneratorMSFWriter
+{
+public:
+	// fragmentation is the percentage of blocks that are not allocated in file order, but taken at random from a pool
+	// of blocks reserved ahead of the current end of the file. streams spanning such blocks are not contiguous on disk.
+	GeneratorMSFWriter(uint32_t blockSize, unsigned int fragmentation, uint64_t seed);
+	~GeneratorMSFWriter(void);
+
+	bool Open(const char* path);
+
+	// Adds an empty stream, returning its index.
+	uint32_t AddStream(void);
+
+	// Appends data to the end of a stream.
+	void Append(uint32_t streamIndex, const void* data, size_t size);
+
+	// Overwrites data that has already been appended to a stream.
+	void Patch(uint32_t streamIndex, uint32_t offset, const void* data, size_t size);
+
+	// Writes the stream directory, the free block map and the super block, and closes the file.
+	// Returns false if any of the preceding operations failed, in which case GetError describes the failure.
+	bool Close(void);
+
+	uint32_t GetStreamSize(uint32_t streamIndex) const
+	{
+		return static_cast<uint32_t>(m_streams[streamIndex].size);
+	}
+
+	uint32_t GetStreamCount(void) const
+	{
+		return static_cast<uint32_t>(m_streams.size());
+	}
+
+	uint32_t GetBlockCount(void) const
+	{
+		return m_blockCount;
+	}
+
+	uint64_t GetFileSize(void) const
+	{
+		return static_cast<uint64_t>(m_blockCount) * m_blockSize;
+	}
+
+	// Returns the number of stream blocks that do not directly follow the preceding block of their stream.
+	uint64_t GetDiscontinuityCount(void) const
+	{
+		return m_discontinuityCount;
+	}
+
+	const char* GetError(void) const
+	{
+		return m_error.c_str();
+	}
+
+private:
+	struct Stream
+	{
+		std::vector<uint32_t> blocks;
+		uint64_t size;
+
+		// data that does not fill a whole block yet
+		std::vector<uint8_t> pending;
+	};
+
+	uint32_t AllocateBlock(void);
+	uint32_t TakeNextBlock(void);
+	bool IsFreeBlockMapBlock(uint32_t blockIndex) const;
+
+	void AddBlock(Stream& stream, const uint8_t* data);
+	void WriteBlock(uint32_t blockIndex, const void* data, size_t size);
+	void WriteAt(uint64_t fileOffset, const void* data, size_t size);
+	void WriteFreeBlockMap(void);
+	void SetError(const std::string& error);
+
+	const uint32_t m_blockSize;
+	const unsigned int m_fragmentation;
+	std::mt19937_64 m_random;
+
+	FILE* m_file;
+	uint64_t m_filePosition;
+
+	std::vector<Stream> m_streams;
+	uint32_t m_blockCount;
+	uint64_t m_discontinuityCount;
+
+	// blocks reserved for fragmented allocations, which are free unless handed out
+	std::vector<uint32_t> m_reservedBlocks;
+
+	std::string m_error;
+
+	PDB_DISABLE_COPY_MOVE(GeneratorMSFWriter);
+};
@@ -0,0 +1,179 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "Examples_PCH.h"
+#include "GeneratorMSFWriter.h"
+#include "GeneratorPdb.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+namespace
+{
+	static void PrintUsage(void)
+	{
+		printf("Usage: raw_pdb_generator <PDB path> [--modules <count>] [--functions <count>] [--locals <count>] [--lines <count>] [--globals <count>] [--types <count>] [--signatures <count>] [--size <MiB>] [--block-size <bytes>] [--fragmentation <percent>] [--seed <value>]\n");
+		printf("  --modules        number of modules (default: 100)\n");
+		printf("  --functions      number of functions per module (default: 50)\n");
+		printf("  --locals         number of local variables per function (default: 2)\n");
+		printf("  --lines          number of line records per function (default: 8)\n");
+		printf("  --globals        number of global variables per module (default: 10)\n");
+		printf("  --types          number of user-defined types (default: 1000)\n");
+		printf("  --signatures     number of function signatures, which precede all user-defined types (default: 16)\n");
+		printf("  --size           approximate size of the PDB in MiB, derives the number of modules from the other options\n");
+		printf("  --block-size     MSF block size, a power of two between 512 and 32768 (default: 4096)\n");
+		printf("  --fragmentation  percentage of blocks that are not allocated in file order, 0 to 100 (default: 0)\n");
+		printf("  --seed           seed for all names, sizes and addresses (default: 1)\n");
+	}
+
+
+	// scales the number of modules, and the number of functions per module if necessary, to reach the given size
+	static void ApplyTargetSize(GeneratorOptions& options, uint64_t targetSize, uint32_t blockSize)
+	{
+		options.moduleCount = 1u;
+		const GeneratorPdb pdb(options);
+
+		// on average, the last block of each module stream is only half full
+		const uint64_t moduleSize = pdb.EstimateModuleSize() + blockSize / 2u;
+		const uint64_t typeSize = pdb.EstimateTypeSize();
+
+		const uint64_t moduleCount = (targetSize > typeSize) ? (targetSize - typeSize) / moduleSize : 0u;
+		if (moduleCount <= GeneratorPdb::MaxModuleCount)
+		{
+			options.moduleCount = (moduleCount != 0u) ? static_cast<uint32_t>(moduleCount) : 1u;
+			return;
+		}
+
+		options.moduleCount = GeneratorPdb::MaxModuleCount;
+		options.functionsPerModule = static_cast<uint32_t>((static_cast<uint64_t>(options.functionsPerModule) * moduleCount + GeneratorPdb::MaxModuleCount - 1u) / GeneratorPdb::MaxModuleCount);
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	// the output path comes first, so an option in its place means that the path is missing
+	if ((argc < 2) || (strncmp(argv[1], "--", 2u) == 0))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	const char* pdbPath = argv[1];
+	GeneratorOptions options = { 100u, 50u, 2u, 8u, 10u, 1000u, 16u, 1u };
+	uint64_t targetSize = 0u;
+	uint32_t blockSize = 4096u;
+	unsigned int fragmentation = 0u;
+
+	for (int i = 2; i < argc; i += 2)
+	{
+		if (i + 1 >= argc)
+		{
+			PrintUsage();
+			return 1;
+		}
+
+		const unsigned long long value = strtoull(argv[i + 1], nullptr, 10);
+		if (strcmp(argv[i], "--modules") == 0)
+		{
+			options.moduleCount = static_cast<uint32_t>(value);
+		}
+		else if (strcmp(argv[i], "--functions") == 0)
+		{
+			options.functionsPerModule = static_cast<uint32_t>(value);
+		}
+		else if (strcmp(argv[i], "--locals") == 0)
+		{
+			options.localsPerFunction = static_cast<uint32_t>(value);
+		}
+		else if (strcmp(argv[i], "--lines") == 0)
+		{
+			options.linesPerFunction = static_cast<uint32_t>(value);
+		}
+		else if (strcmp(argv[i], "--globals") == 0)
+		{
+			options.globalsPerModule = static_cast<uint32_t>(value);
+		}
+		else if (strcmp(argv[i], "--types") == 0)
+		{
+			options.typeCount = static_cast<uint32_t>(value);
+		}
+		else if (strcmp(argv[i], "--signatures") == 0)
+		{
+			options.signatureCount = static_cast<uint32_t>(value);
+		}
+		else if (strcmp(argv[i], "--size") == 0)
+		{
+			targetSize = value << 20u;
+		}
+		else if (strcmp(argv[i], "--block-size") == 0)
+		{
+			blockSize = static_cast<uint32_t>(value);
+		}
+		else if (strcmp(argv[i], "--fragmentation") == 0)
+		{
+			fragmentation = static_cast<unsigned int>(value);
+		}
+		else if (strcmp(argv[i], "--seed") == 0)
+		{
+			options.seed = value;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	// locals are limited so that their stack offsets stay small, and types and signatures so that their type indices fit into 32 bits
+	const bool isValidBlockSize = (blockSize >= 512u) && (blockSize <= 32768u) && ((blockSize & (blockSize - 1u)) == 0u);
+	if (!isValidBlockSize || (fragmentation > 100u) || (options.moduleCount == 0u) || (options.moduleCount > GeneratorPdb::MaxModuleCount) || (options.localsPerFunction > 1000u) || (options.typeCount > 0x10000000u) ||
+		(options.signatureCount == 0u) || (options.signatureCount > 0x10000u))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if (targetSize != 0u)
+	{
+		ApplyTargetSize(options, targetSize, blockSize);
+	}
+
+	printf("Generating %s: %u modules, %u functions per module, %u locals and %u lines per function, %u globals per module, %u types\n",
+		pdbPath, options.moduleCount, options.functionsPerModule, options.localsPerFunction, options.linesPerFunction, options.globalsPerModule, options.typeCount);
+
+	const std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+
+	GeneratorMSFWriter writer(blockSize, fragmentation, options.seed);
+	if (!writer.Open(pdbPath))
+	{
+		printf("%s\n", writer.GetError());
+		return 2;
+	}
+
+	GeneratorPdb pdb(options);
+	if (!pdb.Write(writer))
+	{
+		printf("%s\n", pdb.GetError());
+		return 2;
+	}
+
+	if (!writer.Close())
+	{
+		printf("%s\n", writer.GetError());
+		return 2;
+	}
+
+	const std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+	const double seconds = std::chrono::duration<double>(end - begin).count();
+
+	const PDB::GUID& guid = pdb.GetGUID();
+	printf("Wrote %llu bytes in %.3fs: %u blocks of %u bytes, %u streams, %llu discontiguous stream blocks\n",
+		static_cast<unsigned long long>(writer.GetFileSize()), seconds, writer.GetBlockCount(), blockSize, writer.GetStreamCount(), static_cast<unsigned long long>(writer.GetDiscontinuityCount()));
+	printf("GUID {%08X-%04X-%04X-%02X%02X-%02X%02X%02X%02X%02X%02X}, age %u\n",
+		guid.Data1, guid.Data2, guid.Data3, guid.Data4[0], guid.Data4[1], guid.Data4[2], guid.Data4[3], guid.Data4[4], guid.Data4[5], guid.Data4[6], guid.Data4[7], pdb.GetAge());
+
+	return 0;
+}
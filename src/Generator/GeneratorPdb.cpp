@@ -0,0 +1,1344 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "Examples_PCH.h"
+#include "GeneratorPdb.h"
+#include "GeneratorBuffer.h"
+#include "GeneratorMSFWriter.h"
+#include "GeneratorTypeStream.h"
+#include "Foundation/PDB_Hash.h"
+#include "PDB_DBITypes.h"
+#include "PDB_IPITypes.h"
+#include "PDB_NamesStream.h"
+#include "PDB_TPITypes.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+
+namespace
+{
+	using SymbolRecordKind = PDB::CodeView::DBI::SymbolRecordKind;
+	using TypeRecordKind = PDB::CodeView::TPI::TypeRecordKind;
+	using IdRecordKind = PDB::CodeView::IPI::TypeRecordKind;
+	using TypeIndexKind = PDB::CodeView::TPI::TypeIndexKind;
+
+	// the info, TPI, DBI and IPI streams live at fixed indices, stream 0 holds the old directory and stays empty
+	static constexpr const uint32_t InfoStreamIndex = 1u;
+	static constexpr const uint32_t TPIStreamIndex = 2u;
+	static constexpr const uint32_t DBIStreamIndex = 3u;
+	static constexpr const uint32_t IPIStreamIndex = 4u;
+	static constexpr const uint32_t FixedStreamCount = 5u;
+
+	// the TPI stream starts with an argument list and a procedure record for each signature, followed by 4 records per UDT:
+	// a forward reference, a pointer to it, the field list and the definition
+	static constexpr const uint32_t RecordsPerUDT = 4u;
+
+	// every module includes a few of the shared headers
+	static constexpr const uint32_t HeaderCount = 16u;
+	static constexpr const uint32_t HeadersPerModule = 4u;
+	static constexpr const uint32_t FilesPerModule = 1u + HeadersPerModule;
+
+	// the IPI stream starts with the strings shared by all LF_BUILDINFO records and the header paths, followed by the
+	// source path and LF_BUILDINFO of each module
+	static constexpr const uint32_t BuildStringCount = 4u;
+	static constexpr const uint32_t HeaderIdBegin = GeneratorTypeStream::TypeIndexBegin + BuildStringCount;
+	static constexpr const uint32_t ModuleIdBegin = HeaderIdBegin + HeaderCount;
+
+	// paths have a fixed length, so their offsets in the string tables can be computed directly
+	static constexpr const char* const HeaderPathFormat = "C:\\Source\\Generated\\Include\\Shared%02u.h";
+	static constexpr const char* const ModulePathFormat = "C:\\Source\\Generated\\Module%05u.%s";
+	static constexpr const uint32_t HeaderPathSize = sizeof("C:\\Source\\Generated\\Include\\Shared00.h");
+	static constexpr const uint32_t ModulePathSize = sizeof("C:\\Source\\Generated\\Module00000.cpp");
+
+	// each file checksum entry consists of a 6-byte header and an MD5 checksum, aligned to 4 bytes
+	static constexpr const uint32_t ChecksumSize = 16u;
+	static constexpr const uint32_t ChecksumEntrySize = 24u;
+
+	static constexpr const uint32_t GlobalSize = 8u;
+	static constexpr const uint32_t SectionAlignment = 0x1000u;
+	static constexpr const uint32_t FileAlignment = 0x200u;
+	static constexpr const uint32_t TextCharacteristics = 0x60000020u;	// IMAGE_SCN_CNT_CODE | IMAGE_SCN_MEM_EXECUTE | IMAGE_SCN_MEM_READ
+	static constexpr const uint32_t DataCharacteristics = 0xC0000040u;	// IMAGE_SCN_CNT_INITIALIZED_DATA | IMAGE_SCN_MEM_READ | IMAGE_SCN_MEM_WRITE
+	static constexpr const uint16_t AMD64Machine = 0x8664u;
+	static constexpr const uint16_t RSPRegister = 335u;					// CV_AMD64_RSP
+
+	static constexpr const uint16_t ForwardReferenceProperty = 0x80u;
+	static constexpr const uint16_t PublicAccess = 3u;
+	static constexpr const uint32_t PointerAttributes = 0x0Cu | (8u << 13u);	// CV_PTR_64, 8 bytes
+
+	// the public and global symbol streams use a fixed number of hash buckets, plus a bitmap of non-empty buckets
+	static constexpr const uint32_t SymbolHashBucketCount = 4096u;
+	static constexpr const uint32_t SymbolHashBitmapWordCount = (SymbolHashBucketCount + 32u) / 32u;
+
+	// records are appended to the MSF file in chunks of at least this size
+	static constexpr const size_t FlushSize = 1u << 20u;
+
+	struct BaseType
+	{
+		TypeIndexKind typeIndex;
+		uint16_t size;
+	};
+
+	static constexpr const BaseType BaseTypes[] =
+	{
+		{ TypeIndexKind::T_INT4, 4u },
+		{ TypeIndexKind::T_UINT4, 4u },
+		{ TypeIndexKind::T_REAL32, 4u },
+		{ TypeIndexKind::T_REAL64, 8u },
+		{ TypeIndexKind::T_UQUAD, 8u },
+		{ TypeIndexKind::T_BOOL08, 1u },
+		{ TypeIndexKind::T_CHAR, 1u },
+		{ TypeIndexKind::T_64PVOID, 8u }
+	};
+
+	static const char* const Namespaces[] =
+	{
+		"Core", "Render", "Audio", "Physics", "Network", "Script", "Input", "Memory", "Streaming", "Animation", "Gameplay", "Tools"
+	};
+
+	static const char* const Nouns[] =
+	{
+		"Buffer", "Texture", "Mesh", "Sound", "Body", "Socket", "Actor", "Allocator", "Request", "Skeleton", "Camera", "Light", "Material", "Shader", "Packet", "Event"
+	};
+
+	static const char* const Verbs[] =
+	{
+		"Create", "Destroy", "Update", "Load", "Save", "Find", "Bind", "Submit", "Resolve", "Flush", "Reset", "Compute", "Query", "Apply", "Release", "Register"
+	};
+
+	// the domains for drawing random numbers, so that e.g. the size and the signature of a function are independent
+	namespace Domain
+	{
+		enum : uint32_t
+		{
+			Guid,
+			FunctionName,
+			FunctionSize,
+			FunctionSignature,
+			GlobalName,
+			GlobalType,
+			LocalType,
+			TypeName,
+			TypeMembers,
+			MemberType,
+			LineNumber,
+			Checksum,
+			RelatedType
+		};
+	}
+
+
+	template <typename T>
+	static uint16_t Kind(T kind)
+	{
+		return static_cast<uint16_t>(kind);
+	}
+
+	template <typename T, size_t N>
+	static const T& Pick(const T (&array)[N], uint64_t value)
+	{
+		return array[value % N];
+	}
+
+	static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1u) / alignment * alignment;
+	}
+
+	static std::string GetHeaderPath(uint32_t headerIndex)
+	{
+		char path[64u];
+		snprintf(path, sizeof(path), HeaderPathFormat, headerIndex);
+
+		return path;
+	}
+
+	static std::string GetModulePath(uint32_t moduleIndex, const char* extension)
+	{
+		char path[64u];
+		snprintf(path, sizeof(path), ModulePathFormat, moduleIndex, extension);
+
+		return path;
+	}
+
+	// the names stream starts with the empty string, followed by the header paths and the source path of each module
+	static uint32_t GetHeaderNameOffset(uint32_t headerIndex)
+	{
+		return 1u + headerIndex * HeaderPathSize;
+	}
+
+	static uint32_t GetModuleNameOffset(uint32_t moduleIndex)
+	{
+		return 1u + HeaderCount * HeaderPathSize + moduleIndex * ModulePathSize;
+	}
+
+	static uint32_t GetHeaderIndex(uint32_t moduleIndex, uint32_t fileIndex)
+	{
+		return (moduleIndex + fileIndex - 1u) % HeaderCount;
+	}
+
+	// every 8th UDT is an enum, all others are structs
+	static bool IsEnum(uint32_t udtIndex)
+	{
+		return (udtIndex % 8u) == 7u;
+	}
+
+
+	static void WritePublicSymbol(GeneratorBuffer& buffer, PDB::CodeView::DBI::PublicSymbolFlags flags, uint32_t offset, uint16_t section, const std::string& name)
+	{
+		const size_t record = buffer.BeginRecord(Kind(SymbolRecordKind::S_PUB32));
+		buffer.Write(flags);
+		buffer.Write<uint32_t>(offset);
+		buffer.Write<uint16_t>(section);
+		buffer.WriteString(name.c_str());
+		buffer.Align(4u);
+		buffer.EndRecord(record);
+	}
+
+	static void WriteProcedureReference(GeneratorBuffer& buffer, uint32_t symbolOffset, uint32_t moduleIndex, const std::string& name)
+	{
+		const size_t record = buffer.BeginRecord(Kind(SymbolRecordKind::S_PROCREF));
+		buffer.Write<uint32_t>(0u);
+		buffer.Write<uint32_t>(symbolOffset);
+		buffer.Write<uint16_t>(static_cast<uint16_t>(moduleIndex + 1u));
+		buffer.WriteString(name.c_str());
+		buffer.Align(4u);
+		buffer.EndRecord(record);
+	}
+
+	static void WriteGlobalData(GeneratorBuffer& buffer, uint32_t typeIndex, uint32_t offset, uint16_t section, const std::string& name)
+	{
+		const size_t record = buffer.BeginRecord(Kind(SymbolRecordKind::S_GDATA32));
+		buffer.Write<uint32_t>(typeIndex);
+		buffer.Write<uint32_t>(offset);
+		buffer.Write<uint16_t>(section);
+		buffer.WriteString(name.c_str());
+		buffer.Align(4u);
+		buffer.EndRecord(record);
+	}
+
+	static void WriteUserDefinedType(GeneratorBuffer& buffer, uint32_t typeIndex, const std::string& name)
+	{
+		const size_t record = buffer.BeginRecord(Kind(SymbolRecordKind::S_UDT));
+		buffer.Write<uint32_t>(typeIndex);
+		buffer.WriteString(name.c_str());
+		buffer.Align(4u);
+		buffer.EndRecord(record);
+	}
+
+	static uint32_t WriteStringId(GeneratorTypeStream& ids, const std::string& string)
+	{
+		GeneratorBuffer& buffer = ids.BeginRecord(Kind(IdRecordKind::LF_STRING_ID));
+		buffer.Write<uint32_t>(0u);
+		buffer.WriteString(string.c_str());
+
+		return ids.EndRecord(nullptr);
+	}
+
+	static void WriteFunctionId(GeneratorTypeStream& ids, uint32_t typeIndex, const std::string& name)
+	{
+		GeneratorBuffer& buffer = ids.BeginRecord(Kind(IdRecordKind::LF_FUNC_ID));
+		buffer.Write<uint32_t>(0u);
+		buffer.Write<uint32_t>(typeIndex);
+		buffer.WriteString(name.c_str());
+		ids.EndRecord(nullptr);
+	}
+
+
+	// a record in the symbol record stream, along with the hash bucket of its name
+	struct HashedSymbol
+	{
+		uint32_t offset;
+		uint32_t bucket;
+	};
+
+	static HashedSymbol MakeHashedSymbol(uint64_t offset, const std::string& name)
+	{
+		const uint32_t hash = PDB::Hash::HashStringV1(name.c_str(), name.size());
+
+		return HashedSymbol { static_cast<uint32_t>(offset), hash % SymbolHashBucketCount };
+	}
+
+	// the hash table of the public and global symbol streams, storing the records sorted by their hash bucket
+	// https://llvm.org/docs/PDB/GlobalStream.html
+	struct SymbolHashTable
+	{
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> bucketStarts;		// index of the first record of each bucket, plus one past the last record
+	};
+
+	static SymbolHashTable CreateSymbolHashTable(const std::vector<HashedSymbol>& symbols)
+	{
+		SymbolHashTable table;
+		table.bucketStarts.resize(SymbolHashBucketCount + 1u, 0u);
+		for (const HashedSymbol& symbol : symbols)
+		{
+			++table.bucketStarts[symbol.bucket + 1u];
+		}
+
+		for (uint32_t i = 0u; i < SymbolHashBucketCount; ++i)
+		{
+			table.bucketStarts[i + 1u] += table.bucketStarts[i];
+		}
+
+		// a counting sort keeps the records of each bucket in stream order
+		std::vector<uint32_t> next(table.bucketStarts.begin(), table.bucketStarts.end() - 1);
+		table.offsets.resize(symbols.size());
+		for (const HashedSymbol& symbol : symbols)
+		{
+			table.offsets[next[symbol.bucket]++] = symbol.offset;
+		}
+
+		return table;
+	}
+
+	static uint32_t GetNonEmptyBucketCount(const SymbolHashTable& table)
+	{
+		uint32_t count = 0u;
+		for (uint32_t i = 0u; i < SymbolHashBucketCount; ++i)
+		{
+			count += (table.bucketStarts[i + 1u] != table.bucketStarts[i]) ? 1u : 0u;
+		}
+
+		return count;
+	}
+
+	static uint32_t GetSymbolHashTableSize(const SymbolHashTable& table)
+	{
+		return static_cast<uint32_t>(sizeof(PDB::HashTableHeader) + table.offsets.size() * sizeof(PDB::HashRecord) + (SymbolHashBitmapWordCount + GetNonEmptyBucketCount(table)) * sizeof(uint32_t));
+	}
+
+	static void WriteSymbolHashTable(GeneratorMSFWriter& writer, uint32_t streamIndex, const SymbolHashTable& table)
+	{
+		const uint32_t nonEmptyBucketCount = GetNonEmptyBucketCount(table);
+
+		PDB::HashTableHeader header = {};
+		header.signature = PDB::HashTableHeader::Signature;
+		header.version = PDB::HashTableHeader::Version;
+		header.size = static_cast<uint32_t>(table.offsets.size() * sizeof(PDB::HashRecord));
+		header.bucketCount = (SymbolHashBitmapWordCount + nonEmptyBucketCount) * sizeof(uint32_t);
+		writer.Append(streamIndex, &header, sizeof(header));
+
+		// hash records store the offset of their symbol record plus one
+		GeneratorBuffer buffer;
+		for (uint32_t offset : table.offsets)
+		{
+			buffer.Write(PDB::HashRecord { offset + 1u, 1u });
+			if (buffer.GetSize() >= FlushSize)
+			{
+				writer.Append(streamIndex, buffer.GetData(), buffer.GetSize());
+				buffer.Clear();
+			}
+		}
+
+		// the bitmap of non-empty buckets is followed by the offset of each non-empty bucket's first record. the offset
+		// is measured in the 12-byte hash records the Microsoft linker keeps in memory, not the 8-byte ones on disk.
+		std::vector<uint32_t> bitmap(SymbolHashBitmapWordCount, 0u);
+		std::vector<uint32_t> buckets;
+		buckets.reserve(nonEmptyBucketCount);
+		for (uint32_t i = 0u; i < SymbolHashBucketCount; ++i)
+		{
+			if (table.bucketStarts[i + 1u] != table.bucketStarts[i])
+			{
+				bitmap[i / 32u] |= 1u << (i % 32u);
+				buckets.push_back(table.bucketStarts[i] * 12u);
+			}
+		}
+
+		buffer.WriteBytes(bitmap.data(), bitmap.size() * sizeof(uint32_t));
+		buffer.WriteBytes(buckets.data(), buckets.size() * sizeof(uint32_t));
+		writer.Append(streamIndex, buffer.GetData(), buffer.GetSize());
+	}
+}
+
+
+GeneratorPdb::GeneratorPdb(const GeneratorOptions& options)
+	: m_options(options)
+	, m_guid()
+	, m_age(1u)
+	, m_error()
+	, m_moduleCodeOffsets()
+	, m_codeSize(0u)
+	, m_dataSize(0u)
+	, m_procedureOffsets()
+	, m_moduleStreams()
+	, m_namesStreamIndex(0u)
+	, m_linkInfoStreamIndex(0u)
+	, m_symbolRecordStreamIndex(0u)
+	, m_publicStreamIndex(0u)
+	, m_globalStreamIndex(0u)
+	, m_sectionHeaderStreamIndex(0u)
+{
+	// a version 4 GUID, derived from the seed like everything else
+	const uint64_t low = GetRandom(Domain::Guid, 0u);
+	const uint64_t high = GetRandom(Domain::Guid, 1u);
+	m_guid.Data1 = static_cast<uint32_t>(low);
+	m_guid.Data2 = static_cast<uint16_t>(low >> 32u);
+	m_guid.Data3 = static_cast<uint16_t>(((low >> 48u) & 0x0FFFu) | 0x4000u);
+	memcpy(m_guid.Data4, &high, sizeof(m_guid.Data4));
+	m_guid.Data4[0] = static_cast<uint8_t>((m_guid.Data4[0] & 0x3Fu) | 0x80u);
+}
+
+
+bool GeneratorPdb::Write(GeneratorMSFWriter& writer)
+{
+	if (!LayoutSections())
+	{
+		return false;
+	}
+
+	for (uint32_t i = 0u; i < FixedStreamCount; ++i)
+	{
+		writer.AddStream();
+	}
+
+	GeneratorBuffer buffer;
+	BuildNamesStream(buffer);
+	m_namesStreamIndex = writer.AddStream();
+	writer.Append(m_namesStreamIndex, buffer.GetData(), buffer.GetSize());
+
+	// the link info stream is referenced by the info stream, but empty in PDBs written by current linkers
+	m_linkInfoStreamIndex = writer.AddStream();
+
+	WriteModuleStreams(writer);
+	WriteTPIStream(writer);
+	WriteIPIStream(writer);
+	WriteSymbolStreams(writer);
+	WriteSectionHeaderStream(writer);
+	WriteDBIStream(writer);
+	WriteInfoStream(writer);
+
+	return true;
+}
+
+
+uint64_t GeneratorPdb::EstimateModuleSize(void) const
+{
+	// the module stream of the first module is representative of all others
+	GeneratorBuffer buffer;
+	std::vector<uint32_t> procedureOffsets;
+	uint32_t symbolSize = 0u;
+	BuildModuleStream(0u, 0u, buffer, procedureOffsets, symbolSize);
+	uint64_t size = buffer.GetSize();
+
+	// records in the symbol record stream, along with their hash records and the address map of the public stream
+	buffer.Clear();
+	for (uint32_t i = 0u; i < m_options.functionsPerModule; ++i)
+	{
+		const std::string name = GetFunctionName(GetFunctionIndex(0u, i));
+		WritePublicSymbol(buffer, PDB::CodeView::DBI::PublicSymbolFlags::Function, 0u, 1u, name);
+		WriteProcedureReference(buffer, 0u, 0u, name);
+	}
+
+	for (uint32_t i = 0u; i < m_options.globalsPerModule; ++i)
+	{
+		const std::string name = GetGlobalName(i);
+		WriteGlobalData(buffer, 0u, 0u, 2u, name);
+		WritePublicSymbol(buffer, PDB::CodeView::DBI::PublicSymbolFlags::None, 0u, 2u, name);
+	}
+
+	const uint64_t symbolCount = static_cast<uint64_t>(m_options.functionsPerModule) + m_options.globalsPerModule;
+	size += buffer.GetSize() + symbolCount * (2u * sizeof(PDB::HashRecord) + sizeof(uint32_t));
+
+	// function IDs and their hash values in the IPI stream, along with the module's build information
+	GeneratorTypeStream ids(nullptr, 0u);
+	for (uint32_t i = 0u; i < m_options.functionsPerModule; ++i)
+	{
+		const uint64_t functionIndex = GetFunctionIndex(0u, i);
+		WriteFunctionId(ids, GetProcedureTypeIndex(functionIndex), GetFunctionName(functionIndex));
+	}
+
+	WriteStringId(ids, GetModulePath(0u, "cpp"));
+	size += ids.GetSize() - sizeof(PDB::TPI::StreamHeader) + 28u + (m_options.functionsPerModule + 2u) * sizeof(uint32_t);
+
+	// the module's entries in the DBI and names streams
+	size += sizeof(PDB::DBI::ModuleInfo) + 2u * ModulePathSize + 2u * sizeof(PDB::DBI::SectionContribution) + ModulePathSize + FilesPerModule * sizeof(uint32_t) + 2u * sizeof(uint16_t) + ModulePathSize;
+
+	// the stream directory stores the index of every block
+	return size + size / 1024u;
+}
+
+
+uint64_t GeneratorPdb::EstimateTypeSize(void) const
+{
+	if (m_options.typeCount == 0u)
+	{
+		return 0u;
+	}
+
+	// a sample of the types is representative of all others
+	const uint32_t sampleCount = (m_options.typeCount < 256u) ? m_options.typeCount : 256u;
+
+	GeneratorTypeStream types(nullptr, 0u);
+	GeneratorBuffer buffer;
+	for (uint32_t i = 0u; i < sampleCount; ++i)
+	{
+		BuildTypeRecords(i, types);
+		WriteUserDefinedType(buffer, GetUDTTypeIndex(i), GetTypeName(i));
+	}
+
+	// hash values of the records, the S_UDT record and its hash record, and the LF_UDT_SRC_LINE record and its hash value
+	const uint64_t sampleSize = types.GetSize() - sizeof(PDB::TPI::StreamHeader) + buffer.GetSize() + sampleCount * (RecordsPerUDT * sizeof(uint32_t) + sizeof(PDB::HashRecord) + 20u);
+
+	return sampleSize * m_options.typeCount / sampleCount;
+}
+
+
+bool GeneratorPdb::LayoutSections(void)
+{
+	if (m_options.moduleCount > MaxModuleCount)
+	{
+		m_error = "The number of modules exceeds the maximum of " + std::to_string(MaxModuleCount);
+		return false;
+	}
+
+	m_moduleCodeOffsets.resize(m_options.moduleCount);
+
+	uint64_t codeSize = 0u;
+	for (uint32_t i = 0u; i < m_options.moduleCount; ++i)
+	{
+		m_moduleCodeOffsets[i] = static_cast<uint32_t>(codeSize);
+		for (uint32_t j = 0u; j < m_options.functionsPerModule; ++j)
+		{
+			codeSize += GetFunctionSize(GetFunctionIndex(i, j));
+		}
+
+		if (codeSize > 0xFFFFFFFFu)
+		{
+			break;
+		}
+	}
+
+	// both sections must fit into the 32-bit address space of the image
+	const uint64_t dataSize = static_cast<uint64_t>(m_options.moduleCount) * m_options.globalsPerModule * GlobalSize;
+	const uint64_t imageSize = AlignUp(SectionAlignment + codeSize, SectionAlignment) + dataSize;
+	if (imageSize > 0xFFFFFFFFu)
+	{
+		m_error = "The code and data of all modules exceed the 4 GiB address space of an image, use fewer functions or globals";
+		return false;
+	}
+
+	m_codeSize = static_cast<uint32_t>(codeSize);
+	m_dataSize = static_cast<uint32_t>(dataSize);
+	m_procedureOffsets.resize(static_cast<size_t>(GetFunctionCount()));
+
+	return true;
+}
+
+
+void GeneratorPdb::BuildNamesStream(GeneratorBuffer& buffer) const
+{
+	buffer.Clear();
+	buffer.Write(PDB::NamesHeader { 0xEFFEEFFEu, 1u, 0u });
+
+	std::vector<std::string> names;
+	names.reserve(HeaderCount + m_options.moduleCount);
+	for (uint32_t i = 0u; i < HeaderCount; ++i)
+	{
+		names.push_back(GetHeaderPath(i));
+	}
+
+	for (uint32_t i = 0u; i < m_options.moduleCount; ++i)
+	{
+		names.push_back(GetModulePath(i, "cpp"));
+	}
+
+	const size_t stringTableOffset = buffer.GetSize();
+	buffer.WriteZeros(1u);
+	for (const std::string& name : names)
+	{
+		buffer.WriteString(name.c_str());
+	}
+
+	buffer.Patch<uint32_t>(offsetof(PDB::NamesHeader, size), static_cast<uint32_t>(buffer.GetSize() - stringTableOffset));
+
+	// the hash table of offsets into the string table uses open addressing with linear probing
+	std::vector<uint32_t> buckets((names.size() + 1u) * 2u, 0u);
+	for (size_t i = 0u; i < names.size(); ++i)
+	{
+		const uint32_t offset = (i < HeaderCount) ? GetHeaderNameOffset(static_cast<uint32_t>(i)) : GetModuleNameOffset(static_cast<uint32_t>(i - HeaderCount));
+
+		size_t bucket = PDB::Hash::HashStringV1(names[i].c_str(), names[i].size()) % buckets.size();
+		while (buckets[bucket] != 0u)
+		{
+			bucket = (bucket + 1u) % buckets.size();
+		}
+
+		buckets[bucket] = offset;
+	}
+
+	buffer.Write<uint32_t>(static_cast<uint32_t>(buckets.size()));
+	buffer.WriteBytes(buckets.data(), buckets.size() * sizeof(uint32_t));
+	buffer.Write<uint32_t>(static_cast<uint32_t>(names.size()));
+}
+
+
+void GeneratorPdb::BuildModuleStream(uint32_t moduleIndex, uint32_t codeOffset, GeneratorBuffer& buffer, std::vector<uint32_t>& procedureOffsets, uint32_t& symbolSize) const
+{
+	buffer.Clear();
+	procedureOffsets.clear();
+
+	// CV_SIGNATURE_C13
+	buffer.Write<uint32_t>(4u);
+
+	{
+		const size_t record = buffer.BeginRecord(Kind(SymbolRecordKind::S_OBJNAME));
+		buffer.Write<uint32_t>(0u);
+		buffer.WriteString(GetModulePath(moduleIndex, "obj").c_str());
+		buffer.Align(4u);
+		buffer.EndRecord(record);
+	}
+
+	{
+		const size_t record = buffer.BeginRecord(Kind(SymbolRecordKind::S_BUILDINFO));
+		buffer.Write<uint32_t>(ModuleIdBegin + 2u * moduleIndex + 1u);
+		buffer.EndRecord(record);
+	}
+
+	uint32_t offset = codeOffset;
+	for (uint32_t i = 0u; i < m_options.functionsPerModule; ++i)
+	{
+		const uint64_t functionIndex = GetFunctionIndex(moduleIndex, i);
+		const uint32_t size = GetFunctionSize(functionIndex);
+		procedureOffsets.push_back(static_cast<uint32_t>(buffer.GetSize()));
+
+		const size_t record = buffer.BeginRecord(Kind(SymbolRecordKind::S_GPROC32));
+		buffer.Write<uint32_t>(0u);
+		const size_t endOffset = buffer.GetSize();
+		buffer.Write<uint32_t>(0u);
+		buffer.Write<uint32_t>(0u);
+		buffer.Write<uint32_t>(size);
+		buffer.Write<uint32_t>(4u);
+		buffer.Write<uint32_t>(size - 1u);
+		buffer.Write<uint32_t>(GetProcedureTypeIndex(functionIndex));
+		buffer.Write<uint32_t>(offset);
+		buffer.Write<uint16_t>(1u);
+		buffer.Write<uint8_t>(0u);
+		buffer.WriteString(GetFunctionName(functionIndex).c_str());
+		buffer.Align(4u);
+		buffer.EndRecord(record);
+
+		for (uint32_t j = 0u; j < m_options.localsPerFunction; ++j)
+		{
+			char name[32u];
+			snprintf(name, sizeof(name), "local%u", j);
+
+			const size_t localRecord = buffer.BeginRecord(Kind(SymbolRecordKind::S_REGREL32));
+			buffer.Write<uint32_t>(0x20u + j * GlobalSize);
+			buffer.Write<uint32_t>(GetVariableTypeIndex(Domain::LocalType, functionIndex * m_options.localsPerFunction + j));
+			buffer.Write<uint16_t>(RSPRegister);
+			buffer.WriteString(name);
+			buffer.Align(4u);
+			buffer.EndRecord(localRecord);
+		}
+
+		// the procedure refers to its S_END record
+		buffer.Patch<uint32_t>(endOffset, static_cast<uint32_t>(buffer.GetSize()));
+		buffer.EndRecord(buffer.BeginRecord(Kind(SymbolRecordKind::S_END)));
+
+		offset += size;
+	}
+
+	symbolSize = static_cast<uint32_t>(buffer.GetSize());
+
+	if ((m_options.linesPerFunction != 0u) && (m_options.functionsPerModule != 0u))
+	{
+		// the module's source file and the headers it includes
+		buffer.Write(PDB::CodeView::DBI::DebugSubsectionKind::S_FILECHECKSUMS);
+		buffer.Write<uint32_t>(FilesPerModule * ChecksumEntrySize);
+		for (uint32_t i = 0u; i < FilesPerModule; ++i)
+		{
+			const uint32_t nameOffset = (i == 0u) ? GetModuleNameOffset(moduleIndex) : GetHeaderNameOffset(GetHeaderIndex(moduleIndex, i));
+			buffer.Write<uint32_t>(nameOffset);
+			buffer.Write<uint8_t>(ChecksumSize);
+			buffer.Write(PDB::CodeView::DBI::ChecksumKind::MD5);
+			buffer.Write<uint64_t>(GetRandom(Domain::Checksum, 2u * (static_cast<uint64_t>(moduleIndex) * FilesPerModule + i)));
+			buffer.Write<uint64_t>(GetRandom(Domain::Checksum, 2u * (static_cast<uint64_t>(moduleIndex) * FilesPerModule + i) + 1u));
+			buffer.Align(4u);
+		}
+
+		// one line block per function, with every fifth function coming from one of the headers
+		offset = codeOffset;
+		for (uint32_t i = 0u; i < m_options.functionsPerModule; ++i)
+		{
+			const uint64_t functionIndex = GetFunctionIndex(moduleIndex, i);
+			const uint32_t size = GetFunctionSize(functionIndex);
+			const uint32_t lineCount = (m_options.linesPerFunction < size) ? m_options.linesPerFunction : size;
+			const uint32_t fileIndex = (i % 5u == 4u) ? 1u + (i / 5u) % HeadersPerModule : 0u;
+
+			buffer.Write(PDB::CodeView::DBI::DebugSubsectionKind::S_LINES);
+			buffer.Write<uint32_t>(static_cast<uint32_t>(sizeof(PDB::CodeView::DBI::LinesHeader) + sizeof(PDB::CodeView::DBI::LinesFileBlockHeader) + lineCount * sizeof(PDB::CodeView::DBI::Line)));
+			buffer.Write<uint32_t>(offset);
+			buffer.Write<uint16_t>(1u);
+			buffer.Write<uint16_t>(0u);
+			buffer.Write<uint32_t>(size);
+			buffer.Write<uint32_t>(fileIndex * ChecksumEntrySize);
+			buffer.Write<uint32_t>(lineCount);
+			buffer.Write<uint32_t>(static_cast<uint32_t>(sizeof(PDB::CodeView::DBI::LinesFileBlockHeader) + lineCount * sizeof(PDB::CodeView::DBI::Line)));
+
+			// line numbers increase by one or two, and are marked as statements
+			const uint64_t random = GetRandom(Domain::LineNumber, functionIndex);
+			uint32_t line = 10u + (i * (2u * m_options.linesPerFunction + 4u)) % 0x100000u;
+			for (uint32_t j = 0u; j < lineCount; ++j)
+			{
+				buffer.Write<uint32_t>(static_cast<uint32_t>(static_cast<uint64_t>(j) * size / lineCount));
+				buffer.Write<uint32_t>((line & 0xFFFFFFu) | 0x80000000u);
+				line += 1u + static_cast<uint32_t>((random >> (j % 64u)) & 1u);
+			}
+
+			offset += size;
+		}
+	}
+
+	// the global references are not used
+	buffer.Write<uint32_t>(0u);
+}
+
+
+void GeneratorPdb::BuildTypeRecords(uint32_t udtIndex, GeneratorTypeStream& typeStream) const
+{
+	const std::string name = GetTypeName(udtIndex);
+	const uint32_t forwardReferenceIndex = GetUDTForwardReferenceIndex(udtIndex);
+	const bool isEnum = IsEnum(udtIndex);
+	const uint16_t memberCount = static_cast<uint16_t>(2u + GetRandom(Domain::TypeMembers, udtIndex) % 7u);
+	const uint16_t kind = isEnum ? Kind(TypeRecordKind::LF_ENUM) : Kind(TypeRecordKind::LF_STRUCTURE);
+
+	// every 4th struct befriends an earlier UDT and declares another one as a nested type
+	const uint64_t relatedRandom = GetRandom(Domain::RelatedType, udtIndex);
+	const bool hasRelatedTypes = !isEnum && (udtIndex != 0u) && (relatedRandom % 4u == 0u);
+	const uint16_t fieldCount = static_cast<uint16_t>(memberCount + (hasRelatedTypes ? 2u : 0u));
+
+	const auto writeHeader = [isEnum, &name](GeneratorBuffer& buffer, uint16_t count, uint16_t property, uint32_t fieldList, uint16_t size)
+	{
+		buffer.Write<uint16_t>(count);
+		buffer.Write<uint16_t>(property);
+		if (isEnum)
+		{
+			buffer.Write<uint32_t>(static_cast<uint32_t>(TypeIndexKind::T_INT4));
+			buffer.Write<uint32_t>(fieldList);
+		}
+		else
+		{
+			buffer.Write<uint32_t>(fieldList);
+			buffer.Write<uint32_t>(0u);
+			buffer.Write<uint32_t>(0u);
+			buffer.Write<uint16_t>(size);
+		}
+
+		buffer.WriteString(name.c_str());
+	};
+
+	// forward references are hashed by their contents, so they do not collide with their definition
+	writeHeader(typeStream.BeginRecord(kind), 0u, ForwardReferenceProperty, 0u, 0u);
+	typeStream.EndRecord(nullptr);
+
+	{
+		GeneratorBuffer& buffer = typeStream.BeginRecord(Kind(TypeRecordKind::LF_POINTER));
+		buffer.Write<uint32_t>(forwardReferenceIndex);
+		buffer.Write<uint32_t>(PointerAttributes);
+		typeStream.EndRecord(nullptr);
+	}
+
+	// struct members are either base types or pointers to earlier UDTs
+	uint16_t size = 0u;
+	{
+		GeneratorBuffer& buffer = typeStream.BeginRecord(Kind(TypeRecordKind::LF_FIELDLIST));
+		for (uint16_t i = 0u; i < memberCount; ++i)
+		{
+			char memberName[32u];
+			const uint64_t random = GetRandom(Domain::MemberType, static_cast<uint64_t>(udtIndex) * 8u + i);
+			if (isEnum)
+			{
+				snprintf(memberName, sizeof(memberName), "Value%u", i);
+				buffer.Write(TypeRecordKind::LF_ENUMERATE);
+				buffer.Write<uint16_t>(PublicAccess);
+				buffer.Write<uint16_t>(i);
+			}
+			else
+			{
+				const BaseType& baseType = Pick(BaseTypes, random);
+				const bool isPointer = (udtIndex != 0u) && ((random >> 32u) % 4u == 0u);
+				const uint32_t typeIndex = isPointer ? GetUDTPointerTypeIndex(static_cast<uint32_t>((random >> 40u) % udtIndex)) : static_cast<uint32_t>(baseType.typeIndex);
+				const uint16_t memberSize = isPointer ? 8u : baseType.size;
+
+				size = static_cast<uint16_t>(AlignUp(size, memberSize));
+				snprintf(memberName, sizeof(memberName), "m_%s%u", Pick(Nouns, random >> 8u), i);
+				buffer.Write(TypeRecordKind::LF_MEMBER);
+				buffer.Write<uint16_t>(PublicAccess);
+				buffer.Write<uint32_t>(typeIndex);
+				buffer.Write<uint16_t>(size);
+				size = static_cast<uint16_t>(size + memberSize);
+			}
+
+			buffer.WriteString(memberName);
+			buffer.AlignWithLeafPadding();
+		}
+
+		if (hasRelatedTypes)
+		{
+			const uint32_t friendIndex = static_cast<uint32_t>((relatedRandom >> 8u) % udtIndex);
+			buffer.Write(TypeRecordKind::LF_FRIENDCLS);
+			buffer.Write<uint16_t>(0u);
+			buffer.Write<uint32_t>(GetUDTForwardReferenceIndex(friendIndex));
+
+			const uint32_t nestedIndex = static_cast<uint32_t>((relatedRandom >> 32u) % udtIndex);
+			buffer.Write(TypeRecordKind::LF_NESTTYPE);
+			buffer.Write<uint16_t>(0u);
+			buffer.Write<uint32_t>(GetUDTTypeIndex(nestedIndex));
+			buffer.WriteString(Pick(Nouns, relatedRandom >> 16u));
+			buffer.AlignWithLeafPadding();
+		}
+
+		typeStream.EndRecord(nullptr);
+	}
+
+	writeHeader(typeStream.BeginRecord(kind), fieldCount, 0u, forwardReferenceIndex + 2u, static_cast<uint16_t>(AlignUp(size, 8u)));
+	typeStream.EndRecord(name.c_str());
+}
+
+
+void GeneratorPdb::WriteModuleStreams(GeneratorMSFWriter& writer)
+{
+	GeneratorBuffer buffer;
+	std::vector<uint32_t> procedureOffsets;
+
+	m_moduleStreams.resize(m_options.moduleCount);
+	for (uint32_t i = 0u; i < m_options.moduleCount; ++i)
+	{
+		uint32_t symbolSize = 0u;
+		BuildModuleStream(i, m_moduleCodeOffsets[i], buffer, procedureOffsets, symbolSize);
+
+		const uint32_t streamIndex = writer.AddStream();
+		writer.Append(streamIndex, buffer.GetData(), buffer.GetSize());
+
+		// the C13 line information sits between the symbols and the trailing global references size
+		m_moduleStreams[i] = ModuleStream { static_cast<uint16_t>(streamIndex), symbolSize, static_cast<uint32_t>(buffer.GetSize() - symbolSize - sizeof(uint32_t)) };
+		std::copy(procedureOffsets.begin(), procedureOffsets.end(), m_procedureOffsets.begin() + static_cast<ptrdiff_t>(GetFunctionIndex(i, 0u)));
+	}
+}
+
+
+void GeneratorPdb::WriteTPIStream(GeneratorMSFWriter& writer)
+{
+	GeneratorTypeStream types(&writer, TPIStreamIndex);
+
+	for (uint32_t i = 0u; i < m_options.signatureCount; ++i)
+	{
+		const uint32_t argumentCount = i % 4u;
+
+		GeneratorBuffer& argumentList = types.BeginRecord(Kind(TypeRecordKind::LF_ARGLIST));
+		argumentList.Write<uint32_t>(argumentCount);
+		for (uint32_t j = 0u; j < argumentCount; ++j)
+		{
+			argumentList.Write<uint32_t>(static_cast<uint32_t>(Pick(BaseTypes, i + 3u * j).typeIndex));
+		}
+
+		const uint32_t argumentListIndex = types.EndRecord(nullptr);
+
+		GeneratorBuffer& procedure = types.BeginRecord(Kind(TypeRecordKind::LF_PROCEDURE));
+		procedure.Write<uint32_t>(static_cast<uint32_t>((i % 5u == 0u) ? TypeIndexKind::T_VOID : Pick(BaseTypes, i).typeIndex));
+		procedure.Write<uint8_t>(0u);
+		procedure.Write<uint8_t>(0u);
+		procedure.Write<uint16_t>(static_cast<uint16_t>(argumentCount));
+		procedure.Write<uint32_t>(argumentListIndex);
+		types.EndRecord(nullptr);
+	}
+
+	for (uint32_t i = 0u; i < m_options.typeCount; ++i)
+	{
+		BuildTypeRecords(i, types);
+	}
+
+	types.Finish(writer.AddStream());
+}
+
+
+void GeneratorPdb::WriteIPIStream(GeneratorMSFWriter& writer)
+{
+	GeneratorTypeStream ids(&writer, IPIStreamIndex);
+
+	const uint32_t directoryId = WriteStringId(ids, "C:\\Source\\Generated");
+	const uint32_t compilerId = WriteStringId(ids, "C:\\Tools\\MSVC\\bin\\Hostx64\\x64\\cl.exe");
+	const uint32_t pdbId = WriteStringId(ids, "C:\\Source\\Generated\\Generated.pdb");
+	const uint32_t commandLineId = WriteStringId(ids, "-c -Zi -O2 -MD -std:c++17");
+
+	for (uint32_t i = 0u; i < HeaderCount; ++i)
+	{
+		WriteStringId(ids, GetHeaderPath(i));
+	}
+
+	for (uint32_t i = 0u; i < m_options.moduleCount; ++i)
+	{
+		const uint32_t sourceId = WriteStringId(ids, GetModulePath(i, "cpp"));
+
+		GeneratorBuffer& buffer = ids.BeginRecord(Kind(IdRecordKind::LF_BUILDINFO));
+		buffer.Write<uint16_t>(5u);
+		buffer.Write<uint32_t>(directoryId);
+		buffer.Write<uint32_t>(compilerId);
+		buffer.Write<uint32_t>(sourceId);
+		buffer.Write<uint32_t>(pdbId);
+		buffer.Write<uint32_t>(commandLineId);
+		ids.EndRecord(nullptr);
+	}
+
+	for (uint32_t i = 0u; i < m_options.typeCount; ++i)
+	{
+		GeneratorBuffer& buffer = ids.BeginRecord(Kind(IdRecordKind::LF_UDT_SRC_LINE));
+		buffer.Write<uint32_t>(GetUDTTypeIndex(i));
+		buffer.Write<uint32_t>(HeaderIdBegin + i % HeaderCount);
+		buffer.Write<uint32_t>(10u + i);
+		ids.EndRecord(nullptr);
+	}
+
+	const uint64_t functionCount = GetFunctionCount();
+	for (uint64_t i = 0u; i < functionCount; ++i)
+	{
+		WriteFunctionId(ids, GetProcedureTypeIndex(i), GetFunctionName(i));
+	}
+
+	ids.Finish(writer.AddStream());
+}
+
+
+void GeneratorPdb::WriteSymbolStreams(GeneratorMSFWriter& writer)
+{
+	m_symbolRecordStreamIndex = writer.AddStream();
+
+	GeneratorBuffer buffer;
+	uint64_t flushedSize = 0u;
+	const auto flush = [this, &writer, &buffer, &flushedSize]()
+	{
+		writer.Append(m_symbolRecordStreamIndex, buffer.GetData(), buffer.GetSize());
+		flushedSize += buffer.GetSize();
+		buffer.Clear();
+	};
+
+	const uint64_t globalCount = static_cast<uint64_t>(m_options.moduleCount) * m_options.globalsPerModule;
+
+	std::vector<HashedSymbol> publicSymbols;
+	std::vector<HashedSymbol> globalSymbols;
+	publicSymbols.reserve(static_cast<size_t>(GetFunctionCount() + globalCount));
+	globalSymbols.reserve(static_cast<size_t>(GetFunctionCount() + globalCount + m_options.typeCount));
+
+	// functions are referenced by a public symbol and a procedure reference to their module's S_GPROC32 record
+	for (uint32_t i = 0u; i < m_options.moduleCount; ++i)
+	{
+		uint32_t offset = m_moduleCodeOffsets[i];
+		for (uint32_t j = 0u; j < m_options.functionsPerModule; ++j)
+		{
+			const uint64_t functionIndex = GetFunctionIndex(i, j);
+			const std::string name = GetFunctionName(functionIndex);
+
+			publicSymbols.push_back(MakeHashedSymbol(flushedSize + buffer.GetSize(), name));
+			WritePublicSymbol(buffer, PDB::CodeView::DBI::PublicSymbolFlags::Code | PDB::CodeView::DBI::PublicSymbolFlags::Function, offset, 1u, name);
+
+			globalSymbols.push_back(MakeHashedSymbol(flushedSize + buffer.GetSize(), name));
+			WriteProcedureReference(buffer, m_procedureOffsets[static_cast<size_t>(functionIndex)], i, name);
+
+			offset += GetFunctionSize(functionIndex);
+			if (buffer.GetSize() >= FlushSize)
+			{
+				flush();
+			}
+		}
+	}
+
+	for (uint64_t i = 0u; i < globalCount; ++i)
+	{
+		const std::string name = GetGlobalName(i);
+		const uint32_t offset = static_cast<uint32_t>(i * GlobalSize);
+
+		globalSymbols.push_back(MakeHashedSymbol(flushedSize + buffer.GetSize(), name));
+		WriteGlobalData(buffer, GetVariableTypeIndex(Domain::GlobalType, i), offset, 2u, name);
+
+		publicSymbols.push_back(MakeHashedSymbol(flushedSize + buffer.GetSize(), name));
+		WritePublicSymbol(buffer, PDB::CodeView::DBI::PublicSymbolFlags::None, offset, 2u, name);
+
+		if (buffer.GetSize() >= FlushSize)
+		{
+			flush();
+		}
+	}
+
+	for (uint32_t i = 0u; i < m_options.typeCount; ++i)
+	{
+		const std::string name = GetTypeName(i);
+
+		globalSymbols.push_back(MakeHashedSymbol(flushedSize + buffer.GetSize(), name));
+		WriteUserDefinedType(buffer, GetUDTTypeIndex(i), name);
+
+		if (buffer.GetSize() >= FlushSize)
+		{
+			flush();
+		}
+	}
+
+	flush();
+
+	{
+		m_globalStreamIndex = writer.AddStream();
+		const SymbolHashTable table = CreateSymbolHashTable(globalSymbols);
+		std::vector<HashedSymbol>().swap(globalSymbols);
+		WriteSymbolHashTable(writer, m_globalStreamIndex, table);
+	}
+
+	{
+		m_publicStreamIndex = writer.AddStream();
+		const SymbolHashTable table = CreateSymbolHashTable(publicSymbols);
+
+		PDB::PublicStreamHeader header = {};
+		header.symHash = GetSymbolHashTableSize(table);
+		header.addrMap = static_cast<uint32_t>(publicSymbols.size() * sizeof(uint32_t));
+		header.sectionCount = 2u;
+		writer.Append(m_publicStreamIndex, &header, sizeof(header));
+		WriteSymbolHashTable(writer, m_publicStreamIndex, table);
+
+		// public symbols were emitted in address order within each section, with all code preceding all data
+		std::vector<uint32_t> addressMap;
+		addressMap.reserve(publicSymbols.size());
+		for (const HashedSymbol& symbol : publicSymbols)
+		{
+			addressMap.push_back(symbol.offset);
+		}
+
+		writer.Append(m_publicStreamIndex, addressMap.data(), addressMap.size() * sizeof(uint32_t));
+	}
+}
+
+
+void GeneratorPdb::WriteSectionHeaderStream(GeneratorMSFWriter& writer)
+{
+	PDB::IMAGE_SECTION_HEADER sections[2u] = {};
+
+	PDB::IMAGE_SECTION_HEADER& text = sections[0];
+	memcpy(text.Name, ".text", 5u);
+	text.Misc.VirtualSize = m_codeSize;
+	text.VirtualAddress = SectionAlignment;
+	text.SizeOfRawData = static_cast<uint32_t>(AlignUp(m_codeSize, FileAlignment));
+	text.PointerToRawData = 0x400u;
+	text.Characteristics = TextCharacteristics;
+
+	PDB::IMAGE_SECTION_HEADER& data = sections[1];
+	memcpy(data.Name, ".data", 5u);
+	data.Misc.VirtualSize = m_dataSize;
+	data.VirtualAddress = static_cast<uint32_t>(SectionAlignment + AlignUp((m_codeSize != 0u) ? m_codeSize : 1u, SectionAlignment));
+	data.SizeOfRawData = static_cast<uint32_t>(AlignUp(m_dataSize, FileAlignment));
+	data.PointerToRawData = text.PointerToRawData + text.SizeOfRawData;
+	data.Characteristics = DataCharacteristics;
+
+	m_sectionHeaderStreamIndex = writer.AddStream();
+	writer.Append(m_sectionHeaderStreamIndex, sections, sizeof(sections));
+}
+
+
+void GeneratorPdb::WriteDBIStream(GeneratorMSFWriter& writer)
+{
+	GeneratorBuffer buffer;
+	buffer.WriteZeros(sizeof(PDB::DBI::StreamHeader));
+
+	// module info substream, with the linker's module last
+	const size_t moduleInfoOffset = buffer.GetSize();
+	for (uint32_t i = 0u; i <= m_options.moduleCount; ++i)
+	{
+		const bool isLinkerModule = (i == m_options.moduleCount);
+
+		PDB::DBI::ModuleInfo info = {};
+		info.sectionContribution.section = 1u;
+		info.sectionContribution.moduleIndex = static_cast<uint16_t>(i);
+		info.sectionContribution.characteristics = TextCharacteristics;
+		info.moduleSymbolStreamIndex = PDB::NilStreamIndex;
+		if (!isLinkerModule)
+		{
+			const uint32_t endOffset = (i + 1u < m_options.moduleCount) ? m_moduleCodeOffsets[i + 1u] : m_codeSize;
+			info.sectionContribution.offset = m_moduleCodeOffsets[i];
+			info.sectionContribution.size = endOffset - m_moduleCodeOffsets[i];
+			info.moduleSymbolStreamIndex = m_moduleStreams[i].streamIndex;
+			info.symbolSize = m_moduleStreams[i].symbolSize;
+			info.c13Size = m_moduleStreams[i].c13Size;
+			info.sourceFileCount = FilesPerModule;
+		}
+
+		buffer.Write(info);
+		if (isLinkerModule)
+		{
+			buffer.WriteString("* Linker *");
+			buffer.WriteZeros(1u);
+		}
+		else
+		{
+			const std::string objectPath = GetModulePath(i, "obj");
+			buffer.WriteString(objectPath.c_str());
+			buffer.WriteString(objectPath.c_str());
+		}
+
+		buffer.Align(4u);
+	}
+
+	const uint32_t moduleInfoSize = static_cast<uint32_t>(buffer.GetSize() - moduleInfoOffset);
+
+	// section contribution substream, sorted by section and offset
+	const size_t sectionContributionOffset = buffer.GetSize();
+	buffer.Write(PDB::DBI::SectionContribution::Version::Ver60);
+	for (uint32_t i = 0u; i < m_options.moduleCount; ++i)
+	{
+		const uint32_t endOffset = (i + 1u < m_options.moduleCount) ? m_moduleCodeOffsets[i + 1u] : m_codeSize;
+		if (endOffset != m_moduleCodeOffsets[i])
+		{
+			PDB::DBI::SectionContribution contribution = {};
+			contribution.section = 1u;
+			contribution.offset = m_moduleCodeOffsets[i];
+			contribution.size = endOffset - m_moduleCodeOffsets[i];
+			contribution.characteristics = TextCharacteristics;
+			contribution.moduleIndex = static_cast<uint16_t>(i);
+			buffer.Write(contribution);
+		}
+	}
+
+	for (uint32_t i = 0u; (m_options.globalsPerModule != 0u) && (i < m_options.moduleCount); ++i)
+	{
+		PDB::DBI::SectionContribution contribution = {};
+		contribution.section = 2u;
+		contribution.offset = i * m_options.globalsPerModule * GlobalSize;
+		contribution.size = m_options.globalsPerModule * GlobalSize;
+		contribution.characteristics = DataCharacteristics;
+		contribution.moduleIndex = static_cast<uint16_t>(i);
+		buffer.Write(contribution);
+	}
+
+	const uint32_t sectionContributionSize = static_cast<uint32_t>(buffer.GetSize() - sectionContributionOffset);
+
+	// section map substream, with an additional entry for absolute symbols
+	const size_t sectionMapOffset = buffer.GetSize();
+	{
+		using PDB::DBI::SectionMapEntryFlags;
+
+		buffer.Write(PDB::DBI::SectionMapHeader { 3u, 3u });
+		buffer.Write(PDB::DBI::SectionMapEntry { SectionMapEntryFlags::Read | SectionMapEntryFlags::Execute | SectionMapEntryFlags::AddressIs32Bit | SectionMapEntryFlags::IsSelector, 0u, 0u, 1u, 0xFFFFu, 0xFFFFu, 0u, m_codeSize });
+		buffer.Write(PDB::DBI::SectionMapEntry { SectionMapEntryFlags::Read | SectionMapEntryFlags::Write | SectionMapEntryFlags::AddressIs32Bit | SectionMapEntryFlags::IsSelector, 0u, 0u, 2u, 0xFFFFu, 0xFFFFu, 0u, m_dataSize });
+		buffer.Write(PDB::DBI::SectionMapEntry { SectionMapEntryFlags::AddressIs32Bit | SectionMapEntryFlags::IsAbsoluteAddress, 0u, 0u, 3u, 0xFFFFu, 0xFFFFu, 0u, 0xFFFFFFFFu });
+	}
+
+	const uint32_t sectionMapSize = static_cast<uint32_t>(buffer.GetSize() - sectionMapOffset);
+
+	// source info substream. the counts are stored in 16 bits and ignored by readers for large PDBs, which instead
+	// derive the module count from the module info substream and the file count from the per-module counts.
+	const size_t sourceInfoOffset = buffer.GetSize();
+	{
+		const uint32_t moduleCount = m_options.moduleCount + 1u;
+		buffer.Write<uint16_t>(static_cast<uint16_t>(moduleCount));
+		buffer.Write<uint16_t>(static_cast<uint16_t>(m_options.moduleCount * FilesPerModule));
+
+		for (uint32_t i = 0u; i < moduleCount; ++i)
+		{
+			buffer.Write<uint16_t>(static_cast<uint16_t>(i * FilesPerModule));
+		}
+
+		for (uint32_t i = 0u; i < moduleCount; ++i)
+		{
+			buffer.Write<uint16_t>(static_cast<uint16_t>((i < m_options.moduleCount) ? FilesPerModule : 0u));
+		}
+
+		// the string table stores the header paths first, followed by the source path of each module
+		for (uint32_t i = 0u; i < m_options.moduleCount; ++i)
+		{
+			buffer.Write<uint32_t>(HeaderCount * HeaderPathSize + i * ModulePathSize);
+			for (uint32_t j = 1u; j < FilesPerModule; ++j)
+			{
+				buffer.Write<uint32_t>(GetHeaderIndex(i, j) * HeaderPathSize);
+			}
+		}
+
+		for (uint32_t i = 0u; i < HeaderCount; ++i)
+		{
+			buffer.WriteString(GetHeaderPath(i).c_str());
+		}
+
+		for (uint32_t i = 0u; i < m_options.moduleCount; ++i)
+		{
+			buffer.WriteString(GetModulePath(i, "cpp").c_str());
+		}
+
+		buffer.Align(4u);
+	}
+
+	const uint32_t sourceInfoSize = static_cast<uint32_t>(buffer.GetSize() - sourceInfoOffset);
+
+	// the optional debug header only refers to the section header stream
+	PDB::DBI::DebugHeader debugHeader;
+	memset(&debugHeader, 0xFF, sizeof(debugHeader));
+	debugHeader.sectionHeaderStreamIndex = static_cast<uint16_t>(m_sectionHeaderStreamIndex);
+	buffer.Write(debugHeader);
+
+	PDB::DBI::StreamHeader header = {};
+	header.signature = PDB::DBI::StreamHeader::Signature;
+	header.version = PDB::DBI::StreamHeader::Version::V70;
+	header.age = m_age;
+	header.globalStreamIndex = static_cast<uint16_t>(m_globalStreamIndex);
+	header.publicStreamIndex = static_cast<uint16_t>(m_publicStreamIndex);
+	header.symbolRecordStreamIndex = static_cast<uint16_t>(m_symbolRecordStreamIndex);
+	header.moduleInfoSize = moduleInfoSize;
+	header.sectionContributionSize = sectionContributionSize;
+	header.sectionMapSize = sectionMapSize;
+	header.sourceInfoSize = sourceInfoSize;
+	header.optionalDebugHeaderSize = sizeof(PDB::DBI::DebugHeader);
+	header.machine = AMD64Machine;
+	buffer.Patch(0u, header);
+
+	writer.Append(DBIStreamIndex, buffer.GetData(), buffer.GetSize());
+}
+
+
+void GeneratorPdb::WriteInfoStream(GeneratorMSFWriter& writer)
+{
+	GeneratorBuffer buffer;
+
+	PDB::Header header = {};
+	header.version = PDB::Header::Version::VC70;
+	header.signature = static_cast<uint32_t>(GetRandom(Domain::Guid, 2u));
+	header.age = m_age;
+	header.guid = m_guid;
+	buffer.Write(header);
+
+	// the named stream map consists of a string table and a hash table mapping string offsets to stream indices
+	static const char* const names[] = { "/LinkInfo", "/names" };
+	const uint32_t streamIndices[] = { m_linkInfoStreamIndex, m_namesStreamIndex };
+	const uint32_t nameOffsets[] = { 0u, sizeof("/LinkInfo") };
+
+	buffer.Write<uint32_t>(sizeof("/LinkInfo") + sizeof("/names"));
+	for (const char* name : names)
+	{
+		buffer.WriteString(name);
+	}
+
+	// the hash table uses the lower 16 bits of the hash and linear probing
+	static constexpr const uint32_t capacity = 4u;
+	int buckets[capacity] = { -1, -1, -1, -1 };
+	uint32_t presentBits = 0u;
+	for (int i = 0; i < 2; ++i)
+	{
+		uint32_t bucket = static_cast<uint16_t>(PDB::Hash::HashStringV1(names[i], strlen(names[i]))) % capacity;
+		while (buckets[bucket] != -1)
+		{
+			bucket = (bucket + 1u) % capacity;
+		}
+
+		buckets[bucket] = i;
+		presentBits |= 1u << bucket;
+	}
+
+	buffer.Write(PDB::SerializedHashTable::Header { 2u, capacity });
+	buffer.Write<uint32_t>(1u);
+	buffer.Write<uint32_t>(presentBits);
+	buffer.Write<uint32_t>(0u);
+	for (int bucket : buckets)
+	{
+		if (bucket != -1)
+		{
+			buffer.Write(PDB::NamedStreamMap::HashTableEntry { nameOffsets[bucket], streamIndices[bucket] });
+		}
+	}
+
+	// the feature code announces the IPI stream
+	buffer.Write(PDB::FeatureCode::VC140);
+
+	writer.Append(InfoStreamIndex, buffer.GetData(), buffer.GetSize());
+}
+
+
+uint64_t GeneratorPdb::GetRandom(uint32_t domain, uint64_t index) const
+{
+	// splitmix64, which turns consecutive indices into independent random numbers
+	uint64_t value = m_options.seed ^ (static_cast<uint64_t>(domain) << 56u) ^ index;
+	value += 0x9E3779B97F4A7C15ull;
+	value = (value ^ (value >> 30u)) * 0xBF58476D1CE4E5B9ull;
+	value = (value ^ (value >> 27u)) * 0x94D049BB133111EBull;
+
+	return value ^ (value >> 31u);
+}
+
+
+uint64_t GeneratorPdb::GetFunctionIndex(uint32_t moduleIndex, uint32_t functionIndex) const
+{
+	return static_cast<uint64_t>(moduleIndex) * m_options.functionsPerModule + functionIndex;
+}
+
+
+uint32_t GeneratorPdb::GetFunctionSize(uint64_t functionIndex) const
+{
+	return 16u * (1u + static_cast<uint32_t>(GetRandom(Domain::FunctionSize, functionIndex) % 8u));
+}
+
+
+uint32_t GeneratorPdb::GetProcedureTypeIndex(uint64_t functionIndex) const
+{
+	const uint32_t signature = static_cast<uint32_t>(GetRandom(Domain::FunctionSignature, functionIndex) % m_options.signatureCount);
+
+	return GeneratorTypeStream::TypeIndexBegin + 2u * signature + 1u;
+}
+
+
+uint32_t GeneratorPdb::GetUDTForwardReferenceIndex(uint32_t udtIndex) const
+{
+	return GeneratorTypeStream::TypeIndexBegin + 2u * m_options.signatureCount + RecordsPerUDT * udtIndex;
+}
+
+
+uint32_t GeneratorPdb::GetUDTPointerTypeIndex(uint32_t udtIndex) const
+{
+	return GetUDTForwardReferenceIndex(udtIndex) + 1u;
+}
+
+
+uint32_t GeneratorPdb::GetUDTTypeIndex(uint32_t udtIndex) const
+{
+	return GetUDTForwardReferenceIndex(udtIndex) + 3u;
+}
+
+
+uint32_t GeneratorPdb::GetVariableTypeIndex(uint32_t domain, uint64_t index) const
+{
+	// variables are either of a base type or of a UDT
+	const uint64_t random = GetRandom(domain, index);
+	if ((m_options.typeCount == 0u) || (random % 2u == 0u))
+	{
+		return static_cast<uint32_t>(Pick(BaseTypes, random >> 8u).typeIndex);
+	}
+
+	return GetUDTTypeIndex(static_cast<uint32_t>((random >> 8u) % m_options.typeCount));
+}
+
+
+std::string GeneratorPdb::GetFunctionName(uint64_t functionIndex) const
+{
+	// the index makes every name unique
+	const uint64_t random = GetRandom(Domain::FunctionName, functionIndex);
+
+	char name[128u];
+	snprintf(name, sizeof(name), "%s::%s::%s%s%llu", Pick(Namespaces, random), Pick(Nouns, random >> 8u), Pick(Verbs, random >> 16u), Pick(Nouns, random >> 24u), static_cast<unsigned long long>(functionIndex));
+
+	return name;
+}
+
+
+std::string GeneratorPdb::GetGlobalName(uint64_t globalIndex) const
+{
+	const uint64_t random = GetRandom(Domain::GlobalName, globalIndex);
+
+	char name[128u];
+	snprintf(name, sizeof(name), "%s::g_%s%llu", Pick(Namespaces, random), Pick(Nouns, random >> 8u), static_cast<unsigned long long>(globalIndex));
+
+	return name;
+}
+
+
+std::string GeneratorPdb::GetTypeName(uint32_t udtIndex) const
+{
+	const uint64_t random = GetRandom(Domain::TypeName, udtIndex);
+
+	char name[128u];
+	snprintf(name, sizeof(name), IsEnum(udtIndex) ? "%s::E%s%u" : "%s::%s%u", Pick(Namespaces, random), Pick(Nouns, random >> 8u), udtIndex);
+
+	return name;
+}
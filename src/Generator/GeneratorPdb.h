@@ -0,0 +1,131 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "PDB_Types.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+class GeneratorBuffer;
+class GeneratorMSFWriter;
+class GeneratorTypeStream;
+
+
+struct GeneratorOptions
+{
+	uint32_t moduleCount;
+	uint32_t functionsPerModule;
+	uint32_t localsPerFunction;
+	uint32_t linesPerFunction;
+	uint32_t globalsPerModule;
+	uint32_t typeCount;
+	uint32_t signatureCount;
+	uint64_t seed;
+};
+
+
+// Generates the contents of a synthetic PDB and writes its streams using an MSF writer.
+// all names, sizes and addresses are derived from the seed and the index of the respective module, function or
+// type, which allows writing each stream in a single sequential pass without keeping the whole PDB in memory.
+class GeneratorPdb
+{
+public:
+	// module indices and stream indices are stored in 16-bit fields, which also need to hold the linker's module and
+	// the other streams
+	static constexpr const uint32_t MaxModuleCount = 0xFF00u;
+
+	explicit GeneratorPdb(const GeneratorOptions& options);
+
+	// Writes all streams, returning false if the PDB cannot be represented, e.g. because its code does not fit into 4 GiB.
+	bool Write(GeneratorMSFWriter& writer);
+
+	// Returns the approximate number of bytes a single module adds to the PDB.
+	uint64_t EstimateModuleSize(void) const;
+
+	// Returns the approximate number of bytes the types add to the PDB.
+	uint64_t EstimateTypeSize(void) const;
+
+	const PDB::GUID& GetGUID(void) const
+	{
+		return m_guid;
+	}
+
+	uint32_t GetAge(void) const
+	{
+		return m_age;
+	}
+
+	uint64_t GetFunctionCount(void) const
+	{
+		return static_cast<uint64_t>(m_options.moduleCount) * m_options.functionsPerModule;
+	}
+
+	const char* GetError(void) const
+	{
+		return m_error.c_str();
+	}
+
+private:
+	// the stream index of a module's symbol stream, along with the sizes of its parts stored in the DBI stream
+	struct ModuleStream
+	{
+		uint16_t streamIndex;
+		uint32_t symbolSize;
+		uint32_t c13Size;
+	};
+
+	bool LayoutSections(void);
+
+	void BuildNamesStream(GeneratorBuffer& buffer) const;
+	void BuildModuleStream(uint32_t moduleIndex, uint32_t codeOffset, GeneratorBuffer& buffer, std::vector<uint32_t>& procedureOffsets, uint32_t& symbolSize) const;
+	void BuildTypeRecords(uint32_t udtIndex, GeneratorTypeStream& typeStream) const;
+
+	void WriteModuleStreams(GeneratorMSFWriter& writer);
+	void WriteTPIStream(GeneratorMSFWriter& writer);
+	void WriteIPIStream(GeneratorMSFWriter& writer);
+	void WriteSymbolStreams(GeneratorMSFWriter& writer);
+	void WriteSectionHeaderStream(GeneratorMSFWriter& writer);
+	void WriteDBIStream(GeneratorMSFWriter& writer);
+	void WriteInfoStream(GeneratorMSFWriter& writer);
+
+	uint64_t GetRandom(uint32_t domain, uint64_t index) const;
+	uint64_t GetFunctionIndex(uint32_t moduleIndex, uint32_t functionIndex) const;
+	uint32_t GetFunctionSize(uint64_t functionIndex) const;
+	uint32_t GetProcedureTypeIndex(uint64_t functionIndex) const;
+	uint32_t GetUDTForwardReferenceIndex(uint32_t udtIndex) const;
+	uint32_t GetUDTPointerTypeIndex(uint32_t udtIndex) const;
+	uint32_t GetUDTTypeIndex(uint32_t udtIndex) const;
+	uint32_t GetVariableTypeIndex(uint32_t domain, uint64_t index) const;
+	std::string GetFunctionName(uint64_t functionIndex) const;
+	std::string GetGlobalName(uint64_t globalIndex) const;
+	std::string GetTypeName(uint32_t udtIndex) const;
+
+	const GeneratorOptions m_options;
+	PDB::GUID m_guid;
+	uint32_t m_age;
+	std::string m_error;
+
+	// offset and size of each module's code in the .text section, and of its data in the .data section
+	std::vector<uint32_t> m_moduleCodeOffsets;
+	uint32_t m_codeSize;
+	uint32_t m_dataSize;
+
+	// offset of each function's S_GPROC32 record in its module's symbol stream, referenced by S_PROCREF
+	std::vector<uint32_t> m_procedureOffsets;
+
+	std::vector<ModuleStream> m_moduleStreams;
+
+	uint32_t m_namesStreamIndex;
+	uint32_t m_linkInfoStreamIndex;
+	uint32_t m_symbolRecordStreamIndex;
+	uint32_t m_publicStreamIndex;
+	uint32_t m_globalStreamIndex;
+	uint32_t m_sectionHeaderStreamIndex;
+
+	PDB_DISABLE_COPY_MOVE(GeneratorPdb);
+};
@@ -0,0 +1,150 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "Examples_PCH.h"
+#include "GeneratorTypeStream.h"
+#include "GeneratorMSFWriter.h"
+#include "Foundation/PDB_Hash.h"
+#include "PDB_Types.h"
+
+#include <cstring>
+
+
+namespace
+{
+	// the number of hash buckets used by the Microsoft linker
+	static constexpr const uint32_t HashBucketCount = 0x3FFFFu;
+
+	// the hash stream stores the offset of the first record in every chunk of roughly this size
+	static constexpr const uint32_t TypeIndexOffsetInterval = 8192u;
+
+	// records are appended to the MSF file in chunks of at least this size
+	static constexpr const size_t FlushSize = 1u << 20u;
+
+
+	// records that do not define a UDT are hashed using a CRC32 without the final inversion, like the Microsoft linker does
+	static uint32_t HashRecord(const uint8_t* data, size_t size)
+	{
+		static const std::vector<uint32_t> table = []()
+		{
+			std::vector<uint32_t> crcTable(256u);
+			for (uint32_t i = 0u; i < 256u; ++i)
+			{
+				uint32_t crc = i;
+				for (unsigned int bit = 0u; bit < 8u; ++bit)
+				{
+					crc = (crc & 1u) ? (crc >> 1u) ^ 0xEDB88320u : (crc >> 1u);
+				}
+
+				crcTable[i] = crc;
+			}
+
+			return crcTable;
+		}();
+
+		uint32_t crc = 0xFFFFFFFFu;
+		for (size_t i = 0u; i < size; ++i)
+		{
+			crc = table[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8u);
+		}
+
+		return crc;
+	}
+}
+
+
+GeneratorTypeStream::GeneratorTypeStream(GeneratorMSFWriter* writer, uint32_t streamIndex)
+	: m_writer(writer)
+	, m_streamIndex(streamIndex)
+	, m_buffer()
+	, m_flushedSize(0u)
+	, m_recordOffset(0u)
+	, m_hashValues()
+	, m_typeIndexOffsets()
+	, m_nextTypeIndexOffset(0u)
+{
+	// the header is written last, once the size of all records is known
+	m_buffer.WriteZeros(sizeof(PDB::TPI::StreamHeader));
+}
+
+
+GeneratorBuffer& GeneratorTypeStream::BeginRecord(uint16_t kind)
+{
+	m_recordOffset = m_buffer.BeginRecord(kind);
+
+	return m_buffer;
+}
+
+
+uint32_t GeneratorTypeStream::EndRecord(const char* udtName)
+{
+	m_buffer.AlignWithLeafPadding();
+	m_buffer.EndRecord(m_recordOffset);
+
+	const uint32_t typeIndex = TypeIndexBegin + static_cast<uint32_t>(m_hashValues.size());
+	const uint32_t hash = udtName ?
+		PDB::Hash::HashStringV1(udtName, strlen(udtName)) :
+		HashRecord(m_buffer.GetData() + m_recordOffset, m_buffer.GetSize() - m_recordOffset);
+	m_hashValues.push_back(hash % HashBucketCount);
+
+	const uint64_t offset = m_flushedSize + m_recordOffset - sizeof(PDB::TPI::StreamHeader);
+	if (offset >= m_nextTypeIndexOffset)
+	{
+		m_typeIndexOffsets.push_back(PDB::TPI::TypeIndexOffset { typeIndex, static_cast<uint32_t>(offset) });
+		m_nextTypeIndexOffset = offset + TypeIndexOffsetInterval;
+	}
+
+	if (m_buffer.GetSize() >= FlushSize)
+	{
+		Flush();
+	}
+
+	return typeIndex;
+}
+
+
+void GeneratorTypeStream::Finish(uint32_t hashStreamIndex)
+{
+	Flush();
+
+	if (!m_writer)
+	{
+		return;
+	}
+
+	const uint32_t hashValueBufferLength = static_cast<uint32_t>(m_hashValues.size() * sizeof(uint32_t));
+	const uint32_t indexOffsetBufferLength = static_cast<uint32_t>(m_typeIndexOffsets.size() * sizeof(PDB::TPI::TypeIndexOffset));
+
+	PDB::TPI::StreamHeader header = {};
+	header.version = PDB::TPI::StreamHeader::Version::V80;
+	header.headerSize = sizeof(PDB::TPI::StreamHeader);
+	header.typeIndexBegin = TypeIndexBegin;
+	header.typeIndexEnd = TypeIndexBegin + static_cast<uint32_t>(m_hashValues.size());
+	header.typeRecordBytes = static_cast<uint32_t>(m_flushedSize - sizeof(PDB::TPI::StreamHeader));
+	header.hashStreamIndex = static_cast<uint16_t>(hashStreamIndex);
+	header.hashAuxStreamIndex = PDB::NilStreamIndex;
+	header.hashKeySize = sizeof(uint32_t);
+	header.numHashBuckets = HashBucketCount;
+	header.hashValueBufferOffset = 0;
+	header.hashValueBufferLength = hashValueBufferLength;
+	header.indexOffsetBufferOffset = static_cast<int32_t>(hashValueBufferLength);
+	header.indexOffsetBufferLength = indexOffsetBufferLength;
+	header.hashAdjBufferOffset = static_cast<int32_t>(hashValueBufferLength + indexOffsetBufferLength);
+	header.hashAdjBufferLength = 0u;
+	m_writer->Patch(m_streamIndex, 0u, &header, sizeof(header));
+
+	m_writer->Append(hashStreamIndex, m_hashValues.data(), hashValueBufferLength);
+	m_writer->Append(hashStreamIndex, m_typeIndexOffsets.data(), indexOffsetBufferLength);
+}
+
+
+void GeneratorTypeStream::Flush(void)
+{
+	if (m_writer)
+	{
+		m_writer->Append(m_streamIndex, m_buffer.GetData(), m_buffer.GetSize());
+	}
+
+	m_flushedSize += m_buffer.GetSize();
+	m_buffer.Clear();
+}
@@ -0,0 +1,60 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "GeneratorBuffer.h"
+#include "PDB_TPITypes.h"
+
+#include <cstdint>
+#include <vector>
+
+
+class GeneratorMSFWriter;
+
+
+// Writes a stream in the format shared by the TPI and IPI streams, along with its hash stream.
+// records are appended to the MSF file in large chunks while they are being written. without an MSF writer, records
+// are only measured, which is used for estimating the size of a PDB.
+// https://llvm.org/docs/PDB/TpiStream.html
+class GeneratorTypeStream
+{
+public:
+	static constexpr const uint32_t TypeIndexBegin = 0x1000u;
+
+	GeneratorTypeStream(GeneratorMSFWriter* writer, uint32_t streamIndex);
+
+	// Begins a record of the given kind, returning the buffer its data has to be written to.
+	GeneratorBuffer& BeginRecord(uint16_t kind);
+
+	// Ends the current record, returning its type index.
+	// records defining a UDT are hashed by the given name, all other records are hashed by their contents.
+	uint32_t EndRecord(const char* udtName);
+
+	// Writes the stream header and the hash stream.
+	void Finish(uint32_t hashStreamIndex);
+
+	// Returns the number of bytes written so far, including the stream header.
+	uint64_t GetSize(void) const
+	{
+		return m_flushedSize + m_buffer.GetSize();
+	}
+
+private:
+	void Flush(void);
+
+	GeneratorMSFWriter* m_writer;
+	const uint32_t m_streamIndex;
+
+	GeneratorBuffer m_buffer;
+	uint64_t m_flushedSize;
+	size_t m_recordOffset;
+
+	// the hash bucket of each record, and the offset of every record starting a new chunk of the stream
+	std::vector<uint32_t> m_hashValues;
+	std::vector<PDB::TPI::TypeIndexOffset> m_typeIndexOffsets;
+	uint64_t m_nextTypeIndexOffset;
+
+	PDB_DISABLE_COPY_MOVE(GeneratorTypeStream);
+};
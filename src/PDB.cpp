@@ -30,7 +30,7 @@ PDB_NO_DISCARD PDB::ErrorCode PDB::ValidateFile(const void* data, size_t size) P
 
 		// validate whether enough size is provided for the PDB file
 		// blockCount * blockSize is the size of the PDB file on disk
-		if (size < superBlock->blockCount * superBlock->blockSize)
+		if (size < static_cast<size_t>(superBlock->blockCount) * superBlock->blockSize)
 		{
 			return ErrorCode::InvalidDataSize;
 		}
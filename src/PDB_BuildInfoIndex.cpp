@@ -0,0 +1,435 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_BuildInfoIndex.h"
+#include "PDB_IPIStream.h"
+#include "PDB_ModuleSymbolStream.h"
+#include "Foundation/PDB_Memory.h"
+#include "Foundation/PDB_CRT.h"
+
+
+namespace
+{
+	// marks string ids in the cache that need to be joined from substrings
+	static const char PendingString[1] = { '\0' };
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static const PDB::CodeView::IPI::Record* GetRecord(const PDB::IPIStream& ipiStream, uint32_t typeIndex, PDB::CodeView::IPI::TypeRecordKind kind) PDB_NO_EXCEPT
+	{
+		const PDB::ArrayView<const PDB::CodeView::IPI::Record*> records = ipiStream.GetTypeRecords();
+		if ((typeIndex < ipiStream.GetFirstTypeIndex()) || (typeIndex - ipiStream.GetFirstTypeIndex() >= records.GetLength()))
+		{
+			return nullptr;
+		}
+
+		const PDB::CodeView::IPI::Record* record = records[typeIndex - ipiStream.GetFirstTypeIndex()];
+		return (record->header.kind == kind) ? record : nullptr;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	template <typename F>
+	static void ForEachSubstring(const PDB::IPIStream& ipiStream, const PDB::CodeView::IPI::Record* stringId, F&& functor) PDB_NO_EXCEPT
+	{
+		// long strings are split into a list of substrings, followed by the string's own name
+		const PDB::CodeView::IPI::Record* substringList = GetRecord(ipiStream, stringId->data.LF_STRING_ID.id, PDB::CodeView::IPI::TypeRecordKind::LF_SUBSTR_LIST);
+		if (substringList)
+		{
+			for (uint32_t i = 0u; i < substringList->data.LF_SUBSTR_LIST.count; ++i)
+			{
+				const PDB::CodeView::IPI::Record* substring = GetRecord(ipiStream, substringList->data.LF_SUBSTR_LIST.typeIndices[i], PDB::CodeView::IPI::TypeRecordKind::LF_STRING_ID);
+				if (substring)
+				{
+					functor(substring->data.LF_STRING_ID.name);
+				}
+			}
+		}
+
+		functor(stringId->data.LF_STRING_ID.name);
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static const char* FindEnvironmentValue(const char* strings, const char* end, const char* key) PDB_NO_EXCEPT
+	{
+		// the environment block stores pairs of keys and values, terminated by an empty key
+		while ((strings < end) && (*strings != '\0'))
+		{
+			const char* value = strings + strlen(strings) + 1u;
+			if (value >= end)
+			{
+				break;
+			}
+
+			if (strcmp(strings, key) == 0)
+			{
+				return value;
+			}
+
+			strings = value + strlen(value) + 1u;
+		}
+
+		return nullptr;
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::BuildInfoIndex::BuildInfoIndex(void) PDB_NO_EXCEPT
+	: m_entries(nullptr)
+	, m_entryCount(0u)
+	, m_moduleStrings(nullptr)
+	, m_stringCache(nullptr)
+	, m_typeIndexBegin(0u)
+	, m_typeIndexEnd(0u)
+	, m_joinedStrings(nullptr)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::BuildInfoIndex::BuildInfoIndex(BuildInfoIndex&& other) PDB_NO_EXCEPT
+	: m_entries(PDB_MOVE(other.m_entries))
+	, m_entryCount(PDB_MOVE(other.m_entryCount))
+	, m_moduleStrings(PDB_MOVE(other.m_moduleStrings))
+	, m_stringCache(PDB_MOVE(other.m_stringCache))
+	, m_typeIndexBegin(PDB_MOVE(other.m_typeIndexBegin))
+	, m_typeIndexEnd(PDB_MOVE(other.m_typeIndexEnd))
+	, m_joinedStrings(PDB_MOVE(other.m_joinedStrings))
+{
+	other.m_entries = nullptr;
+	other.m_entryCount = 0u;
+	other.m_moduleStrings = nullptr;
+	other.m_stringCache = nullptr;
+	other.m_typeIndexBegin = 0u;
+	other.m_typeIndexEnd = 0u;
+	other.m_joinedStrings = nullptr;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::BuildInfoIndex& PDB::BuildInfoIndex::operator=(BuildInfoIndex&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		for (size_t i = 0u; i < m_entryCount; ++i)
+		{
+			PDB_DELETE_ARRAY(m_moduleStrings[i]);
+		}
+
+		PDB_DELETE_ARRAY(m_entries);
+		PDB_DELETE_ARRAY(m_moduleStrings);
+		PDB_DELETE_ARRAY(m_stringCache);
+		PDB_DELETE_ARRAY(m_joinedStrings);
+
+		m_entries = PDB_MOVE(other.m_entries);
+		m_entryCount = PDB_MOVE(other.m_entryCount);
+		m_moduleStrings = PDB_MOVE(other.m_moduleStrings);
+		m_stringCache = PDB_MOVE(other.m_stringCache);
+		m_typeIndexBegin = PDB_MOVE(other.m_typeIndexBegin);
+		m_typeIndexEnd = PDB_MOVE(other.m_typeIndexEnd);
+		m_joinedStrings = PDB_MOVE(other.m_joinedStrings);
+
+		other.m_entries = nullptr;
+		other.m_entryCount = 0u;
+		other.m_moduleStrings = nullptr;
+		other.m_stringCache = nullptr;
+		other.m_typeIndexBegin = 0u;
+		other.m_typeIndexEnd = 0u;
+		other.m_joinedStrings = nullptr;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::BuildInfoIndex::BuildInfoIndex(const RawFile& file, const ModuleInfoStream& moduleInfoStream, const IPIStream& ipiStream) PDB_NO_EXCEPT
+	: BuildInfoIndex()
+{
+	if (!BeginBuild(moduleInfoStream, ipiStream))
+	{
+		return;
+	}
+
+	for (size_t i = 0u; i < m_entryCount; ++i)
+	{
+		ProcessModule(file, moduleInfoStream.GetModule(static_cast<uint32_t>(i)), ipiStream, i);
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::BuildInfoIndex::~BuildInfoIndex(void) PDB_NO_EXCEPT
+{
+	for (size_t i = 0u; i < m_entryCount; ++i)
+	{
+		PDB_DELETE_ARRAY(m_moduleStrings[i]);
+	}
+
+	PDB_DELETE_ARRAY(m_entries);
+	PDB_DELETE_ARRAY(m_moduleStrings);
+	PDB_DELETE_ARRAY(m_stringCache);
+	PDB_DELETE_ARRAY(m_joinedStrings);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD bool PDB::BuildInfoIndex::BeginBuild(const ModuleInfoStream& moduleInfoStream, const IPIStream& ipiStream) PDB_NO_EXCEPT
+{
+	const size_t moduleCount = moduleInfoStream.GetModules().GetLength();
+	if (moduleCount == 0u)
+	{
+		return false;
+	}
+
+	m_entries = PDB_NEW_ARRAY(Entry, moduleCount);
+	m_moduleStrings = PDB_NEW_ARRAY(char*, moduleCount);
+	m_entryCount = moduleCount;
+	memset(m_entries, 0, sizeof(Entry) * moduleCount);
+	memset(m_moduleStrings, 0, sizeof(char*) * moduleCount);
+
+	// the records of a lazy IPI stream are not indexed, so no build information would be found
+	PDB_ASSERT(ipiStream.GetMode() == IPIStream::Mode::Eager, "The IPI stream must have been created in eager mode.");
+
+	const ArrayView<const CodeView::IPI::Record*> records = ipiStream.GetTypeRecords();
+	if (records.GetLength() == 0u)
+	{
+		return true;
+	}
+
+	m_typeIndexBegin = ipiStream.GetFirstTypeIndex();
+	m_typeIndexEnd = m_typeIndexBegin + static_cast<uint32_t>(records.GetLength());
+	m_stringCache = PDB_NEW_ARRAY(const char*, records.GetLength());
+	memset(m_stringCache, 0, sizeof(const char*) * records.GetLength());
+
+	// strings without substrings are used in place, all others are marked for joining
+	size_t joinedSize = 0u;
+	for (const CodeView::IPI::Record* record : records)
+	{
+		if (record->header.kind != CodeView::IPI::TypeRecordKind::LF_BUILDINFO)
+		{
+			continue;
+		}
+
+		for (uint16_t i = 0u; i < record->data.LF_BUILDINFO.count; ++i)
+		{
+			const uint32_t stringIdIndex = record->data.LF_BUILDINFO.typeIndices[i];
+			const CodeView::IPI::Record* stringId = GetRecord(ipiStream, stringIdIndex, CodeView::IPI::TypeRecordKind::LF_STRING_ID);
+			if (!stringId || m_stringCache[stringIdIndex - m_typeIndexBegin])
+			{
+				continue;
+			}
+
+			if (stringId->data.LF_STRING_ID.id == 0u)
+			{
+				m_stringCache[stringIdIndex - m_typeIndexBegin] = stringId->data.LF_STRING_ID.name;
+				continue;
+			}
+
+			ForEachSubstring(ipiStream, stringId, [&joinedSize](const char* substring)
+			{
+				joinedSize += strlen(substring);
+			});
+
+			++joinedSize;
+			m_stringCache[stringIdIndex - m_typeIndexBegin] = PendingString;
+		}
+	}
+
+	if (joinedSize == 0u)
+	{
+		return true;
+	}
+
+	m_joinedStrings = PDB_NEW_ARRAY(char, joinedSize);
+
+	char* joinedString = m_joinedStrings;
+	for (uint32_t typeIndex = m_typeIndexBegin; typeIndex < m_typeIndexEnd; ++typeIndex)
+	{
+		if (m_stringCache[typeIndex - m_typeIndexBegin] != PendingString)
+		{
+			continue;
+		}
+
+		m_stringCache[typeIndex - m_typeIndexBegin] = joinedString;
+		ForEachSubstring(ipiStream, records[typeIndex - m_typeIndexBegin], [&joinedString](const char* substring)
+		{
+			const size_t length = strlen(substring);
+			memcpy(joinedString, substring, length);
+			joinedString += length;
+		});
+
+		*joinedString++ = '\0';
+	}
+
+	return true;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::BuildInfoIndex::ProcessModule(const RawFile& file, const ModuleInfoStream::Module& module, const IPIStream& ipiStream, size_t moduleIndex) PDB_NO_EXCEPT
+{
+	if (!module.HasSymbolStream())
+	{
+		return;
+	}
+
+	const ModuleSymbolStream symbolStream = module.CreateSymbolStream(file);
+
+	// compilers emit these symbols once per module
+	const CodeView::DBI::Record* compileRecord = nullptr;
+	const CodeView::DBI::Record* environmentRecord = nullptr;
+	const CodeView::DBI::Record* buildInfoRecord = nullptr;
+	symbolStream.ForEachSymbol([&compileRecord, &environmentRecord, &buildInfoRecord](const CodeView::DBI::Record* record)
+	{
+		if ((record->header.kind == CodeView::DBI::SymbolRecordKind::S_COMPILE3) && !compileRecord)
+		{
+			compileRecord = record;
+		}
+		else if ((record->header.kind == CodeView::DBI::SymbolRecordKind::S_ENVBLOCK) && !environmentRecord)
+		{
+			environmentRecord = record;
+		}
+		else if ((record->header.kind == CodeView::DBI::SymbolRecordKind::S_BUILDINFO) && !buildInfoRecord)
+		{
+			buildInfoRecord = record;
+		}
+	});
+
+	Entry& entry = m_entries[moduleIndex];
+
+	// the symbol stream is freed on return, so strings stored in symbols have to be copied
+	const size_t compilerNameLength = compileRecord ? strlen(compileRecord->data.S_COMPILE3.version) : 0u;
+	const char* environmentStrings = environmentRecord ? environmentRecord->data.S_ENVBLOCK.strings : nullptr;
+	const char* environmentEnd = environmentRecord ? reinterpret_cast<const char*>(environmentRecord) + sizeof(uint16_t) + environmentRecord->header.size : nullptr;
+	const size_t environmentSize = environmentRecord ? static_cast<size_t>(environmentEnd - environmentStrings) : 0u;
+
+	// two extra terminators make sure the copied environment block ends with an empty key
+	char* strings = PDB_NEW_ARRAY(char, compilerNameLength + 1u + environmentSize + 2u);
+	m_moduleStrings[moduleIndex] = strings;
+
+	if (compileRecord)
+	{
+		entry.hasCompileSymbol = true;
+		entry.flags = compileRecord->data.S_COMPILE3.flags;
+		entry.language = static_cast<uint8_t>(static_cast<uint32_t>(entry.flags) & static_cast<uint32_t>(CodeView::DBI::CompileSymbolFlags::SourceLanguageMask));
+		entry.machine = compileRecord->data.S_COMPILE3.machine;
+		entry.frontendVersion[0] = compileRecord->data.S_COMPILE3.versionFrontendMajor;
+		entry.frontendVersion[1] = compileRecord->data.S_COMPILE3.versionFrontendMinor;
+		entry.frontendVersion[2] = compileRecord->data.S_COMPILE3.versionFrontendBuild;
+		entry.frontendVersion[3] = compileRecord->data.S_COMPILE3.versionFrontendQFE;
+		entry.backendVersion[0] = compileRecord->data.S_COMPILE3.versionBackendMajor;
+		entry.backendVersion[1] = compileRecord->data.S_COMPILE3.versionBackendMinor;
+		entry.backendVersion[2] = compileRecord->data.S_COMPILE3.versionBackendBuild;
+		entry.backendVersion[3] = compileRecord->data.S_COMPILE3.versionBackendQFE;
+
+		memcpy(strings, compileRecord->data.S_COMPILE3.version, compilerNameLength);
+		entry.compilerName = strings;
+	}
+
+	strings[compilerNameLength] = '\0';
+
+	char* environmentCopy = strings + compilerNameLength + 1u;
+	if (environmentSize != 0u)
+	{
+		memcpy(environmentCopy, environmentStrings, environmentSize);
+	}
+
+	environmentCopy[environmentSize] = '\0';
+	environmentCopy[environmentSize + 1u] = '\0';
+
+	// LF_BUILDINFO takes precedence over the environment block
+	const CodeView::IPI::Record* buildInfo = buildInfoRecord ? GetRecord(ipiStream, buildInfoRecord->data.S_BUILDINFO.typeIndex, CodeView::IPI::TypeRecordKind::LF_BUILDINFO) : nullptr;
+	if (buildInfo)
+	{
+		for (uint16_t i = 0u; i < buildInfo->data.LF_BUILDINFO.count; ++i)
+		{
+			const char* string = GetString(buildInfo->data.LF_BUILDINFO.typeIndices[i]);
+			switch (static_cast<CodeView::IPI::BuildInfoType>(i))
+			{
+			case CodeView::IPI::BuildInfoType::CurrentDirectory:
+				entry.currentDirectory = string;
+				break;
+
+			case CodeView::IPI::BuildInfoType::BuildTool:
+				entry.buildTool = string;
+				break;
+
+			case CodeView::IPI::BuildInfoType::SourceFile:
+				entry.sourceFile = string;
+				break;
+
+			case CodeView::IPI::BuildInfoType::TypeServerPDB:
+				entry.pdbPath = string;
+				break;
+
+			case CodeView::IPI::BuildInfoType::CommandLine:
+				entry.commandLine = string;
+				break;
+
+			default:
+				break;
+			}
+		}
+	}
+
+	const char* environmentCopyEnd = environmentCopy + environmentSize + 2u;
+	if (!entry.currentDirectory)
+	{
+		entry.currentDirectory = FindEnvironmentValue(environmentCopy, environmentCopyEnd, "cwd");
+	}
+
+	if (!entry.buildTool)
+	{
+		entry.buildTool = FindEnvironmentValue(environmentCopy, environmentCopyEnd, "exe");
+	}
+
+	if (!entry.sourceFile)
+	{
+		entry.sourceFile = FindEnvironmentValue(environmentCopy, environmentCopyEnd, "src");
+	}
+
+	if (!entry.pdbPath)
+	{
+		entry.pdbPath = FindEnvironmentValue(environmentCopy, environmentCopyEnd, "pdb");
+	}
+
+	if (!entry.commandLine)
+	{
+		entry.commandLine = FindEnvironmentValue(environmentCopy, environmentCopyEnd, "cmd");
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const char* PDB::BuildInfoIndex::GetString(uint32_t stringId) const PDB_NO_EXCEPT
+{
+	if ((stringId < m_typeIndexBegin) || (stringId >= m_typeIndexEnd))
+	{
+		return nullptr;
+	}
+
+	return m_stringCache[stringId - m_typeIndexBegin];
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::BuildInfoIndex PDB::CreateBuildInfoIndex(const RawFile& file, const ModuleInfoStream& moduleInfoStream, const IPIStream& ipiStream) PDB_NO_EXCEPT
+{
+	return BuildInfoIndex { file, moduleInfoStream, ipiStream };
+}
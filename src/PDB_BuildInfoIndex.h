@@ -0,0 +1,113 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_ArrayView.h"
+#include "PDB_DBITypes.h"
+#include "PDB_ModuleInfoStream.h"
+
+
+namespace PDB
+{
+	class RawFile;
+	class IPIStream;
+
+
+	// Stores the compiler and build information of all modules, gathered from the S_COMPILE3, S_ENVBLOCK and S_BUILDINFO
+	// symbols of each module. S_BUILDINFO refers to an LF_BUILDINFO record in the IPI stream, whose arguments are string ids
+	// that can be split into several substrings. the strings referenced by all LF_BUILDINFO records are resolved once upon
+	// construction, so that modules sharing a command line or working directory share the same string.
+	// strings not split into substrings point into the IPI stream, which must therefore outlive the index.
+	class PDB_NO_DISCARD BuildInfoIndex
+	{
+	public:
+		struct Entry
+		{
+			// only set if the module has an S_COMPILE3 symbol
+			bool hasCompileSymbol;
+			uint8_t language;								// CV_CFL_LANG, the lowest byte of the compile flags
+			CodeView::DBI::CompileSymbolFlags flags;
+			CodeView::DBI::CPUType machine;
+			uint16_t frontendVersion[4];					// major, minor, build, QFE
+			uint16_t backendVersion[4];						// major, minor, build, QFE
+
+			// each string is nullptr if not known
+			const char* compilerName;
+			const char* currentDirectory;
+			const char* buildTool;
+			const char* sourceFile;
+			const char* pdbPath;
+			const char* commandLine;
+		};
+
+		BuildInfoIndex(void) PDB_NO_EXCEPT;
+		BuildInfoIndex(BuildInfoIndex&& other) PDB_NO_EXCEPT;
+		BuildInfoIndex& operator=(BuildInfoIndex&& other) PDB_NO_EXCEPT;
+
+		// the IPI stream must have been created in eager mode.
+		explicit BuildInfoIndex(const RawFile& file, const ModuleInfoStream& moduleInfoStream, const IPIStream& ipiStream) PDB_NO_EXCEPT;
+
+		// Builds the index by processing modules concurrently. The IPI stream must have been created in eager mode.
+		// the given functor is called with a number of tasks and a task, and must call the task once for each index in [0, count),
+		// e.g. by distributing the calls across a thread pool. it must not return before all tasks have finished.
+		template <typename ParallelFor>
+		explicit BuildInfoIndex(const RawFile& file, const ModuleInfoStream& moduleInfoStream, const IPIStream& ipiStream, ParallelFor&& parallelFor) PDB_NO_EXCEPT
+			: BuildInfoIndex()
+		{
+			if (!BeginBuild(moduleInfoStream, ipiStream))
+			{
+				return;
+			}
+
+			parallelFor(m_entryCount, [this, &file, &moduleInfoStream, &ipiStream](size_t moduleIndex)
+			{
+				ProcessModule(file, moduleInfoStream.GetModule(static_cast<uint32_t>(moduleIndex)), ipiStream, moduleIndex);
+			});
+		}
+
+		~BuildInfoIndex(void) PDB_NO_EXCEPT;
+
+		// Returns the entries of all modules, indexed by module index.
+		PDB_NO_DISCARD inline ArrayView<Entry> GetEntries(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<Entry>(m_entries, m_entryCount);
+		}
+
+		// Returns the entry of the module with the given index.
+		PDB_NO_DISCARD inline const Entry& GetEntry(uint32_t moduleIndex) const PDB_NO_EXCEPT
+		{
+			return m_entries[moduleIndex];
+		}
+
+	private:
+		// Allocates the entries and resolves all strings referenced by LF_BUILDINFO records. Returns false if there are no modules.
+		PDB_NO_DISCARD bool BeginBuild(const ModuleInfoStream& moduleInfoStream, const IPIStream& ipiStream) PDB_NO_EXCEPT;
+
+		// Fills the entry of a single module.
+		void ProcessModule(const RawFile& file, const ModuleInfoStream::Module& module, const IPIStream& ipiStream, size_t moduleIndex) PDB_NO_EXCEPT;
+
+		// Returns the resolved string of a string id, or nullptr if the id was not referenced by an LF_BUILDINFO record.
+		PDB_NO_DISCARD const char* GetString(uint32_t stringId) const PDB_NO_EXCEPT;
+
+		Entry* m_entries;
+		size_t m_entryCount;
+
+		// copies of the compiler name and environment block of each module, indexed by module index
+		char** m_moduleStrings;
+
+		// the resolved string of each string id referenced by an LF_BUILDINFO record, indexed by type index - first type index
+		const char** m_stringCache;
+		uint32_t m_typeIndexBegin;
+		uint32_t m_typeIndexEnd;
+
+		// the storage of all strings that had to be joined from substrings
+		char* m_joinedStrings;
+
+		PDB_DISABLE_COPY(BuildInfoIndex);
+	};
+
+	// Creates an index of the compiler and build information of all modules. The IPI stream must have been created in eager mode.
+	PDB_NO_DISCARD BuildInfoIndex CreateBuildInfoIndex(const RawFile& file, const ModuleInfoStream& moduleInfoStream, const IPIStream& ipiStream) PDB_NO_EXCEPT;
+}
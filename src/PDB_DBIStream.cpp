@@ -323,6 +323,18 @@ PDB_NO_DISCARD PDB::SectionContributionStream PDB::DBIStream::CreateSectionContr
 }
 
 
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::SectionMapStream PDB::DBIStream::CreateSectionMapStream(const RawFile& /* file */) const PDB_NO_EXCEPT
+{
+	// find the section map sub-stream
+	// https://llvm.org/docs/PDB/DbiStream.html#section-map-substream
+	const uint32_t streamOffset = GetSectionMapSubstreamOffset(m_header);
+
+	return SectionMapStream(m_stream, m_header.sectionMapSize, streamOffset);
+}
+
+
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB_NO_DISCARD PDB::ModuleInfoStream PDB::DBIStream::CreateModuleInfoStream(const RawFile& /* file */) const PDB_NO_EXCEPT
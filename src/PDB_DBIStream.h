@@ -13,6 +13,7 @@
 #include "PDB_GlobalSymbolStream.h"
 #include "PDB_SourceFileStream.h"
 #include "PDB_SectionContributionStream.h"
+#include "PDB_SectionMapStream.h"
 #include "PDB_ModuleInfoStream.h"
 
 
@@ -44,6 +45,7 @@ namespace PDB
 		PDB_NO_DISCARD SourceFileStream CreateSourceFileStream(const RawFile& file) const PDB_NO_EXCEPT;
 		PDB_NO_DISCARD SectionContributionStream CreateSectionContributionStream(const RawFile& file) const PDB_NO_EXCEPT;
 		PDB_NO_DISCARD ModuleInfoStream CreateModuleInfoStream(const RawFile& file) const PDB_NO_EXCEPT;
+		PDB_NO_DISCARD SectionMapStream CreateSectionMapStream(const RawFile& file) const PDB_NO_EXCEPT;
 
 		PDB_NO_DISCARD const DBI::StreamHeader& GetHeader(void) const PDB_NO_EXCEPT
 		{
@@ -86,6 +86,38 @@ namespace PDB
 			uint32_t relocationCrc;
 		};
 
+		// https://llvm.org/docs/PDB/DbiStream.html#section-map-substream
+		struct SectionMapHeader
+		{
+			uint16_t count;										// number of segment descriptors
+			uint16_t logicalCount;								// number of logical segment descriptors
+		};
+
+		enum class PDB_NO_DISCARD SectionMapEntryFlags : uint16_t
+		{
+			None = 0u,
+			Read = 1u << 0u,
+			Write = 1u << 1u,
+			Execute = 1u << 2u,
+			AddressIs32Bit = 1u << 3u,
+			IsSelector = 1u << 8u,
+			IsAbsoluteAddress = 1u << 9u,
+			IsGroup = 1u << 10u
+		};
+		PDB_DEFINE_BIT_OPERATORS(SectionMapEntryFlags);
+
+		struct SectionMapEntry
+		{
+			SectionMapEntryFlags flags;
+			uint16_t overlay;									// logical overlay number
+			uint16_t group;										// group index into the descriptor array
+			uint16_t frame;										// one-based index of the physical section
+			uint16_t sectionName;								// byte index of the segment or group name in the string table, or 0xFFFF
+			uint16_t className;									// byte index of the class name in the string table, or 0xFFFF
+			uint32_t offset;									// byte offset of the logical segment within the physical section
+			uint32_t sectionLength;								// byte count of the segment or group
+		};
+
 		// https://llvm.org/docs/PDB/DbiStream.html#module-info-substream
 		struct ModuleInfo
 		{
@@ -92,6 +92,31 @@ void PDB::DirectMSFStream::ReadAtOffset(void* destination, size_t size, size_t o
 }
 
 
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const void* PDB::DirectMSFStream::GetContiguousDataAtOffset(size_t offset, size_t size) const PDB_NO_EXCEPT
+{
+	PDB_ASSERT(offset + size <= m_size, "Not enough data left to read.");
+
+	const size_t blockIndex = offset >> m_blockSizeLog2;
+	const size_t offsetWithinBlock = offset & (m_blockSize - 1u);
+
+	// check whether all blocks touched by the data are contiguous (N, N+1, N+2, ...)
+	const size_t lastBlockIndex = (size != 0u) ? ((offset + size - 1u) >> m_blockSizeLog2) : blockIndex;
+	for (size_t i = blockIndex + 1u; i <= lastBlockIndex; ++i)
+	{
+		if (m_blockIndices[i] != m_blockIndices[i - 1u] + 1u)
+		{
+			return nullptr;
+		}
+	}
+
+	const size_t offsetWithinData = (static_cast<size_t>(m_blockIndices[blockIndex]) << m_blockSizeLog2) + offsetWithinBlock;
+
+	return Pointer::Offset<const void*>(m_data, offsetWithinData);
+}
+
+
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB_NO_DISCARD PDB::DirectMSFStream::IndexAndOffset PDB::DirectMSFStream::GetBlockIndexForOffset(uint32_t offset) const PDB_NO_EXCEPT
@@ -34,6 +34,10 @@ namespace PDB
 			return data;
 		}
 
+		// Returns a pointer to the memory-mapped data at the given offset if the given number of bytes is stored contiguously,
+		// i.e. does not cross a block boundary or only crosses into contiguous blocks. Returns nullptr otherwise.
+		PDB_NO_DISCARD const void* GetContiguousDataAtOffset(size_t offset, size_t size) const PDB_NO_EXCEPT;
+
 		// Returns the block size of the stream.
 		PDB_NO_DISCARD inline uint32_t GetBlockSize(void) const PDB_NO_EXCEPT
 		{
@@ -0,0 +1,206 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_EmbeddedSourceStream.h"
+#include "PDB_RawFile.h"
+#include "PDB_Inflate.h"
+#include "Foundation/PDB_Memory.h"
+#include "Foundation/PDB_CRT.h"
+
+
+namespace
+{
+	// the prefix of the names of all named streams storing embedded source files
+	static constexpr const char EmbeddedSourcePrefix[] = "/src/files/";
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::EmbeddedSourceStream::EmbeddedSourceStream(void) PDB_NO_EXCEPT
+	: m_stream()
+	, m_compression(EmbeddedSourceCompression::None)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::EmbeddedSourceStream::EmbeddedSourceStream(const RawFile& file, uint32_t streamIndex, EmbeddedSourceCompression compression) PDB_NO_EXCEPT
+	: m_stream(file.CreateMSFStream<DirectMSFStream>(streamIndex))
+	, m_compression(compression)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::ArrayView<PDB::Byte> PDB::EmbeddedSourceStream::GetContiguousData(void) const PDB_NO_EXCEPT
+{
+	// compressed contents can only be read chunk by chunk
+	const size_t size = m_stream.GetSize();
+	const void* data = ((size != 0u) && (m_compression == EmbeddedSourceCompression::None)) ? m_stream.GetContiguousDataAtOffset(0u, size) : nullptr;
+	if (!data)
+	{
+		return ArrayView<Byte>(nullptr, 0u);
+	}
+
+	return ArrayView<Byte>(static_cast<const Byte*>(data), size);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::ErrorCode PDB::EmbeddedSourceStream::Decompress(ChunkFunction function, void* userData) const PDB_NO_EXCEPT
+{
+	const size_t size = m_stream.GetSize();
+	if (size < sizeof(int32_t))
+	{
+		return ErrorCode::InvalidCompressedData;
+	}
+
+	// a size of zero denotes text that was stored uncompressed because compressing it did not pay off
+	const int32_t textSize = m_stream.ReadAtOffset<int32_t>(0u);
+	if (textSize < 0)
+	{
+		return ErrorCode::InvalidCompressedData;
+	}
+	else if (textSize == 0)
+	{
+		const size_t blockSize = m_stream.GetBlockSize();
+		for (size_t offset = sizeof(int32_t); offset < size; /* nothing */)
+		{
+			// a chunk never crosses a block boundary, so its data is always contiguous
+			const size_t remainingInBlock = blockSize - (offset % blockSize);
+			const size_t chunkSize = (size - offset < remainingInBlock) ? size - offset : remainingInBlock;
+			function(ArrayView<Byte>(static_cast<const Byte*>(m_stream.GetContiguousDataAtOffset(offset, chunkSize)), chunkSize), userData);
+			offset += chunkSize;
+		}
+
+		return ErrorCode::Success;
+	}
+
+	// make sure that the text has the size announced up front
+	struct Context
+	{
+		ChunkFunction function;
+		void* userData;
+		size_t size;
+	};
+
+	Context context = { function, userData, 0u };
+	const ErrorCode errorCode = Inflate::Decompress(m_stream, sizeof(int32_t), [](ArrayView<Byte> chunk, void* contextData)
+	{
+		Context* chunkContext = static_cast<Context*>(contextData);
+		chunkContext->size += chunk.GetLength();
+		chunkContext->function(chunk, chunkContext->userData);
+	}, &context);
+
+	if (errorCode != ErrorCode::Success)
+	{
+		return errorCode;
+	}
+
+	return (context.size == static_cast<size_t>(textSize)) ? ErrorCode::Success : ErrorCode::InvalidCompressedData;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SourceHeaderBlockStream::SourceHeaderBlockStream(void) PDB_NO_EXCEPT
+	: m_stream()
+	, m_entries(nullptr)
+	, m_entryCount(0u)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SourceHeaderBlockStream::SourceHeaderBlockStream(const RawFile& file, uint32_t streamIndex) PDB_NO_EXCEPT
+	: m_stream(file.CreateMSFStream<CoalescedMSFStream>(streamIndex))
+	, m_entries(nullptr)
+	, m_entryCount(0u)
+{
+	const size_t streamSize = m_stream.GetSize();
+	size_t streamOffset = sizeof(SourceHeaderBlock::Header) + sizeof(SerializedHashTable::Header);
+	if (streamSize < streamOffset + sizeof(SerializedHashTable::BitVector))
+	{
+		return;
+	}
+
+	const SourceHeaderBlock::Header* header = m_stream.GetDataAtOffset<const SourceHeaderBlock::Header>(0u);
+	if (header->version != SourceHeaderBlock::Version)
+	{
+		return;
+	}
+
+	const SerializedHashTable::Header* hashTableHeader = m_stream.GetDataAtOffset<const SerializedHashTable::Header>(sizeof(SourceHeaderBlock::Header));
+
+	// only the entries of present buckets are serialized, so both bit vectors can be skipped
+	for (uint32_t i = 0u; i < 2u; ++i)
+	{
+		if (streamSize < streamOffset + sizeof(SerializedHashTable::BitVector))
+		{
+			return;
+		}
+
+		const SerializedHashTable::BitVector* bitVector = m_stream.GetDataAtOffset<const SerializedHashTable::BitVector>(streamOffset);
+		streamOffset += sizeof(SerializedHashTable::BitVector) + sizeof(uint32_t) * static_cast<size_t>(bitVector->wordCount);
+	}
+
+	if ((streamOffset > streamSize) || ((streamSize - streamOffset) / sizeof(SourceHeaderBlock::HashTableEntry) < hashTableHeader->size))
+	{
+		return;
+	}
+
+	m_entries = m_stream.GetDataAtOffset<const SourceHeaderBlock::HashTableEntry>(streamOffset);
+	m_entryCount = hashTableHeader->size;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::SourceHeaderBlockStream PDB::CreateSourceHeaderBlockStream(const RawFile& file, const InfoStream& infoStream) PDB_NO_EXCEPT
+{
+	const uint32_t streamIndex = infoStream.FindNamedStream("/src/headerblock");
+	if (streamIndex == 0u)
+	{
+		return SourceHeaderBlockStream {};
+	}
+
+	return SourceHeaderBlockStream { file, streamIndex };
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::FindEmbeddedSourceStream(const InfoStream& infoStream, const char* path) PDB_NO_EXCEPT
+{
+	const size_t prefixLength = sizeof(EmbeddedSourcePrefix) - 1u;
+	const size_t pathLength = strlen(path);
+
+	char* name = PDB_NEW_ARRAY(char, prefixLength + pathLength + 1u);
+	memcpy(name, EmbeddedSourcePrefix, prefixLength);
+	memcpy(name + prefixLength, path, pathLength + 1u);
+
+	// tools store the stream under the lowercase path, but the virtual path in the header block as is
+	uint32_t streamIndex = infoStream.FindNamedStream(name);
+	if (streamIndex == 0u)
+	{
+		for (size_t i = prefixLength; i < prefixLength + pathLength; ++i)
+		{
+			if ((name[i] >= 'A') && (name[i] <= 'Z'))
+			{
+				name[i] = static_cast<char>(name[i] - 'A' + 'a');
+			}
+		}
+
+		streamIndex = infoStream.FindNamedStream(name);
+	}
+
+	PDB_DELETE_ARRAY(name);
+
+	return streamIndex;
+}
@@ -0,0 +1,211 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_ArrayView.h"
+#include "Foundation/PDB_TypeTraits.h"
+#include "PDB_ErrorCodes.h"
+#include "PDB_Types.h"
+#include "PDB_DirectMSFStream.h"
+#include "PDB_CoalescedMSFStream.h"
+#include "PDB_InfoStream.h"
+#include "PDB_NamesStream.h"
+
+
+namespace PDB
+{
+	class RawFile;
+
+
+	// How the contents of an embedded source file are compressed, see PDB_SourceCompression in LLVM.
+	enum class PDB_NO_DISCARD EmbeddedSourceCompression : uint8_t
+	{
+		None = 0u,
+		RunLengthEncoded = 1u,
+		Huffman = 2u,
+		LZ = 3u,
+		DotNet = 101u
+	};
+
+	// The "/src/headerblock" stream describes all embedded source files. a header is followed by a serialized hash table
+	// mapping the "/names" offset of each file's virtual path to its entry.
+	// https://llvm.org/docs/PDB/HashTable.html
+	struct SourceHeaderBlock
+	{
+		static constexpr const uint32_t Version = 19980827u;			// PdbRaw_SrcHeaderBlockVer::SrcVerOne
+
+		struct Header
+		{
+			uint32_t version;
+			uint32_t size;							// size of the whole stream
+			uint32_t fileTime[2];					// FILETIME
+			uint32_t age;
+			uint8_t padding[44];
+		};
+
+		struct Entry
+		{
+			uint32_t size;							// size of the entry
+			uint32_t version;
+			uint32_t crc;							// CRC of the original file contents
+			uint32_t fileSize;						// size of the original file contents
+			uint32_t fileNameOffset;				// offset of the file name into the "/names" stream
+			uint32_t objectNameOffset;				// offset of the object name into the "/names" stream
+			uint32_t virtualFileNameOffset;			// offset of the virtual file name into the "/names" stream
+			EmbeddedSourceCompression compression;
+			uint8_t isVirtual;
+			uint16_t padding2;
+			uint8_t reserved[8];
+		};
+
+		struct HashTableEntry
+		{
+			uint32_t virtualFileNameOffset;
+			Entry entry;
+		};
+	};
+
+	static_assert(sizeof(SourceHeaderBlock::Header) == 64u, "Size mismatch.");
+	static_assert(sizeof(SourceHeaderBlock::Entry) == 40u, "Size mismatch.");
+	static_assert(sizeof(SourceHeaderBlock::HashTableEntry) == 44u, "Size mismatch.");
+
+
+	// Provides access to the contents of a source file embedded into the PDB, stored in a named stream "/src/files/<path>".
+	// uncompressed contents are never copied: they can either be accessed as a whole if all blocks of the stream are contiguous,
+	// or block by block otherwise.
+	// sources compressed by the .NET compilers (EmbeddedSourceCompression::DotNet) store the size of the source text followed by
+	// the text compressed using DEFLATE, or a size of zero followed by the uncompressed text. they are decompressed on the fly.
+	// the other kinds of compression are undocumented and cannot be read.
+	class PDB_NO_DISCARD EmbeddedSourceStream
+	{
+	public:
+		EmbeddedSourceStream(void) PDB_NO_EXCEPT;
+		explicit EmbeddedSourceStream(const RawFile& file, uint32_t streamIndex, EmbeddedSourceCompression compression) PDB_NO_EXCEPT;
+
+		PDB_DEFAULT_MOVE(EmbeddedSourceStream);
+
+		// Returns how the contents are compressed, as stored in the "/src/headerblock" stream.
+		PDB_NO_DISCARD inline EmbeddedSourceCompression GetCompression(void) const PDB_NO_EXCEPT
+		{
+			return m_compression;
+		}
+
+		// Returns the size of the stored contents in bytes, which is the size of the compressed contents for compressed sources.
+		PDB_NO_DISCARD inline size_t GetSize(void) const PDB_NO_EXCEPT
+		{
+			return m_stream.GetSize();
+		}
+
+		// Returns the source text if it is stored uncompressed and all blocks of the stream are contiguous, or an empty view otherwise.
+		// use ForEachChunk() for reading compressed sources.
+		PDB_NO_DISCARD ArrayView<Byte> GetContiguousData(void) const PDB_NO_EXCEPT;
+
+		// Iterates the source text in contiguous chunks, in order.
+		// uncompressed text is handed out in one chunk if all blocks of the stream are contiguous, otherwise each chunk corresponds
+		// to one block. compressed text is handed out in chunks of at most Inflate::WindowSize bytes while it is being decompressed.
+		// Returns ErrorCode::UnsupportedCompression without calling the functor if the compression is not supported, and
+		// ErrorCode::InvalidCompressedData if decompression fails, in which case the chunks handed out so far are incomplete.
+		template <typename F>
+		PDB_NO_DISCARD ErrorCode ForEachChunk(F&& functor) const PDB_NO_EXCEPT
+		{
+			if (m_compression == EmbeddedSourceCompression::DotNet)
+			{
+				using Functor = typename remove_reference<F>::type;
+				return Decompress([](ArrayView<Byte> chunk, void* userData)
+				{
+					(*static_cast<Functor*>(userData))(chunk);
+				}, const_cast<void*>(static_cast<const void*>(&functor)));
+			}
+
+			if (m_compression != EmbeddedSourceCompression::None)
+			{
+				return ErrorCode::UnsupportedCompression;
+			}
+
+			const size_t size = m_stream.GetSize();
+			if (size == 0u)
+			{
+				return ErrorCode::Success;
+			}
+
+			const void* data = m_stream.GetContiguousDataAtOffset(0u, size);
+			if (data)
+			{
+				functor(ArrayView<Byte>(static_cast<const Byte*>(data), size));
+				return ErrorCode::Success;
+			}
+
+			// a chunk never crosses a block boundary, so its data is always contiguous
+			const size_t blockSize = m_stream.GetBlockSize();
+			for (size_t offset = 0u; offset < size; offset += blockSize)
+			{
+				const size_t chunkSize = (size - offset < blockSize) ? size - offset : blockSize;
+				functor(ArrayView<Byte>(static_cast<const Byte*>(m_stream.GetContiguousDataAtOffset(offset, chunkSize)), chunkSize));
+			}
+
+			return ErrorCode::Success;
+		}
+
+	private:
+		using ChunkFunction = void (*)(ArrayView<Byte> chunk, void* userData);
+
+		// Reads a source compressed by the .NET compilers, calling the function for each chunk of source text.
+		PDB_NO_DISCARD ErrorCode Decompress(ChunkFunction function, void* userData) const PDB_NO_EXCEPT;
+
+		DirectMSFStream m_stream;
+		EmbeddedSourceCompression m_compression;
+
+		PDB_DISABLE_COPY(EmbeddedSourceStream);
+	};
+
+
+	// Provides access to the entries of the "/src/headerblock" stream, one for each embedded source file.
+	class PDB_NO_DISCARD SourceHeaderBlockStream
+	{
+	public:
+		SourceHeaderBlockStream(void) PDB_NO_EXCEPT;
+		explicit SourceHeaderBlockStream(const RawFile& file, uint32_t streamIndex) PDB_NO_EXCEPT;
+
+		PDB_DEFAULT_MOVE(SourceHeaderBlockStream);
+
+		// Returns the entries of all embedded source files, in bucket order. The view is empty if the stream is malformed.
+		PDB_NO_DISCARD inline ArrayView<SourceHeaderBlock::HashTableEntry> GetEntries(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<SourceHeaderBlock::HashTableEntry>(m_entries, m_entryCount);
+		}
+
+	private:
+		CoalescedMSFStream m_stream;
+		const SourceHeaderBlock::HashTableEntry* m_entries;
+		size_t m_entryCount;
+
+		PDB_DISABLE_COPY(SourceHeaderBlockStream);
+	};
+
+	// Creates a stream for the "/src/headerblock" stream. The stream has no entries if the PDB has no such stream.
+	PDB_NO_DISCARD SourceHeaderBlockStream CreateSourceHeaderBlockStream(const RawFile& file, const InfoStream& infoStream) PDB_NO_EXCEPT;
+
+	// Returns the index of the named stream "/src/files/<path>" storing the embedded source file with the given virtual path,
+	// or zero if no such stream exists.
+	PDB_NO_DISCARD uint32_t FindEmbeddedSourceStream(const InfoStream& infoStream, const char* path) PDB_NO_EXCEPT;
+
+	// Iterates all embedded source files described by the "/src/headerblock" stream, calling the functor with the
+	// virtual path of each file and a stream providing its contents along with their compression.
+	template <typename F>
+	inline void ForEachEmbeddedSource(const RawFile& file, const InfoStream& infoStream, const NamesStream& namesStream, F&& functor) PDB_NO_EXCEPT
+	{
+		const SourceHeaderBlockStream headerBlockStream = CreateSourceHeaderBlockStream(file, infoStream);
+		for (const SourceHeaderBlock::HashTableEntry& hashTableEntry : headerBlockStream.GetEntries())
+		{
+			const char* path = namesStream.GetFilename(hashTableEntry.entry.virtualFileNameOffset);
+			const uint32_t streamIndex = FindEmbeddedSourceStream(infoStream, path);
+			if (streamIndex != 0u)
+			{
+				const EmbeddedSourceStream embeddedSource(file, streamIndex, hashTableEntry.entry.compression);
+				functor(path, embeddedSource);
+			}
+		}
+	}
+}
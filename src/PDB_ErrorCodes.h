@@ -21,6 +21,14 @@ namespace PDB
 		InvalidStream,
 		InvalidSignature,
 		InvalidStreamIndex,
-		UnknownVersion
+		UnknownVersion,
+
+		// symbol index cache validation
+		InvalidChecksum,
+		MismatchingPDB,
+
+		// embedded source decompression
+		UnsupportedCompression,
+		InvalidCompressedData
 	};
 }
@@ -0,0 +1,208 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_BitUtil.h"
+#include "PDB_TPITypes.h"
+#include "PDB_Util.h"
+
+
+// Fields of classes, structs, unions and enums are stored in LF_FIELDLIST records. each field starts with its kind,
+// followed by a fixed-size part, a number of numeric leaves of variable size, and an optional name. fields are padded
+// to 4 bytes, and long lists are split into several records, each ending with an LF_INDEX to the next one.
+namespace PDB
+{
+	// Describes how a field of a certain kind is stored.
+	struct FieldEncoding
+	{
+		uint8_t fixedSize;					// including the 2-byte kind, zero for fields that cannot be walked
+		uint8_t numericLeafCount;
+		bool hasName;
+	};
+
+	// Returns the encoding of fields of the given kind.
+	PDB_NO_DISCARD inline FieldEncoding GetFieldEncoding(CodeView::TPI::TypeRecordKind kind) PDB_NO_EXCEPT
+	{
+		// indexed by kind - LF_BCLASS
+		static constexpr const FieldEncoding encodings1400[] =
+		{
+			{ 8u, 1u, false },				// LF_BCLASS
+			{ 12u, 2u, false },				// LF_VBCLASS
+			{ 12u, 2u, false },				// LF_IVBCLASS
+			{ 0u, 0u, false },				// LF_FRIENDFCN_ST
+			{ 8u, 0u, false },				// LF_INDEX
+			{ 0u, 0u, false },				// LF_MEMBER_ST
+			{ 0u, 0u, false },				// LF_STMEMBER_ST
+			{ 0u, 0u, false },				// LF_METHOD_ST
+			{ 0u, 0u, false },				// LF_NESTTYPE_ST
+			{ 8u, 0u, false },				// LF_VFUNCTAB
+			{ 8u, 0u, false },				// LF_FRIENDCLS
+			{ 0u, 0u, false },				// LF_ONEMETHOD_ST
+			{ 12u, 0u, false }				// LF_VFUNCOFF
+		};
+
+		// indexed by kind - LF_SMAX
+		static constexpr const FieldEncoding encodings1500[] =
+		{
+			{ 0u, 0u, false },				// LF_SMAX
+			{ 0u, 0u, false },				// LF_TYPESERVER
+			{ 4u, 1u, true },				// LF_ENUMERATE
+			{ 0u, 0u, false },				// LF_ARRAY
+			{ 0u, 0u, false },				// LF_CLASS
+			{ 0u, 0u, false },				// LF_STRUCTURE
+			{ 0u, 0u, false },				// LF_UNION
+			{ 0u, 0u, false },				// LF_ENUM
+			{ 0u, 0u, false },				// LF_DIMARRAY
+			{ 0u, 0u, false },				// LF_PRECOMP
+			{ 0u, 0u, false },				// LF_ALIAS
+			{ 0u, 0u, false },				// LF_DEFARG
+			{ 8u, 0u, true },				// LF_FRIENDFCN
+			{ 8u, 1u, true },				// LF_MEMBER
+			{ 8u, 0u, true },				// LF_STMEMBER
+			{ 8u, 0u, true },				// LF_METHOD
+			{ 8u, 0u, true },				// LF_NESTTYPE
+			{ 8u, 0u, true },				// LF_ONEMETHOD, see GetFieldName()
+			{ 8u, 0u, true },				// LF_NESTTYPEEX
+			{ 8u, 0u, true }				// LF_MEMBERMODIFY
+		};
+
+		const uint16_t value = static_cast<uint16_t>(kind);
+		if (value >= static_cast<uint16_t>(CodeView::TPI::TypeRecordKind::LF_BCLASS))
+		{
+			const uint16_t index = static_cast<uint16_t>(value - static_cast<uint16_t>(CodeView::TPI::TypeRecordKind::LF_BCLASS));
+			if (index < sizeof(encodings1400) / sizeof(encodings1400[0]))
+			{
+				return encodings1400[index];
+			}
+		}
+
+		if (value >= static_cast<uint16_t>(CodeView::TPI::TypeRecordKind::LF_SMAX))
+		{
+			const uint16_t index = static_cast<uint16_t>(value - static_cast<uint16_t>(CodeView::TPI::TypeRecordKind::LF_SMAX));
+			if (index < sizeof(encodings1500) / sizeof(encodings1500[0]))
+			{
+				return encodings1500[index];
+			}
+		}
+
+		return FieldEncoding { 0u, 0u, false };
+	}
+
+	// Returns the first numeric leaf of a field, e.g. the offset of an LF_MEMBER or the value of an LF_ENUMERATE.
+	// Returns nullptr if fields of this kind do not store numeric leaves.
+	PDB_NO_DISCARD inline const char* GetFieldNumericLeaf(const CodeView::TPI::FieldList* field) PDB_NO_EXCEPT
+	{
+		const FieldEncoding encoding = GetFieldEncoding(field->kind);
+		if (encoding.numericLeafCount == 0u)
+		{
+			return nullptr;
+		}
+
+		return reinterpret_cast<const char*>(field) + encoding.fixedSize;
+	}
+
+	// Returns the name of a field, or nullptr if fields of this kind are not named or cannot be walked.
+	PDB_NO_DISCARD inline const char* GetFieldName(const CodeView::TPI::FieldList* field) PDB_NO_EXCEPT
+	{
+		const FieldEncoding encoding = GetFieldEncoding(field->kind);
+		if (!encoding.hasName)
+		{
+			return nullptr;
+		}
+
+		const char* name = reinterpret_cast<const char*>(field) + encoding.fixedSize;
+		for (uint8_t i = 0u; i < encoding.numericLeafCount; ++i)
+		{
+			name += GetNumericLeafSize(name);
+		}
+
+		if (field->kind == CodeView::TPI::TypeRecordKind::LF_ONEMETHOD)
+		{
+			// introducing virtual methods store their offset in the virtual function table before the name
+			const CodeView::TPI::MethodProperty property = static_cast<CodeView::TPI::MethodProperty>(field->data.LF_ONEMETHOD.attributes.mprop);
+			if ((property == CodeView::TPI::MethodProperty::Intro) || (property == CodeView::TPI::MethodProperty::PureIntro))
+			{
+				name += sizeof(uint32_t);
+			}
+		}
+
+		return name;
+	}
+
+	// Returns the size of a field in bytes, not including any padding. Returns zero for fields that cannot be walked.
+	PDB_NO_DISCARD inline size_t GetFieldSize(const CodeView::TPI::FieldList* field) PDB_NO_EXCEPT
+	{
+		const FieldEncoding encoding = GetFieldEncoding(field->kind);
+		if (encoding.fixedSize == 0u)
+		{
+			return 0u;
+		}
+
+		const char* start = reinterpret_cast<const char*>(field);
+		if (encoding.hasName)
+		{
+			const char* name = GetFieldName(field);
+			size_t length = 0u;
+			while (name[length] != '\0')
+			{
+				++length;
+			}
+
+			return static_cast<size_t>(name - start) + length + 1u;
+		}
+
+		const char* end = start + encoding.fixedSize;
+		for (uint8_t i = 0u; i < encoding.numericLeafCount; ++i)
+		{
+			end += GetNumericLeafSize(end);
+		}
+
+		return static_cast<size_t>(end - start);
+	}
+
+	// Calls the functor for each field of a field list, following LF_INDEX continuations into the remaining records.
+	// LF_INDEX fields themselves are not passed to the functor. iteration stops at the first field that cannot be walked.
+	// works with any table providing GetTypeRecord(uint32_t typeIndex), e.g. a TypeTable.
+	template <typename Table, typename F>
+	void ForEachField(const Table& typeTable, uint32_t fieldListIndex, F&& functor) PDB_NO_EXCEPT
+	{
+		// guards against cycles in malformed type information
+		static constexpr const uint32_t MaxFieldListCount = 0x10000u;
+
+		for (uint32_t listCount = 0u; (fieldListIndex != 0u) && (listCount < MaxFieldListCount); ++listCount)
+		{
+			const CodeView::TPI::Record* record = typeTable.GetTypeRecord(fieldListIndex);
+			if (!record || (record->header.kind != CodeView::TPI::TypeRecordKind::LF_FIELDLIST))
+			{
+				return;
+			}
+
+			fieldListIndex = 0u;
+
+			const char* fields = reinterpret_cast<const char*>(&record->data.LF_FIELD.list);
+			const size_t size = GetCodeViewRecordSize(record);
+			for (size_t i = 0u; i + sizeof(CodeView::TPI::TypeRecordKind) <= size; /* nothing */)
+			{
+				const CodeView::TPI::FieldList* field = reinterpret_cast<const CodeView::TPI::FieldList*>(fields + i);
+				if (field->kind == CodeView::TPI::TypeRecordKind::LF_INDEX)
+				{
+					fieldListIndex = field->data.LF_INDEX.type;
+					break;
+				}
+
+				const size_t fieldSize = GetFieldSize(field);
+				if ((fieldSize == 0u) || (i + fieldSize > size))
+				{
+					return;
+				}
+
+				functor(field);
+
+				// fields are padded to 4 bytes
+				i = BitUtil::RoundUpToMultiple<size_t>(i + fieldSize, 4u);
+			}
+		}
+	}
+}
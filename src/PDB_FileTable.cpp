@@ -0,0 +1,297 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_FileTable.h"
+#include "PDB_RawFile.h"
+#include "PDB_ModuleInfoStream.h"
+#include "Foundation/PDB_Hash.h"
+#include "Foundation/PDB_Memory.h"
+#include "Foundation/PDB_CRT.h"
+
+
+namespace
+{
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	template <typename T>
+	static void Grow(T*& array, size_t count, size_t& capacity, size_t requiredCapacity) PDB_NO_EXCEPT
+	{
+		if (requiredCapacity <= capacity)
+		{
+			return;
+		}
+
+		size_t newCapacity = (capacity < 256u) ? 256u : capacity * 2u;
+		while (newCapacity < requiredCapacity)
+		{
+			newCapacity *= 2u;
+		}
+
+		T* newArray = PDB_NEW_ARRAY(T, newCapacity);
+		if (count != 0u)
+		{
+			memcpy(newArray, array, sizeof(T) * count);
+		}
+
+		PDB_DELETE_ARRAY(array);
+		array = newArray;
+		capacity = newCapacity;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline uint32_t HashFile(const PDB::FileTable::File& file) PDB_NO_EXCEPT
+	{
+		uint32_t hash = PDB::Hash::FNV1a(&file.filenameOffset, sizeof(file.filenameOffset));
+		hash = PDB::Hash::FNV1a(&file.checksumKind, sizeof(file.checksumKind), hash);
+
+		return PDB::Hash::FNV1a(file.checksum, file.checksumSize, hash);
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline bool IsSameFile(const PDB::FileTable::File& lhs, const PDB::FileTable::File& rhs) PDB_NO_EXCEPT
+	{
+		return (lhs.filenameOffset == rhs.filenameOffset)
+			&& (lhs.checksumKind == rhs.checksumKind)
+			&& (lhs.checksumSize == rhs.checksumSize)
+			&& (memcmp(lhs.checksum, rhs.checksum, lhs.checksumSize) == 0);
+	}
+
+
+	// A hash set of file ids used while building the table, using open addressing with linear probing.
+	class FileSet
+	{
+	public:
+		FileSet(void) PDB_NO_EXCEPT
+			: m_hashes(nullptr)
+			, m_ids(nullptr)
+			, m_capacity(0u)
+			, m_count(0u)
+		{
+		}
+
+		~FileSet(void) PDB_NO_EXCEPT
+		{
+			PDB_DELETE_ARRAY(m_hashes);
+			PDB_DELETE_ARRAY(m_ids);
+		}
+
+		// Returns the id of an equal file already in the set, or stores and returns the given id.
+		PDB_NO_DISCARD uint32_t FindOrAdd(const PDB::FileTable::File* files, const PDB::FileTable::File& file, uint32_t id) PDB_NO_EXCEPT
+		{
+			// keep the load factor below 50%
+			if ((m_count + 1u) * 2u > m_capacity)
+			{
+				Rehash((m_capacity == 0u) ? 1024u : m_capacity * 2u);
+			}
+
+			const uint32_t hash = HashFile(file);
+			size_t slot = hash & (m_capacity - 1u);
+			while (m_ids[slot] != PDB::FileTable::InvalidFileId)
+			{
+				if ((m_hashes[slot] == hash) && IsSameFile(files[m_ids[slot]], file))
+				{
+					return m_ids[slot];
+				}
+
+				slot = (slot + 1u) & (m_capacity - 1u);
+			}
+
+			m_hashes[slot] = hash;
+			m_ids[slot] = id;
+			++m_count;
+
+			return id;
+		}
+
+	private:
+		void Rehash(size_t capacity) PDB_NO_EXCEPT
+		{
+			uint32_t* hashes = PDB_NEW_ARRAY(uint32_t, capacity);
+			uint32_t* ids = PDB_NEW_ARRAY(uint32_t, capacity);
+			memset(ids, 0xFF, sizeof(uint32_t) * capacity);
+
+			for (size_t i = 0u; i < m_capacity; ++i)
+			{
+				if (m_ids[i] == PDB::FileTable::InvalidFileId)
+				{
+					continue;
+				}
+
+				size_t slot = m_hashes[i] & (capacity - 1u);
+				while (ids[slot] != PDB::FileTable::InvalidFileId)
+				{
+					slot = (slot + 1u) & (capacity - 1u);
+				}
+
+				hashes[slot] = m_hashes[i];
+				ids[slot] = m_ids[i];
+			}
+
+			PDB_DELETE_ARRAY(m_hashes);
+			PDB_DELETE_ARRAY(m_ids);
+
+			m_hashes = hashes;
+			m_ids = ids;
+			m_capacity = capacity;
+		}
+
+		uint32_t* m_hashes;
+		uint32_t* m_ids;
+		size_t m_capacity;
+		size_t m_count;
+
+		PDB_DISABLE_COPY(FileSet);
+	};
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::FileTable::FileTable(void) PDB_NO_EXCEPT
+	: m_files(nullptr)
+	, m_fileCount(0u)
+	, m_remap(nullptr)
+	, m_moduleRemapOffsets(nullptr)
+	, m_moduleCount(0u)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::FileTable::FileTable(FileTable&& other) PDB_NO_EXCEPT
+	: m_files(PDB_MOVE(other.m_files))
+	, m_fileCount(PDB_MOVE(other.m_fileCount))
+	, m_remap(PDB_MOVE(other.m_remap))
+	, m_moduleRemapOffsets(PDB_MOVE(other.m_moduleRemapOffsets))
+	, m_moduleCount(PDB_MOVE(other.m_moduleCount))
+{
+	other.m_files = nullptr;
+	other.m_fileCount = 0u;
+	other.m_remap = nullptr;
+	other.m_moduleRemapOffsets = nullptr;
+	other.m_moduleCount = 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::FileTable& PDB::FileTable::operator=(FileTable&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		PDB_DELETE_ARRAY(m_files);
+		PDB_DELETE_ARRAY(m_remap);
+		PDB_DELETE_ARRAY(m_moduleRemapOffsets);
+
+		m_files = PDB_MOVE(other.m_files);
+		m_fileCount = PDB_MOVE(other.m_fileCount);
+		m_remap = PDB_MOVE(other.m_remap);
+		m_moduleRemapOffsets = PDB_MOVE(other.m_moduleRemapOffsets);
+		m_moduleCount = PDB_MOVE(other.m_moduleCount);
+
+		other.m_files = nullptr;
+		other.m_fileCount = 0u;
+		other.m_remap = nullptr;
+		other.m_moduleRemapOffsets = nullptr;
+		other.m_moduleCount = 0u;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::FileTable::FileTable(const RawFile& file, const ModuleInfoStream& moduleInfoStream) PDB_NO_EXCEPT
+	: m_files(nullptr)
+	, m_fileCount(0u)
+	, m_remap(nullptr)
+	, m_moduleRemapOffsets(nullptr)
+	, m_moduleCount(0u)
+{
+	const ArrayView<ModuleInfoStream::Module> modules = moduleInfoStream.GetModules();
+
+	m_moduleCount = modules.GetLength();
+	m_moduleRemapOffsets = PDB_NEW_ARRAY(uint32_t, m_moduleCount + 1u);
+
+	size_t fileCapacity = 0u;
+	size_t remapCount = 0u;
+	size_t remapCapacity = 0u;
+	FileSet fileSet;
+
+	for (size_t i = 0u; i < m_moduleCount; ++i)
+	{
+		m_moduleRemapOffsets[i] = static_cast<uint32_t>(remapCount);
+
+		const ModuleInfoStream::Module& module = modules[i];
+		if (!module.HasLineStream())
+		{
+			continue;
+		}
+
+		const ModuleLineStream lineStream = module.CreateLineStream(file);
+		lineStream.ForEachSection([this, &lineStream, &fileSet, &fileCapacity, &remapCount, &remapCapacity](const CodeView::DBI::LineSection* section)
+		{
+			if (section->header.kind != CodeView::DBI::DebugSubsectionKind::S_FILECHECKSUMS)
+			{
+				return;
+			}
+
+			// checksum offsets are relative to the first checksum and 4-byte aligned, so one slot is needed
+			// for every 4 bytes of checksum data.
+			const size_t slotCount = (section->header.size + 3u) / 4u;
+			const size_t moduleRemapStart = remapCount;
+			Grow(m_remap, remapCount, remapCapacity, remapCount + slotCount);
+			memset(m_remap + moduleRemapStart, 0xFF, sizeof(uint32_t) * slotCount);
+			remapCount += slotCount;
+
+			const Byte* checksumsStart = reinterpret_cast<const Byte*>(&section->checksumHeader);
+			lineStream.ForEachFileChecksum(section, [this, &fileSet, &fileCapacity, moduleRemapStart, checksumsStart](const CodeView::DBI::FileChecksumHeader* checksumHeader)
+			{
+				Grow(m_files, m_fileCount, fileCapacity, m_fileCount + 1u);
+
+				File& newFile = m_files[m_fileCount];
+				newFile.filenameOffset = checksumHeader->filenameOffset;
+				newFile.checksumKind = checksumHeader->checksumKind;
+				newFile.checksumSize = (checksumHeader->checksumSize < sizeof(newFile.checksum)) ? checksumHeader->checksumSize : static_cast<uint8_t>(sizeof(newFile.checksum));
+				memset(newFile.checksum, 0, sizeof(newFile.checksum));
+				memcpy(newFile.checksum, checksumHeader->checksum, newFile.checksumSize);
+
+				const uint32_t fileId = fileSet.FindOrAdd(m_files, newFile, m_fileCount);
+				if (fileId == m_fileCount)
+				{
+					++m_fileCount;
+				}
+
+				const size_t checksumOffset = static_cast<size_t>(reinterpret_cast<const Byte*>(checksumHeader) - checksumsStart);
+				m_remap[moduleRemapStart + checksumOffset / 4u] = fileId;
+			});
+		});
+	}
+
+	m_moduleRemapOffsets[m_moduleCount] = static_cast<uint32_t>(remapCount);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::FileTable::~FileTable(void) PDB_NO_EXCEPT
+{
+	PDB_DELETE_ARRAY(m_files);
+	PDB_DELETE_ARRAY(m_remap);
+	PDB_DELETE_ARRAY(m_moduleRemapOffsets);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::FileTable PDB::CreateFileTable(const RawFile& file, const ModuleInfoStream& moduleInfoStream) PDB_NO_EXCEPT
+{
+	return FileTable { file, moduleInfoStream };
+}
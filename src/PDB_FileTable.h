@@ -0,0 +1,89 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_ArrayView.h"
+#include "PDB_DBITypes.h"
+
+
+namespace PDB
+{
+	class RawFile;
+	class ModuleInfoStream;
+
+
+	// A table of all source files referenced by the S_FILECHECKSUMS sections of all modules.
+	// files are deduplicated by their "/names" offset and checksum, and identified by dense ids starting at zero.
+	// for each module, the table stores an array that maps the checksum offsets used by the module's lines to file ids,
+	// so that lines can be processed using integers only.
+	class PDB_NO_DISCARD FileTable
+	{
+	public:
+		static constexpr const uint32_t InvalidFileId = 0xFFFFFFFFu;
+
+		struct File
+		{
+			uint32_t filenameOffset;		// offset into the "/names" stream, see NamesStream::GetFilename()
+			CodeView::DBI::ChecksumKind checksumKind;
+			uint8_t checksumSize;
+			uint8_t checksum[32];
+		};
+
+		FileTable(void) PDB_NO_EXCEPT;
+		FileTable(FileTable&& other) PDB_NO_EXCEPT;
+		FileTable& operator=(FileTable&& other) PDB_NO_EXCEPT;
+
+		explicit FileTable(const RawFile& file, const ModuleInfoStream& moduleInfoStream) PDB_NO_EXCEPT;
+		~FileTable(void) PDB_NO_EXCEPT;
+
+		// Returns the id of the file referred to by a checksum offset in the given module, e.g. LinesFileBlockHeader::fileChecksumOffset.
+		// Returns InvalidFileId if the offset does not denote a file checksum.
+		PDB_NO_DISCARD inline uint32_t GetFileId(uint32_t moduleIndex, uint32_t checksumOffset) const PDB_NO_EXCEPT
+		{
+			const ArrayView<uint32_t> remap = GetModuleRemap(moduleIndex);
+			const uint32_t slot = checksumOffset / 4u;
+
+			return (slot < remap.GetLength()) ? remap[slot] : InvalidFileId;
+		}
+
+		// Returns the array mapping checksum offsets of the given module to file ids.
+		// checksums are 4-byte aligned, so the array is indexed by the checksum offset divided by 4.
+		PDB_NO_DISCARD inline ArrayView<uint32_t> GetModuleRemap(uint32_t moduleIndex) const PDB_NO_EXCEPT
+		{
+			PDB_ASSERT(moduleIndex < m_moduleCount, "Module index %u out of bounds [0, %zu).", moduleIndex, m_moduleCount);
+
+			const uint32_t start = m_moduleRemapOffsets[moduleIndex];
+			return ArrayView<uint32_t>(m_remap + start, m_moduleRemapOffsets[moduleIndex + 1u] - start);
+		}
+
+		// Returns the file with the given id.
+		PDB_NO_DISCARD inline const File& GetFile(uint32_t fileId) const PDB_NO_EXCEPT
+		{
+			PDB_ASSERT(fileId < m_fileCount, "File id %u out of bounds [0, %u).", fileId, m_fileCount);
+
+			return m_files[fileId];
+		}
+
+		// Returns a view of all files, indexed by their id.
+		PDB_NO_DISCARD inline ArrayView<File> GetFiles(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<File>(m_files, m_fileCount);
+		}
+
+	private:
+		File* m_files;
+		uint32_t m_fileCount;
+
+		// the remap arrays of all modules are stored consecutively. the offsets array has an additional entry denoting the end.
+		uint32_t* m_remap;
+		uint32_t* m_moduleRemapOffsets;
+		size_t m_moduleCount;
+
+		PDB_DISABLE_COPY(FileTable);
+	};
+
+	// Creates a table of all source files referenced by the modules' line information.
+	PDB_NO_DISCARD FileTable CreateFileTable(const RawFile& file, const ModuleInfoStream& moduleInfoStream) PDB_NO_EXCEPT;
+}
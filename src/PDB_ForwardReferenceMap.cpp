@@ -0,0 +1,311 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_ForwardReferenceMap.h"
+#include "PDB_TypeTable.h"
+#include "PDB_Util.h"
+#include "Foundation/PDB_Hash.h"
+#include "Foundation/PDB_Memory.h"
+#include "Foundation/PDB_CRT.h"
+
+
+namespace
+{
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static const char* GetKey(const PDB::CodeView::TPI::Record* record, const PDB::CodeView::TPI::TypeProperty& property) PDB_NO_EXCEPT
+	{
+		// unique names tell apart types with the same name in different scopes, e.g. in anonymous namespaces
+		const char* uniqueName = PDB::GetUDTUniqueName(record, property);
+		return uniqueName ? uniqueName : PDB::GetUDTName(record);
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ForwardReferenceMap::ForwardReferenceMap(void) PDB_NO_EXCEPT
+	: m_definitions(nullptr)
+	, m_typeIndexBegin(0u)
+	, m_typeIndexEnd(0u)
+	, m_resolvedCount(0u)
+	, m_roles(nullptr)
+	, m_hashes(nullptr)
+	, m_bucketDefinitions(nullptr)
+	, m_bucketOffsets(nullptr)
+	, m_bucketCount(0u)
+	, m_segmentCount(0u)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ForwardReferenceMap::ForwardReferenceMap(ForwardReferenceMap&& other) PDB_NO_EXCEPT
+	: m_definitions(PDB_MOVE(other.m_definitions))
+	, m_typeIndexBegin(PDB_MOVE(other.m_typeIndexBegin))
+	, m_typeIndexEnd(PDB_MOVE(other.m_typeIndexEnd))
+	, m_resolvedCount(PDB_MOVE(other.m_resolvedCount))
+	, m_roles(nullptr)
+	, m_hashes(nullptr)
+	, m_bucketDefinitions(nullptr)
+	, m_bucketOffsets(nullptr)
+	, m_bucketCount(0u)
+	, m_segmentCount(0u)
+{
+	other.m_definitions = nullptr;
+	other.m_typeIndexBegin = 0u;
+	other.m_typeIndexEnd = 0u;
+	other.m_resolvedCount = 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ForwardReferenceMap& PDB::ForwardReferenceMap::operator=(ForwardReferenceMap&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		PDB_DELETE_ARRAY(m_definitions);
+
+		m_definitions = PDB_MOVE(other.m_definitions);
+		m_typeIndexBegin = PDB_MOVE(other.m_typeIndexBegin);
+		m_typeIndexEnd = PDB_MOVE(other.m_typeIndexEnd);
+		m_resolvedCount = PDB_MOVE(other.m_resolvedCount);
+
+		other.m_definitions = nullptr;
+		other.m_typeIndexBegin = 0u;
+		other.m_typeIndexEnd = 0u;
+		other.m_resolvedCount = 0u;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ForwardReferenceMap::ForwardReferenceMap(const TypeTable& typeTable) PDB_NO_EXCEPT
+	: ForwardReferenceMap()
+{
+	if (!BeginBuild(typeTable))
+	{
+		return;
+	}
+
+	for (size_t i = 0u; i < m_segmentCount; ++i)
+	{
+		HashSegment(typeTable, i);
+	}
+
+	BuildBuckets();
+
+	for (size_t i = 0u; i < m_segmentCount; ++i)
+	{
+		ResolveSegment(typeTable, i);
+	}
+
+	EndBuild();
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ForwardReferenceMap::~ForwardReferenceMap(void) PDB_NO_EXCEPT
+{
+	PDB_DELETE_ARRAY(m_definitions);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD bool PDB::ForwardReferenceMap::BeginBuild(const TypeTable& typeTable) PDB_NO_EXCEPT
+{
+	m_typeIndexBegin = typeTable.GetFirstTypeIndex();
+	m_typeIndexEnd = typeTable.GetLastTypeIndex();
+
+	const size_t typeCount = typeTable.GetTypeRecordCount();
+	if (typeCount == 0u)
+	{
+		return false;
+	}
+
+	m_definitions = PDB_NEW_ARRAY(uint32_t, typeCount);
+	m_roles = PDB_NEW_ARRAY(Role, typeCount);
+	m_hashes = PDB_NEW_ARRAY(uint32_t, typeCount);
+	m_segmentCount = (typeCount + TypeIndicesPerSegment - 1u) / TypeIndicesPerSegment;
+
+	return true;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::ForwardReferenceMap::HashSegment(const TypeTable& typeTable, size_t segmentIndex) PDB_NO_EXCEPT
+{
+	const size_t typeCount = typeTable.GetTypeRecordCount();
+	const size_t begin = segmentIndex * TypeIndicesPerSegment;
+	const size_t end = (begin + TypeIndicesPerSegment < typeCount) ? begin + TypeIndicesPerSegment : typeCount;
+
+	for (size_t i = begin; i < end; ++i)
+	{
+		m_roles[i] = Role::None;
+		m_hashes[i] = 0u;
+
+		const CodeView::TPI::Record* record = typeTable.GetTypeRecord(m_typeIndexBegin + static_cast<uint32_t>(i));
+		CodeView::TPI::TypeProperty property = {};
+		if (!record || !GetUDTProperty(record, property))
+		{
+			continue;
+		}
+
+		const char* key = GetKey(record, property);
+		m_roles[i] = property.fwdref ? Role::ForwardReference : Role::Definition;
+		m_hashes[i] = Hash::FNV1a(key, strlen(key));
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::ForwardReferenceMap::BuildBuckets(void) PDB_NO_EXCEPT
+{
+	const size_t typeCount = m_typeIndexEnd - m_typeIndexBegin;
+
+	size_t definitionCount = 0u;
+	for (size_t i = 0u; i < typeCount; ++i)
+	{
+		definitionCount += (m_roles[i] == Role::Definition) ? 1u : 0u;
+	}
+
+	// use a power-of-two number of buckets holding one definition on average
+	m_bucketCount = 1u;
+	while (m_bucketCount < definitionCount)
+	{
+		m_bucketCount *= 2u;
+	}
+
+	m_bucketOffsets = PDB_NEW_ARRAY(uint32_t, m_bucketCount + 1u);
+	memset(m_bucketOffsets, 0, sizeof(uint32_t) * (m_bucketCount + 1u));
+
+	m_bucketDefinitions = PDB_NEW_ARRAY(uint32_t, definitionCount);
+
+	// count the definitions of each bucket, turn the counts into offsets, and store the definitions in type index order
+	for (size_t i = 0u; i < typeCount; ++i)
+	{
+		if (m_roles[i] == Role::Definition)
+		{
+			++m_bucketOffsets[(m_hashes[i] & (m_bucketCount - 1u)) + 1u];
+		}
+	}
+
+	for (uint32_t i = 0u; i < m_bucketCount; ++i)
+	{
+		m_bucketOffsets[i + 1u] += m_bucketOffsets[i];
+	}
+
+	// the offsets are used as insertion cursors and shifted back by one bucket afterwards
+	for (size_t i = 0u; i < typeCount; ++i)
+	{
+		if (m_roles[i] == Role::Definition)
+		{
+			const uint32_t bucket = m_hashes[i] & (m_bucketCount - 1u);
+			m_bucketDefinitions[m_bucketOffsets[bucket]++] = m_typeIndexBegin + static_cast<uint32_t>(i);
+		}
+	}
+
+	for (uint32_t i = m_bucketCount; i > 0u; --i)
+	{
+		m_bucketOffsets[i] = m_bucketOffsets[i - 1u];
+	}
+
+	m_bucketOffsets[0u] = 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::ForwardReferenceMap::ResolveSegment(const TypeTable& typeTable, size_t segmentIndex) PDB_NO_EXCEPT
+{
+	const size_t typeCount = typeTable.GetTypeRecordCount();
+	const size_t begin = segmentIndex * TypeIndicesPerSegment;
+	const size_t end = (begin + TypeIndicesPerSegment < typeCount) ? begin + TypeIndicesPerSegment : typeCount;
+
+	for (size_t i = begin; i < end; ++i)
+	{
+		m_definitions[i] = 0u;
+		if (m_roles[i] != Role::ForwardReference)
+		{
+			continue;
+		}
+
+		const CodeView::TPI::Record* record = typeTable.GetTypeRecord(m_typeIndexBegin + static_cast<uint32_t>(i));
+		CodeView::TPI::TypeProperty property = {};
+		(void)GetUDTProperty(record, property);
+		const char* key = GetKey(record, property);
+
+		// the first definition of the same kind wins
+		const uint32_t bucket = m_hashes[i] & (m_bucketCount - 1u);
+		for (uint32_t j = m_bucketOffsets[bucket]; j < m_bucketOffsets[bucket + 1u]; ++j)
+		{
+			const uint32_t definitionIndex = m_bucketDefinitions[j];
+			if (m_hashes[definitionIndex - m_typeIndexBegin] != m_hashes[i])
+			{
+				continue;
+			}
+
+			const CodeView::TPI::Record* definition = typeTable.GetTypeRecord(definitionIndex);
+			CodeView::TPI::TypeProperty definitionProperty = {};
+			if ((definition->header.kind != record->header.kind) || !GetUDTProperty(definition, definitionProperty))
+			{
+				continue;
+			}
+
+			if (strcmp(GetKey(definition, definitionProperty), key) == 0)
+			{
+				m_definitions[i] = definitionIndex;
+				break;
+			}
+		}
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::ForwardReferenceMap::EndBuild(void) PDB_NO_EXCEPT
+{
+	const size_t typeCount = m_typeIndexEnd - m_typeIndexBegin;
+	for (size_t i = 0u; i < typeCount; ++i)
+	{
+		m_resolvedCount += (m_definitions[i] != 0u) ? 1u : 0u;
+	}
+
+	PDB_DELETE_ARRAY(m_roles);
+	PDB_DELETE_ARRAY(m_hashes);
+	PDB_DELETE_ARRAY(m_bucketDefinitions);
+	PDB_DELETE_ARRAY(m_bucketOffsets);
+	m_roles = nullptr;
+	m_hashes = nullptr;
+	m_bucketDefinitions = nullptr;
+	m_bucketOffsets = nullptr;
+	m_bucketCount = 0u;
+	m_segmentCount = 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD size_t PDB::ForwardReferenceMap::GetAllocatedSize(void) const PDB_NO_EXCEPT
+{
+	return (m_typeIndexEnd - m_typeIndexBegin) * sizeof(uint32_t);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::ForwardReferenceMap PDB::CreateForwardReferenceMap(const TypeTable& typeTable) PDB_NO_EXCEPT
+{
+	return ForwardReferenceMap { typeTable };
+}
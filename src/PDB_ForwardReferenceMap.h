@@ -0,0 +1,124 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+
+
+namespace PDB
+{
+	class TypeTable;
+
+
+	// Maps forward references of user-defined types (classes, structs, interfaces, unions and enums) to their definition.
+	// most references to user-defined types in symbols and other type records point at forward references, whose definition
+	// can only be found by name. the map matches all forward references against all definitions once upon construction,
+	// using the unique name if a type has one, so that following a forward reference afterwards is a single array lookup.
+	// definitions are matched using a hash table built from the type table, so the TPI hash stream is not needed.
+	class PDB_NO_DISCARD ForwardReferenceMap
+	{
+	public:
+		// the number of type indices making up one segment when building the map concurrently
+		static constexpr const uint32_t TypeIndicesPerSegment = 4096u;
+
+		ForwardReferenceMap(void) PDB_NO_EXCEPT;
+		ForwardReferenceMap(ForwardReferenceMap&& other) PDB_NO_EXCEPT;
+		ForwardReferenceMap& operator=(ForwardReferenceMap&& other) PDB_NO_EXCEPT;
+
+		explicit ForwardReferenceMap(const TypeTable& typeTable) PDB_NO_EXCEPT;
+
+		// Builds the map by hashing and resolving segments of type indices concurrently.
+		// the given functor is called with a number of tasks and a task, and must call the task once for each index in [0, count),
+		// e.g. by distributing the calls across a thread pool. it must not return before all tasks have finished.
+		template <typename ParallelFor>
+		explicit ForwardReferenceMap(const TypeTable& typeTable, ParallelFor&& parallelFor) PDB_NO_EXCEPT
+			: ForwardReferenceMap()
+		{
+			if (!BeginBuild(typeTable))
+			{
+				return;
+			}
+
+			parallelFor(m_segmentCount, [this, &typeTable](size_t segmentIndex)
+			{
+				HashSegment(typeTable, segmentIndex);
+			});
+
+			BuildBuckets();
+
+			parallelFor(m_segmentCount, [this, &typeTable](size_t segmentIndex)
+			{
+				ResolveSegment(typeTable, segmentIndex);
+			});
+
+			EndBuild();
+		}
+
+		~ForwardReferenceMap(void) PDB_NO_EXCEPT;
+
+		// Returns the type index of the definition of a forward reference. Returns the given type index if it does not refer
+		// to a forward reference, or no definition could be found.
+		PDB_NO_DISCARD inline uint32_t Resolve(uint32_t typeIndex) const PDB_NO_EXCEPT
+		{
+			if ((typeIndex < m_typeIndexBegin) || (typeIndex >= m_typeIndexEnd))
+			{
+				return typeIndex;
+			}
+
+			const uint32_t definition = m_definitions[typeIndex - m_typeIndexBegin];
+			return (definition != 0u) ? definition : typeIndex;
+		}
+
+		// Returns the number of forward references that were resolved to a definition.
+		PDB_NO_DISCARD inline size_t GetResolvedCount(void) const PDB_NO_EXCEPT
+		{
+			return m_resolvedCount;
+		}
+
+		// Returns the number of bytes allocated by the map.
+		PDB_NO_DISCARD size_t GetAllocatedSize(void) const PDB_NO_EXCEPT;
+
+	private:
+		enum class Role : uint8_t
+		{
+			None,
+			Definition,
+			ForwardReference
+		};
+
+		// Allocates the map and build data. Returns false if there is nothing to build.
+		PDB_NO_DISCARD bool BeginBuild(const TypeTable& typeTable) PDB_NO_EXCEPT;
+
+		// Stores the role and name hash of all types in a segment.
+		void HashSegment(const TypeTable& typeTable, size_t segmentIndex) PDB_NO_EXCEPT;
+
+		// Sorts all definitions into the buckets of a hash table.
+		void BuildBuckets(void) PDB_NO_EXCEPT;
+
+		// Looks up the definition of all forward references in a segment.
+		void ResolveSegment(const TypeTable& typeTable, size_t segmentIndex) PDB_NO_EXCEPT;
+
+		// Counts the resolved forward references and frees all build data.
+		void EndBuild(void) PDB_NO_EXCEPT;
+
+		// the type index of the definition for each type index - first type index, zero for anything else
+		uint32_t* m_definitions;
+		uint32_t m_typeIndexBegin;
+		uint32_t m_typeIndexEnd;
+		size_t m_resolvedCount;
+
+		// the role and name hash of each type, the definitions sorted by bucket, and the offset of each bucket. only needed while building.
+		Role* m_roles;
+		uint32_t* m_hashes;
+		uint32_t* m_bucketDefinitions;
+		uint32_t* m_bucketOffsets;
+		uint32_t m_bucketCount;
+		size_t m_segmentCount;
+
+		PDB_DISABLE_COPY(ForwardReferenceMap);
+	};
+
+	// Creates a map from all forward references in the type table to their definition.
+	PDB_NO_DISCARD ForwardReferenceMap CreateForwardReferenceMap(const TypeTable& typeTable) PDB_NO_EXCEPT;
+}
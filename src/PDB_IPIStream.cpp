@@ -8,11 +8,27 @@
 #include "PDB_DirectMSFStream.h"
 #include "PDB_InfoStream.h"
 #include "Foundation/PDB_Memory.h"
+#include "Foundation/PDB_CRT.h"
 
 namespace
 {
 	// the IPI stream always resides at index 4
 	static constexpr const uint32_t IPIStreamIndex = 4u;
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	template <typename Chunk>
+	static void FreeChunks(Chunk* chunks, size_t count) PDB_NO_EXCEPT
+	{
+		for (size_t i = 0u; i < count; ++i)
+		{
+			PDB_DELETE_ARRAY(chunks[i].ownedData);
+			PDB_DELETE_ARRAY(chunks[i].records);
+		}
+
+		PDB_DELETE_ARRAY(chunks);
+	}
 }
 
 
@@ -23,6 +39,12 @@ PDB::IPIStream::IPIStream(void) PDB_NO_EXCEPT
 	, m_stream()
 	, m_records(nullptr)
 	, m_recordCount(0u)
+	, m_typeIndexOffsets(nullptr)
+	, m_typeIndexOffsetCount(0u)
+	, m_mode(Mode::Eager)
+	, m_directStream()
+	, m_chunks(nullptr)
+	, m_chunkCount(0u)
 {
 }
 
@@ -34,9 +56,19 @@ PDB::IPIStream::IPIStream(IPIStream&& other) PDB_NO_EXCEPT
 	, m_stream(PDB_MOVE(other.m_stream))
 	, m_records(PDB_MOVE(other.m_records))
 	, m_recordCount(PDB_MOVE(other.m_recordCount))
+	, m_typeIndexOffsets(PDB_MOVE(other.m_typeIndexOffsets))
+	, m_typeIndexOffsetCount(PDB_MOVE(other.m_typeIndexOffsetCount))
+	, m_mode(PDB_MOVE(other.m_mode))
+	, m_directStream(PDB_MOVE(other.m_directStream))
+	, m_chunks(PDB_MOVE(other.m_chunks))
+	, m_chunkCount(PDB_MOVE(other.m_chunkCount))
 {
 	other.m_records = nullptr;
 	other.m_recordCount = 0u;
+	other.m_typeIndexOffsets = nullptr;
+	other.m_typeIndexOffsetCount = 0u;
+	other.m_chunks = nullptr;
+	other.m_chunkCount = 0u;
 }
 
 
@@ -46,15 +78,27 @@ PDB::IPIStream& PDB::IPIStream::operator=(IPIStream&& other) PDB_NO_EXCEPT
 {
 	if (this != &other)
 	{
+		FreeChunks(m_chunks, m_chunkCount);
 		PDB_DELETE_ARRAY(m_records);
+		PDB_DELETE_ARRAY(m_typeIndexOffsets);
 
 		m_header = PDB_MOVE(other.m_header);
 		m_stream = PDB_MOVE(other.m_stream);
 		m_records = PDB_MOVE(other.m_records);
 		m_recordCount = PDB_MOVE(other.m_recordCount);
+		m_typeIndexOffsets = PDB_MOVE(other.m_typeIndexOffsets);
+		m_typeIndexOffsetCount = PDB_MOVE(other.m_typeIndexOffsetCount);
+		m_mode = PDB_MOVE(other.m_mode);
+		m_directStream = PDB_MOVE(other.m_directStream);
+		m_chunks = PDB_MOVE(other.m_chunks);
+		m_chunkCount = PDB_MOVE(other.m_chunkCount);
 
 		other.m_records = nullptr;
 		other.m_recordCount = 0u;
+		other.m_typeIndexOffsets = nullptr;
+		other.m_typeIndexOffsetCount = 0u;
+		other.m_chunks = nullptr;
+		other.m_chunkCount = 0u;
 	}
 
 	return *this;
@@ -64,42 +108,218 @@ PDB::IPIStream& PDB::IPIStream::operator=(IPIStream&& other) PDB_NO_EXCEPT
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB::IPIStream::IPIStream(const RawFile& file, const IPI::StreamHeader& header) PDB_NO_EXCEPT
-	: m_header(header)
-	, m_stream(file.CreateMSFStream<CoalescedMSFStream>(IPIStreamIndex))
-	, m_records(nullptr)
-	, m_recordCount(GetLastTypeIndex() - GetFirstTypeIndex())
+	: IPIStream()
+{
+	Initialize(file, header);
+
+	const size_t segmentCount = GetRecordSegmentCount();
+	for (size_t i = 0u; i < segmentCount; ++i)
+	{
+		IndexSegment(i);
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::IPIStream::IPIStream(const RawFile& file, const IPI::StreamHeader& header, Mode mode) PDB_NO_EXCEPT
+	: IPIStream()
 {
+	if (mode == Mode::Eager)
+	{
+		*this = IPIStream(file, header);
+		return;
+	}
+
+	// the stream is neither coalesced nor walked, we only need the offsets for finding records later
+	m_header = header;
+	m_recordCount = GetLastTypeIndex() - GetFirstTypeIndex();
+	m_mode = Mode::Lazy;
+	m_directStream = file.CreateMSFStream<DirectMSFStream>(IPIStreamIndex);
+
+	ReadTypeIndexOffsets(file);
+
+	// each type index offset starts a new chunk. the first chunk always starts at the first record, even if there are no offsets.
+	m_chunkCount = (m_typeIndexOffsetCount == 0u) ? 1u : m_typeIndexOffsetCount;
+	m_chunks = PDB_NEW_ARRAY(Chunk, m_chunkCount);
+	memset(m_chunks, 0, sizeof(Chunk) * m_chunkCount);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::IPIStream::~IPIStream(void) PDB_NO_EXCEPT
+{
+	FreeChunks(m_chunks, m_chunkCount);
+	PDB_DELETE_ARRAY(m_records);
+	PDB_DELETE_ARRAY(m_typeIndexOffsets);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::IPIStream::Initialize(const RawFile& file, const IPI::StreamHeader& header) PDB_NO_EXCEPT
+{
+	m_header = header;
+	m_stream = file.CreateMSFStream<CoalescedMSFStream>(IPIStreamIndex);
+	m_recordCount = GetLastTypeIndex() - GetFirstTypeIndex();
+
 	// types in the IPI stream are accessed by their index from other streams.
 	// however, the index is not stored with types in the IPI stream directly, but has to be built while walking the stream.
 	// similarly, because types are variable-length records, there are no direct offsets to access individual types.
 	// we therefore walk the IPI stream once, and store pointers to the records for trivial O(N) array lookup by index later.
 	m_records = PDB_NEW_ARRAY(const CodeView::IPI::Record*, m_recordCount);
+	memset(m_records, 0, sizeof(const CodeView::IPI::Record*) * m_recordCount);
+
+	ReadTypeIndexOffsets(file);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::IPIStream::ReadTypeIndexOffsets(const RawFile& file) PDB_NO_EXCEPT
+{
+	// the hash stream is optional. without it, the stream is walked as a single segment.
+	if ((m_header.hashStreamIndex == PDB::NilStreamIndex) || (m_header.hashStreamIndex >= file.GetStreamCount()))
+	{
+		return;
+	}
+
+	const DirectMSFStream hashStream = file.CreateMSFStream<DirectMSFStream>(m_header.hashStreamIndex);
+
+	// the offset is stored unsigned here, so a negative offset shows up as a huge one. checking the offset and length
+	// separately keeps their sum from wrapping around.
+	const size_t hashStreamSize = hashStream.GetSize();
+	if ((m_header.indexOffsetBufferOffset <= hashStreamSize) && (m_header.indexOffsetBufferLength <= hashStreamSize - m_header.indexOffsetBufferOffset))
+	{
+		m_typeIndexOffsetCount = m_header.indexOffsetBufferLength / sizeof(IPI::TypeIndexOffset);
+		if (m_typeIndexOffsetCount != 0u)
+		{
+			m_typeIndexOffsets = PDB_NEW_ARRAY(IPI::TypeIndexOffset, m_typeIndexOffsetCount);
+			hashStream.ReadAtOffset(m_typeIndexOffsets, m_typeIndexOffsetCount * sizeof(IPI::TypeIndexOffset), m_header.indexOffsetBufferOffset);
+		}
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::IPIStream::IndexSegment(size_t segmentIndex) PDB_NO_EXCEPT
+{
+	uint32_t typeIndex = m_header.typeIndexBegin;
+	size_t offset = m_header.headerSize;
+	if (segmentIndex != 0u)
+	{
+		const IPI::TypeIndexOffset& start = m_typeIndexOffsets[segmentIndex * TypeIndexOffsetsPerSegment];
+		typeIndex = start.typeIndex;
+		offset += start.offset;
+	}
 
-	// ignore the stream's header
-	size_t offset = sizeof(IPI::StreamHeader);
+	const size_t nextSegmentStart = (segmentIndex + 1u) * TypeIndexOffsetsPerSegment;
+	const uint32_t endTypeIndex = (nextSegmentStart < m_typeIndexOffsetCount) ? m_typeIndexOffsets[nextSegmentStart].typeIndex : m_header.typeIndexEnd;
 
 	// parse the CodeView records
-	uint32_t typeIndex = 0u;
-	while (offset < m_stream.GetSize())
+	for (/* nothing */; (typeIndex < endTypeIndex) && (offset < m_stream.GetSize()); ++typeIndex)
 	{
 		// https://llvm.org/docs/PDB/CodeViewTypes.html
 		const CodeView::IPI::Record* record = m_stream.GetDataAtOffset<const CodeView::IPI::Record>(offset);
 		const uint32_t recordSize = GetCodeViewRecordSize(record);
-		m_records[typeIndex] = record;
+		m_records[typeIndex - m_header.typeIndexBegin] = record;
 
 		// position the stream offset at the next record
 		offset += sizeof(CodeView::IPI::RecordHeader) + recordSize;
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::IPIStream::ResolveChunk(size_t chunkIndex) PDB_NO_EXCEPT
+{
+	uint32_t typeIndex = m_header.typeIndexBegin;
+	uint32_t startOffset = 0u;
+	if (chunkIndex != 0u)
+	{
+		typeIndex = m_typeIndexOffsets[chunkIndex].typeIndex;
+		startOffset = m_typeIndexOffsets[chunkIndex].offset;
+	}
 
-		++typeIndex;
+	uint32_t endTypeIndex = m_header.typeIndexEnd;
+	uint32_t endOffset = m_directStream.GetSize() - m_header.headerSize;
+	if (chunkIndex + 1u < m_typeIndexOffsetCount)
+	{
+		endTypeIndex = m_typeIndexOffsets[chunkIndex + 1u].typeIndex;
+		endOffset = m_typeIndexOffsets[chunkIndex + 1u].offset;
+	}
+
+	Chunk& chunk = m_chunks[chunkIndex];
+	chunk.records = PDB_NEW_ARRAY(const CodeView::IPI::Record*, endTypeIndex - typeIndex);
+	memset(chunk.records, 0, sizeof(const CodeView::IPI::Record*) * (endTypeIndex - typeIndex));
+
+	// access the records directly in the file if possible, otherwise copy them into contiguous memory
+	const size_t chunkSize = (endOffset > startOffset) ? endOffset - startOffset : 0u;
+	chunk.data = static_cast<const Byte*>(m_directStream.GetContiguousDataAtOffset(m_header.headerSize + startOffset, chunkSize));
+	if (!chunk.data)
+	{
+		chunk.ownedData = PDB_NEW_ARRAY(Byte, chunkSize);
+		m_directStream.ReadAtOffset(chunk.ownedData, chunkSize, m_header.headerSize + startOffset);
+		chunk.data = chunk.ownedData;
+	}
+
+	const uint32_t firstTypeIndex = typeIndex;
+	size_t offset = 0u;
+	for (/* nothing */; (typeIndex < endTypeIndex) && (offset + sizeof(CodeView::IPI::RecordHeader) <= chunkSize); ++typeIndex)
+	{
+		const CodeView::IPI::Record* record = reinterpret_cast<const CodeView::IPI::Record*>(chunk.data + offset);
+		chunk.records[typeIndex - firstTypeIndex] = record;
+
+		// position the offset at the next record
+		offset += sizeof(CodeView::IPI::RecordHeader) + GetCodeViewRecordSize(record);
 	}
 }
 
 
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
-PDB::IPIStream::~IPIStream(void) PDB_NO_EXCEPT
+PDB_NO_DISCARD const PDB::CodeView::IPI::Record* PDB::IPIStream::GetTypeRecord(uint32_t typeIndex) PDB_NO_EXCEPT
 {
-	PDB_DELETE_ARRAY(m_records);
+	if ((typeIndex < m_header.typeIndexBegin) || (typeIndex >= m_header.typeIndexEnd))
+	{
+		return nullptr;
+	}
+
+	if (m_mode == Mode::Eager)
+	{
+		return m_records[typeIndex - m_header.typeIndexBegin];
+	}
+
+	// find the last offset of a record with an index less than or equal to the one we're looking for
+	size_t first = 0u;
+	size_t count = m_typeIndexOffsetCount;
+	while (count != 0u)
+	{
+		const size_t step = count / 2u;
+		const size_t middle = first + step;
+		if (m_typeIndexOffsets[middle].typeIndex <= typeIndex)
+		{
+			first = middle + 1u;
+			count -= step + 1u;
+		}
+		else
+		{
+			count = step;
+		}
+	}
+
+	const size_t chunkIndex = (first == 0u) ? 0u : first - 1u;
+	if (!m_chunks[chunkIndex].records)
+	{
+		ResolveChunk(chunkIndex);
+	}
+
+	const uint32_t chunkTypeIndex = (chunkIndex == 0u) ? m_header.typeIndexBegin : m_typeIndexOffsets[chunkIndex].typeIndex;
+
+	return m_chunks[chunkIndex].records[typeIndex - chunkTypeIndex];
 }
 
 
@@ -132,9 +352,24 @@ PDB_NO_DISCARD PDB::ErrorCode PDB::HasValidIPIStream(const RawFile& file) PDB_NO
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB_NO_DISCARD PDB::IPIStream PDB::CreateIPIStream(const RawFile& file) PDB_NO_EXCEPT
+{
+	return IPIStream { file, ReadIPIStreamHeader(file) };
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::IPIStream PDB::CreateIPIStream(const RawFile& file, IPIStream::Mode mode) PDB_NO_EXCEPT
+{
+	return IPIStream { file, ReadIPIStreamHeader(file), mode };
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::IPI::StreamHeader PDB::ReadIPIStreamHeader(const RawFile& file) PDB_NO_EXCEPT
 {
 	DirectMSFStream stream = file.CreateMSFStream<DirectMSFStream>(IPIStreamIndex);
 
-	const IPI::StreamHeader header = stream.ReadAtOffset<IPI::StreamHeader>(0u);
-	return IPIStream { file, header };
+	return stream.ReadAtOffset<IPI::StreamHeader>(0u);
 }
@@ -8,6 +8,7 @@
 #include "PDB_ErrorCodes.h"
 #include "PDB_IPITypes.h"
 #include "PDB_CoalescedMSFStream.h"
+#include "PDB_DirectMSFStream.h"
 
 
 // PDB IPI stream
@@ -17,14 +18,43 @@ namespace PDB
 	class RawFile;
 
 
+	// In eager mode, the whole stream is coalesced and all records are indexed upon construction.
+	// in lazy mode, construction only reads the type index offsets from the hash stream. records are resolved on demand
+	// by walking the block of records between two offsets, which is cached for subsequent lookups.
 	class PDB_NO_DISCARD IPIStream
 	{
 	public:
+		enum class PDB_NO_DISCARD Mode : uint8_t
+		{
+			Eager,
+			Lazy
+		};
+
+		// the number of type index offsets making up one record segment, see the parallel constructor
+		static constexpr const size_t TypeIndexOffsetsPerSegment = 16u;
+
 		IPIStream(void) PDB_NO_EXCEPT;
 		IPIStream(IPIStream&& other) PDB_NO_EXCEPT;
 		IPIStream& operator=(IPIStream&& other) PDB_NO_EXCEPT;
 
 		explicit IPIStream(const RawFile& file, const IPI::StreamHeader& header) PDB_NO_EXCEPT;
+		explicit IPIStream(const RawFile& file, const IPI::StreamHeader& header, Mode mode) PDB_NO_EXCEPT;
+
+		// Walks the record segments of the stream concurrently. Segments start at the type index offsets stored in the hash stream.
+		// the given functor is called with a number of tasks and a task, and must call the task once for each index in [0, count),
+		// e.g. by distributing the calls across a thread pool. it must not return before all tasks have finished.
+		template <typename ParallelFor>
+		explicit IPIStream(const RawFile& file, const IPI::StreamHeader& header, ParallelFor&& parallelFor) PDB_NO_EXCEPT
+			: IPIStream()
+		{
+			Initialize(file, header);
+
+			parallelFor(GetRecordSegmentCount(), [this](size_t segmentIndex)
+			{
+				IndexSegment(segmentIndex);
+			});
+		}
+
 		~IPIStream(void) PDB_NO_EXCEPT;
 
 		// Returns the index of the first type, which is not necessarily zero.
@@ -39,18 +69,69 @@ namespace PDB
 			return m_header.typeIndexEnd;
 		}
 
-		// Returns a view of all type records.
+		// Returns a view of all type records. The view is empty in lazy mode, use GetTypeRecord() instead.
 		// Records identified by a type index can be accessed via "allRecords[typeIndex - firstTypeIndex]".
 		PDB_NO_DISCARD inline ArrayView<const CodeView::IPI::Record*> GetTypeRecords(void) const PDB_NO_EXCEPT
 		{
-			return ArrayView<const CodeView::IPI::Record*>(m_records, m_recordCount);
+			return ArrayView<const CodeView::IPI::Record*>(m_records, (m_mode == Mode::Eager) ? m_recordCount : 0u);
+		}
+
+		// Returns the record with the given type index, or nullptr if the index does not refer to a record in the IPI stream.
+		// in lazy mode, this resolves and caches the block of records containing the record, and must not be called
+		// concurrently.
+		PDB_NO_DISCARD const CodeView::IPI::Record* GetTypeRecord(uint32_t typeIndex) PDB_NO_EXCEPT;
+
+		// Returns the mode the stream was created with.
+		PDB_NO_DISCARD inline Mode GetMode(void) const PDB_NO_EXCEPT
+		{
+			return m_mode;
+		}
+
+		// Returns the type index offsets stored in the hash stream, sorted by type index.
+		PDB_NO_DISCARD inline ArrayView<IPI::TypeIndexOffset> GetTypeIndexOffsets(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<IPI::TypeIndexOffset>(m_typeIndexOffsets, m_typeIndexOffsetCount);
+		}
+
+		// Returns the number of record segments. Segments start at known record offsets, so they can be walked independently
+		// of each other.
+		PDB_NO_DISCARD inline size_t GetRecordSegmentCount(void) const PDB_NO_EXCEPT
+		{
+			return (m_typeIndexOffsetCount == 0u) ? 1u : (m_typeIndexOffsetCount + TypeIndexOffsetsPerSegment - 1u) / TypeIndexOffsetsPerSegment;
 		}
 
 	private:
+		// Coalesces the stream, reads the type index offsets and allocates the records.
+		void Initialize(const RawFile& file, const IPI::StreamHeader& header) PDB_NO_EXCEPT;
+
+		// Stores pointers to all records in the given segment.
+		void IndexSegment(size_t segmentIndex) PDB_NO_EXCEPT;
+
+		// Reads the type index offsets from the hash stream, if any.
+		void ReadTypeIndexOffsets(const RawFile& file) PDB_NO_EXCEPT;
+
+		// Walks the records between two type index offsets, used in lazy mode.
+		void ResolveChunk(size_t chunkIndex) PDB_NO_EXCEPT;
+
+		// a block of records between two type index offsets, resolved on demand in lazy mode
+		struct Chunk
+		{
+			const Byte* data;
+			Byte* ownedData;								// only allocated if the records are not stored contiguously in the file
+			const CodeView::IPI::Record** records;
+		};
+
 		IPI::StreamHeader m_header;
 		CoalescedMSFStream m_stream;
 		const CodeView::IPI::Record** m_records;
 		size_t m_recordCount;
+		IPI::TypeIndexOffset* m_typeIndexOffsets;
+		size_t m_typeIndexOffsetCount;
+		Mode m_mode;
+
+		DirectMSFStream m_directStream;
+		Chunk* m_chunks;
+		size_t m_chunkCount;
 
 		PDB_DISABLE_COPY(IPIStream);
 	};
@@ -63,4 +144,15 @@ namespace PDB
 	PDB_NO_DISCARD ErrorCode HasValidIPIStream(const RawFile& file) PDB_NO_EXCEPT;
 
 	PDB_NO_DISCARD IPIStream CreateIPIStream(const RawFile& file) PDB_NO_EXCEPT;
+	PDB_NO_DISCARD IPIStream CreateIPIStream(const RawFile& file, IPIStream::Mode mode) PDB_NO_EXCEPT;
+
+	// Reads the header of the IPI stream, which is needed for constructing an IPIStream directly.
+	PDB_NO_DISCARD IPI::StreamHeader ReadIPIStreamHeader(const RawFile& file) PDB_NO_EXCEPT;
+
+	// Creates the IPI stream, walking its record segments concurrently using the given parallel-for.
+	template <typename ParallelFor>
+	PDB_NO_DISCARD inline IPIStream CreateIPIStream(const RawFile& file, ParallelFor&& parallelFor) PDB_NO_EXCEPT
+	{
+		return IPIStream { file, ReadIPIStreamHeader(file), parallelFor };
+	}
 }
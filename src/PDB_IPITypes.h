@@ -38,6 +38,15 @@ namespace PDB
 			uint32_t hashAdjBufferOffset;
 			uint32_t hashAdjBufferLength;
 		};
+
+		// https://llvm.org/docs/PDB/TpiStream.html#type-index-offsets
+		// the hash stream stores the offset of every n-th type record (roughly every 8 KiB), allowing random access
+		// to records without walking the whole stream.
+		struct TypeIndexOffset
+		{
+			uint32_t typeIndex;
+			uint32_t offset;			// relative to the end of the IPI stream header
+		};
 	}
 
 
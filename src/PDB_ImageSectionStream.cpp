@@ -4,6 +4,20 @@
 #include "PDB_PCH.h"
 #include "PDB_ImageSectionStream.h"
 #include "PDB_RawFile.h"
+#include "Foundation/PDB_Memory.h"
+#include "Foundation/PDB_CRT.h"
+
+
+namespace
+{
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline uint32_t GetSectionSize(const PDB::IMAGE_SECTION_HEADER& header) PDB_NO_EXCEPT
+	{
+		// the virtual size can be zero in object files
+		return (header.Misc.VirtualSize != 0u) ? header.Misc.VirtualSize : header.SizeOfRawData;
+	}
+}
 
 
 // ------------------------------------------------------------------------------------------------
@@ -12,7 +26,50 @@ PDB::ImageSectionStream::ImageSectionStream(void) PDB_NO_EXCEPT
 	: m_stream()
 	, m_headers(nullptr)
 	, m_count(0u)
+	, m_virtualAddresses(nullptr)
+	, m_sortedSections(nullptr)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ImageSectionStream::ImageSectionStream(ImageSectionStream&& other) PDB_NO_EXCEPT
+	: m_stream(PDB_MOVE(other.m_stream))
+	, m_headers(PDB_MOVE(other.m_headers))
+	, m_count(PDB_MOVE(other.m_count))
+	, m_virtualAddresses(PDB_MOVE(other.m_virtualAddresses))
+	, m_sortedSections(PDB_MOVE(other.m_sortedSections))
+{
+	other.m_headers = nullptr;
+	other.m_count = 0u;
+	other.m_virtualAddresses = nullptr;
+	other.m_sortedSections = nullptr;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ImageSectionStream& PDB::ImageSectionStream::operator=(ImageSectionStream&& other) PDB_NO_EXCEPT
 {
+	if (this != &other)
+	{
+		PDB_DELETE_ARRAY(m_virtualAddresses);
+		PDB_DELETE_ARRAY(m_sortedSections);
+
+		m_stream = PDB_MOVE(other.m_stream);
+		m_headers = PDB_MOVE(other.m_headers);
+		m_count = PDB_MOVE(other.m_count);
+		m_virtualAddresses = PDB_MOVE(other.m_virtualAddresses);
+		m_sortedSections = PDB_MOVE(other.m_sortedSections);
+
+		other.m_headers = nullptr;
+		other.m_count = 0u;
+		other.m_virtualAddresses = nullptr;
+		other.m_sortedSections = nullptr;
+	}
+
+	return *this;
 }
 
 
@@ -22,7 +79,47 @@ PDB::ImageSectionStream::ImageSectionStream(const RawFile& file, uint16_t stream
 	: m_stream(file.CreateMSFStream<CoalescedMSFStream>(streamIndex))
 	, m_headers(m_stream.GetDataAtOffset<IMAGE_SECTION_HEADER>(0u))
 	, m_count(m_stream.GetSize() / sizeof(IMAGE_SECTION_HEADER))
+	, m_virtualAddresses(nullptr)
+	, m_sortedSections(nullptr)
+{
+	// section indices are 16-bit
+	if (m_count > 0xFFFFu)
+	{
+		m_count = 0xFFFFu;
+	}
+
+	m_virtualAddresses = PDB_NEW_ARRAY(uint32_t, m_count + 1u);
+	m_sortedSections = PDB_NEW_ARRAY(uint16_t, m_count);
+
+	m_virtualAddresses[0] = 0u;
+	for (size_t i = 0u; i < m_count; ++i)
+	{
+		m_virtualAddresses[i + 1u] = m_headers[i].VirtualAddress;
+	}
+
+	// sections are almost always sorted already, so an insertion sort is all that is needed
+	for (size_t i = 0u; i < m_count; ++i)
+	{
+		const uint16_t section = static_cast<uint16_t>(i + 1u);
+
+		size_t j = i;
+		while ((j != 0u) && (m_virtualAddresses[m_sortedSections[j - 1u]] > m_virtualAddresses[section]))
+		{
+			m_sortedSections[j] = m_sortedSections[j - 1u];
+			--j;
+		}
+
+		m_sortedSections[j] = section;
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::ImageSectionStream::~ImageSectionStream(void) PDB_NO_EXCEPT
 {
+	PDB_DELETE_ARRAY(m_virtualAddresses);
+	PDB_DELETE_ARRAY(m_sortedSections);
 }
 
 
@@ -45,3 +142,67 @@ PDB_NO_DISCARD uint32_t PDB::ImageSectionStream::ConvertSectionOffsetToRVA(uint1
 
 	return m_headers[oneBasedSectionIndex - 1u].VirtualAddress + offsetInSection;
 }
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::ImageSectionStream::ConvertSectionOffsetsToRVAs(const uint16_t* oneBasedSectionIndices, const uint32_t* offsetsInSection, size_t count, uint32_t* rvas) const PDB_NO_EXCEPT
+{
+	if (!m_virtualAddresses)
+	{
+		memset(rvas, 0, sizeof(uint32_t) * count);
+		return;
+	}
+
+	for (size_t i = 0u; i < count; ++i)
+	{
+		// section zero and sections beyond the last one wrap around to large values, and are redirected to index zero
+		const uint32_t zeroBasedIndex = static_cast<uint32_t>(oneBasedSectionIndices[i]) - 1u;
+		const bool isValid = (zeroBasedIndex < m_count);
+		const uint32_t index = isValid ? zeroBasedIndex + 1u : 0u;
+
+		// a mask instead of a branch zeroes the RVA of invalid sections
+		rvas[i] = (m_virtualAddresses[index] + offsetsInSection[i]) & (0u - static_cast<uint32_t>(isValid));
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD bool PDB::ImageSectionStream::ConvertRVAToSectionOffset(uint32_t rva, uint16_t& oneBasedSectionIndex, uint32_t& offsetInSection) const PDB_NO_EXCEPT
+{
+	// find the last section starting at or before the RVA
+	size_t first = 0u;
+	size_t count = m_count;
+	while (count != 0u)
+	{
+		const size_t step = count / 2u;
+		const size_t middle = first + step;
+		if (m_virtualAddresses[m_sortedSections[middle]] <= rva)
+		{
+			first = middle + 1u;
+			count -= step + 1u;
+		}
+		else
+		{
+			count = step;
+		}
+	}
+
+	if (first == 0u)
+	{
+		return false;
+	}
+
+	const uint16_t section = m_sortedSections[first - 1u];
+	const uint32_t offset = rva - m_virtualAddresses[section];
+	if (offset >= GetSectionSize(m_headers[section - 1u]))
+	{
+		return false;
+	}
+
+	oneBasedSectionIndex = section;
+	offsetInSection = offset;
+
+	return true;
+}
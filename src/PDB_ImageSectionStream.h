@@ -19,13 +19,22 @@ namespace PDB
 	{
 	public:
 		ImageSectionStream(void) PDB_NO_EXCEPT;
-		explicit ImageSectionStream(const RawFile& file, uint16_t streamIndex) PDB_NO_EXCEPT;
+		ImageSectionStream(ImageSectionStream&& other) PDB_NO_EXCEPT;
+		ImageSectionStream& operator=(ImageSectionStream&& other) PDB_NO_EXCEPT;
 
-		PDB_DEFAULT_MOVE(ImageSectionStream);
+		explicit ImageSectionStream(const RawFile& file, uint16_t streamIndex) PDB_NO_EXCEPT;
+		~ImageSectionStream(void) PDB_NO_EXCEPT;
 
 		// Converts a one-based section offset into an RVA.
 		PDB_NO_DISCARD uint32_t ConvertSectionOffsetToRVA(uint16_t oneBasedSectionIndex, uint32_t offsetInSection) const PDB_NO_EXCEPT;
 
+		// Converts many one-based section offsets into RVAs at once. Section offsets that cannot be converted yield an RVA of zero.
+		// the conversion uses a dense table of virtual addresses and no branches, so the compiler is free to vectorize it.
+		void ConvertSectionOffsetsToRVAs(const uint16_t* oneBasedSectionIndices, const uint32_t* offsetsInSection, size_t count, uint32_t* rvas) const PDB_NO_EXCEPT;
+
+		// Converts an RVA into a one-based section offset. Returns false if the RVA does not lie within any section.
+		PDB_NO_DISCARD bool ConvertRVAToSectionOffset(uint32_t rva, uint16_t& oneBasedSectionIndex, uint32_t& offsetInSection) const PDB_NO_EXCEPT;
+
 		// Returns a view of all the sections in the stream.
 		PDB_NO_DISCARD inline ArrayView<IMAGE_SECTION_HEADER> GetImageSections(void) const PDB_NO_EXCEPT
 		{
@@ -37,6 +46,12 @@ namespace PDB
 		const IMAGE_SECTION_HEADER* m_headers;
 		size_t m_count;
 
+		// the virtual address of each section, indexed by one-based section index. index zero is unused.
+		uint32_t* m_virtualAddresses;
+
+		// one-based section indices, sorted by virtual address
+		uint16_t* m_sortedSections;
+
 		PDB_DISABLE_COPY(ImageSectionStream);
 	};
 }
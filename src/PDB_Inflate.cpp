@@ -0,0 +1,490 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_Inflate.h"
+#include "PDB_DirectMSFStream.h"
+#include "Foundation/PDB_Memory.h"
+#include "Foundation/PDB_CRT.h"
+
+
+namespace
+{
+	static constexpr const uint32_t MaxCodeLength = 15u;
+	static constexpr const uint32_t MaxLiteralLengthCodes = 288u;
+	static constexpr const uint32_t MaxDistanceCodes = 30u;
+	static constexpr const uint32_t CodeLengthCodes = 19u;
+	static constexpr const uint32_t EndOfBlock = 256u;
+
+	static constexpr const uint16_t LengthBase[29u] = { 3u, 4u, 5u, 6u, 7u, 8u, 9u, 10u, 11u, 13u, 15u, 17u, 19u, 23u, 27u, 31u, 35u, 43u, 51u, 59u, 67u, 83u, 99u, 115u, 131u, 163u, 195u, 227u, 258u };
+	static constexpr const uint8_t LengthExtraBits[29u] = { 0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u, 1u, 1u, 1u, 1u, 2u, 2u, 2u, 2u, 3u, 3u, 3u, 3u, 4u, 4u, 4u, 4u, 5u, 5u, 5u, 5u, 0u };
+	static constexpr const uint16_t DistanceBase[30u] = { 1u, 2u, 3u, 4u, 5u, 7u, 9u, 13u, 17u, 25u, 33u, 49u, 65u, 97u, 129u, 193u, 257u, 385u, 513u, 769u, 1025u, 1537u, 2049u, 3073u, 4097u, 6145u, 8193u, 12289u, 16385u, 24577u };
+	static constexpr const uint8_t DistanceExtraBits[30u] = { 0u, 0u, 0u, 0u, 1u, 1u, 2u, 2u, 3u, 3u, 4u, 4u, 5u, 5u, 6u, 6u, 7u, 7u, 8u, 8u, 9u, 9u, 10u, 10u, 11u, 11u, 12u, 12u, 13u, 13u };
+
+	// the order in which the code lengths of the code length alphabet are stored
+	static constexpr const uint8_t CodeLengthOrder[CodeLengthCodes] = { 16u, 17u, 18u, 0u, 8u, 7u, 9u, 6u, 10u, 5u, 11u, 4u, 12u, 3u, 13u, 2u, 14u, 1u, 15u };
+
+
+	// a canonical Huffman code, stored as the number of codes of each length and the symbols ordered by their code
+	struct Huffman
+	{
+		uint16_t counts[MaxCodeLength + 1u];
+		uint16_t symbols[MaxLiteralLengthCodes];
+	};
+
+
+	// reads the compressed data bit by bit, fetching one block of the stream at a time
+	class BitReader
+	{
+	public:
+		explicit BitReader(const PDB::DirectMSFStream& stream, size_t offset) PDB_NO_EXCEPT
+			: m_stream(stream)
+			, m_offset(offset)
+			, m_data(nullptr)
+			, m_dataEnd(nullptr)
+			, m_bits(0u)
+			, m_bitCount(0u)
+			, m_isOverrun(false)
+		{
+		}
+
+		// Returns the next byte. Reading beyond the end of the stream yields zero and marks the reader as overrun.
+		PDB_NO_DISCARD PDB::Byte ReadByte(void) PDB_NO_EXCEPT
+		{
+			if ((m_data == m_dataEnd) && !FetchChunk())
+			{
+				m_isOverrun = true;
+				return static_cast<PDB::Byte>(0u);
+			}
+
+			return *m_data++;
+		}
+
+		// Returns the given number of bits, at most 16.
+		PDB_NO_DISCARD uint32_t ReadBits(uint32_t count) PDB_NO_EXCEPT
+		{
+			while (m_bitCount < count)
+			{
+				m_bits |= static_cast<uint32_t>(ReadByte()) << m_bitCount;
+				m_bitCount += 8u;
+			}
+
+			const uint32_t bits = m_bits & ((1u << count) - 1u);
+			m_bits >>= count;
+			m_bitCount -= count;
+
+			return bits;
+		}
+
+		// Discards the remaining bits of the current byte.
+		void AlignToByte(void) PDB_NO_EXCEPT
+		{
+			m_bits = 0u;
+			m_bitCount = 0u;
+		}
+
+		PDB_NO_DISCARD inline bool IsOverrun(void) const PDB_NO_EXCEPT
+		{
+			return m_isOverrun;
+		}
+
+	private:
+		PDB_NO_DISCARD bool FetchChunk(void) PDB_NO_EXCEPT
+		{
+			const size_t size = m_stream.GetSize();
+			if (m_offset >= size)
+			{
+				return false;
+			}
+
+			// a chunk never crosses a block boundary, so its data is always contiguous
+			const size_t blockSize = m_stream.GetBlockSize();
+			const size_t remainingInBlock = blockSize - (m_offset % blockSize);
+			const size_t chunkSize = (size - m_offset < remainingInBlock) ? size - m_offset : remainingInBlock;
+
+			m_data = static_cast<const PDB::Byte*>(m_stream.GetContiguousDataAtOffset(m_offset, chunkSize));
+			m_dataEnd = m_data + chunkSize;
+			m_offset += chunkSize;
+
+			return true;
+		}
+
+		const PDB::DirectMSFStream& m_stream;
+		size_t m_offset;
+		const PDB::Byte* m_data;
+		const PDB::Byte* m_dataEnd;
+		uint32_t m_bits;
+		uint32_t m_bitCount;
+		bool m_isOverrun;
+
+		PDB_DISABLE_COPY(BitReader);
+	};
+
+
+	// stores the last WindowSize bytes of decompressed data for resolving back references, and hands out the data whenever the
+	// window is full
+	class Window
+	{
+	public:
+		explicit Window(PDB::Inflate::ChunkFunction function, void* userData) PDB_NO_EXCEPT
+			: m_data(PDB_NEW_ARRAY(PDB::Byte, PDB::Inflate::WindowSize))
+			, m_position(0u)
+			, m_totalSize(0u)
+			, m_function(function)
+			, m_userData(userData)
+		{
+		}
+
+		~Window(void) PDB_NO_EXCEPT
+		{
+			PDB_DELETE_ARRAY(m_data);
+		}
+
+		void Put(PDB::Byte byte) PDB_NO_EXCEPT
+		{
+			m_data[m_position] = byte;
+			++m_position;
+			++m_totalSize;
+
+			if (m_position == PDB::Inflate::WindowSize)
+			{
+				Flush();
+			}
+		}
+
+		// Copies bytes from the given distance back. Returns false if the distance reaches beyond the start of the data.
+		PDB_NO_DISCARD bool Copy(uint32_t distance, uint32_t length) PDB_NO_EXCEPT
+		{
+			if (distance > m_totalSize)
+			{
+				return false;
+			}
+
+			// the window is used as a ring buffer, whose contents stay intact when it is handed out
+			for (uint32_t i = 0u; i < length; ++i)
+			{
+				Put(m_data[(m_position + PDB::Inflate::WindowSize - distance) % PDB::Inflate::WindowSize]);
+			}
+
+			return true;
+		}
+
+		// Hands out all data that has not been handed out yet.
+		void Flush(void) PDB_NO_EXCEPT
+		{
+			if (m_position != 0u)
+			{
+				m_function(PDB::ArrayView<PDB::Byte>(m_data, m_position), m_userData);
+				m_position = 0u;
+			}
+		}
+
+	private:
+		PDB::Byte* m_data;
+		size_t m_position;
+		size_t m_totalSize;
+		PDB::Inflate::ChunkFunction m_function;
+		void* m_userData;
+
+		PDB_DISABLE_COPY(Window);
+	};
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static bool BuildHuffman(Huffman& huffman, const uint8_t* lengths, uint32_t count) PDB_NO_EXCEPT
+	{
+		memset(huffman.counts, 0, sizeof(huffman.counts));
+		for (uint32_t symbol = 0u; symbol < count; ++symbol)
+		{
+			++huffman.counts[lengths[symbol]];
+		}
+
+		// a code using more codes than available is invalid. incomplete codes are allowed, their unused codes fail to decode.
+		int32_t left = 1;
+		for (uint32_t length = 1u; length <= MaxCodeLength; ++length)
+		{
+			left = left * 2 - static_cast<int32_t>(huffman.counts[length]);
+			if (left < 0)
+			{
+				return false;
+			}
+		}
+
+		uint16_t offsets[MaxCodeLength + 1u];
+		offsets[1u] = 0u;
+		for (uint32_t length = 1u; length < MaxCodeLength; ++length)
+		{
+			offsets[length + 1u] = static_cast<uint16_t>(offsets[length] + huffman.counts[length]);
+		}
+
+		for (uint32_t symbol = 0u; symbol < count; ++symbol)
+		{
+			if (lengths[symbol] != 0u)
+			{
+				huffman.symbols[offsets[lengths[symbol]]] = static_cast<uint16_t>(symbol);
+				++offsets[lengths[symbol]];
+			}
+		}
+
+		return true;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static int32_t DecodeSymbol(BitReader& reader, const Huffman& huffman) PDB_NO_EXCEPT
+	{
+		// codes are stored starting with their most significant bit, so they are decoded one bit at a time
+		int32_t code = 0;
+		int32_t first = 0;
+		int32_t index = 0;
+		for (uint32_t length = 1u; length <= MaxCodeLength; ++length)
+		{
+			code |= static_cast<int32_t>(reader.ReadBits(1u));
+
+			const int32_t count = huffman.counts[length];
+			if (code - first < count)
+			{
+				return huffman.symbols[index + code - first];
+			}
+
+			index += count;
+			first = (first + count) << 1;
+			code <<= 1;
+		}
+
+		return -1;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static bool DecodeCodes(BitReader& reader, Window& window, const Huffman& literalLengthCode, const Huffman& distanceCode) PDB_NO_EXCEPT
+	{
+		for (;;)
+		{
+			const int32_t symbol = DecodeSymbol(reader, literalLengthCode);
+			if ((symbol < 0) || reader.IsOverrun())
+			{
+				return false;
+			}
+
+			if (symbol < static_cast<int32_t>(EndOfBlock))
+			{
+				window.Put(static_cast<PDB::Byte>(symbol));
+				continue;
+			}
+
+			if (symbol == static_cast<int32_t>(EndOfBlock))
+			{
+				return true;
+			}
+
+			const uint32_t lengthIndex = static_cast<uint32_t>(symbol) - EndOfBlock - 1u;
+			if (lengthIndex >= sizeof(LengthBase) / sizeof(LengthBase[0u]))
+			{
+				return false;
+			}
+
+			const uint32_t length = LengthBase[lengthIndex] + reader.ReadBits(LengthExtraBits[lengthIndex]);
+
+			const int32_t distanceIndex = DecodeSymbol(reader, distanceCode);
+			if ((distanceIndex < 0) || (distanceIndex >= static_cast<int32_t>(MaxDistanceCodes)))
+			{
+				return false;
+			}
+
+			const uint32_t distance = DistanceBase[distanceIndex] + reader.ReadBits(DistanceExtraBits[distanceIndex]);
+			if (!window.Copy(distance, length))
+			{
+				return false;
+			}
+		}
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static bool DecodeStoredBlock(BitReader& reader, Window& window) PDB_NO_EXCEPT
+	{
+		reader.AlignToByte();
+
+		const uint32_t length = reader.ReadBits(16u);
+		const uint32_t complement = reader.ReadBits(16u);
+		if (length != (~complement & 0xFFFFu))
+		{
+			return false;
+		}
+
+		for (uint32_t i = 0u; i < length; ++i)
+		{
+			window.Put(reader.ReadByte());
+		}
+
+		return !reader.IsOverrun();
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static bool DecodeFixedBlock(BitReader& reader, Window& window) PDB_NO_EXCEPT
+	{
+		uint8_t lengths[MaxLiteralLengthCodes];
+		memset(lengths, 8, 144u);
+		memset(lengths + 144u, 9, 256u - 144u);
+		memset(lengths + 256u, 7, 280u - 256u);
+		memset(lengths + 280u, 8, MaxLiteralLengthCodes - 280u);
+
+		Huffman literalLengthCode;
+		Huffman distanceCode;
+		if (!BuildHuffman(literalLengthCode, lengths, MaxLiteralLengthCodes))
+		{
+			return false;
+		}
+
+		memset(lengths, 5, MaxDistanceCodes);
+		if (!BuildHuffman(distanceCode, lengths, MaxDistanceCodes))
+		{
+			return false;
+		}
+
+		return DecodeCodes(reader, window, literalLengthCode, distanceCode);
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static bool DecodeDynamicBlock(BitReader& reader, Window& window) PDB_NO_EXCEPT
+	{
+		const uint32_t literalLengthCount = reader.ReadBits(5u) + 257u;
+		const uint32_t distanceCount = reader.ReadBits(5u) + 1u;
+		const uint32_t codeLengthCount = reader.ReadBits(4u) + 4u;
+		if ((literalLengthCount > 286u) || (distanceCount > MaxDistanceCodes))
+		{
+			return false;
+		}
+
+		// the code lengths of both codes are themselves Huffman-coded
+		uint8_t lengths[MaxLiteralLengthCodes + MaxDistanceCodes] = {};
+		for (uint32_t i = 0u; i < codeLengthCount; ++i)
+		{
+			lengths[CodeLengthOrder[i]] = static_cast<uint8_t>(reader.ReadBits(3u));
+		}
+
+		Huffman codeLengthCode;
+		if (!BuildHuffman(codeLengthCode, lengths, CodeLengthCodes))
+		{
+			return false;
+		}
+
+		const uint32_t totalCount = literalLengthCount + distanceCount;
+		uint32_t index = 0u;
+		while (index < totalCount)
+		{
+			const int32_t symbol = DecodeSymbol(reader, codeLengthCode);
+			if ((symbol < 0) || reader.IsOverrun())
+			{
+				return false;
+			}
+
+			if (symbol < 16)
+			{
+				lengths[index] = static_cast<uint8_t>(symbol);
+				++index;
+				continue;
+			}
+
+			// symbols 16 to 18 repeat the previous length or zero
+			uint8_t length = 0u;
+			uint32_t repeatCount = 0u;
+			if (symbol == 16)
+			{
+				if (index == 0u)
+				{
+					return false;
+				}
+
+				length = lengths[index - 1u];
+				repeatCount = 3u + reader.ReadBits(2u);
+			}
+			else if (symbol == 17)
+			{
+				repeatCount = 3u + reader.ReadBits(3u);
+			}
+			else
+			{
+				repeatCount = 11u + reader.ReadBits(7u);
+			}
+
+			if (index + repeatCount > totalCount)
+			{
+				return false;
+			}
+
+			for (uint32_t i = 0u; i < repeatCount; ++i)
+			{
+				lengths[index] = length;
+				++index;
+			}
+		}
+
+		// a block without an end-of-block code cannot be terminated
+		if (lengths[EndOfBlock] == 0u)
+		{
+			return false;
+		}
+
+		Huffman literalLengthCode;
+		Huffman distanceCode;
+		if (!BuildHuffman(literalLengthCode, lengths, literalLengthCount) || !BuildHuffman(distanceCode, lengths + literalLengthCount, distanceCount))
+		{
+			return false;
+		}
+
+		return DecodeCodes(reader, window, literalLengthCode, distanceCode);
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::ErrorCode PDB::Inflate::Decompress(const DirectMSFStream& stream, size_t offset, ChunkFunction function, void* userData) PDB_NO_EXCEPT
+{
+	BitReader reader(stream, offset);
+	Window window(function, userData);
+
+	bool isLastBlock = false;
+	while (!isLastBlock)
+	{
+		isLastBlock = (reader.ReadBits(1u) != 0u);
+
+		bool isValid = false;
+		switch (reader.ReadBits(2u))
+		{
+			case 0u:
+				isValid = DecodeStoredBlock(reader, window);
+				break;
+
+			case 1u:
+				isValid = DecodeFixedBlock(reader, window);
+				break;
+
+			case 2u:
+				isValid = DecodeDynamicBlock(reader, window);
+				break;
+
+			default:
+				break;
+		}
+
+		if (!isValid || reader.IsOverrun())
+		{
+			return ErrorCode::InvalidCompressedData;
+		}
+	}
+
+	window.Flush();
+
+	return ErrorCode::Success;
+}
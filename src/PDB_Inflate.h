@@ -0,0 +1,31 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_ArrayView.h"
+#include "PDB_ErrorCodes.h"
+#include "PDB_Types.h"
+
+
+// https://www.rfc-editor.org/rfc/rfc1951
+namespace PDB
+{
+	class DirectMSFStream;
+
+	namespace Inflate
+	{
+		// the maximum distance of a back reference, which is also the maximum size of a decompressed chunk
+		static constexpr const size_t WindowSize = 32768u;
+
+		// Receives a chunk of decompressed data.
+		using ChunkFunction = void (*)(ArrayView<Byte> chunk, void* userData);
+
+		// Decompresses the raw DEFLATE data stored in a stream from the given offset on, and calls the function for each
+		// chunk of decompressed data. the compressed data is read block by block, so the stream does not need to be contiguous.
+		// Returns ErrorCode::InvalidCompressedData if the data is malformed or truncated, in which case the chunks handed out
+		// so far only hold part of the data.
+		PDB_NO_DISCARD ErrorCode Decompress(const DirectMSFStream& stream, size_t offset, ChunkFunction function, void* userData) PDB_NO_EXCEPT;
+	}
+}
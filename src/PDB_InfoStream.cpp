@@ -4,12 +4,49 @@
 #include "PDB_PCH.h"
 #include "PDB_InfoStream.h"
 #include "PDB_RawFile.h"
+#include "Foundation/PDB_BitUtil.h"
+#include "Foundation/PDB_Hash.h"
 #include "Foundation/PDB_CRT.h"
 
 namespace
 {
 	// the PDB info stream always resides at index 1
 	static constexpr const uint32_t InfoStreamIndex = 1u;
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static bool IsBitSet(const PDB::SerializedHashTable::BitVector* bitVector, uint32_t bit) PDB_NO_EXCEPT
+	{
+		const uint32_t word = bit / 32u;
+		if (word >= bitVector->wordCount)
+		{
+			return false;
+		}
+
+		return (bitVector->words[word] & (1u << (bit % 32u))) != 0u;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static uint32_t CountBitsBefore(const PDB::SerializedHashTable::BitVector* bitVector, uint32_t bit) PDB_NO_EXCEPT
+	{
+		const uint32_t word = bit / 32u;
+
+		uint32_t count = 0u;
+		for (uint32_t i = 0u; (i < word) && (i < bitVector->wordCount); ++i)
+		{
+			count += PDB::BitUtil::CountSetBits(bitVector->words[i]);
+		}
+
+		if (word < bitVector->wordCount)
+		{
+			count += PDB::BitUtil::CountSetBits(bitVector->words[word] & ((1u << (bit % 32u)) - 1u));
+		}
+
+		return count;
+	}
 }
 
 
@@ -18,6 +55,11 @@ namespace
 PDB::InfoStream::InfoStream(void) PDB_NO_EXCEPT
 	: m_stream()
 	, m_header(nullptr)
+	, m_namedStreamMap(nullptr)
+	, m_hashTableHeader(nullptr)
+	, m_presentBitVector(nullptr)
+	, m_deletedBitVector(nullptr)
+	, m_namedStreamEntries(nullptr)
 	, m_namesStreamIndex(0)
 	, m_usesDebugFastlink(false)
 	, m_hasIPIStream(false)
@@ -38,17 +80,17 @@ PDB::InfoStream::InfoStream(const RawFile& file) PDB_NO_EXCEPT
 	// https://llvm.org/docs/PDB/PdbStream.html#named-stream-map
 	size_t streamOffset = sizeof(Header);
 
-	const NamedStreamMap* namedStreamMap = m_stream.GetDataAtOffset<const NamedStreamMap>(streamOffset);
-	streamOffset += sizeof(NamedStreamMap) + namedStreamMap->length;
+	m_namedStreamMap = m_stream.GetDataAtOffset<const NamedStreamMap>(streamOffset);
+	streamOffset += sizeof(NamedStreamMap) + m_namedStreamMap->length;
 
-	const SerializedHashTable::Header* hashTableHeader = m_stream.GetDataAtOffset<const SerializedHashTable::Header>(streamOffset);
+	m_hashTableHeader = m_stream.GetDataAtOffset<const SerializedHashTable::Header>(streamOffset);
 	streamOffset += sizeof(SerializedHashTable::Header);
 
-	const SerializedHashTable::BitVector* presentBitVector = m_stream.GetDataAtOffset<const SerializedHashTable::BitVector>(streamOffset);
-	streamOffset += sizeof(SerializedHashTable::BitVector) + sizeof(uint32_t) * presentBitVector->wordCount;
+	m_presentBitVector = m_stream.GetDataAtOffset<const SerializedHashTable::BitVector>(streamOffset);
+	streamOffset += sizeof(SerializedHashTable::BitVector) + sizeof(uint32_t) * m_presentBitVector->wordCount;
 
-	const SerializedHashTable::BitVector* deletedBitVector = m_stream.GetDataAtOffset<const SerializedHashTable::BitVector>(streamOffset);
-	streamOffset += sizeof(SerializedHashTable::BitVector) + sizeof(uint32_t) * deletedBitVector->wordCount;
+	m_deletedBitVector = m_stream.GetDataAtOffset<const SerializedHashTable::BitVector>(streamOffset);
+	streamOffset += sizeof(SerializedHashTable::BitVector) + sizeof(uint32_t) * m_deletedBitVector->wordCount;
 
 	// the hash table entries can be used to identify the indices of certain common streams like:
 	//	"/UDTSRCLINEUNDONE"
@@ -56,22 +98,12 @@ PDB::InfoStream::InfoStream(const RawFile& file) PDB_NO_EXCEPT
 	//	"/LinkInfo"
 	//	"/TMCache"
 	//	"/names"
+	m_namedStreamEntries = m_stream.GetDataAtOffset<const NamedStreamMap::HashTableEntry>(streamOffset);
 
-	const NamedStreamMap::HashTableEntry* namedStreamMapHashEntries = m_stream.GetDataAtOffset<const NamedStreamMap::HashTableEntry>(streamOffset);
-
-	// Find "/names" stream, used to look up filenames for lines.
-	for (uint32_t i = 0, size = hashTableHeader->size; i < size; ++i)
-	{
-		const NamedStreamMap::HashTableEntry& entry = namedStreamMapHashEntries[i];
-		const char* streamName = &namedStreamMap->stringTable[entry.stringTableOffset];
-
-		if (strcmp("/names", streamName) == 0)
-		{
-			m_namesStreamIndex = entry.streamIndex;
-		}
-	}
+	// find "/names" stream, used to look up filenames for lines
+	m_namesStreamIndex = FindNamedStream("/names");
 
-	streamOffset += sizeof(NamedStreamMap::HashTableEntry) * hashTableHeader->size;
+	streamOffset += sizeof(NamedStreamMap::HashTableEntry) * m_hashTableHeader->size;
 
 	// read feature codes by consuming remaining bytes
 	// https://llvm.org/docs/PDB/PdbStream.html#pdb-feature-codes
@@ -100,3 +132,42 @@ PDB::NamesStream PDB::InfoStream::CreateNamesStream(const RawFile& file) const P
 {
 	return NamesStream(file, m_namesStreamIndex);
 }
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::InfoStream::FindNamedStream(const char* name) const PDB_NO_EXCEPT
+{
+	const uint32_t capacity = m_hashTableHeader ? m_hashTableHeader->capacity : 0u;
+	if (capacity == 0u)
+	{
+		return 0u;
+	}
+
+	// the named stream map hashes names with the lower 16 bits of hash version 1, and resolves collisions by linear probing.
+	// only present buckets are serialized, so the entry of a bucket is found by counting the present buckets before it.
+	// https://llvm.org/docs/PDB/HashTable.html
+	const uint32_t hash = static_cast<uint16_t>(Hash::HashStringV1(name, strlen(name)));
+
+	uint32_t bucket = hash % capacity;
+	for (uint32_t i = 0u; i < capacity; ++i)
+	{
+		if (IsBitSet(m_presentBitVector, bucket))
+		{
+			const NamedStreamMap::HashTableEntry& entry = m_namedStreamEntries[CountBitsBefore(m_presentBitVector, bucket)];
+			if (strcmp(name, GetNamedStreamName(entry)) == 0)
+			{
+				return entry.streamIndex;
+			}
+		}
+		else if (!IsBitSet(m_deletedBitVector, bucket))
+		{
+			// an empty bucket ends the probe sequence
+			return 0u;
+		}
+
+		bucket = (bucket + 1u == capacity) ? 0u : bucket + 1u;
+	}
+
+	return 0u;
+}
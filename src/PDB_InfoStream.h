@@ -4,6 +4,7 @@
 #pragma once
 
 #include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_ArrayView.h"
 #include "PDB_Types.h"
 #include "PDB_CoalescedMSFStream.h"
 #include "PDB_NamesStream.h"
@@ -50,9 +51,33 @@ namespace PDB
 		// Create names stream
 		PDB_NO_DISCARD NamesStream CreateNamesStream(const RawFile& file) const PDB_NO_EXCEPT;
 
+		// Returns the index of the stream with the given name, e.g. "/LinkInfo" or "/src/headerblock", or zero if no such stream exists.
+		// the stream is looked up using the serialized hash table of the named stream map.
+		PDB_NO_DISCARD uint32_t FindNamedStream(const char* name) const PDB_NO_EXCEPT;
+
+		// Returns all entries of the named stream map, in bucket order.
+		PDB_NO_DISCARD inline ArrayView<NamedStreamMap::HashTableEntry> GetNamedStreams(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<NamedStreamMap::HashTableEntry>(m_namedStreamEntries, m_hashTableHeader ? m_hashTableHeader->size : 0u);
+		}
+
+		// Returns the name of an entry of the named stream map.
+		PDB_NO_DISCARD inline const char* GetNamedStreamName(const NamedStreamMap::HashTableEntry& entry) const PDB_NO_EXCEPT
+		{
+			return &m_namedStreamMap->stringTable[entry.stringTableOffset];
+		}
+
 	private:
 		CoalescedMSFStream m_stream;
 		const Header* m_header;
+
+		// the named stream map and its serialized hash table, pointing into the stream
+		const NamedStreamMap* m_namedStreamMap;
+		const SerializedHashTable::Header* m_hashTableHeader;
+		const SerializedHashTable::BitVector* m_presentBitVector;
+		const SerializedHashTable::BitVector* m_deletedBitVector;
+		const NamedStreamMap::HashTableEntry* m_namedStreamEntries;
+
 		uint32_t m_namesStreamIndex;
 		bool m_usesDebugFastlink;
 		bool m_hasIPIStream;
@@ -0,0 +1,617 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_LineIndex.h"
+#include "PDB_RawFile.h"
+#include "PDB_ModuleInfoStream.h"
+#include "PDB_ImageSectionStream.h"
+#include "Foundation/PDB_PointerUtil.h"
+#include "Foundation/PDB_RadixSort.h"
+#include "Foundation/PDB_Memory.h"
+#include "Foundation/PDB_CRT.h"
+
+
+namespace
+{
+	using RawLine = PDB::LineIndex::Line;
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline uint32_t ZigZagEncode(uint32_t delta) PDB_NO_EXCEPT
+	{
+		// maps small negative and positive deltas to small unsigned values
+		return (delta << 1u) ^ (0u - (delta >> 31u));
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline uint32_t ZigZagDecode(uint32_t value) PDB_NO_EXCEPT
+	{
+		return (value >> 1u) ^ (0u - (value & 1u));
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline size_t GetVarintSize(uint32_t value) PDB_NO_EXCEPT
+	{
+		size_t size = 1u;
+		while (value >= 0x80u)
+		{
+			value >>= 7u;
+			++size;
+		}
+
+		return size;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline PDB::Byte* WriteVarint(PDB::Byte* data, uint32_t value) PDB_NO_EXCEPT
+	{
+		while (value >= 0x80u)
+		{
+			*data++ = static_cast<PDB::Byte>((value & 0x7Fu) | 0x80u);
+			value >>= 7u;
+		}
+
+		*data++ = static_cast<PDB::Byte>(value);
+
+		return data;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline const PDB::Byte* ReadVarint(const PDB::Byte* data, uint32_t& value) PDB_NO_EXCEPT
+	{
+		uint32_t result = 0u;
+		uint32_t shift = 0u;
+		for (;;)
+		{
+			const uint32_t byte = static_cast<uint32_t>(*data++);
+			result |= (byte & 0x7Fu) << shift;
+			if ((byte & 0x80u) == 0u)
+			{
+				break;
+			}
+
+			shift += 7u;
+		}
+
+		value = result;
+
+		return data;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline size_t GetEncodedLineSize(const RawLine& line, const RawLine& previous) PDB_NO_EXCEPT
+	{
+		return GetVarintSize(line.rva - previous.rva)
+			+ GetVarintSize(line.codeSize)
+			+ GetVarintSize(ZigZagEncode(line.lineNumber - previous.lineNumber))
+			+ GetVarintSize(line.column)
+			+ GetVarintSize(ZigZagEncode(line.filenameOffset - previous.filenameOffset));
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline PDB::Byte* EncodeLine(PDB::Byte* data, const RawLine& line, const RawLine& previous) PDB_NO_EXCEPT
+	{
+		data = WriteVarint(data, line.rva - previous.rva);
+		data = WriteVarint(data, line.codeSize);
+		data = WriteVarint(data, ZigZagEncode(line.lineNumber - previous.lineNumber));
+		data = WriteVarint(data, line.column);
+		data = WriteVarint(data, ZigZagEncode(line.filenameOffset - previous.filenameOffset));
+
+		return data;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	static void GrowLines(RawLine*& lines, size_t count, size_t& capacity, size_t requiredCapacity) PDB_NO_EXCEPT
+	{
+		if (requiredCapacity <= capacity)
+		{
+			return;
+		}
+
+		// grow geometrically to keep the number of copies low
+		size_t newCapacity = (capacity < 1024u) ? 1024u : capacity * 2u;
+		while (newCapacity < requiredCapacity)
+		{
+			newCapacity *= 2u;
+		}
+
+		RawLine* newLines = PDB_NEW_ARRAY(RawLine, newCapacity);
+		if (count != 0u)
+		{
+			memcpy(newLines, lines, sizeof(RawLine) * count);
+		}
+
+		PDB_DELETE_ARRAY(lines);
+		lines = newLines;
+		capacity = newCapacity;
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::LineIndex::LineIndex(void) PDB_NO_EXCEPT
+	: m_blockRVAs(nullptr)
+	, m_blockOffsets(nullptr)
+	, m_blockCount(0u)
+	, m_data(nullptr)
+	, m_dataSize(0u)
+	, m_lineCount(0u)
+	, m_ownsLines(true)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::LineIndex::LineIndex(LineIndex&& other) PDB_NO_EXCEPT
+	: m_blockRVAs(PDB_MOVE(other.m_blockRVAs))
+	, m_blockOffsets(PDB_MOVE(other.m_blockOffsets))
+	, m_blockCount(PDB_MOVE(other.m_blockCount))
+	, m_data(PDB_MOVE(other.m_data))
+	, m_dataSize(PDB_MOVE(other.m_dataSize))
+	, m_lineCount(PDB_MOVE(other.m_lineCount))
+	, m_ownsLines(PDB_MOVE(other.m_ownsLines))
+{
+	other.m_blockRVAs = nullptr;
+	other.m_blockOffsets = nullptr;
+	other.m_blockCount = 0u;
+	other.m_data = nullptr;
+	other.m_dataSize = 0u;
+	other.m_lineCount = 0u;
+	other.m_ownsLines = true;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::LineIndex& PDB::LineIndex::operator=(LineIndex&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		if (m_ownsLines)
+		{
+			PDB_DELETE_ARRAY(m_blockRVAs);
+			PDB_DELETE_ARRAY(m_blockOffsets);
+			PDB_DELETE_ARRAY(m_data);
+		}
+
+		m_blockRVAs = PDB_MOVE(other.m_blockRVAs);
+		m_blockOffsets = PDB_MOVE(other.m_blockOffsets);
+		m_blockCount = PDB_MOVE(other.m_blockCount);
+		m_data = PDB_MOVE(other.m_data);
+		m_dataSize = PDB_MOVE(other.m_dataSize);
+		m_lineCount = PDB_MOVE(other.m_lineCount);
+		m_ownsLines = PDB_MOVE(other.m_ownsLines);
+
+		other.m_blockRVAs = nullptr;
+		other.m_blockOffsets = nullptr;
+		other.m_blockCount = 0u;
+		other.m_data = nullptr;
+		other.m_dataSize = 0u;
+		other.m_lineCount = 0u;
+		other.m_ownsLines = true;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::LineIndex::LineIndex(const RawFile& file, const ModuleInfoStream& moduleInfoStream, const ImageSectionStream& imageSectionStream) PDB_NO_EXCEPT
+	: m_blockRVAs(nullptr)
+	, m_blockOffsets(nullptr)
+	, m_blockCount(0u)
+	, m_data(nullptr)
+	, m_dataSize(0u)
+	, m_lineCount(0u)
+	, m_ownsLines(true)
+{
+	// gather the lines of all modules first. they are neither sorted across modules nor across sections, so they
+	// are stored unordered and sorted by RVA afterwards.
+	RawLine* lines = nullptr;
+	size_t lineCount = 0u;
+	size_t lineCapacity = 0u;
+
+	for (const ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+	{
+		if (!module.HasLineStream())
+		{
+			continue;
+		}
+
+		const ModuleLineStream lineStream = module.CreateLineStream(file);
+
+		// lines refer to their file by an offset into the module's S_FILECHECKSUMS section, which can be stored
+		// after the S_LINES sections. find the checksums and count the lines in one go.
+		const CodeView::DBI::FileChecksumHeader* checksums = nullptr;
+		size_t moduleLineCount = 0u;
+		lineStream.ForEachSection([&lineStream, &checksums, &moduleLineCount](const CodeView::DBI::LineSection* section)
+		{
+			if (section->header.kind == CodeView::DBI::DebugSubsectionKind::S_FILECHECKSUMS)
+			{
+				checksums = &section->checksumHeader;
+			}
+			else if (section->header.kind == CodeView::DBI::DebugSubsectionKind::S_LINES)
+			{
+				lineStream.ForEachLinesBlock(section, [&moduleLineCount](const CodeView::DBI::LinesFileBlockHeader* linesBlockHeader, const CodeView::DBI::Line*, const CodeView::DBI::Column*)
+				{
+					moduleLineCount += linesBlockHeader->numLines;
+				});
+			}
+		});
+
+		if (moduleLineCount == 0u || checksums == nullptr)
+		{
+			continue;
+		}
+
+		GrowLines(lines, lineCount, lineCapacity, lineCount + moduleLineCount);
+
+		lineStream.ForEachSection([&lineStream, &imageSectionStream, checksums, lines, &lineCount](const CodeView::DBI::LineSection* section)
+		{
+			if (section->header.kind != CodeView::DBI::DebugSubsectionKind::S_LINES)
+			{
+				return;
+			}
+
+			const CodeView::DBI::LinesHeader& linesHeader = section->linesHeader;
+			const bool hasColumns = (linesHeader.flags.fHasColumns != 0u);
+
+			lineStream.ForEachLinesBlock(section, [&imageSectionStream, &linesHeader, hasColumns, checksums, lines, &lineCount](const CodeView::DBI::LinesFileBlockHeader* linesBlockHeader, const CodeView::DBI::Line* blockLines, const CodeView::DBI::Column* blockColumns)
+			{
+				const uint32_t numLines = linesBlockHeader->numLines;
+				if (numLines == 0u)
+				{
+					return;
+				}
+
+				const CodeView::DBI::FileChecksumHeader* checksumHeader = Pointer::Offset<const CodeView::DBI::FileChecksumHeader*>(checksums, linesBlockHeader->fileChecksumOffset);
+				const uint32_t filenameOffset = checksumHeader->filenameOffset;
+
+				for (uint32_t i = 0u; i < numLines; ++i)
+				{
+					const CodeView::DBI::Line& line = blockLines[i];
+
+					const uint32_t rva = imageSectionStream.ConvertSectionOffsetToRVA(linesHeader.sectionIndex, linesHeader.sectionOffset + line.offset);
+					if (rva == 0u)
+					{
+						// the line belongs to a section that is not part of the image
+						continue;
+					}
+
+					// the last line of a block extends to the end of the code described by the section.
+					// this is clamped against the next line once all lines are sorted.
+					const uint32_t nextOffset = (i + 1u < numLines) ? blockLines[i + 1u].offset : linesHeader.codeSize;
+
+					RawLine& rawLine = lines[lineCount];
+					rawLine.rva = rva;
+					rawLine.codeSize = (nextOffset > line.offset) ? (nextOffset - line.offset) : 0u;
+					rawLine.lineNumber = line.linenumStart;
+					rawLine.filenameOffset = filenameOffset;
+					rawLine.column = (hasColumns && blockColumns) ? blockColumns[i].start : static_cast<uint16_t>(0u);
+					++lineCount;
+				}
+			});
+		});
+	}
+
+	if (lineCount == 0u)
+	{
+		PDB_DELETE_ARRAY(lines);
+		return;
+	}
+
+	// sort all lines by RVA
+	uint32_t* rvas = PDB_NEW_ARRAY(uint32_t, lineCount);
+	uint32_t* order = PDB_NEW_ARRAY(uint32_t, lineCount);
+	{
+		uint32_t* scratch = PDB_NEW_ARRAY(uint32_t, lineCount);
+		for (size_t i = 0u; i < lineCount; ++i)
+		{
+			rvas[i] = lines[i].rva;
+			order[i] = static_cast<uint32_t>(i);
+		}
+
+		RadixSort::SortIndices(rvas, order, scratch, lineCount);
+
+		PDB_DELETE_ARRAY(scratch);
+		PDB_DELETE_ARRAY(rvas);
+	}
+
+	// clamp the code size of each line against the next line with a higher RVA
+	for (size_t i = 0u; i + 1u < lineCount; ++i)
+	{
+		RawLine& line = lines[order[i]];
+		const uint32_t nextRVA = lines[order[i + 1u]].rva;
+		if ((nextRVA > line.rva) && (line.codeSize > nextRVA - line.rva))
+		{
+			line.codeSize = nextRVA - line.rva;
+		}
+	}
+
+	// bring the lines into address order before encoding them
+	RawLine* sortedLines = PDB_NEW_ARRAY(RawLine, lineCount);
+	for (size_t i = 0u; i < lineCount; ++i)
+	{
+		sortedLines[i] = lines[order[i]];
+	}
+
+	PDB_DELETE_ARRAY(order);
+	PDB_DELETE_ARRAY(lines);
+
+	Encode(sortedLines, lineCount);
+
+	PDB_DELETE_ARRAY(sortedLines);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::LineIndex::LineIndex(const Line* lines, size_t lineCount) PDB_NO_EXCEPT
+	: m_blockRVAs(nullptr)
+	, m_blockOffsets(nullptr)
+	, m_blockCount(0u)
+	, m_data(nullptr)
+	, m_dataSize(0u)
+	, m_lineCount(0u)
+	, m_ownsLines(true)
+{
+	if (lineCount == 0u)
+	{
+		return;
+	}
+
+	Encode(lines, lineCount);
+}
+
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::LineIndex::LineIndex(const EncodedLines& encodedLines) PDB_NO_EXCEPT
+	: m_blockRVAs(encodedLines.blockRVAs)
+	, m_blockOffsets(encodedLines.blockOffsets)
+	, m_blockCount(encodedLines.blockCount)
+	, m_data(encodedLines.data)
+	, m_dataSize(encodedLines.dataSize)
+	, m_lineCount(encodedLines.lineCount)
+	, m_ownsLines(false)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::LineIndex::~LineIndex(void) PDB_NO_EXCEPT
+{
+	if (m_ownsLines)
+	{
+		PDB_DELETE_ARRAY(m_blockRVAs);
+		PDB_DELETE_ARRAY(m_blockOffsets);
+		PDB_DELETE_ARRAY(m_data);
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::LineIndex::EncodedLines PDB::LineIndex::GetEncodedLines(void) const PDB_NO_EXCEPT
+{
+	return EncodedLines { m_blockRVAs, m_blockOffsets, m_blockCount, m_data, m_dataSize, m_lineCount };
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::LineIndex::Encode(const Line* lines, size_t lineCount) PDB_NO_EXCEPT
+{
+	// work out the size of the encoded data first, so it can be allocated in one go
+	m_lineCount = lineCount;
+	m_blockCount = static_cast<uint32_t>((lineCount + LinesPerBlock - 1u) / LinesPerBlock);
+	uint32_t* blockRVAs = PDB_NEW_ARRAY(uint32_t, m_blockCount);
+	uint32_t* blockOffsets = PDB_NEW_ARRAY(uint32_t, m_blockCount + 1u);
+	m_blockRVAs = blockRVAs;
+	m_blockOffsets = blockOffsets;
+
+	const Line zeroLine = {};
+	size_t dataSize = 0u;
+	for (size_t i = 0u; i < lineCount; ++i)
+	{
+		const Line& line = lines[i];
+		if ((i % LinesPerBlock) == 0u)
+		{
+			// the first line of each block is encoded relative to the block's RVA and zero
+			const uint32_t blockIndex = static_cast<uint32_t>(i / LinesPerBlock);
+			blockRVAs[blockIndex] = line.rva;
+			blockOffsets[blockIndex] = static_cast<uint32_t>(dataSize);
+
+			Line base = zeroLine;
+			base.rva = line.rva;
+			dataSize += GetEncodedLineSize(line, base);
+		}
+		else
+		{
+			dataSize += GetEncodedLineSize(line, lines[i - 1u]);
+		}
+	}
+
+	blockOffsets[m_blockCount] = static_cast<uint32_t>(dataSize);
+	m_dataSize = dataSize;
+
+	Byte* encodedData = PDB_NEW_ARRAY(Byte, dataSize);
+	m_data = encodedData;
+
+	Byte* data = encodedData;
+	for (size_t i = 0u; i < lineCount; ++i)
+	{
+		const Line& line = lines[i];
+		if ((i % LinesPerBlock) == 0u)
+		{
+			Line base = zeroLine;
+			base.rva = line.rva;
+			data = EncodeLine(data, line, base);
+		}
+		else
+		{
+			data = EncodeLine(data, line, lines[i - 1u]);
+		}
+	}
+
+	PDB_ASSERT(data == m_data + dataSize, "Mismatch between encoded size %zu and precomputed size %zu.", static_cast<size_t>(data - m_data), dataSize);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::LineIndex::DecodeBlock(uint32_t blockIndex, Line* lines) const PDB_NO_EXCEPT
+{
+	PDB_ASSERT(blockIndex < m_blockCount, "Block index %u out of bounds [0, %u).", blockIndex, m_blockCount);
+
+	const size_t firstLine = static_cast<size_t>(blockIndex) * LinesPerBlock;
+	const uint32_t count = (m_lineCount - firstLine < LinesPerBlock) ? static_cast<uint32_t>(m_lineCount - firstLine) : LinesPerBlock;
+
+	const Byte* data = m_data + m_blockOffsets[blockIndex];
+
+	uint32_t rva = m_blockRVAs[blockIndex];
+	uint32_t lineNumber = 0u;
+	uint32_t filenameOffset = 0u;
+	for (uint32_t i = 0u; i < count; ++i)
+	{
+		uint32_t rvaDelta = 0u;
+		uint32_t codeSize = 0u;
+		uint32_t lineDelta = 0u;
+		uint32_t column = 0u;
+		uint32_t filenameDelta = 0u;
+
+		data = ReadVarint(data, rvaDelta);
+		data = ReadVarint(data, codeSize);
+		data = ReadVarint(data, lineDelta);
+		data = ReadVarint(data, column);
+		data = ReadVarint(data, filenameDelta);
+
+		rva += rvaDelta;
+		lineNumber += ZigZagDecode(lineDelta);
+		filenameOffset += ZigZagDecode(filenameDelta);
+
+		Line& line = lines[i];
+		line.rva = rva;
+		line.codeSize = codeSize;
+		line.lineNumber = lineNumber;
+		line.filenameOffset = filenameOffset;
+		line.column = static_cast<uint16_t>(column);
+	}
+
+	return count;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::LineIndex::FindBlock(uint32_t rva) const PDB_NO_EXCEPT
+{
+	// find the last block whose first RVA is less than or equal to the given RVA
+	uint32_t first = 0u;
+	uint32_t count = m_blockCount;
+	while (count != 0u)
+	{
+		const uint32_t step = count / 2u;
+		const uint32_t middle = first + step;
+		if (m_blockRVAs[middle] <= rva)
+		{
+			first = middle + 1u;
+			count -= step + 1u;
+		}
+		else
+		{
+			count = step;
+		}
+	}
+
+	return (first == 0u) ? m_blockCount : first - 1u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD bool PDB::LineIndex::FindLine(uint32_t rva, Line& line) const PDB_NO_EXCEPT
+{
+	size_t found = FindLines(&rva, &line, 1u);
+
+	return (found != 0u);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+size_t PDB::LineIndex::FindLines(const uint32_t* rvas, Line* lines, size_t count) const PDB_NO_EXCEPT
+{
+	Line blockLines[LinesPerBlock];
+	uint32_t blockLineCount = 0u;
+	uint32_t decodedBlock = m_blockCount;
+
+	size_t foundCount = 0u;
+	for (size_t i = 0u; i < count; ++i)
+	{
+		const uint32_t rva = rvas[i];
+		Line& result = lines[i];
+
+		// only search for and decode a block if the RVA is not contained in the block decoded last
+		const bool isInDecodedBlock = (decodedBlock != m_blockCount) && (rva >= m_blockRVAs[decodedBlock]) && ((decodedBlock + 1u == m_blockCount) || (rva < m_blockRVAs[decodedBlock + 1u]));
+		if (!isInDecodedBlock)
+		{
+			decodedBlock = FindBlock(rva);
+			blockLineCount = (decodedBlock != m_blockCount) ? DecodeBlock(decodedBlock, blockLines) : 0u;
+		}
+
+		// find the last line starting at or before the RVA
+		const Line* candidate = nullptr;
+		for (uint32_t j = 0u; j < blockLineCount; ++j)
+		{
+			if (blockLines[j].rva > rva)
+			{
+				break;
+			}
+
+			candidate = &blockLines[j];
+		}
+
+		if (candidate && (rva - candidate->rva < candidate->codeSize))
+		{
+			result = *candidate;
+			++foundCount;
+		}
+		else
+		{
+			result = Line {};
+			result.rva = rva;
+		}
+	}
+
+	return foundCount;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::LineIndex PDB::CreateLineIndex(const RawFile& file, const ModuleInfoStream& moduleInfoStream, const ImageSectionStream& imageSectionStream) PDB_NO_EXCEPT
+{
+	return LineIndex { file, moduleInfoStream, imageSectionStream };
+}
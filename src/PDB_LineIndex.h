@@ -0,0 +1,127 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "PDB_Types.h"
+
+
+namespace PDB
+{
+	class RawFile;
+	class ModuleInfoStream;
+	class ImageSectionStream;
+
+
+	// An address-ordered index of the C13 line information (S_LINES and S_FILECHECKSUMS) of all modules.
+	// lines are sorted by RVA and stored delta-encoded in small blocks, so that a lookup consists of a binary search
+	// over the first RVA of each block, followed by decoding at most one block.
+	// the index is immutable once built and can therefore be queried from any number of threads concurrently.
+	class PDB_NO_DISCARD LineIndex
+	{
+	public:
+		// the number of lines stored in each delta-encoded block
+		static constexpr const uint32_t LinesPerBlock = 32u;
+
+		struct Line
+		{
+			uint32_t rva;
+			uint32_t codeSize;
+			uint32_t lineNumber;
+			uint32_t filenameOffset;		// offset into the "/names" stream, see NamesStream::GetFilename(), or into the filenames of a SymbolIndexCache
+			uint16_t column;				// zero if the module does not store column information
+		};
+
+		// the delta-encoded lines of an index, e.g. for storing them in a SymbolIndexCache
+		struct EncodedLines
+		{
+			const uint32_t* blockRVAs;
+			const uint32_t* blockOffsets;	// blockCount + 1 entries
+			uint32_t blockCount;
+			const Byte* data;
+			size_t dataSize;
+			size_t lineCount;
+		};
+
+		LineIndex(void) PDB_NO_EXCEPT;
+		LineIndex(LineIndex&& other) PDB_NO_EXCEPT;
+		LineIndex& operator=(LineIndex&& other) PDB_NO_EXCEPT;
+
+		explicit LineIndex(const RawFile& file, const ModuleInfoStream& moduleInfoStream, const ImageSectionStream& imageSectionStream) PDB_NO_EXCEPT;
+
+		// Creates an index from lines sorted by RVA, e.g. after their filename offsets have been changed.
+		explicit LineIndex(const Line* lines, size_t lineCount) PDB_NO_EXCEPT;
+
+		// Creates an index that refers to previously encoded lines without copying them. The lines must outlive the index.
+		explicit LineIndex(const EncodedLines& encodedLines) PDB_NO_EXCEPT;
+		~LineIndex(void) PDB_NO_EXCEPT;
+
+		// Finds the line containing the given RVA. Returns false if no line contains the RVA.
+		PDB_NO_DISCARD bool FindLine(uint32_t rva, Line& line) const PDB_NO_EXCEPT;
+
+		// Finds the lines containing the given RVAs, and returns the number of RVAs that could be resolved.
+		// lines that could not be resolved have their line number and code size set to zero.
+		// lookups are fastest if the RVAs are sorted, because consecutive RVAs in the same block only decode the block once.
+		size_t FindLines(const uint32_t* rvas, Line* lines, size_t count) const PDB_NO_EXCEPT;
+
+		// Iterates all lines in address order.
+		template <typename F>
+		void ForEachLine(F&& functor) const PDB_NO_EXCEPT
+		{
+			Line lines[LinesPerBlock];
+			for (uint32_t i = 0u; i < m_blockCount; ++i)
+			{
+				const uint32_t count = DecodeBlock(i, lines);
+				for (uint32_t j = 0u; j < count; ++j)
+				{
+					functor(lines[j]);
+				}
+			}
+		}
+
+		// Returns the number of lines in the index.
+		PDB_NO_DISCARD inline size_t GetLineCount(void) const PDB_NO_EXCEPT
+		{
+			return m_lineCount;
+		}
+
+		// Returns the number of bytes used by the delta-encoded lines.
+		PDB_NO_DISCARD inline size_t GetEncodedSize(void) const PDB_NO_EXCEPT
+		{
+			return m_dataSize;
+		}
+
+		// Returns the delta-encoded lines.
+		PDB_NO_DISCARD EncodedLines GetEncodedLines(void) const PDB_NO_EXCEPT;
+
+	private:
+		// Encodes lines sorted by RVA into newly allocated blocks.
+		void Encode(const Line* lines, size_t lineCount) PDB_NO_EXCEPT;
+
+		// Decodes all lines of a block, and returns the number of lines decoded.
+		PDB_NO_DISCARD uint32_t DecodeBlock(uint32_t blockIndex, Line* lines) const PDB_NO_EXCEPT;
+
+		// Returns the index of the block that holds the given RVA, or m_blockCount if there is none.
+		PDB_NO_DISCARD uint32_t FindBlock(uint32_t rva) const PDB_NO_EXCEPT;
+
+		// the first RVA of each block, for binary search
+		const uint32_t* m_blockRVAs;
+
+		// the offset of each block into the encoded data, with an additional entry denoting the end of the data
+		const uint32_t* m_blockOffsets;
+		uint32_t m_blockCount;
+
+		const Byte* m_data;
+		size_t m_dataSize;
+		size_t m_lineCount;
+
+		// whether the index owns the encoded lines, or refers to lines stored elsewhere
+		bool m_ownsLines;
+
+		PDB_DISABLE_COPY(LineIndex);
+	};
+
+	// Creates an address-to-line index from the line streams of all modules.
+	PDB_NO_DISCARD LineIndex CreateLineIndex(const RawFile& file, const ModuleInfoStream& moduleInfoStream, const ImageSectionStream& imageSectionStream) PDB_NO_EXCEPT;
+}
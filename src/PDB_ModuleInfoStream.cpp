@@ -5,6 +5,7 @@
 #include "PDB_ModuleInfoStream.h"
 #include "Foundation/PDB_Memory.h"
 #include "Foundation/PDB_CRT.h"
+#include "Foundation/PDB_Hash.h"
 
 namespace
 {
@@ -19,6 +20,90 @@ namespace
 		// the module info is stored in variable-length records, so we can't determine the exact number without walking the stream.
 		return streamSize / sizeof(PDB::DBI::ModuleInfo);
 	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline char ToLowerCase(char c) PDB_NO_EXCEPT
+	{
+		// module and object names are paths, so treat '/' and '\\' alike
+		if (c == '/')
+		{
+			return '\\';
+		}
+
+		return ((c >= 'A') && (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a') : c;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline uint32_t HashCaseInsensitive(const char* string, size_t length) PDB_NO_EXCEPT
+	{
+		uint32_t hash = PDB::Hash::FNV1aOffsetBasis;
+		for (size_t i = 0u; i < length; ++i)
+		{
+			const char c = ToLowerCase(string[i]);
+			hash = PDB::Hash::FNV1a(&c, 1u, hash);
+		}
+
+		return hash;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline bool EqualsCaseInsensitive(const char* lhs, size_t lhsLength, const char* rhs, size_t rhsLength) PDB_NO_EXCEPT
+	{
+		if (lhsLength != rhsLength)
+		{
+			return false;
+		}
+
+		for (size_t i = 0u; i < lhsLength; ++i)
+		{
+			if (ToLowerCase(lhs[i]) != ToLowerCase(rhs[i]))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline size_t FindBasenameOffset(const char* string, size_t length) PDB_NO_EXCEPT
+	{
+		for (size_t i = length; i > 0u; --i)
+		{
+			if ((string[i - 1u] == '\\') || (string[i - 1u] == '/'))
+			{
+				return i;
+			}
+		}
+
+		return 0u;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline PDB::ArrayView<char> GetKey(const PDB::ModuleInfoStream::Module& module, PDB::ModuleInfoStream::Lookup lookup) PDB_NO_EXCEPT
+	{
+		const bool usesObjectName = (lookup == PDB::ModuleInfoStream::Lookup::ObjectName) || (lookup == PDB::ModuleInfoStream::Lookup::ObjectNameBasename);
+		const PDB::ArrayView<char> string = usesObjectName ? module.GetObjectName() : module.GetName();
+
+		const bool usesBasename = (lookup == PDB::ModuleInfoStream::Lookup::NameBasename) || (lookup == PDB::ModuleInfoStream::Lookup::ObjectNameBasename);
+		if (!usesBasename)
+		{
+			return string;
+		}
+
+		const size_t offset = FindBasenameOffset(string.Decay(), string.GetLength());
+		return PDB::ArrayView<char>(string.Decay() + offset, string.GetLength() - offset);
+	}
 }
 
 
@@ -87,6 +172,9 @@ PDB::ModuleInfoStream::ModuleInfoStream(void) PDB_NO_EXCEPT
 	: m_stream()
 	, m_modules(nullptr)
 	, m_moduleCount(0u)
+	, m_buckets(nullptr)
+	, m_chains(nullptr)
+	, m_bucketCount(0u)
 {
 }
 
@@ -97,9 +185,15 @@ PDB::ModuleInfoStream::ModuleInfoStream(ModuleInfoStream&& other) PDB_NO_EXCEPT
 	: m_stream(PDB_MOVE(other.m_stream))
 	, m_modules(PDB_MOVE(other.m_modules))
 	, m_moduleCount(PDB_MOVE(other.m_moduleCount))
+	, m_buckets(PDB_MOVE(other.m_buckets))
+	, m_chains(PDB_MOVE(other.m_chains))
+	, m_bucketCount(PDB_MOVE(other.m_bucketCount))
 {
 	other.m_modules = nullptr;
 	other.m_moduleCount = 0u;
+	other.m_buckets = nullptr;
+	other.m_chains = nullptr;
+	other.m_bucketCount = 0u;
 }
 
 
@@ -110,13 +204,21 @@ PDB::ModuleInfoStream& PDB::ModuleInfoStream::operator=(ModuleInfoStream&& other
 	if (this != &other)
 	{
 		PDB_DELETE_ARRAY(m_modules);
+		PDB_DELETE_ARRAY(m_buckets);
+		PDB_DELETE_ARRAY(m_chains);
 
 		m_stream = PDB_MOVE(other.m_stream);
 		m_modules = PDB_MOVE(other.m_modules);
 		m_moduleCount = PDB_MOVE(other.m_moduleCount);
+		m_buckets = PDB_MOVE(other.m_buckets);
+		m_chains = PDB_MOVE(other.m_chains);
+		m_bucketCount = PDB_MOVE(other.m_bucketCount);
 
 		other.m_modules = nullptr;
 		other.m_moduleCount = 0u;
+		other.m_buckets = nullptr;
+		other.m_chains = nullptr;
+		other.m_bucketCount = 0u;
 	}
 
 	return *this;
@@ -129,6 +231,9 @@ PDB::ModuleInfoStream::ModuleInfoStream(const DirectMSFStream& directStream, uin
 	: m_stream(directStream, size, offset)
 	, m_modules(nullptr)
 	, m_moduleCount(0u)
+	, m_buckets(nullptr)
+	, m_chains(nullptr)
+	, m_bucketCount(0u)
 {
 	m_modules = PDB_NEW_ARRAY(Module, EstimateModuleCount(size));
 
@@ -152,6 +257,8 @@ PDB::ModuleInfoStream::ModuleInfoStream(const DirectMSFStream& directStream, uin
 		m_modules[m_moduleCount] = Module(moduleInfo, name, nameLength, objectName, objectNameLength);
 		++m_moduleCount;
 	}
+
+	BuildLookups();
 }
 
 
@@ -160,25 +267,122 @@ PDB::ModuleInfoStream::ModuleInfoStream(const DirectMSFStream& directStream, uin
 PDB::ModuleInfoStream::~ModuleInfoStream(void) PDB_NO_EXCEPT
 {
 	PDB_DELETE_ARRAY(m_modules);
+	PDB_DELETE_ARRAY(m_buckets);
+	PDB_DELETE_ARRAY(m_chains);
 }
 
 
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
-PDB_NO_DISCARD const PDB::ModuleInfoStream::Module* PDB::ModuleInfoStream::FindLinkerModule(void) const PDB_NO_EXCEPT
+void PDB::ModuleInfoStream::BuildLookups(void) PDB_NO_EXCEPT
 {
-	const size_t count = m_moduleCount;
-	for (size_t i = 0u; i < count; ++i)
+	// keep the tables at most half full, using a power-of-two bucket count so buckets can be masked
+	m_bucketCount = 1u;
+	while (m_bucketCount < m_moduleCount * 2u)
+	{
+		m_bucketCount <<= 1u;
+	}
+
+	m_buckets = PDB_NEW_ARRAY(uint32_t, m_bucketCount * LookupCount);
+	m_chains = PDB_NEW_ARRAY(uint32_t, m_moduleCount * LookupCount + 1u);
+
+	for (size_t i = 0u; i < m_bucketCount * LookupCount; ++i)
 	{
-		// with both MSVC cl.exe and Clang, the linker symbol is the last one to be stored, so start searching from the end
-		const Module& module = m_modules[count - i - 1u];
+		m_buckets[i] = InvalidModuleIndex;
+	}
 
-		// check if this is the linker symbol
-		if (strcmp(module.GetName().Decay(), LinkerSymbolName) == 0)
+	for (uint32_t lookupIndex = 0u; lookupIndex < LookupCount; ++lookupIndex)
+	{
+		const Lookup lookup = static_cast<Lookup>(lookupIndex);
+		uint32_t* buckets = m_buckets + lookupIndex * m_bucketCount;
+		uint32_t* chains = m_chains + lookupIndex * m_moduleCount;
+
+		// insert in reverse order at the head of each chain, so that chains are walked in module order
+		for (size_t i = m_moduleCount; i > 0u; --i)
 		{
-			return &module;
+			const uint32_t moduleIndex = static_cast<uint32_t>(i - 1u);
+			const ArrayView<char> key = GetKey(m_modules[moduleIndex], lookup);
+			const uint32_t bucket = HashCaseInsensitive(key.Decay(), key.GetLength()) & (m_bucketCount - 1u);
+
+			chains[moduleIndex] = buckets[bucket];
+			buckets[bucket] = moduleIndex;
 		}
 	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::ModuleInfoStream::FindInChain(Lookup lookup, const char* string, uint32_t moduleIndex) const PDB_NO_EXCEPT
+{
+	const uint32_t* chains = m_chains + PDB_AS_UNDERLYING(lookup) * m_moduleCount;
+	const size_t length = strlen(string);
+
+	for (/* nothing */; moduleIndex != InvalidModuleIndex; moduleIndex = chains[moduleIndex])
+	{
+		const ArrayView<char> key = GetKey(m_modules[moduleIndex], lookup);
+		if (EqualsCaseInsensitive(key.Decay(), key.GetLength(), string, length))
+		{
+			return moduleIndex;
+		}
+	}
+
+	return InvalidModuleIndex;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::ModuleInfoStream::FindFirstModuleIndex(Lookup lookup, const char* string) const PDB_NO_EXCEPT
+{
+	if (m_moduleCount == 0u)
+	{
+		return InvalidModuleIndex;
+	}
+
+	const uint32_t bucket = HashCaseInsensitive(string, strlen(string)) & (m_bucketCount - 1u);
+	return FindInChain(lookup, string, m_buckets[PDB_AS_UNDERLYING(lookup) * m_bucketCount + bucket]);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::ModuleInfoStream::FindNextModuleIndex(Lookup lookup, const char* string, uint32_t moduleIndex) const PDB_NO_EXCEPT
+{
+	const uint32_t* chains = m_chains + PDB_AS_UNDERLYING(lookup) * m_moduleCount;
+	return FindInChain(lookup, string, chains[moduleIndex]);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const PDB::ModuleInfoStream::Module* PDB::ModuleInfoStream::FindModule(Lookup lookup, const char* string) const PDB_NO_EXCEPT
+{
+	const uint32_t moduleIndex = FindFirstModuleIndex(lookup, string);
+	if (moduleIndex == InvalidModuleIndex)
+	{
+		return nullptr;
+	}
+
+	return &m_modules[moduleIndex];
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const PDB::ModuleInfoStream::Module* PDB::ModuleInfoStream::FindLinkerModule(void) const PDB_NO_EXCEPT
+{
+	// with both MSVC cl.exe and Clang, the linker symbol is the last one to be stored, so prefer the last match
+	uint32_t linkerModuleIndex = InvalidModuleIndex;
+	ForEachModule(Lookup::Name, LinkerSymbolName, [&linkerModuleIndex](uint32_t moduleIndex)
+	{
+		linkerModuleIndex = moduleIndex;
+	});
+
+	if (linkerModuleIndex == InvalidModuleIndex)
+	{
+		return nullptr;
+	}
 
-	return nullptr;
+	return &m_modules[linkerModuleIndex];
 }
@@ -71,6 +71,18 @@ namespace PDB
 			PDB_DISABLE_COPY(Module);
 		};
 
+		// the keys modules can be looked up by
+		enum class PDB_NO_DISCARD Lookup : uint8_t
+		{
+			Name,					// the module name
+			ObjectName,				// the object file name
+			NameBasename,			// the module name without its directory
+			ObjectNameBasename		// the object file name without its directory
+		};
+
+		static constexpr const uint32_t LookupCount = 4u;
+		static constexpr const uint32_t InvalidModuleIndex = 0xFFFFFFFFu;
+
 		ModuleInfoStream(void) PDB_NO_EXCEPT;
 		ModuleInfoStream(ModuleInfoStream&& other) PDB_NO_EXCEPT;
 		ModuleInfoStream& operator=(ModuleInfoStream&& other) PDB_NO_EXCEPT;
@@ -82,6 +94,21 @@ namespace PDB
 		// Tries to find the linker module corresponding to the linker, i.e. the module named "* Linker *".
 		PDB_NO_DISCARD const Module* FindLinkerModule(void) const PDB_NO_EXCEPT;
 
+		// Returns the first module whose key matches the given string, or nullptr if there is no such module.
+		// keys are compared case-insensitively, and looked up using a hash table built upon construction.
+		PDB_NO_DISCARD const Module* FindModule(Lookup lookup, const char* string) const PDB_NO_EXCEPT;
+
+		// Calls the functor with the index of each module whose key matches the given string, in module order.
+		// e.g. looking up the basename of an object file finds all modules compiled from object files with that name.
+		template <typename F>
+		void ForEachModule(Lookup lookup, const char* string, F&& functor) const PDB_NO_EXCEPT
+		{
+			for (uint32_t i = FindFirstModuleIndex(lookup, string); i != InvalidModuleIndex; i = FindNextModuleIndex(lookup, string, i))
+			{
+				functor(i);
+			}
+		}
+
 		// Returns the module with the given index.
 		PDB_NO_DISCARD inline const Module& GetModule(uint32_t index) const PDB_NO_EXCEPT
 		{
@@ -95,10 +122,28 @@ namespace PDB
 		}
 
 	private:
+		// Builds the hash tables of all lookups.
+		void BuildLookups(void) PDB_NO_EXCEPT;
+
+		// Returns the index of the first module whose key matches, or InvalidModuleIndex.
+		PDB_NO_DISCARD uint32_t FindFirstModuleIndex(Lookup lookup, const char* string) const PDB_NO_EXCEPT;
+
+		// Returns the index of the next module after the given one whose key matches, or InvalidModuleIndex.
+		PDB_NO_DISCARD uint32_t FindNextModuleIndex(Lookup lookup, const char* string, uint32_t moduleIndex) const PDB_NO_EXCEPT;
+
+		// Returns the index of the first module in a chain whose key matches, or InvalidModuleIndex.
+		PDB_NO_DISCARD uint32_t FindInChain(Lookup lookup, const char* string, uint32_t moduleIndex) const PDB_NO_EXCEPT;
+
 		CoalescedMSFStream m_stream;
 		Module* m_modules;
 		size_t m_moduleCount;
 
+		// chained hash tables, one per lookup. buckets store the index of the first module in their chain,
+		// and chains store the index of the next module with a key in the same bucket.
+		uint32_t* m_buckets;
+		uint32_t* m_chains;
+		uint32_t m_bucketCount;
+
 		PDB_DISABLE_COPY(ModuleInfoStream);
 	};
 }
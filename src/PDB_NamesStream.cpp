@@ -4,6 +4,15 @@
 #include "PDB_PCH.h"
 #include "PDB_NamesStream.h"
 #include "PDB_RawFile.h"
+#include "Foundation/PDB_Hash.h"
+#include "Foundation/PDB_CRT.h"
+
+
+namespace
+{
+	// the number of strings hashed at once when looking up many strings
+	static constexpr const size_t HashBatchSize = 64u;
+}
 
 
 // ------------------------------------------------------------------------------------------------
@@ -12,6 +21,8 @@ PDB::NamesStream::NamesStream(void) PDB_NO_EXCEPT
 	: m_stream()
 	, m_header(nullptr)
 	, m_stringTable(nullptr)
+	, m_buckets(nullptr)
+	, m_bucketCount(0u)
 {
 }
 
@@ -22,7 +33,108 @@ PDB::NamesStream::NamesStream(const RawFile& file, uint32_t streamIndex) PDB_NO_
 	: m_stream(file.CreateMSFStream<CoalescedMSFStream>(streamIndex))
 	, m_header(m_stream.GetDataAtOffset<const NamesHeader>(0u))
 	, m_stringTable(nullptr)
+	, m_buckets(nullptr)
+	, m_bucketCount(0u)
 {
 	// grab a pointer into the string table
 	m_stringTable = m_stream.GetDataAtOffset<char>(sizeof(NamesHeader));
+
+	// the string table is followed by the bucket count and the buckets of the hash table
+	// https://llvm.org/docs/PDB/StringTable.html
+	const size_t bucketCountOffset = sizeof(NamesHeader) + m_header->size;
+	if (bucketCountOffset + sizeof(uint32_t) > m_stream.GetSize())
+	{
+		return;
+	}
+
+	const uint32_t bucketCount = *m_stream.GetDataAtOffset<uint32_t>(bucketCountOffset);
+	if (bucketCountOffset + sizeof(uint32_t) + sizeof(uint32_t) * static_cast<size_t>(bucketCount) > m_stream.GetSize())
+	{
+		return;
+	}
+
+	m_buckets = m_stream.GetDataAtOffset<uint32_t>(bucketCountOffset + sizeof(uint32_t));
+	m_bucketCount = bucketCount;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::NamesStream::FindOffset(const char* string) const PDB_NO_EXCEPT
+{
+	if (m_bucketCount == 0u)
+	{
+		return 0u;
+	}
+
+	return FindHashedOffset(string, HashString(string));
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::NamesStream::FindOffsets(const char* const* strings, size_t count, uint32_t* offsets) const PDB_NO_EXCEPT
+{
+	if (m_bucketCount == 0u)
+	{
+		memset(offsets, 0, sizeof(uint32_t) * count);
+		return;
+	}
+
+	// hashing a batch of strings in a tight loop keeps the hash function's instructions independent of the probing,
+	// letting the CPU overlap the hashes of several strings
+	uint32_t hashes[HashBatchSize];
+	for (size_t batch = 0u; batch < count; batch += HashBatchSize)
+	{
+		const size_t batchCount = (count - batch < HashBatchSize) ? count - batch : HashBatchSize;
+		for (size_t i = 0u; i < batchCount; ++i)
+		{
+			hashes[i] = HashString(strings[batch + i]);
+		}
+
+		for (size_t i = 0u; i < batchCount; ++i)
+		{
+			offsets[batch + i] = FindHashedOffset(strings[batch + i], hashes[i]);
+		}
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::NamesStream::HashString(const char* string) const PDB_NO_EXCEPT
+{
+	const size_t length = strlen(string);
+	if (m_header->hashVersion == 2u)
+	{
+		return Hash::HashStringV2(string, length);
+	}
+
+	return Hash::HashStringV1(string, length);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::NamesStream::FindHashedOffset(const char* string, uint32_t hash) const PDB_NO_EXCEPT
+{
+	// collisions are resolved by linear probing, an empty bucket ends the probe sequence
+	uint32_t bucket = hash % m_bucketCount;
+	for (uint32_t i = 0u; i < m_bucketCount; ++i)
+	{
+		const uint32_t offset = m_buckets[bucket];
+		if (offset == 0u)
+		{
+			return 0u;
+		}
+
+		if ((offset < m_header->size) && (strcmp(m_stringTable + offset, string) == 0))
+		{
+			return offset;
+		}
+
+		bucket = (bucket + 1u == m_bucketCount) ? 0u : bucket + 1u;
+	}
+
+	return 0u;
 }
@@ -38,11 +38,30 @@ namespace PDB
 			return m_stringTable + filenameOffset;
 		}
 
+		// Returns the offset of the given string, or zero if the stream does not contain the string.
+		// the string is looked up using the hash table stored after the string table, hashed according to the stream's hash version.
+		PDB_NO_DISCARD uint32_t FindOffset(const char* string) const PDB_NO_EXCEPT;
+
+		// Looks up the offsets of many strings at once, storing zero for strings not contained in the stream.
+		// strings are processed in batches of 64: all strings of a batch are hashed before the hash table is probed
+		// for them, which is considerably faster than looking up strings one by one.
+		void FindOffsets(const char* const* strings, size_t count, uint32_t* offsets) const PDB_NO_EXCEPT;
+
 	private:
+		// Returns the hash of a string according to the stream's hash version.
+		PDB_NO_DISCARD uint32_t HashString(const char* string) const PDB_NO_EXCEPT;
+
+		// Returns the offset of a string with the given hash, or zero if the stream does not contain the string.
+		PDB_NO_DISCARD uint32_t FindHashedOffset(const char* string, uint32_t hash) const PDB_NO_EXCEPT;
+
 		CoalescedMSFStream m_stream;
 		const NamesHeader* m_header;
 		const char* m_stringTable;
 
+		// the hash table stores the offset of each string in the bucket of its hash, with zero denoting an empty bucket
+		const uint32_t* m_buckets;
+		uint32_t m_bucketCount;
+
 		PDB_DISABLE_COPY(NamesStream);
 	};
 }
@@ -0,0 +1,144 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_TypeTraits.h"
+#include "Foundation/PDB_Forward.h"
+#include "PDB_DBITypes.h"
+#include "PDB_TPITypes.h"
+#include "PDB_IPITypes.h"
+
+
+// Dispatches records to handlers registered for specific record kinds, e.g.:
+//
+//	auto visitor = PDB::MakeRecordVisitor(
+//		PDB::OnSymbol<PDB::CodeView::DBI::SymbolRecordKind::S_GPROC32>([](const PDB::CodeView::DBI::Record* record) { ... }),
+//		PDB::OnSymbol<PDB::CodeView::DBI::SymbolRecordKind::S_LPROC32>([](const PDB::CodeView::DBI::Record* record) { ... }));
+//	moduleSymbolStream.ForEachSymbol(visitor);
+//
+// all record kinds are known at compile time, so the dispatch consists of a chain of comparisons against constants,
+// which compilers turn into a switch or jump table after inlining. records of kinds that are not handled are only
+// looked at by their header. Handles() can be used to skip such records before reading them.
+namespace PDB
+{
+	// Maps a record kind enumeration to the record type it identifies.
+	template <typename KindType>
+	struct RecordKindTraits;
+
+	template <>
+	struct RecordKindTraits<CodeView::DBI::SymbolRecordKind>
+	{
+		using Record = CodeView::DBI::Record;
+	};
+
+	template <>
+	struct RecordKindTraits<CodeView::TPI::TypeRecordKind>
+	{
+		using Record = CodeView::TPI::Record;
+	};
+
+	template <>
+	struct RecordKindTraits<CodeView::IPI::TypeRecordKind>
+	{
+		using Record = CodeView::IPI::Record;
+	};
+
+
+	// A functor handling records of a single kind, see OnSymbol(), OnType() and OnIPIType().
+	template <typename KindType, KindType Kind, typename F>
+	struct RecordHandler
+	{
+		F functor;
+	};
+
+
+	template <typename KindType, typename... Handlers>
+	class RecordVisitor;
+
+	// The end of the handler chain, which ignores all records.
+	template <typename KindType>
+	class RecordVisitor<KindType>
+	{
+	public:
+		using Record = typename RecordKindTraits<KindType>::Record;
+
+		// Returns whether records of the given kind are handled by the visitor.
+		PDB_NO_DISCARD static constexpr bool Handles(KindType) PDB_NO_EXCEPT
+		{
+			return false;
+		}
+
+		// Calls the handler registered for the record's kind. Returns false if there is none.
+		inline bool operator()(const Record*) PDB_NO_EXCEPT
+		{
+			return false;
+		}
+	};
+
+	template <typename KindType, KindType Kind, typename F, typename... Handlers>
+	class RecordVisitor<KindType, RecordHandler<KindType, Kind, F>, Handlers...> : private RecordVisitor<KindType, Handlers...>
+	{
+		using Base = RecordVisitor<KindType, Handlers...>;
+
+	public:
+		using Record = typename RecordKindTraits<KindType>::Record;
+
+		explicit RecordVisitor(RecordHandler<KindType, Kind, F>&& handler, Handlers&&... handlers) PDB_NO_EXCEPT
+			: Base(static_cast<Handlers&&>(handlers)...)
+			, m_functor(static_cast<F&&>(handler.functor))
+		{
+		}
+
+		// Returns whether records of the given kind are handled by the visitor.
+		PDB_NO_DISCARD static constexpr bool Handles(KindType kind) PDB_NO_EXCEPT
+		{
+			return (kind == Kind) || Base::Handles(kind);
+		}
+
+		// Calls the handler registered for the record's kind. Returns false if there is none.
+		inline bool operator()(const Record* record) PDB_NO_EXCEPT
+		{
+			if (record->header.kind == Kind)
+			{
+				m_functor(record);
+				return true;
+			}
+
+			return Base::operator()(record);
+		}
+
+	private:
+		F m_functor;
+	};
+
+
+	// Registers a handler for symbol records of the given kind.
+	template <CodeView::DBI::SymbolRecordKind Kind, typename F>
+	PDB_NO_DISCARD inline RecordHandler<CodeView::DBI::SymbolRecordKind, Kind, typename remove_reference<F>::type> OnSymbol(F&& functor) PDB_NO_EXCEPT
+	{
+		return RecordHandler<CodeView::DBI::SymbolRecordKind, Kind, typename remove_reference<F>::type> { PDB_FORWARD(functor) };
+	}
+
+	// Registers a handler for TPI records of the given kind.
+	template <CodeView::TPI::TypeRecordKind Kind, typename F>
+	PDB_NO_DISCARD inline RecordHandler<CodeView::TPI::TypeRecordKind, Kind, typename remove_reference<F>::type> OnType(F&& functor) PDB_NO_EXCEPT
+	{
+		return RecordHandler<CodeView::TPI::TypeRecordKind, Kind, typename remove_reference<F>::type> { PDB_FORWARD(functor) };
+	}
+
+	// Registers a handler for IPI records of the given kind.
+	template <CodeView::IPI::TypeRecordKind Kind, typename F>
+	PDB_NO_DISCARD inline RecordHandler<CodeView::IPI::TypeRecordKind, Kind, typename remove_reference<F>::type> OnIPIType(F&& functor) PDB_NO_EXCEPT
+	{
+		return RecordHandler<CodeView::IPI::TypeRecordKind, Kind, typename remove_reference<F>::type> { PDB_FORWARD(functor) };
+	}
+
+	// Creates a visitor from any number of handlers for records of the same enumeration.
+	template <typename KindType, KindType Kind, typename F, typename... Handlers>
+	PDB_NO_DISCARD inline RecordVisitor<KindType, RecordHandler<KindType, Kind, F>, Handlers...> MakeRecordVisitor(RecordHandler<KindType, Kind, F>&& handler, Handlers&&... handlers) PDB_NO_EXCEPT
+	{
+		return RecordVisitor<KindType, RecordHandler<KindType, Kind, F>, Handlers...>(static_cast<RecordHandler<KindType, Kind, F>&&>(handler), static_cast<Handlers&&>(handlers)...);
+	}
+}
@@ -0,0 +1,156 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_SectionMapStream.h"
+#include "PDB_ImageSectionStream.h"
+#include "Foundation/PDB_Memory.h"
+
+
+namespace
+{
+	// the number of segment offsets converted at once when converting into RVAs
+	static constexpr const size_t ConversionBatchSize = 256u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SectionMapStream::SectionMapStream(void) PDB_NO_EXCEPT
+	: m_stream()
+	, m_header(nullptr)
+	, m_entries(nullptr)
+	, m_entryCount(0u)
+	, m_frames(nullptr)
+	, m_frameOffsets(nullptr)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SectionMapStream::SectionMapStream(SectionMapStream&& other) PDB_NO_EXCEPT
+	: m_stream(PDB_MOVE(other.m_stream))
+	, m_header(PDB_MOVE(other.m_header))
+	, m_entries(PDB_MOVE(other.m_entries))
+	, m_entryCount(PDB_MOVE(other.m_entryCount))
+	, m_frames(PDB_MOVE(other.m_frames))
+	, m_frameOffsets(PDB_MOVE(other.m_frameOffsets))
+{
+	other.m_header = nullptr;
+	other.m_entries = nullptr;
+	other.m_entryCount = 0u;
+	other.m_frames = nullptr;
+	other.m_frameOffsets = nullptr;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SectionMapStream& PDB::SectionMapStream::operator=(SectionMapStream&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		PDB_DELETE_ARRAY(m_frames);
+		PDB_DELETE_ARRAY(m_frameOffsets);
+
+		m_stream = PDB_MOVE(other.m_stream);
+		m_header = PDB_MOVE(other.m_header);
+		m_entries = PDB_MOVE(other.m_entries);
+		m_entryCount = PDB_MOVE(other.m_entryCount);
+		m_frames = PDB_MOVE(other.m_frames);
+		m_frameOffsets = PDB_MOVE(other.m_frameOffsets);
+
+		other.m_header = nullptr;
+		other.m_entries = nullptr;
+		other.m_entryCount = 0u;
+		other.m_frames = nullptr;
+		other.m_frameOffsets = nullptr;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SectionMapStream::SectionMapStream(const DirectMSFStream& directStream, uint32_t size, uint32_t offset) PDB_NO_EXCEPT
+	: m_stream(directStream, size, offset)
+	, m_header(nullptr)
+	, m_entries(nullptr)
+	, m_entryCount(0u)
+	, m_frames(nullptr)
+	, m_frameOffsets(nullptr)
+{
+	// the sub-stream has the following layout:
+	//	struct SectionMapSubstream
+	//	{
+	//		SectionMapHeader header;
+	//		SectionMapEntry entries[header.count];
+	//	};
+	if (m_stream.GetSize() >= sizeof(DBI::SectionMapHeader))
+	{
+		m_header = m_stream.GetDataAtOffset<DBI::SectionMapHeader>(0u);
+		m_entries = m_stream.GetDataAtOffset<DBI::SectionMapEntry>(sizeof(DBI::SectionMapHeader));
+
+		// never trust the count to stay within the sub-stream
+		const size_t availableCount = (m_stream.GetSize() - sizeof(DBI::SectionMapHeader)) / sizeof(DBI::SectionMapEntry);
+		m_entryCount = (m_header->count < availableCount) ? m_header->count : availableCount;
+	}
+
+	m_frames = PDB_NEW_ARRAY(uint16_t, m_entryCount + 1u);
+	m_frameOffsets = PDB_NEW_ARRAY(uint32_t, m_entryCount + 1u);
+
+	// section zero is converted into an RVA of zero
+	m_frames[0] = 0u;
+	m_frameOffsets[0] = 0u;
+
+	for (size_t i = 0u; i < m_entryCount; ++i)
+	{
+		const DBI::SectionMapEntry& entry = m_entries[i];
+
+		// absolute addresses do not refer to any section
+		const bool isAbsolute = ((PDB_AS_UNDERLYING(entry.flags) & PDB_AS_UNDERLYING(DBI::SectionMapEntryFlags::IsAbsoluteAddress)) != 0u);
+		m_frames[i + 1u] = isAbsolute ? 0u : entry.frame;
+		m_frameOffsets[i + 1u] = isAbsolute ? 0u : entry.offset;
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SectionMapStream::~SectionMapStream(void) PDB_NO_EXCEPT
+{
+	PDB_DELETE_ARRAY(m_frames);
+	PDB_DELETE_ARRAY(m_frameOffsets);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::SectionMapStream::ConvertSegmentOffsetsToSectionOffsets(const uint16_t* oneBasedSegmentIndices, const uint32_t* offsetsInSegment, size_t count, uint16_t* oneBasedSectionIndices, uint32_t* offsetsInSection) const PDB_NO_EXCEPT
+{
+	// the loop body is free of branches, so the compiler can use conditional moves for the bounds check
+	for (size_t i = 0u; i < count; ++i)
+	{
+		ConvertSegmentOffsetToSectionOffset(oneBasedSegmentIndices[i], offsetsInSegment[i], oneBasedSectionIndices[i], offsetsInSection[i]);
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::SectionMapStream::ConvertSegmentOffsetsToRVAs(const ImageSectionStream& imageSectionStream, const uint16_t* oneBasedSegmentIndices, const uint32_t* offsetsInSegment, size_t count, uint32_t* rvas) const PDB_NO_EXCEPT
+{
+	// convert in batches small enough to stay in the cache
+	uint16_t sectionIndices[ConversionBatchSize];
+	uint32_t offsetsInSection[ConversionBatchSize];
+
+	for (size_t batch = 0u; batch < count; batch += ConversionBatchSize)
+	{
+		const size_t batchCount = (count - batch < ConversionBatchSize) ? count - batch : ConversionBatchSize;
+		ConvertSegmentOffsetsToSectionOffsets(oneBasedSegmentIndices + batch, offsetsInSegment + batch, batchCount, sectionIndices, offsetsInSection);
+
+		imageSectionStream.ConvertSectionOffsetsToRVAs(sectionIndices, offsetsInSection, batchCount, rvas + batch);
+	}
+}
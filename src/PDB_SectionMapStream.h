@@ -0,0 +1,76 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_ArrayView.h"
+#include "PDB_DBITypes.h"
+#include "PDB_CoalescedMSFStream.h"
+
+
+namespace PDB
+{
+	class PDB_NO_DISCARD DirectMSFStream;
+	class ImageSectionStream;
+
+
+	// Provides access to the section map sub-stream of the DBI stream, which describes the logical segments of the image.
+	// https://llvm.org/docs/PDB/DbiStream.html#section-map-substream
+	// the i-th entry describes the logical segment i + 1, which is located at an offset within a physical section.
+	// upon construction, the entries are condensed into a table that translates logical segments into physical sections
+	// with a single indexed load, without having to touch the entries again.
+	class PDB_NO_DISCARD SectionMapStream
+	{
+	public:
+		SectionMapStream(void) PDB_NO_EXCEPT;
+		SectionMapStream(SectionMapStream&& other) PDB_NO_EXCEPT;
+		SectionMapStream& operator=(SectionMapStream&& other) PDB_NO_EXCEPT;
+
+		explicit SectionMapStream(const DirectMSFStream& directStream, uint32_t size, uint32_t offset) PDB_NO_EXCEPT;
+		~SectionMapStream(void) PDB_NO_EXCEPT;
+
+		// Returns the header of the section map.
+		PDB_NO_DISCARD inline const DBI::SectionMapHeader* GetHeader(void) const PDB_NO_EXCEPT
+		{
+			return m_header;
+		}
+
+		// Returns a view of all entries, indexed by logical segment - 1.
+		PDB_NO_DISCARD inline ArrayView<DBI::SectionMapEntry> GetEntries(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<DBI::SectionMapEntry>(m_entries, m_entryCount);
+		}
+
+		// Converts a one-based logical segment and an offset within the segment into a one-based physical section and an offset
+		// within the section. Unknown segments and absolute addresses are converted into section zero.
+		inline void ConvertSegmentOffsetToSectionOffset(uint16_t oneBasedSegmentIndex, uint32_t offsetInSegment, uint16_t& oneBasedSectionIndex, uint32_t& offsetInSection) const PDB_NO_EXCEPT
+		{
+			// unknown segments use the invalid translation stored at index zero
+			const size_t index = (oneBasedSegmentIndex <= m_entryCount) ? oneBasedSegmentIndex : 0u;
+
+			oneBasedSectionIndex = m_frames[index];
+			offsetInSection = m_frameOffsets[index] + offsetInSegment;
+		}
+
+		// Converts many logical segment offsets into physical section offsets at once.
+		void ConvertSegmentOffsetsToSectionOffsets(const uint16_t* oneBasedSegmentIndices, const uint32_t* offsetsInSegment, size_t count, uint16_t* oneBasedSectionIndices, uint32_t* offsetsInSection) const PDB_NO_EXCEPT;
+
+		// Converts many logical segment offsets into RVAs at once, using the sections of the given image section stream.
+		// segment offsets that cannot be converted yield an RVA of zero, the same as ImageSectionStream::ConvertSectionOffsetsToRVAs.
+		void ConvertSegmentOffsetsToRVAs(const ImageSectionStream& imageSectionStream, const uint16_t* oneBasedSegmentIndices, const uint32_t* offsetsInSegment, size_t count, uint32_t* rvas) const PDB_NO_EXCEPT;
+
+	private:
+		CoalescedMSFStream m_stream;
+		const DBI::SectionMapHeader* m_header;
+		const DBI::SectionMapEntry* m_entries;
+		size_t m_entryCount;
+
+		// the physical section and the offset within it of each logical segment, indexed by one-based segment index.
+		// index zero holds the translation of invalid segments.
+		uint16_t* m_frames;
+		uint32_t* m_frameOffsets;
+
+		PDB_DISABLE_COPY(SectionMapStream);
+	};
+}
@@ -0,0 +1,350 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_SourceLineIndex.h"
+#include "PDB_RawFile.h"
+#include "PDB_ImageSectionStream.h"
+#include "Foundation/PDB_PointerUtil.h"
+#include "Foundation/PDB_RadixSort.h"
+#include "Foundation/PDB_Memory.h"
+#include "Foundation/PDB_CRT.h"
+
+
+namespace
+{
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline bool IsOrderedBefore(const PDB::SourceLineIndex::Entry& entry, uint32_t filenameOffset, uint32_t lineNumber) PDB_NO_EXCEPT
+	{
+		if (entry.filenameOffset == filenameOffset)
+		{
+			return entry.lineNumber < lineNumber;
+		}
+
+		return entry.filenameOffset < filenameOffset;
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SourceLineIndex::SourceLineIndex(void) PDB_NO_EXCEPT
+	: m_entries(nullptr)
+	, m_entryCount(0u)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SourceLineIndex::SourceLineIndex(SourceLineIndex&& other) PDB_NO_EXCEPT
+	: m_entries(PDB_MOVE(other.m_entries))
+	, m_entryCount(PDB_MOVE(other.m_entryCount))
+{
+	other.m_entries = nullptr;
+	other.m_entryCount = 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SourceLineIndex& PDB::SourceLineIndex::operator=(SourceLineIndex&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		PDB_DELETE_ARRAY(m_entries);
+
+		m_entries = PDB_MOVE(other.m_entries);
+		m_entryCount = PDB_MOVE(other.m_entryCount);
+
+		other.m_entries = nullptr;
+		other.m_entryCount = 0u;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SourceLineIndex::SourceLineIndex(const RawFile& file, const ModuleInfoStream::Module& module, const ImageSectionStream& imageSectionStream) PDB_NO_EXCEPT
+	: m_entries(nullptr)
+	, m_entryCount(0u)
+{
+	if (!module.HasLineStream())
+	{
+		return;
+	}
+
+	const ModuleLineStream lineStream = module.CreateLineStream(file);
+
+	// the S_FILECHECKSUMS section can be stored after the S_LINES sections that refer to it, so find the checksums
+	// and count the lines before storing any entries.
+	const CodeView::DBI::FileChecksumHeader* checksums = nullptr;
+	size_t lineCount = 0u;
+	lineStream.ForEachSection([&lineStream, &checksums, &lineCount](const CodeView::DBI::LineSection* section)
+	{
+		if (section->header.kind == CodeView::DBI::DebugSubsectionKind::S_FILECHECKSUMS)
+		{
+			checksums = &section->checksumHeader;
+		}
+		else if (section->header.kind == CodeView::DBI::DebugSubsectionKind::S_LINES)
+		{
+			lineStream.ForEachLinesBlock(section, [&lineCount](const CodeView::DBI::LinesFileBlockHeader* linesBlockHeader, const CodeView::DBI::Line*, const CodeView::DBI::Column*)
+			{
+				lineCount += linesBlockHeader->numLines;
+			});
+		}
+	});
+
+	if (lineCount == 0u || checksums == nullptr)
+	{
+		return;
+	}
+
+	Entry* entries = PDB_NEW_ARRAY(Entry, lineCount);
+	size_t entryCount = 0u;
+
+	lineStream.ForEachSection([&lineStream, &imageSectionStream, checksums, entries, &entryCount](const CodeView::DBI::LineSection* section)
+	{
+		if (section->header.kind != CodeView::DBI::DebugSubsectionKind::S_LINES)
+		{
+			return;
+		}
+
+		const CodeView::DBI::LinesHeader& linesHeader = section->linesHeader;
+
+		lineStream.ForEachLinesBlock(section, [&imageSectionStream, &linesHeader, checksums, entries, &entryCount](const CodeView::DBI::LinesFileBlockHeader* linesBlockHeader, const CodeView::DBI::Line* blockLines, const CodeView::DBI::Column*)
+		{
+			const uint32_t numLines = linesBlockHeader->numLines;
+			if (numLines == 0u)
+			{
+				return;
+			}
+
+			const CodeView::DBI::FileChecksumHeader* checksumHeader = Pointer::Offset<const CodeView::DBI::FileChecksumHeader*>(checksums, linesBlockHeader->fileChecksumOffset);
+			const uint32_t filenameOffset = checksumHeader->filenameOffset;
+
+			for (uint32_t i = 0u; i < numLines; ++i)
+			{
+				const CodeView::DBI::Line& line = blockLines[i];
+
+				const uint32_t rva = imageSectionStream.ConvertSectionOffsetToRVA(linesHeader.sectionIndex, linesHeader.sectionOffset + line.offset);
+				if (rva == 0u)
+				{
+					continue;
+				}
+
+				// the last line of a block extends to the end of the code described by the section
+				const uint32_t nextOffset = (i + 1u < numLines) ? blockLines[i + 1u].offset : linesHeader.codeSize;
+				if (nextOffset <= line.offset)
+				{
+					// lines without code cannot be resolved to an address
+					continue;
+				}
+
+				Entry& entry = entries[entryCount];
+				entry.filenameOffset = filenameOffset;
+				entry.lineNumber = line.linenumStart;
+				entry.rva = rva;
+				entry.codeSize = nextOffset - line.offset;
+				++entryCount;
+			}
+		});
+	});
+
+	Build(entries, entryCount);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SourceLineIndex::SourceLineIndex(ArrayView<const SourceLineIndex*> indices) PDB_NO_EXCEPT
+	: m_entries(nullptr)
+	, m_entryCount(0u)
+{
+	size_t count = 0u;
+	for (const SourceLineIndex* index : indices)
+	{
+		count += index->m_entryCount;
+	}
+
+	if (count == 0u)
+	{
+		return;
+	}
+
+	Entry* entries = PDB_NEW_ARRAY(Entry, count);
+	size_t entryCount = 0u;
+	for (const SourceLineIndex* index : indices)
+	{
+		if (index->m_entryCount != 0u)
+		{
+			memcpy(entries + entryCount, index->m_entries, sizeof(Entry) * index->m_entryCount);
+			entryCount += index->m_entryCount;
+		}
+	}
+
+	Build(entries, entryCount);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SourceLineIndex::~SourceLineIndex(void) PDB_NO_EXCEPT
+{
+	PDB_DELETE_ARRAY(m_entries);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::SourceLineIndex::Build(Entry* entries, size_t count) PDB_NO_EXCEPT
+{
+	if (count == 0u)
+	{
+		PDB_DELETE_ARRAY(entries);
+		return;
+	}
+
+	// sort by filename, line and RVA. the radix sort is stable, so sort by the least significant key first.
+	uint32_t* order = PDB_NEW_ARRAY(uint32_t, count);
+	{
+		uint32_t* keys = PDB_NEW_ARRAY(uint32_t, count);
+		uint32_t* scratch = PDB_NEW_ARRAY(uint32_t, count);
+
+		for (size_t i = 0u; i < count; ++i)
+		{
+			order[i] = static_cast<uint32_t>(i);
+			keys[i] = entries[i].rva;
+		}
+		RadixSort::SortIndices(keys, order, scratch, count);
+
+		for (size_t i = 0u; i < count; ++i)
+		{
+			keys[i] = entries[i].lineNumber;
+		}
+		RadixSort::SortIndices(keys, order, scratch, count);
+
+		for (size_t i = 0u; i < count; ++i)
+		{
+			keys[i] = entries[i].filenameOffset;
+		}
+		RadixSort::SortIndices(keys, order, scratch, count);
+
+		PDB_DELETE_ARRAY(scratch);
+		PDB_DELETE_ARRAY(keys);
+	}
+
+	// store the sorted entries, merging overlapping and adjacent code ranges of the same line.
+	// the same line is often split into several ranges that directly follow each other, e.g. for loops.
+	Entry* sortedEntries = PDB_NEW_ARRAY(Entry, count);
+	size_t sortedCount = 0u;
+	for (size_t i = 0u; i < count; ++i)
+	{
+		const Entry& entry = entries[order[i]];
+		if (sortedCount != 0u)
+		{
+			Entry& previous = sortedEntries[sortedCount - 1u];
+			const uint32_t previousEnd = previous.rva + previous.codeSize;
+			if ((previous.filenameOffset == entry.filenameOffset) && (previous.lineNumber == entry.lineNumber) && (entry.rva <= previousEnd))
+			{
+				const uint32_t end = entry.rva + entry.codeSize;
+				if (end > previousEnd)
+				{
+					previous.codeSize = end - previous.rva;
+				}
+
+				continue;
+			}
+		}
+
+		sortedEntries[sortedCount] = entry;
+		++sortedCount;
+	}
+
+	PDB_DELETE_ARRAY(order);
+	PDB_DELETE_ARRAY(entries);
+
+	PDB_DELETE_ARRAY(m_entries);
+	m_entries = sortedEntries;
+	m_entryCount = sortedCount;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD size_t PDB::SourceLineIndex::LowerBound(uint32_t filenameOffset, uint32_t lineNumber) const PDB_NO_EXCEPT
+{
+	size_t first = 0u;
+	size_t count = m_entryCount;
+	while (count != 0u)
+	{
+		const size_t step = count / 2u;
+		const size_t middle = first + step;
+		if (IsOrderedBefore(m_entries[middle], filenameOffset, lineNumber))
+		{
+			first = middle + 1u;
+			count -= step + 1u;
+		}
+		else
+		{
+			count = step;
+		}
+	}
+
+	return first;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::ArrayView<PDB::SourceLineIndex::Entry> PDB::SourceLineIndex::GetLineEntries(size_t index) const PDB_NO_EXCEPT
+{
+	const Entry& first = m_entries[index];
+
+	size_t end = index + 1u;
+	while ((end < m_entryCount) && (m_entries[end].filenameOffset == first.filenameOffset) && (m_entries[end].lineNumber == first.lineNumber))
+	{
+		++end;
+	}
+
+	return ArrayView<Entry>(m_entries + index, end - index);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::ArrayView<PDB::SourceLineIndex::Entry> PDB::SourceLineIndex::FindLine(uint32_t filenameOffset, uint32_t lineNumber) const PDB_NO_EXCEPT
+{
+	const size_t index = LowerBound(filenameOffset, lineNumber);
+	if ((index == m_entryCount) || (m_entries[index].filenameOffset != filenameOffset) || (m_entries[index].lineNumber != lineNumber))
+	{
+		return ArrayView<Entry>(nullptr, 0u);
+	}
+
+	return GetLineEntries(index);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::ArrayView<PDB::SourceLineIndex::Entry> PDB::SourceLineIndex::FindNearestLine(uint32_t filenameOffset, uint32_t lineNumber) const PDB_NO_EXCEPT
+{
+	const size_t index = LowerBound(filenameOffset, lineNumber);
+	if ((index == m_entryCount) || (m_entries[index].filenameOffset != filenameOffset))
+	{
+		return ArrayView<Entry>(nullptr, 0u);
+	}
+
+	return GetLineEntries(index);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::SourceLineIndex PDB::CreateSourceLineIndex(const RawFile& file, const ModuleInfoStream::Module& module, const ImageSectionStream& imageSectionStream) PDB_NO_EXCEPT
+{
+	return SourceLineIndex { file, module, imageSectionStream };
+}
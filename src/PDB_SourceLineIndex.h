@@ -0,0 +1,77 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_ArrayView.h"
+#include "PDB_ModuleInfoStream.h"
+
+
+namespace PDB
+{
+	class RawFile;
+	class ImageSectionStream;
+
+
+	// A source-ordered index of the C13 line information, mapping a file and line to the code generated for it.
+	// entries are sorted by filename, line and RVA, and adjacent code ranges of the same line are merged.
+	// filenames are identified by their offset into the "/names" stream, which is shared by all modules.
+	// the index of each module is independent of all other modules, and can therefore be built on any thread. indices
+	// of several modules are then merged into one, which allows building the index incrementally, e.g. only for
+	// modules that are needed right now.
+	class PDB_NO_DISCARD SourceLineIndex
+	{
+	public:
+		struct Entry
+		{
+			uint32_t filenameOffset;		// offset into the "/names" stream, see NamesStream::GetFilename()
+			uint32_t lineNumber;
+			uint32_t rva;
+			uint32_t codeSize;
+		};
+
+		SourceLineIndex(void) PDB_NO_EXCEPT;
+		SourceLineIndex(SourceLineIndex&& other) PDB_NO_EXCEPT;
+		SourceLineIndex& operator=(SourceLineIndex&& other) PDB_NO_EXCEPT;
+
+		// Builds the index for the lines of a single module.
+		explicit SourceLineIndex(const RawFile& file, const ModuleInfoStream::Module& module, const ImageSectionStream& imageSectionStream) PDB_NO_EXCEPT;
+
+		// Merges several indices into one. The given indices are left untouched.
+		explicit SourceLineIndex(ArrayView<const SourceLineIndex*> indices) PDB_NO_EXCEPT;
+
+		~SourceLineIndex(void) PDB_NO_EXCEPT;
+
+		// Returns all code ranges generated for the given line, sorted by RVA. The view is empty if the line has no code.
+		PDB_NO_DISCARD ArrayView<Entry> FindLine(uint32_t filenameOffset, uint32_t lineNumber) const PDB_NO_EXCEPT;
+
+		// Returns all code ranges generated for the first line at or after the given line in the same file.
+		// this is what debuggers do when placing a breakpoint on a line that did not generate any code.
+		PDB_NO_DISCARD ArrayView<Entry> FindNearestLine(uint32_t filenameOffset, uint32_t lineNumber) const PDB_NO_EXCEPT;
+
+		// Returns a view of all entries in the index.
+		PDB_NO_DISCARD inline ArrayView<Entry> GetEntries(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<Entry>(m_entries, m_entryCount);
+		}
+
+	private:
+		// Sorts the given entries, merges adjacent code ranges and takes ownership of the result.
+		void Build(Entry* entries, size_t count) PDB_NO_EXCEPT;
+
+		// Returns the index of the first entry not ordered before the given filename and line.
+		PDB_NO_DISCARD size_t LowerBound(uint32_t filenameOffset, uint32_t lineNumber) const PDB_NO_EXCEPT;
+
+		// Returns a view of all entries of the line found at the given index.
+		PDB_NO_DISCARD ArrayView<Entry> GetLineEntries(size_t index) const PDB_NO_EXCEPT;
+
+		Entry* m_entries;
+		size_t m_entryCount;
+
+		PDB_DISABLE_COPY(SourceLineIndex);
+	};
+
+	// Creates a source line index for a single module.
+	PDB_NO_DISCARD SourceLineIndex CreateSourceLineIndex(const RawFile& file, const ModuleInfoStream::Module& module, const ImageSectionStream& imageSectionStream) PDB_NO_EXCEPT;
+}
@@ -0,0 +1,573 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_SourceLinkMap.h"
+#include "PDB_RawFile.h"
+#include "PDB_InfoStream.h"
+#include "PDB_CoalescedMSFStream.h"
+#include "Foundation/PDB_Memory.h"
+#include "Foundation/PDB_CRT.h"
+
+
+namespace
+{
+	// nesting deeper than this is considered malformed
+	static constexpr const uint32_t MaxJsonDepth = 64u;
+
+
+	// a minimal parser for the subset of JSON needed to read Source Link documents
+	struct JsonParser
+	{
+		const char* position;
+		const char* end;
+	};
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	static void SkipWhitespace(JsonParser& parser) PDB_NO_EXCEPT
+	{
+		while ((parser.position < parser.end) && ((*parser.position == ' ') || (*parser.position == '\t') || (*parser.position == '\r') || (*parser.position == '\n')))
+		{
+			++parser.position;
+		}
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static bool Consume(JsonParser& parser, char c) PDB_NO_EXCEPT
+	{
+		SkipWhitespace(parser);
+		if ((parser.position == parser.end) || (*parser.position != c))
+		{
+			return false;
+		}
+
+		++parser.position;
+		return true;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static bool ParseHexDigits(JsonParser& parser, uint32_t& value) PDB_NO_EXCEPT
+	{
+		if (parser.end - parser.position < 4)
+		{
+			return false;
+		}
+
+		value = 0u;
+		for (uint32_t i = 0u; i < 4u; ++i)
+		{
+			const char c = *parser.position++;
+			value <<= 4u;
+			if ((c >= '0') && (c <= '9'))
+			{
+				value |= static_cast<uint32_t>(c - '0');
+			}
+			else if ((c >= 'a') && (c <= 'f'))
+			{
+				value |= static_cast<uint32_t>(c - 'a' + 10);
+			}
+			else if ((c >= 'A') && (c <= 'F'))
+			{
+				value |= static_cast<uint32_t>(c - 'A' + 10);
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static bool ParseString(JsonParser& parser, char* string, size_t& length) PDB_NO_EXCEPT
+	{
+		// the unescaped string is never longer than its escaped form, so the output can be as large as the input
+		length = 0u;
+		if (!Consume(parser, '"'))
+		{
+			return false;
+		}
+
+		while (parser.position < parser.end)
+		{
+			char c = *parser.position++;
+			if (c == '"')
+			{
+				return true;
+			}
+
+			if (c != '\\')
+			{
+				string[length++] = c;
+				continue;
+			}
+
+			if (parser.position == parser.end)
+			{
+				return false;
+			}
+
+			c = *parser.position++;
+			switch (c)
+			{
+			case 'b':
+				string[length++] = '\b';
+				break;
+
+			case 'f':
+				string[length++] = '\f';
+				break;
+
+			case 'n':
+				string[length++] = '\n';
+				break;
+
+			case 'r':
+				string[length++] = '\r';
+				break;
+
+			case 't':
+				string[length++] = '\t';
+				break;
+
+			case 'u':
+			{
+				uint32_t codePoint = 0u;
+				if (!ParseHexDigits(parser, codePoint))
+				{
+					return false;
+				}
+
+				// combine surrogate pairs
+				if ((codePoint >= 0xD800u) && (codePoint < 0xDC00u) && (parser.end - parser.position >= 6) && (parser.position[0] == '\\') && (parser.position[1] == 'u'))
+				{
+					parser.position += 2;
+
+					uint32_t lowSurrogate = 0u;
+					if (!ParseHexDigits(parser, lowSurrogate))
+					{
+						return false;
+					}
+
+					codePoint = 0x10000u + ((codePoint - 0xD800u) << 10u) + (lowSurrogate - 0xDC00u);
+				}
+
+				// encode as UTF-8
+				if (codePoint < 0x80u)
+				{
+					string[length++] = static_cast<char>(codePoint);
+				}
+				else if (codePoint < 0x800u)
+				{
+					string[length++] = static_cast<char>(0xC0u | (codePoint >> 6u));
+					string[length++] = static_cast<char>(0x80u | (codePoint & 0x3Fu));
+				}
+				else if (codePoint < 0x10000u)
+				{
+					string[length++] = static_cast<char>(0xE0u | (codePoint >> 12u));
+					string[length++] = static_cast<char>(0x80u | ((codePoint >> 6u) & 0x3Fu));
+					string[length++] = static_cast<char>(0x80u | (codePoint & 0x3Fu));
+				}
+				else
+				{
+					string[length++] = static_cast<char>(0xF0u | (codePoint >> 18u));
+					string[length++] = static_cast<char>(0x80u | ((codePoint >> 12u) & 0x3Fu));
+					string[length++] = static_cast<char>(0x80u | ((codePoint >> 6u) & 0x3Fu));
+					string[length++] = static_cast<char>(0x80u | (codePoint & 0x3Fu));
+				}
+			}
+			break;
+
+			default:
+				// '"', '\\' and '/'
+				string[length++] = c;
+				break;
+			}
+		}
+
+		return false;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static bool SkipValue(JsonParser& parser, uint32_t depth) PDB_NO_EXCEPT
+	{
+		SkipWhitespace(parser);
+		if ((parser.position == parser.end) || (depth > MaxJsonDepth))
+		{
+			return false;
+		}
+
+		const char c = *parser.position;
+		if (c == '"')
+		{
+			// skip the string without unescaping it
+			++parser.position;
+			while (parser.position < parser.end)
+			{
+				const char s = *parser.position++;
+				if (s == '"')
+				{
+					return true;
+				}
+				else if ((s == '\\') && (parser.position < parser.end))
+				{
+					++parser.position;
+				}
+			}
+
+			return false;
+		}
+		else if ((c == '{') || (c == '['))
+		{
+			const char close = (c == '{') ? '}' : ']';
+			++parser.position;
+			if (Consume(parser, close))
+			{
+				return true;
+			}
+
+			do
+			{
+				if ((c == '{') && (!SkipValue(parser, depth + 1u) || !Consume(parser, ':')))
+				{
+					return false;
+				}
+
+				if (!SkipValue(parser, depth + 1u))
+				{
+					return false;
+				}
+			}
+			while (Consume(parser, ','));
+
+			return Consume(parser, close);
+		}
+
+		// numbers, true, false and null
+		while ((parser.position < parser.end) && (*parser.position != ',') && (*parser.position != '}') && (*parser.position != ']'))
+		{
+			++parser.position;
+		}
+
+		return true;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static char NormalizePathCharacter(char c) PDB_NO_EXCEPT
+	{
+		if ((c >= 'A') && (c <= 'Z'))
+		{
+			return static_cast<char>(c - 'A' + 'a');
+		}
+
+		return (c == '\\') ? '/' : c;
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SourceLinkMap::SourceLinkMap(void) PDB_NO_EXCEPT
+	: m_nodes(nullptr)
+	, m_nodeCount(0u)
+	, m_mappings(nullptr)
+	, m_mappingCount(0u)
+	, m_urls(nullptr)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SourceLinkMap::SourceLinkMap(SourceLinkMap&& other) PDB_NO_EXCEPT
+	: m_nodes(PDB_MOVE(other.m_nodes))
+	, m_nodeCount(PDB_MOVE(other.m_nodeCount))
+	, m_mappings(PDB_MOVE(other.m_mappings))
+	, m_mappingCount(PDB_MOVE(other.m_mappingCount))
+	, m_urls(PDB_MOVE(other.m_urls))
+{
+	other.m_nodes = nullptr;
+	other.m_nodeCount = 0u;
+	other.m_mappings = nullptr;
+	other.m_mappingCount = 0u;
+	other.m_urls = nullptr;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SourceLinkMap& PDB::SourceLinkMap::operator=(SourceLinkMap&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		PDB_DELETE_ARRAY(m_nodes);
+		PDB_DELETE_ARRAY(m_mappings);
+		PDB_DELETE_ARRAY(m_urls);
+
+		m_nodes = PDB_MOVE(other.m_nodes);
+		m_nodeCount = PDB_MOVE(other.m_nodeCount);
+		m_mappings = PDB_MOVE(other.m_mappings);
+		m_mappingCount = PDB_MOVE(other.m_mappingCount);
+		m_urls = PDB_MOVE(other.m_urls);
+
+		other.m_nodes = nullptr;
+		other.m_nodeCount = 0u;
+		other.m_mappings = nullptr;
+		other.m_mappingCount = 0u;
+		other.m_urls = nullptr;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SourceLinkMap::SourceLinkMap(const char* json, size_t size) PDB_NO_EXCEPT
+	: SourceLinkMap()
+{
+	// skip a UTF-8 byte order mark
+	if ((size >= 3u) && (static_cast<uint8_t>(json[0]) == 0xEFu) && (static_cast<uint8_t>(json[1]) == 0xBBu) && (static_cast<uint8_t>(json[2]) == 0xBFu))
+	{
+		json += 3u;
+		size -= 3u;
+	}
+
+	// each character of a path adds at most one node, and each mapping takes at least 5 characters ("":"")
+	m_nodes = PDB_NEW_ARRAY(Node, size + 1u);
+	m_mappings = PDB_NEW_ARRAY(Mapping, size / 5u + 1u);
+	m_urls = PDB_NEW_ARRAY(char, size + 1u);
+	char* path = PDB_NEW_ARRAY(char, size + 1u);
+
+	m_nodes[0] = Node { 0u, 0u, 0u, 0u, '\0' };
+	m_nodeCount = 1u;
+
+	JsonParser parser = { json, json + size };
+	size_t urlSize = 0u;
+
+	if (Consume(parser, '{') && !Consume(parser, '}'))
+	{
+		do
+		{
+			size_t keyLength = 0u;
+			if (!ParseString(parser, path, keyLength) || !Consume(parser, ':'))
+			{
+				break;
+			}
+
+			if ((keyLength != 9u) || (memcmp(path, "documents", 9u) != 0))
+			{
+				if (!SkipValue(parser, 0u))
+				{
+					break;
+				}
+
+				continue;
+			}
+
+			if (!Consume(parser, '{') || Consume(parser, '}'))
+			{
+				continue;
+			}
+
+			do
+			{
+				size_t pathLength = 0u;
+				size_t urlLength = 0u;
+				if (!ParseString(parser, path, pathLength) || !Consume(parser, ':') || !ParseString(parser, m_urls + urlSize, urlLength))
+				{
+					break;
+				}
+
+				AddMapping(path, pathLength, static_cast<uint32_t>(urlSize), static_cast<uint32_t>(urlLength));
+				urlSize += urlLength;
+			}
+			while (Consume(parser, ','));
+
+			if (!Consume(parser, '}'))
+			{
+				break;
+			}
+		}
+		while (Consume(parser, ','));
+	}
+
+	PDB_DELETE_ARRAY(path);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SourceLinkMap::~SourceLinkMap(void) PDB_NO_EXCEPT
+{
+	PDB_DELETE_ARRAY(m_nodes);
+	PDB_DELETE_ARRAY(m_mappings);
+	PDB_DELETE_ARRAY(m_urls);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD size_t PDB::SourceLinkMap::Resolve(const char* path, char* url, size_t urlCapacity) const PDB_NO_EXCEPT
+{
+	if (m_nodeCount == 0u)
+	{
+		return 0u;
+	}
+
+	// walk the trie as far as the path goes, remembering the longest prefix that has a mapping
+	uint32_t node = 0u;
+	uint32_t mapping = m_nodes[0].prefixMapping;
+	size_t prefixLength = 0u;
+
+	size_t i = 0u;
+	for (/* nothing */; path[i] != '\0'; ++i)
+	{
+		const char c = NormalizePathCharacter(path[i]);
+
+		uint32_t child = m_nodes[node].firstChild;
+		while ((child != 0u) && (m_nodes[child].character != c))
+		{
+			child = m_nodes[child].nextSibling;
+		}
+
+		if (child == 0u)
+		{
+			break;
+		}
+
+		node = child;
+		if (m_nodes[node].prefixMapping != 0u)
+		{
+			mapping = m_nodes[node].prefixMapping;
+			prefixLength = i + 1u;
+		}
+	}
+
+	// an exact mapping of the whole path takes precedence
+	if ((path[i] == '\0') && (m_nodes[node].exactMapping != 0u))
+	{
+		mapping = m_nodes[node].exactMapping;
+		prefixLength = i;
+	}
+
+	if (mapping == 0u)
+	{
+		return 0u;
+	}
+
+	// replace the '*' in the URL by the rest of the path, using forward slashes
+	const Mapping& urlMapping = m_mappings[mapping - 1u];
+	const char* urlTemplate = m_urls + urlMapping.urlOffset;
+
+	size_t length = 0u;
+	const auto append = [url, urlCapacity, &length](char c)
+	{
+		if (length + 1u < urlCapacity)
+		{
+			url[length] = c;
+		}
+
+		++length;
+	};
+
+	bool replaced = false;
+	for (size_t j = 0u; j < urlMapping.urlLength; ++j)
+	{
+		if ((urlTemplate[j] == '*') && !replaced)
+		{
+			for (const char* rest = path + prefixLength; *rest != '\0'; ++rest)
+			{
+				append((*rest == '\\') ? '/' : *rest);
+			}
+
+			replaced = true;
+			continue;
+		}
+
+		append(urlTemplate[j]);
+	}
+
+	if (urlCapacity != 0u)
+	{
+		url[(length < urlCapacity) ? length : urlCapacity - 1u] = '\0';
+	}
+
+	return length;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::SourceLinkMap::AddMapping(const char* path, size_t pathLength, uint32_t urlOffset, uint32_t urlLength) PDB_NO_EXCEPT
+{
+	// only a trailing '*' denotes a prefix
+	const bool isPrefix = (pathLength != 0u) && (path[pathLength - 1u] == '*');
+	if (isPrefix)
+	{
+		--pathLength;
+	}
+
+	uint32_t node = 0u;
+	for (size_t i = 0u; i < pathLength; ++i)
+	{
+		const char c = NormalizePathCharacter(path[i]);
+
+		uint32_t child = m_nodes[node].firstChild;
+		while ((child != 0u) && (m_nodes[child].character != c))
+		{
+			child = m_nodes[child].nextSibling;
+		}
+
+		if (child == 0u)
+		{
+			child = static_cast<uint32_t>(m_nodeCount++);
+			m_nodes[child] = Node { 0u, m_nodes[node].firstChild, 0u, 0u, c };
+			m_nodes[node].firstChild = child;
+		}
+
+		node = child;
+	}
+
+	m_mappings[m_mappingCount] = Mapping { urlOffset, urlLength };
+	++m_mappingCount;
+
+	// later mappings of the same path replace earlier ones
+	if (isPrefix)
+	{
+		m_nodes[node].prefixMapping = static_cast<uint32_t>(m_mappingCount);
+	}
+	else
+	{
+		m_nodes[node].exactMapping = static_cast<uint32_t>(m_mappingCount);
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::SourceLinkMap PDB::CreateSourceLinkMap(const RawFile& file, const InfoStream& infoStream) PDB_NO_EXCEPT
+{
+	const uint32_t streamIndex = infoStream.FindNamedStream("/sourcelink");
+	if (streamIndex == 0u)
+	{
+		return SourceLinkMap {};
+	}
+
+	const CoalescedMSFStream stream = file.CreateMSFStream<CoalescedMSFStream>(streamIndex);
+
+	return SourceLinkMap { stream.GetDataAtOffset<const char>(0u), stream.GetSize() };
+}
@@ -0,0 +1,75 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+
+
+namespace PDB
+{
+	class RawFile;
+	class InfoStream;
+
+
+	// Maps local source file paths to URLs using the Source Link document mappings stored in the "/sourcelink" stream.
+	// https://github.com/dotnet/designs/blob/main/accepted/2020/diagnostics/source-link.md
+	// each mapping is either an exact path, or a path prefix ending in '*' whose URL contains a '*' that is replaced by the
+	// rest of the path. all mappings are stored in a prefix trie, so resolving a path walks the trie once, choosing the longest
+	// matching prefix. paths are matched case-insensitively, treating '\' and '/' as the same character.
+	class PDB_NO_DISCARD SourceLinkMap
+	{
+	public:
+		SourceLinkMap(void) PDB_NO_EXCEPT;
+		SourceLinkMap(SourceLinkMap&& other) PDB_NO_EXCEPT;
+		SourceLinkMap& operator=(SourceLinkMap&& other) PDB_NO_EXCEPT;
+
+		// Parses the "documents" object of a Source Link JSON document. Malformed documents yield the mappings parsed so far.
+		explicit SourceLinkMap(const char* json, size_t size) PDB_NO_EXCEPT;
+		~SourceLinkMap(void) PDB_NO_EXCEPT;
+
+		// Stores the URL of the given path in the given buffer, truncating the URL if the buffer is too small.
+		// Returns the length of the URL without the null terminator, or zero if no mapping matches the path.
+		PDB_NO_DISCARD size_t Resolve(const char* path, char* url, size_t urlCapacity) const PDB_NO_EXCEPT;
+
+		// Returns the number of mappings.
+		PDB_NO_DISCARD inline size_t GetMappingCount(void) const PDB_NO_EXCEPT
+		{
+			return m_mappingCount;
+		}
+
+	private:
+		struct Node
+		{
+			uint32_t firstChild;
+			uint32_t nextSibling;
+			uint32_t exactMapping;			// mapping index + 1 of a path ending at this node, zero if none
+			uint32_t prefixMapping;			// mapping index + 1 of a prefix ending at this node, zero if none
+			char character;
+		};
+
+		struct Mapping
+		{
+			uint32_t urlOffset;
+			uint32_t urlLength;
+		};
+
+		// Adds a mapping from a path or path prefix to the URL stored at the given offset.
+		void AddMapping(const char* path, size_t pathLength, uint32_t urlOffset, uint32_t urlLength) PDB_NO_EXCEPT;
+
+		// the root node is stored at index zero, a child index of zero denotes no child
+		Node* m_nodes;
+		size_t m_nodeCount;
+
+		Mapping* m_mappings;
+		size_t m_mappingCount;
+
+		// the URLs of all mappings, unescaped
+		char* m_urls;
+
+		PDB_DISABLE_COPY(SourceLinkMap);
+	};
+
+	// Creates a map from the "/sourcelink" stream. The map is empty if the PDB has no such stream.
+	PDB_NO_DISCARD SourceLinkMap CreateSourceLinkMap(const RawFile& file, const InfoStream& infoStream) PDB_NO_EXCEPT;
+}
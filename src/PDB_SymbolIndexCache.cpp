@@ -0,0 +1,213 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_SymbolIndexCache.h"
+#include "Foundation/PDB_PointerUtil.h"
+#include "Foundation/PDB_Hash.h"
+#include "Foundation/PDB_CRT.h"
+
+
+namespace
+{
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline bool IsTableInBounds(uint32_t offset, uint32_t count, size_t elementSize, uint32_t alignment, uint32_t size) PDB_NO_EXCEPT
+	{
+		if ((offset > size) || ((offset % alignment) != 0u))
+		{
+			return false;
+		}
+
+		return (count <= (size - offset) / elementSize);
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	template <typename T>
+	PDB_NO_DISCARD static inline const T* FindContainingEntry(const T* entries, uint32_t count, uint32_t rva) PDB_NO_EXCEPT
+	{
+		// find the last entry whose RVA is less than or equal to the given RVA
+		uint32_t first = 0u;
+		while (count != 0u)
+		{
+			const uint32_t step = count / 2u;
+			const uint32_t middle = first + step;
+			if (entries[middle].rva <= rva)
+			{
+				first = middle + 1u;
+				count -= step + 1u;
+			}
+			else
+			{
+				count = step;
+			}
+		}
+
+		if (first == 0u)
+		{
+			return nullptr;
+		}
+
+		const T* entry = &entries[first - 1u];
+		return (rva - entry->rva < entry->size) ? entry : nullptr;
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SymbolIndexCache::SymbolIndexCache(void) PDB_NO_EXCEPT
+	: m_header(nullptr)
+	, m_functions(nullptr)
+	, m_functionNames(nullptr)
+	, m_filenames(nullptr)
+	, m_contributions(nullptr)
+	, m_lineIndex()
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SymbolIndexCache::SymbolIndexCache(const void* data) PDB_NO_EXCEPT
+	: m_header(Pointer::Offset<const Header*>(data, 0u))
+	, m_functions(Pointer::Offset<const Function*>(data, m_header->functionsOffset))
+	, m_functionNames(Pointer::Offset<const char*>(data, m_header->functionNamesOffset))
+	, m_filenames(Pointer::Offset<const char*>(data, m_header->filenamesOffset))
+	, m_contributions(Pointer::Offset<const Contribution*>(data, m_header->contributionsOffset))
+	, m_lineIndex(LineIndex::EncodedLines
+		{
+			Pointer::Offset<const uint32_t*>(data, m_header->lineBlockRVAsOffset),
+			Pointer::Offset<const uint32_t*>(data, m_header->lineBlockOffsetsOffset),
+			m_header->lineBlockCount,
+			Pointer::Offset<const Byte*>(data, m_header->lineDataOffset),
+			m_header->lineDataSize,
+			m_header->lineCount
+		})
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const PDB::SymbolIndexCache::Function* PDB::SymbolIndexCache::FindFunction(uint32_t rva) const PDB_NO_EXCEPT
+{
+	if (!m_header)
+	{
+		return nullptr;
+	}
+
+	return FindContainingEntry(m_functions, m_header->functionCount, rva);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const PDB::SymbolIndexCache::Contribution* PDB::SymbolIndexCache::FindContribution(uint32_t rva) const PDB_NO_EXCEPT
+{
+	if (!m_header)
+	{
+		return nullptr;
+	}
+
+	return FindContainingEntry(m_contributions, m_header->contributionCount, rva);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::ComputeSymbolIndexCacheChecksum(const void* data, size_t size) PDB_NO_EXCEPT
+{
+	// FNV-1a on four independent lanes of 4-byte words, which is considerably faster than hashing single bytes
+	// and allows the compiler to vectorize the loop
+	uint32_t lanes[4u] = { Hash::FNV1aOffsetBasis, Hash::FNV1aOffsetBasis + 1u, Hash::FNV1aOffsetBasis + 2u, Hash::FNV1aOffsetBasis + 3u };
+
+	const Byte* bytes = static_cast<const Byte*>(data);
+	size_t i = 0u;
+	for (/* nothing */; i + sizeof(lanes) <= size; i += sizeof(lanes))
+	{
+		uint32_t words[4u];
+		memcpy(words, bytes + i, sizeof(words));
+
+		for (uint32_t j = 0u; j < 4u; ++j)
+		{
+			lanes[j] = (lanes[j] ^ words[j]) * Hash::FNV1aPrime;
+		}
+	}
+
+	lanes[0u] = Hash::FNV1a(bytes + i, size - i, lanes[0u]);
+
+	return Hash::FNV1a(lanes, sizeof(lanes));
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::ErrorCode PDB::ValidateSymbolIndexCache(const void* data, size_t size, const GUID& guid, uint32_t age) PDB_NO_EXCEPT
+{
+	using Header = SymbolIndexCache::Header;
+
+	if (size < sizeof(Header))
+	{
+		return ErrorCode::InvalidDataSize;
+	}
+
+	const Header* header = Pointer::Offset<const Header*>(data, 0u);
+	if (header->magic != SymbolIndexCache::Magic)
+	{
+		return ErrorCode::InvalidSignature;
+	}
+
+	if (header->version != SymbolIndexCache::Version)
+	{
+		return ErrorCode::UnknownVersion;
+	}
+
+	// a cache built from a different PDB, or an older build of the same PDB, must not be used
+	if ((memcmp(&header->guid, &guid, sizeof(GUID)) != 0) || (header->age != age))
+	{
+		return ErrorCode::MismatchingPDB;
+	}
+
+	if ((header->size < sizeof(Header)) || (header->size > size))
+	{
+		return ErrorCode::InvalidDataSize;
+	}
+
+	// make sure that all tables are stored within the cache, so that lookups never read outside of it
+	const uint32_t cacheSize = header->size;
+	const bool areTablesInBounds =
+		IsTableInBounds(header->functionsOffset, header->functionCount, sizeof(SymbolIndexCache::Function), 4u, cacheSize) &&
+		IsTableInBounds(header->functionNamesOffset, header->functionNamesSize, sizeof(char), 1u, cacheSize) &&
+		IsTableInBounds(header->lineBlockRVAsOffset, header->lineBlockCount, sizeof(uint32_t), 4u, cacheSize) &&
+		(header->lineBlockCount != 0xFFFFFFFFu) &&
+		IsTableInBounds(header->lineBlockOffsetsOffset, header->lineBlockCount + 1u, sizeof(uint32_t), 4u, cacheSize) &&
+		IsTableInBounds(header->lineDataOffset, header->lineDataSize, sizeof(Byte), 1u, cacheSize) &&
+		IsTableInBounds(header->filenamesOffset, header->filenamesSize, sizeof(char), 1u, cacheSize) &&
+		IsTableInBounds(header->contributionsOffset, header->contributionCount, sizeof(SymbolIndexCache::Contribution), 4u, cacheSize);
+
+	if (!areTablesInBounds)
+	{
+		return ErrorCode::InvalidDataSize;
+	}
+
+	// the contents of the tables are not validated individually. they are written by SymbolIndexCacheWriter and
+	// protected against corruption by the checksum.
+	const uint32_t checksum = ComputeSymbolIndexCacheChecksum(Pointer::Offset<const void*>(data, sizeof(Header)), cacheSize - sizeof(Header));
+	if (checksum != header->checksum)
+	{
+		return ErrorCode::InvalidChecksum;
+	}
+
+	return ErrorCode::Success;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::SymbolIndexCache PDB::CreateSymbolIndexCache(const void* data) PDB_NO_EXCEPT
+{
+	return SymbolIndexCache { data };
+}
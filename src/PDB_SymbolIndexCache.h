@@ -0,0 +1,135 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_ArrayView.h"
+#include "PDB_ErrorCodes.h"
+#include "PDB_LineIndex.h"
+#include "PDB_Types.h"
+
+
+namespace PDB
+{
+	// Provides lookups into a symbol index cache, a file storing the address-to-function, address-to-line and section
+	// contribution tables of a PDB, so that they don't have to be rebuilt from the PDB each time.
+	// the cache is written by SymbolIndexCacheWriter and consists of a header followed by tables that are used in place,
+	// so a cache can be memory-mapped and queried without any parsing. all tables are 4-byte aligned.
+	// the cache stores the filenames of all lines as well, so that lookups don't need the PDB's "/names" stream.
+	// a cache is identified by the GUID and age of the PDB it was built from, see InfoStream::GetHeader().
+	class PDB_NO_DISCARD SymbolIndexCache
+	{
+	public:
+		static constexpr const uint32_t Magic = 0x43535052u;		// "RPSC"
+		static constexpr const uint32_t Version = 2u;
+
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			GUID guid;
+			uint32_t age;
+			uint32_t size;							// size of the cache including the header
+			uint32_t checksum;						// checksum of everything following the header
+
+			uint32_t functionCount;
+			uint32_t functionsOffset;				// Function[functionCount], sorted by RVA
+			uint32_t functionNamesOffset;			// null-terminated names referred to by Function::nameOffset
+			uint32_t functionNamesSize;
+
+			uint32_t lineCount;
+			uint32_t lineBlockCount;
+			uint32_t lineBlockRVAsOffset;			// uint32_t[lineBlockCount]
+			uint32_t lineBlockOffsetsOffset;		// uint32_t[lineBlockCount + 1]
+			uint32_t lineDataOffset;				// delta-encoded lines, see LineIndex
+			uint32_t lineDataSize;
+			uint32_t filenamesOffset;				// null-terminated filenames referred to by LineIndex::Line::filenameOffset
+			uint32_t filenamesSize;
+
+			uint32_t contributionCount;
+			uint32_t contributionsOffset;			// Contribution[contributionCount], sorted by RVA
+		};
+
+		struct Function
+		{
+			uint32_t rva;
+			uint32_t size;
+			uint32_t nameOffset;
+		};
+
+		struct Contribution
+		{
+			uint32_t rva;
+			uint32_t size;
+			uint32_t moduleIndex;
+		};
+
+		SymbolIndexCache(void) PDB_NO_EXCEPT;
+		explicit SymbolIndexCache(const void* data) PDB_NO_EXCEPT;
+
+		PDB_DEFAULT_MOVE(SymbolIndexCache);
+
+		// Returns the header of the cache.
+		PDB_NO_DISCARD inline const Header* GetHeader(void) const PDB_NO_EXCEPT
+		{
+			return m_header;
+		}
+
+		// Finds the function containing the given RVA. Returns nullptr if no function contains the RVA.
+		PDB_NO_DISCARD const Function* FindFunction(uint32_t rva) const PDB_NO_EXCEPT;
+
+		// Finds the section contribution containing the given RVA. Returns nullptr if no contribution contains the RVA.
+		PDB_NO_DISCARD const Contribution* FindContribution(uint32_t rva) const PDB_NO_EXCEPT;
+
+		// Returns the name of the given function.
+		PDB_NO_DISCARD inline const char* GetFunctionName(const Function& function) const PDB_NO_EXCEPT
+		{
+			return m_functionNames + function.nameOffset;
+		}
+
+		// Returns the filename of the given line, which is empty if the line's file is unknown.
+		PDB_NO_DISCARD inline const char* GetFilename(const LineIndex::Line& line) const PDB_NO_EXCEPT
+		{
+			return m_filenames + line.filenameOffset;
+		}
+
+		// Returns a view of all functions, sorted by RVA.
+		PDB_NO_DISCARD inline ArrayView<Function> GetFunctions(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<Function>(m_functions, m_header ? m_header->functionCount : 0u);
+		}
+
+		// Returns a view of all section contributions, sorted by RVA.
+		PDB_NO_DISCARD inline ArrayView<Contribution> GetContributions(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<Contribution>(m_contributions, m_header ? m_header->contributionCount : 0u);
+		}
+
+		// Returns the address-to-line index, which refers to the lines stored in the cache.
+		PDB_NO_DISCARD inline const LineIndex& GetLineIndex(void) const PDB_NO_EXCEPT
+		{
+			return m_lineIndex;
+		}
+
+	private:
+		const Header* m_header;
+		const Function* m_functions;
+		const char* m_functionNames;
+		const char* m_filenames;
+		const Contribution* m_contributions;
+		LineIndex m_lineIndex;
+
+		PDB_DISABLE_COPY(SymbolIndexCache);
+	};
+
+	// Computes the checksum of the data following the header of a symbol index cache.
+	PDB_NO_DISCARD uint32_t ComputeSymbolIndexCacheChecksum(const void* data, size_t size) PDB_NO_EXCEPT;
+
+	// Validates whether a symbol index cache is intact and was built from the PDB with the given GUID and age.
+	// this touches all of the cache's data once in order to verify its checksum.
+	PDB_NO_DISCARD ErrorCode ValidateSymbolIndexCache(const void* data, size_t size, const GUID& guid, uint32_t age) PDB_NO_EXCEPT;
+
+	// Creates a symbol index cache from data that must have been validated.
+	PDB_NO_DISCARD SymbolIndexCache CreateSymbolIndexCache(const void* data) PDB_NO_EXCEPT;
+}
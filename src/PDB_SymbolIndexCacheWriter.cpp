@@ -0,0 +1,463 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_SymbolIndexCacheWriter.h"
+#include "PDB_SymbolIndexCache.h"
+#include "PDB_RawFile.h"
+#include "PDB_InfoStream.h"
+#include "PDB_DBIStream.h"
+#include "PDB_LineIndex.h"
+#include "PDB_NamesStream.h"
+#include "Foundation/PDB_RadixSort.h"
+#include "Foundation/PDB_Memory.h"
+#include "Foundation/PDB_CRT.h"
+
+
+namespace
+{
+	struct RawFunction
+	{
+		uint32_t rva;
+		uint32_t size;
+		uint32_t nameOffset;
+		bool isPublic;
+	};
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	template <typename T>
+	static void Grow(T*& array, size_t count, size_t& capacity, size_t requiredCapacity) PDB_NO_EXCEPT
+	{
+		if (requiredCapacity <= capacity)
+		{
+			return;
+		}
+
+		// grow geometrically to keep the number of copies low
+		size_t newCapacity = (capacity < 1024u) ? 1024u : capacity * 2u;
+		while (newCapacity < requiredCapacity)
+		{
+			newCapacity *= 2u;
+		}
+
+		T* newArray = PDB_NEW_ARRAY(T, newCapacity);
+		if (count != 0u)
+		{
+			memcpy(newArray, array, sizeof(T) * count);
+		}
+
+		PDB_DELETE_ARRAY(array);
+		array = newArray;
+		capacity = newCapacity;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline uint32_t AllocateTable(size_t& size, size_t tableSize) PDB_NO_EXCEPT
+	{
+		// all tables are 4-byte aligned so they can be used in place
+		const size_t offset = PDB::BitUtil::RoundUpToMultiple<size_t>(size, 4u);
+		size = offset + tableSize;
+
+		return static_cast<uint32_t>(offset);
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SymbolIndexCacheWriter::SymbolIndexCacheWriter(void) PDB_NO_EXCEPT
+	: m_data(nullptr)
+	, m_size(0u)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SymbolIndexCacheWriter::SymbolIndexCacheWriter(SymbolIndexCacheWriter&& other) PDB_NO_EXCEPT
+	: m_data(PDB_MOVE(other.m_data))
+	, m_size(PDB_MOVE(other.m_size))
+{
+	other.m_data = nullptr;
+	other.m_size = 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SymbolIndexCacheWriter& PDB::SymbolIndexCacheWriter::operator=(SymbolIndexCacheWriter&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		PDB_DELETE_ARRAY(m_data);
+
+		m_data = PDB_MOVE(other.m_data);
+		m_size = PDB_MOVE(other.m_size);
+
+		other.m_data = nullptr;
+		other.m_size = 0u;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SymbolIndexCacheWriter::SymbolIndexCacheWriter(const RawFile& file, const InfoStream& infoStream, const DBIStream& dbiStream) PDB_NO_EXCEPT
+	: m_data(nullptr)
+	, m_size(0u)
+{
+	const ImageSectionStream imageSectionStream = dbiStream.CreateImageSectionStream(file);
+	const ModuleInfoStream moduleInfoStream = dbiStream.CreateModuleInfoStream(file);
+
+	// gather functions along with a copy of their names, because the streams they are stored in are not kept around
+	RawFunction* rawFunctions = nullptr;
+	size_t rawFunctionCount = 0u;
+	size_t rawFunctionCapacity = 0u;
+
+	char* names = nullptr;
+	size_t namesSize = 0u;
+	size_t namesCapacity = 0u;
+
+	auto addFunction = [&rawFunctions, &rawFunctionCount, &rawFunctionCapacity, &names, &namesSize, &namesCapacity](const char* name, uint32_t rva, uint32_t size, bool isPublic)
+	{
+		const size_t nameLength = strlen(name);
+		Grow(names, namesSize, namesCapacity, namesSize + nameLength + 1u);
+		memcpy(names + namesSize, name, nameLength + 1u);
+
+		Grow(rawFunctions, rawFunctionCount, rawFunctionCapacity, rawFunctionCount + 1u);
+		rawFunctions[rawFunctionCount] = RawFunction { rva, size, static_cast<uint32_t>(namesSize), isPublic };
+		++rawFunctionCount;
+
+		namesSize += nameLength + 1u;
+	};
+
+	for (const ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+	{
+		if (!module.HasSymbolStream())
+		{
+			continue;
+		}
+
+		const ModuleSymbolStream moduleSymbolStream = module.CreateSymbolStream(file);
+		moduleSymbolStream.ForEachSymbol([&imageSectionStream, &addFunction](const CodeView::DBI::Record* record)
+		{
+			const char* name = nullptr;
+			uint32_t rva = 0u;
+			uint32_t size = 0u;
+			if (record->header.kind == CodeView::DBI::SymbolRecordKind::S_LPROC32)
+			{
+				name = record->data.S_LPROC32.name;
+				rva = imageSectionStream.ConvertSectionOffsetToRVA(record->data.S_LPROC32.section, record->data.S_LPROC32.offset);
+				size = record->data.S_LPROC32.codeSize;
+			}
+			else if (record->header.kind == CodeView::DBI::SymbolRecordKind::S_GPROC32)
+			{
+				name = record->data.S_GPROC32.name;
+				rva = imageSectionStream.ConvertSectionOffsetToRVA(record->data.S_GPROC32.section, record->data.S_GPROC32.offset);
+				size = record->data.S_GPROC32.codeSize;
+			}
+			else if (record->header.kind == CodeView::DBI::SymbolRecordKind::S_LPROC32_ID)
+			{
+				name = record->data.S_LPROC32_ID.name;
+				rva = imageSectionStream.ConvertSectionOffsetToRVA(record->data.S_LPROC32_ID.section, record->data.S_LPROC32_ID.offset);
+				size = record->data.S_LPROC32_ID.codeSize;
+			}
+			else if (record->header.kind == CodeView::DBI::SymbolRecordKind::S_GPROC32_ID)
+			{
+				name = record->data.S_GPROC32_ID.name;
+				rva = imageSectionStream.ConvertSectionOffsetToRVA(record->data.S_GPROC32_ID.section, record->data.S_GPROC32_ID.offset);
+				size = record->data.S_GPROC32_ID.codeSize;
+			}
+
+			if (rva == 0u)
+			{
+				return;
+			}
+
+			addFunction(name, rva, size, false);
+		});
+	}
+
+	// public function symbols cover functions of modules without private symbols
+	{
+		const CoalescedMSFStream symbolRecordStream = dbiStream.CreateSymbolRecordStream(file);
+		const PublicSymbolStream publicSymbolStream = dbiStream.CreatePublicSymbolStream(file);
+
+		for (const HashRecord& hashRecord : publicSymbolStream.GetRecords())
+		{
+			const CodeView::DBI::Record* record = publicSymbolStream.GetRecord(symbolRecordStream, hashRecord);
+			if (record->header.kind != CodeView::DBI::SymbolRecordKind::S_PUB32)
+			{
+				continue;
+			}
+
+			if ((PDB_AS_UNDERLYING(record->data.S_PUB32.flags) & PDB_AS_UNDERLYING(CodeView::DBI::PublicSymbolFlags::Function)) == 0u)
+			{
+				continue;
+			}
+
+			const uint32_t rva = imageSectionStream.ConvertSectionOffsetToRVA(record->data.S_PUB32.section, record->data.S_PUB32.offset);
+			if (rva == 0u)
+			{
+				continue;
+			}
+
+			addFunction(record->data.S_PUB32.name, rva, 0u, true);
+		}
+	}
+
+	// sort functions by RVA. the sort is stable, so module functions come before public symbols at the same RVA.
+	uint32_t* functionOrder = PDB_NEW_ARRAY(uint32_t, rawFunctionCount);
+	{
+		uint32_t* rvas = PDB_NEW_ARRAY(uint32_t, rawFunctionCount);
+		uint32_t* scratch = PDB_NEW_ARRAY(uint32_t, rawFunctionCount);
+		for (size_t i = 0u; i < rawFunctionCount; ++i)
+		{
+			rvas[i] = rawFunctions[i].rva;
+			functionOrder[i] = static_cast<uint32_t>(i);
+		}
+
+		RadixSort::SortIndices(rvas, functionOrder, scratch, rawFunctionCount);
+
+		PDB_DELETE_ARRAY(scratch);
+		PDB_DELETE_ARRAY(rvas);
+	}
+
+	// keep only the first function at each RVA, and let public functions extend up to the next function
+	SymbolIndexCache::Function* functions = PDB_NEW_ARRAY(SymbolIndexCache::Function, rawFunctionCount);
+	size_t functionCount = 0u;
+	bool isPreviousPublic = false;
+	for (size_t i = 0u; i < rawFunctionCount; ++i)
+	{
+		const RawFunction& rawFunction = rawFunctions[functionOrder[i]];
+		if ((functionCount != 0u) && (functions[functionCount - 1u].rva == rawFunction.rva))
+		{
+			continue;
+		}
+
+		if ((functionCount != 0u) && isPreviousPublic)
+		{
+			SymbolIndexCache::Function& previous = functions[functionCount - 1u];
+			previous.size = rawFunction.rva - previous.rva;
+		}
+
+		functions[functionCount] = SymbolIndexCache::Function { rawFunction.rva, rawFunction.size, rawFunction.nameOffset };
+		++functionCount;
+		isPreviousPublic = rawFunction.isPublic;
+	}
+
+	PDB_DELETE_ARRAY(functionOrder);
+	PDB_DELETE_ARRAY(rawFunctions);
+
+	// gather section contributions sorted by RVA
+	const SectionContributionStream sectionContributionStream = dbiStream.CreateSectionContributionStream(file);
+	const ArrayView<DBI::SectionContribution> sectionContributions = sectionContributionStream.GetContributions();
+
+	SymbolIndexCache::Contribution* contributions = PDB_NEW_ARRAY(SymbolIndexCache::Contribution, sectionContributions.GetLength());
+	size_t contributionCount = 0u;
+	{
+		SymbolIndexCache::Contribution* unsortedContributions = PDB_NEW_ARRAY(SymbolIndexCache::Contribution, sectionContributions.GetLength());
+		uint32_t* rvas = PDB_NEW_ARRAY(uint32_t, sectionContributions.GetLength());
+		for (const DBI::SectionContribution& sectionContribution : sectionContributions)
+		{
+			const uint32_t rva = imageSectionStream.ConvertSectionOffsetToRVA(sectionContribution.section, sectionContribution.offset);
+			if ((rva == 0u) || (sectionContribution.size == 0u))
+			{
+				continue;
+			}
+
+			unsortedContributions[contributionCount] = SymbolIndexCache::Contribution { rva, sectionContribution.size, sectionContribution.moduleIndex };
+			rvas[contributionCount] = rva;
+			++contributionCount;
+		}
+
+		uint32_t* order = PDB_NEW_ARRAY(uint32_t, contributionCount);
+		uint32_t* scratch = PDB_NEW_ARRAY(uint32_t, contributionCount);
+		for (size_t i = 0u; i < contributionCount; ++i)
+		{
+			order[i] = static_cast<uint32_t>(i);
+		}
+
+		RadixSort::SortIndices(rvas, order, scratch, contributionCount);
+
+		for (size_t i = 0u; i < contributionCount; ++i)
+		{
+			contributions[i] = unsortedContributions[order[i]];
+		}
+
+		PDB_DELETE_ARRAY(scratch);
+		PDB_DELETE_ARRAY(order);
+		PDB_DELETE_ARRAY(rvas);
+		PDB_DELETE_ARRAY(unsortedContributions);
+	}
+
+	// lines refer to their file by an offset into the "/names" stream. the filenames are copied into the cache, and
+	// the lines are re-encoded with offsets into the copied filenames, so that lookups don't need the PDB.
+	const LineIndex pdbLineIndex(file, moduleInfoStream, imageSectionStream);
+	const size_t lineCount = pdbLineIndex.GetLineCount();
+	LineIndex::Line* lines = PDB_NEW_ARRAY(LineIndex::Line, lineCount);
+	{
+		size_t i = 0u;
+		pdbLineIndex.ForEachLine([lines, &i](const LineIndex::Line& line)
+		{
+			lines[i] = line;
+			++i;
+		});
+	}
+
+	// offset zero denotes an unknown file, both in the "/names" stream and in the cache
+	char* filenames = nullptr;
+	size_t filenamesSize = 1u;
+	size_t filenamesCapacity = 0u;
+	Grow(filenames, 0u, filenamesCapacity, filenamesSize);
+	filenames[0] = '\0';
+
+	if (infoStream.HasNamesStream())
+	{
+		const NamesStream namesStream = infoStream.CreateNamesStream(file);
+
+		// visit the lines ordered by filename offset, so that each filename is copied only once
+		uint32_t* namesOffsets = PDB_NEW_ARRAY(uint32_t, lineCount);
+		uint32_t* order = PDB_NEW_ARRAY(uint32_t, lineCount);
+		uint32_t* scratch = PDB_NEW_ARRAY(uint32_t, lineCount);
+		for (size_t i = 0u; i < lineCount; ++i)
+		{
+			namesOffsets[i] = lines[i].filenameOffset;
+			order[i] = static_cast<uint32_t>(i);
+		}
+
+		RadixSort::SortIndices(namesOffsets, order, scratch, lineCount);
+
+		uint32_t previousNamesOffset = 0u;
+		uint32_t filenameOffset = 0u;
+		for (size_t i = 0u; i < lineCount; ++i)
+		{
+			LineIndex::Line& line = lines[order[i]];
+			if (line.filenameOffset != previousNamesOffset)
+			{
+				previousNamesOffset = line.filenameOffset;
+				filenameOffset = static_cast<uint32_t>(filenamesSize);
+
+				const char* filename = namesStream.GetFilename(line.filenameOffset);
+				const size_t filenameLength = strlen(filename);
+				Grow(filenames, filenamesSize, filenamesCapacity, filenamesSize + filenameLength + 1u);
+				memcpy(filenames + filenamesSize, filename, filenameLength + 1u);
+				filenamesSize += filenameLength + 1u;
+			}
+
+			line.filenameOffset = filenameOffset;
+		}
+
+		PDB_DELETE_ARRAY(scratch);
+		PDB_DELETE_ARRAY(order);
+		PDB_DELETE_ARRAY(namesOffsets);
+	}
+	else
+	{
+		for (size_t i = 0u; i < lineCount; ++i)
+		{
+			lines[i].filenameOffset = 0u;
+		}
+	}
+
+	// the line index is stored in its delta-encoded form
+	const LineIndex lineIndex(lines, lineCount);
+	const LineIndex::EncodedLines encodedLines = lineIndex.GetEncodedLines();
+	PDB_DELETE_ARRAY(lines);
+
+	// lay out all tables, storing the byte-sized ones last so that fewer padding bytes are needed
+	SymbolIndexCache::Header header = {};
+	size_t size = sizeof(SymbolIndexCache::Header);
+	header.functionsOffset = AllocateTable(size, sizeof(SymbolIndexCache::Function) * functionCount);
+	header.contributionsOffset = AllocateTable(size, sizeof(SymbolIndexCache::Contribution) * contributionCount);
+	header.lineBlockRVAsOffset = AllocateTable(size, sizeof(uint32_t) * encodedLines.blockCount);
+	header.lineBlockOffsetsOffset = AllocateTable(size, sizeof(uint32_t) * (encodedLines.blockCount + 1u));
+	header.functionNamesOffset = AllocateTable(size, namesSize);
+	header.lineDataOffset = AllocateTable(size, encodedLines.dataSize);
+	header.filenamesOffset = AllocateTable(size, filenamesSize);
+	size = BitUtil::RoundUpToMultiple<size_t>(size, 4u);
+
+	// all offsets and sizes are stored as 32-bit values, so a cache exceeding 4 GiB cannot be built and the writer is left empty
+	if (size > 0xFFFFFFFFu)
+	{
+		PDB_DELETE_ARRAY(contributions);
+		PDB_DELETE_ARRAY(functions);
+		PDB_DELETE_ARRAY(names);
+		PDB_DELETE_ARRAY(filenames);
+
+		return;
+	}
+
+	header.magic = SymbolIndexCache::Magic;
+	header.version = SymbolIndexCache::Version;
+	header.guid = infoStream.GetHeader()->guid;
+	header.age = infoStream.GetHeader()->age;
+	header.size = static_cast<uint32_t>(size);
+	header.functionCount = static_cast<uint32_t>(functionCount);
+	header.functionNamesSize = static_cast<uint32_t>(namesSize);
+	header.lineCount = static_cast<uint32_t>(encodedLines.lineCount);
+	header.lineBlockCount = encodedLines.blockCount;
+	header.lineDataSize = static_cast<uint32_t>(encodedLines.dataSize);
+	header.filenamesSize = static_cast<uint32_t>(filenamesSize);
+	header.contributionCount = static_cast<uint32_t>(contributionCount);
+
+	// padding bytes are cleared so that the checksum and the file contents are deterministic
+	m_size = size;
+	m_data = PDB_NEW_ARRAY(Byte, size);
+	memset(m_data, 0, size);
+
+	if (functionCount != 0u)
+	{
+		memcpy(m_data + header.functionsOffset, functions, sizeof(SymbolIndexCache::Function) * functionCount);
+	}
+
+	if (contributionCount != 0u)
+	{
+		memcpy(m_data + header.contributionsOffset, contributions, sizeof(SymbolIndexCache::Contribution) * contributionCount);
+	}
+
+	// an empty line index has no block offsets, which is stored as a single end offset of zero
+	if (encodedLines.blockCount != 0u)
+	{
+		memcpy(m_data + header.lineBlockRVAsOffset, encodedLines.blockRVAs, sizeof(uint32_t) * encodedLines.blockCount);
+		memcpy(m_data + header.lineBlockOffsetsOffset, encodedLines.blockOffsets, sizeof(uint32_t) * (encodedLines.blockCount + 1u));
+		memcpy(m_data + header.lineDataOffset, encodedLines.data, encodedLines.dataSize);
+	}
+
+	if (namesSize != 0u)
+	{
+		memcpy(m_data + header.functionNamesOffset, names, namesSize);
+	}
+
+	memcpy(m_data + header.filenamesOffset, filenames, filenamesSize);
+
+	header.checksum = ComputeSymbolIndexCacheChecksum(m_data + sizeof(SymbolIndexCache::Header), size - sizeof(SymbolIndexCache::Header));
+	memcpy(m_data, &header, sizeof(SymbolIndexCache::Header));
+
+	PDB_DELETE_ARRAY(contributions);
+	PDB_DELETE_ARRAY(functions);
+	PDB_DELETE_ARRAY(names);
+	PDB_DELETE_ARRAY(filenames);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::SymbolIndexCacheWriter::~SymbolIndexCacheWriter(void) PDB_NO_EXCEPT
+{
+	PDB_DELETE_ARRAY(m_data);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::SymbolIndexCacheWriter PDB::CreateSymbolIndexCacheWriter(const RawFile& file, const InfoStream& infoStream, const DBIStream& dbiStream) PDB_NO_EXCEPT
+{
+	return SymbolIndexCacheWriter { file, infoStream, dbiStream };
+}
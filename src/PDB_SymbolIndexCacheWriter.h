@@ -0,0 +1,51 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_ArrayView.h"
+#include "PDB_Types.h"
+
+
+namespace PDB
+{
+	class RawFile;
+	class InfoStream;
+	class DBIStream;
+
+
+	// Builds the address-to-function, address-to-line and section contribution tables of a PDB, and serializes them
+	// into a symbol index cache that can be stored on disk and loaded using SymbolIndexCache.
+	// functions are gathered from the S_*PROC32 records of all modules, completed by public function symbols that
+	// no module knows about. the size of a public function extends up to the next function, which leaves a public
+	// function at the very end of the image without a size.
+	// the filenames of all lines are copied from the "/names" stream into the cache.
+	class PDB_NO_DISCARD SymbolIndexCacheWriter
+	{
+	public:
+		SymbolIndexCacheWriter(void) PDB_NO_EXCEPT;
+		SymbolIndexCacheWriter(SymbolIndexCacheWriter&& other) PDB_NO_EXCEPT;
+		SymbolIndexCacheWriter& operator=(SymbolIndexCacheWriter&& other) PDB_NO_EXCEPT;
+
+		// Builds a cache from a PDB whose symbol record, public symbol, image section and section contribution streams
+		// have been validated. the cache is left empty if it would exceed the maximum size of 4 GiB.
+		explicit SymbolIndexCacheWriter(const RawFile& file, const InfoStream& infoStream, const DBIStream& dbiStream) PDB_NO_EXCEPT;
+		~SymbolIndexCacheWriter(void) PDB_NO_EXCEPT;
+
+		// Returns the serialized cache, which can be written to disk as is, or an empty view if the cache could not be built.
+		PDB_NO_DISCARD inline ArrayView<Byte> GetData(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<Byte>(m_data, m_size);
+		}
+
+	private:
+		Byte* m_data;
+		size_t m_size;
+
+		PDB_DISABLE_COPY(SymbolIndexCacheWriter);
+	};
+
+	// Builds a symbol index cache from a PDB.
+	PDB_NO_DISCARD SymbolIndexCacheWriter CreateSymbolIndexCacheWriter(const RawFile& file, const InfoStream& infoStream, const DBIStream& dbiStream) PDB_NO_EXCEPT;
+}
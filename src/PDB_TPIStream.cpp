@@ -2,7 +2,9 @@
 #include "PDB_TPIStream.h"
 #include "PDB_RawFile.h"
 #include "PDB_DirectMSFStream.h"
+#include "Foundation/PDB_Hash.h"
 #include "Foundation/PDB_Memory.h"
+#include "Foundation/PDB_CRT.h"
 
 namespace
 {
@@ -17,6 +19,11 @@ PDB::TPIStream::TPIStream(void) PDB_NO_EXCEPT
 	: m_stream()
 	, m_header()
 	, m_recordCount(0u)
+	, m_typeIndexOffsets(nullptr)
+	, m_typeIndexOffsetCount(0u)
+	, m_hashBucketOffsets(nullptr)
+	, m_hashBucketRecords(nullptr)
+	, m_hashBucketCount(0u)
 {
 }
 
@@ -27,8 +34,18 @@ PDB::TPIStream::TPIStream(TPIStream&& other) PDB_NO_EXCEPT
 	: m_stream(PDB_MOVE(other.m_stream))
 	, m_header(PDB_MOVE(other.m_header))
 	, m_recordCount(PDB_MOVE(other.m_recordCount))
+	, m_typeIndexOffsets(PDB_MOVE(other.m_typeIndexOffsets))
+	, m_typeIndexOffsetCount(PDB_MOVE(other.m_typeIndexOffsetCount))
+	, m_hashBucketOffsets(PDB_MOVE(other.m_hashBucketOffsets))
+	, m_hashBucketRecords(PDB_MOVE(other.m_hashBucketRecords))
+	, m_hashBucketCount(PDB_MOVE(other.m_hashBucketCount))
 {
 	other.m_recordCount = 0u;
+	other.m_typeIndexOffsets = nullptr;
+	other.m_typeIndexOffsetCount = 0u;
+	other.m_hashBucketOffsets = nullptr;
+	other.m_hashBucketRecords = nullptr;
+	other.m_hashBucketCount = 0u;
 }
 
 
@@ -38,11 +55,25 @@ PDB::TPIStream& PDB::TPIStream::operator=(TPIStream&& other) PDB_NO_EXCEPT
 {
 	if (this != &other)
 	{
+		PDB_DELETE_ARRAY(m_typeIndexOffsets);
+		PDB_DELETE_ARRAY(m_hashBucketOffsets);
+		PDB_DELETE_ARRAY(m_hashBucketRecords);
+
 		m_stream = PDB_MOVE(other.m_stream);
 		m_header = PDB_MOVE(other.m_header);
 		m_recordCount = PDB_MOVE(other.m_recordCount);
+		m_typeIndexOffsets = PDB_MOVE(other.m_typeIndexOffsets);
+		m_typeIndexOffsetCount = PDB_MOVE(other.m_typeIndexOffsetCount);
+		m_hashBucketOffsets = PDB_MOVE(other.m_hashBucketOffsets);
+		m_hashBucketRecords = PDB_MOVE(other.m_hashBucketRecords);
+		m_hashBucketCount = PDB_MOVE(other.m_hashBucketCount);
 
 		other.m_recordCount = 0u;
+		other.m_typeIndexOffsets = nullptr;
+		other.m_typeIndexOffsetCount = 0u;
+		other.m_hashBucketOffsets = nullptr;
+		other.m_hashBucketRecords = nullptr;
+		other.m_hashBucketCount = 0u;
 	}
 
 	return *this;
@@ -54,10 +85,240 @@ PDB::TPIStream& PDB::TPIStream::operator=(TPIStream&& other) PDB_NO_EXCEPT
 PDB::TPIStream::TPIStream(const RawFile& file) PDB_NO_EXCEPT
 	: m_stream(file.CreateMSFStream<DirectMSFStream>(TPIStreamIndex)),
 	  m_header(m_stream.ReadAtOffset<TPI::StreamHeader>(0u)),
-	  m_recordCount(GetLastTypeIndex() - GetFirstTypeIndex())
+	  m_recordCount(GetLastTypeIndex() - GetFirstTypeIndex()),
+	  m_typeIndexOffsets(nullptr),
+	  m_typeIndexOffsetCount(0u),
+	  m_hashBucketOffsets(nullptr),
+	  m_hashBucketRecords(nullptr),
+	  m_hashBucketCount(0u)
+{
+	// the hash stream is optional
+	if ((m_header.hashStreamIndex == PDB::NilStreamIndex) || (m_header.hashStreamIndex >= file.GetStreamCount()))
+	{
+		return;
+	}
+
+	const DirectMSFStream hashStream = file.CreateMSFStream<DirectMSFStream>(m_header.hashStreamIndex);
+
+	const uint32_t indexOffsetBufferOffset = static_cast<uint32_t>(m_header.indexOffsetBufferOffset);
+	if ((m_header.indexOffsetBufferOffset >= 0) && (indexOffsetBufferOffset + m_header.indexOffsetBufferLength <= hashStream.GetSize()))
+	{
+		m_typeIndexOffsetCount = m_header.indexOffsetBufferLength / sizeof(TPI::TypeIndexOffset);
+		if (m_typeIndexOffsetCount != 0u)
+		{
+			m_typeIndexOffsets = PDB_NEW_ARRAY(TPI::TypeIndexOffset, m_typeIndexOffsetCount);
+			hashStream.ReadAtOffset(m_typeIndexOffsets, m_typeIndexOffsetCount * sizeof(TPI::TypeIndexOffset), indexOffsetBufferOffset);
+		}
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::TPIStream::BuildNameIndex(const RawFile& file) PDB_NO_EXCEPT
+{
+	// the index only needs to be built once, and the hash stream is optional
+	if ((m_hashBucketCount != 0u) || (m_header.hashStreamIndex == PDB::NilStreamIndex) || (m_header.hashStreamIndex >= file.GetStreamCount()))
+	{
+		return;
+	}
+
+	const DirectMSFStream hashStream = file.CreateMSFStream<DirectMSFStream>(m_header.hashStreamIndex);
+
+	// the hash value buffer stores the hash bucket of each record. in order to walk a bucket, the records are sorted by bucket.
+	const uint32_t hashValueBufferOffset = static_cast<uint32_t>(m_header.hashValueBufferOffset);
+	if ((m_header.hashValueBufferOffset >= 0) && (hashValueBufferOffset + m_header.hashValueBufferLength <= hashStream.GetSize()) &&
+		(m_header.hashKeySize == sizeof(uint32_t)) && (m_header.numHashBuckets != 0u) && (m_header.hashValueBufferLength / sizeof(uint32_t) == m_recordCount))
+	{
+		uint32_t* hashValues = PDB_NEW_ARRAY(uint32_t, m_recordCount);
+		hashStream.ReadAtOffset(hashValues, m_recordCount * sizeof(uint32_t), hashValueBufferOffset);
+
+		m_hashBucketCount = m_header.numHashBuckets;
+		m_hashBucketOffsets = PDB_NEW_ARRAY(uint32_t, m_hashBucketCount + 1u);
+		m_hashBucketRecords = PDB_NEW_ARRAY(uint32_t, m_recordCount);
+		memset(m_hashBucketOffsets, 0, sizeof(uint32_t) * (m_hashBucketCount + 1u));
+
+		for (size_t i = 0u; i < m_recordCount; ++i)
+		{
+			if (hashValues[i] < m_hashBucketCount)
+			{
+				++m_hashBucketOffsets[hashValues[i] + 1u];
+			}
+		}
+
+		for (uint32_t i = 0u; i < m_hashBucketCount; ++i)
+		{
+			m_hashBucketOffsets[i + 1u] += m_hashBucketOffsets[i];
+		}
+
+		// store the records of each bucket in ascending order, using the bucket offsets as insertion cursors
+		for (size_t i = 0u; i < m_recordCount; ++i)
+		{
+			if (hashValues[i] < m_hashBucketCount)
+			{
+				m_hashBucketRecords[m_hashBucketOffsets[hashValues[i]]++] = static_cast<uint32_t>(i);
+			}
+		}
+
+		// the cursors now point to the end of each bucket, which is the start of the next one
+		for (uint32_t i = m_hashBucketCount; i > 0u; --i)
+		{
+			m_hashBucketOffsets[i] = m_hashBucketOffsets[i - 1u];
+		}
+		m_hashBucketOffsets[0u] = 0u;
+
+		PDB_DELETE_ARRAY(hashValues);
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TPIStream::~TPIStream(void) PDB_NO_EXCEPT
+{
+	PDB_DELETE_ARRAY(m_typeIndexOffsets);
+	PDB_DELETE_ARRAY(m_hashBucketOffsets);
+	PDB_DELETE_ARRAY(m_hashBucketRecords);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD size_t PDB::TPIStream::FindTypeRecordOffset(uint32_t typeIndex) const PDB_NO_EXCEPT
+{
+	if ((typeIndex < m_header.typeIndexBegin) || (typeIndex >= m_header.typeIndexEnd))
+	{
+		return 0u;
+	}
+
+	// find the last known offset of a record with an index less than or equal to the one we're looking for
+	size_t first = 0u;
+	size_t count = m_typeIndexOffsetCount;
+	while (count != 0u)
+	{
+		const size_t step = count / 2u;
+		const size_t middle = first + step;
+		if (m_typeIndexOffsets[middle].typeIndex <= typeIndex)
+		{
+			first = middle + 1u;
+			count -= step + 1u;
+		}
+		else
+		{
+			count = step;
+		}
+	}
+
+	uint32_t currentIndex = m_header.typeIndexBegin;
+	size_t offset = m_header.headerSize;
+	if (first != 0u)
+	{
+		currentIndex = m_typeIndexOffsets[first - 1u].typeIndex;
+		offset += m_typeIndexOffsets[first - 1u].offset;
+	}
+
+	// walk the remaining records
+	for (/* nothing */; currentIndex < typeIndex; ++currentIndex)
+	{
+		if (offset + sizeof(CodeView::TPI::RecordHeader) > m_stream.GetSize())
+		{
+			return 0u;
+		}
+
+		const CodeView::TPI::RecordHeader header = ReadTypeRecordHeader(offset);
+		offset += sizeof(CodeView::TPI::RecordHeader) + header.size - sizeof(uint16_t);
+	}
+
+	if (offset + sizeof(CodeView::TPI::RecordHeader) > m_stream.GetSize())
+	{
+		return 0u;
+	}
+
+	return offset;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::CoalescedMSFStream PDB::TPIStream::GetRecordAtIndex(uint32_t typeIndex) const PDB_NO_EXCEPT
+{
+	const size_t offset = FindTypeRecordOffset(typeIndex);
+	if (offset == 0u)
+	{
+		return CoalescedMSFStream();
+	}
+
+	const CodeView::TPI::RecordHeader header = ReadTypeRecordHeader(offset);
+
+	return CoalescedMSFStream(m_stream, header.size + static_cast<uint32_t>(sizeof(uint16_t)), static_cast<uint32_t>(offset));
+}
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+size_t PDB::TPIStream::FindTypesByName(const char* name, uint32_t* typeIndices, size_t maxTypeIndexCount) const PDB_NO_EXCEPT
+{
+	if (m_hashBucketCount == 0u)
+	{
+		return 0u;
+	}
+
+	const uint32_t bucket = Hash::HashStringV1(name, strlen(name)) % m_hashBucketCount;
+	const uint32_t bucketStart = m_hashBucketOffsets[bucket];
+	const uint32_t bucketEnd = m_hashBucketOffsets[bucket + 1u];
+
+	// walk the bucket twice, storing definitions in the first and forward declarations in the second pass
+	size_t count = 0u;
+	for (uint32_t pass = 0u; pass < 2u; ++pass)
+	{
+		const bool wantForwardReference = (pass == 1u);
+		for (uint32_t i = bucketStart; i < bucketEnd; ++i)
+		{
+			const uint32_t typeIndex = m_header.typeIndexBegin + m_hashBucketRecords[i];
+			const CoalescedMSFStream recordStream = GetRecordAtIndex(typeIndex);
+			if (recordStream.GetSize() == 0u)
+			{
+				continue;
+			}
+
+			const CodeView::TPI::Record* record = recordStream.GetDataAtOffset<const CodeView::TPI::Record>(0u);
+
+			CodeView::TPI::TypeProperty property = {};
+			if (!GetUDTProperty(record, property) || ((property.fwdref != 0u) != wantForwardReference))
+			{
+				continue;
+			}
+
+			const char* udtName = GetUDTName(record);
+			const char* uniqueName = GetUDTUniqueName(record, property);
+			if ((strcmp(udtName, name) != 0) && (!uniqueName || (strcmp(uniqueName, name) != 0)))
+			{
+				continue;
+			}
+
+			if (count < maxTypeIndexCount)
+			{
+				typeIndices[count] = typeIndex;
+			}
+
+			++count;
+		}
+	}
+
+	return count;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::TPIStream::FindTypeByName(const char* name) const PDB_NO_EXCEPT
 {
+	uint32_t typeIndex = 0u;
+	const size_t count = FindTypesByName(name, &typeIndex, 1u);
+
+	return (count != 0u) ? typeIndex : 0u;
 }
 
+
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB_NO_DISCARD PDB::ErrorCode PDB::HasValidTPIStream(const RawFile& file) PDB_NO_EXCEPT
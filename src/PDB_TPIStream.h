@@ -5,6 +5,7 @@
 #include "PDB_ErrorCodes.h"
 #include "PDB_TPITypes.h"
 #include "PDB_DirectMSFStream.h"
+#include "PDB_CoalescedMSFStream.h"
 #include "PDB_Util.h"
 
 // PDB TPI stream
@@ -17,11 +18,15 @@ namespace PDB
 	class PDB_NO_DISCARD TPIStream
 	{
 	public:
+		// the number of type index offsets making up one record segment, see ForEachTypeRecordInSegment()
+		static constexpr const size_t TypeIndexOffsetsPerSegment = 16u;
+
 		TPIStream(void) PDB_NO_EXCEPT;
 		TPIStream(TPIStream&& other) PDB_NO_EXCEPT;
 		TPIStream& operator=(TPIStream&& other) PDB_NO_EXCEPT;
 
 		explicit TPIStream(const RawFile& file) PDB_NO_EXCEPT;
+		~TPIStream(void) PDB_NO_EXCEPT;
 
 		PDB_NO_DISCARD inline const DirectMSFStream& GetDirectMSFStream(void) const PDB_NO_EXCEPT
 		{
@@ -46,6 +51,28 @@ namespace PDB
 			return m_recordCount;
 		}
 
+		// Returns the offset of the record with the given type index within the stream, or zero if there is no such record.
+		// uses the type index offsets stored in the hash stream to seek close to the record, so only a few records need to be walked.
+		PDB_NO_DISCARD size_t FindTypeRecordOffset(uint32_t typeIndex) const PDB_NO_EXCEPT;
+
+		// Returns the record with the given type index as a coalesced stream starting at the record header.
+		// the returned stream is empty if there is no such record. no data is copied unless the record crosses a block boundary.
+		PDB_NO_DISCARD CoalescedMSFStream GetRecordAtIndex(uint32_t typeIndex) const PDB_NO_EXCEPT;
+
+		// Builds the index of type records by hash bucket needed by FindTypesByName(), reading the hash value buffer stored
+		// in the hash stream. the index is not built by default because it needs to read a value for every record.
+		void BuildNameIndex(const RawFile& file) PDB_NO_EXCEPT;
+
+		// Finds all user-defined types with the given name or unique name by walking the matching bucket of the type hash table.
+		// definitions are stored before forward declarations. Note that the PDB hashes forward declarations by their record
+		// contents rather than by name, so they are usually not found. Finds nothing unless BuildNameIndex() was called.
+		// Returns the number of types found, which can be larger than the given maximum number of type indices.
+		size_t FindTypesByName(const char* name, uint32_t* typeIndices, size_t maxTypeIndexCount) const PDB_NO_EXCEPT;
+
+		// Returns the type index of the user-defined type with the given name, preferring definitions over forward declarations.
+		// Returns zero if no such type could be found.
+		PDB_NO_DISCARD uint32_t FindTypeByName(const char* name) const PDB_NO_EXCEPT;
+
 		CodeView::TPI::RecordHeader ReadTypeRecordHeader(size_t offset) const PDB_NO_EXCEPT
 		{
 			const CodeView::TPI::RecordHeader header = m_stream.ReadAtOffset<CodeView::TPI::RecordHeader>(offset);
@@ -69,11 +96,60 @@ namespace PDB
 			}
 		}
 
+		// Returns the type index offsets stored in the hash stream, sorted by type index.
+		PDB_NO_DISCARD inline ArrayView<TPI::TypeIndexOffset> GetTypeIndexOffsets(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<TPI::TypeIndexOffset>(m_typeIndexOffsets, m_typeIndexOffsetCount);
+		}
+
+		// Returns the number of record segments. Segments start at known record offsets, so they can be walked independently
+		// of each other, e.g. on different threads.
+		PDB_NO_DISCARD inline size_t GetRecordSegmentCount(void) const PDB_NO_EXCEPT
+		{
+			return (m_typeIndexOffsetCount == 0u) ? 1u : (m_typeIndexOffsetCount + TypeIndexOffsetsPerSegment - 1u) / TypeIndexOffsetsPerSegment;
+		}
+
+		// Calls the functor with the type index, header and offset of each record in the given segment.
+		template <typename F>
+		void ForEachTypeRecordInSegment(size_t segmentIndex, F&& functor) const PDB_NO_EXCEPT
+		{
+			uint32_t typeIndex = m_header.typeIndexBegin;
+			size_t offset = m_header.headerSize;
+			if (segmentIndex != 0u)
+			{
+				const TPI::TypeIndexOffset& start = m_typeIndexOffsets[segmentIndex * TypeIndexOffsetsPerSegment];
+				typeIndex = start.typeIndex;
+				offset += start.offset;
+			}
+
+			const size_t nextSegmentStart = (segmentIndex + 1u) * TypeIndexOffsetsPerSegment;
+			const uint32_t endTypeIndex = (nextSegmentStart < m_typeIndexOffsetCount) ? m_typeIndexOffsets[nextSegmentStart].typeIndex : m_header.typeIndexEnd;
+
+			for (/* nothing */; (typeIndex < endTypeIndex) && (offset + sizeof(CodeView::TPI::RecordHeader) <= m_stream.GetSize()); ++typeIndex)
+			{
+				const CodeView::TPI::RecordHeader header = ReadTypeRecordHeader(offset);
+
+				functor(typeIndex, header, offset);
+
+				// position the stream offset at the next record
+				offset += sizeof(CodeView::TPI::RecordHeader) + header.size - sizeof(uint16_t);
+			}
+		}
+
 	private:
 		DirectMSFStream m_stream;
 		TPI::StreamHeader m_header;
 		size_t m_recordCount;
 
+		// the type index offsets read from the hash stream, sorted by type index
+		TPI::TypeIndexOffset* m_typeIndexOffsets;
+		size_t m_typeIndexOffsetCount;
+
+		// the records of each hash bucket, stored consecutively. the offsets array has an additional entry denoting the end.
+		uint32_t* m_hashBucketOffsets;
+		uint32_t* m_hashBucketRecords;
+		uint32_t m_hashBucketCount;
+
 		PDB_DISABLE_COPY(TPIStream);
 	};
 
@@ -39,6 +39,15 @@ namespace PDB
 			int32_t hashAdjBufferOffset;
 			uint32_t hashAdjBufferLength;
 		};
+
+		// https://llvm.org/docs/PDB/TpiStream.html#type-index-offsets
+		// the hash stream stores the offset of every n-th type record (roughly every 8 KiB), allowing random access
+		// to records without walking the whole stream.
+		struct TypeIndexOffset
+		{
+			uint32_t typeIndex;
+			uint32_t offset;			// relative to the end of the TPI stream header
+		};
 	}
 
 
@@ -100,6 +109,8 @@ namespace PDB
 				LF_MEMBERMODIFY = 0x001513u,
 				LF_MANAGED = 0x001514u,
 				LF_TYPESERVER2 = 0x001515u,
+				LF_INTERFACE = 0x001519u,
+				LF_VFTABLE = 0x00151Du,
 				LF_CLASS2 = 0x001608u,
 				LF_STRUCTURE2 = 0x001609u,
 
@@ -677,6 +688,45 @@ namespace PDB
 						uint32_t index;			// index of type record for field
 						PDB_FLEXIBLE_ARRAY_MEMBER(char, name);
 					}LF_STMEMBER;
+
+					// friend class leaf
+					struct
+					{
+						uint16_t pad0;			// internal padding, must be 0
+						uint32_t index;			// index to type record of friend class
+					} LF_FRIENDCLS;
+
+					// friend function leaf
+					struct
+					{
+						uint16_t pad0;			// internal padding, must be 0
+						uint32_t index;			// index to type record of friend function
+						PDB_FLEXIBLE_ARRAY_MEMBER(char, name);
+					} LF_FRIENDFCN;
+
+					// nested type leaf with attributes
+					struct
+					{
+						MemberAttributes attributes;
+						uint32_t index;			// index of nested type definition
+						PDB_FLEXIBLE_ARRAY_MEMBER(char, name);
+					} LF_NESTTYPEEX;
+
+					// modification of a base class member
+					struct
+					{
+						MemberAttributes attributes;
+						uint32_t index;			// index of base class type definition
+						PDB_FLEXIBLE_ARRAY_MEMBER(char, name);
+					} LF_MEMBERMODIFY;
+
+					// virtual function offset leaf
+					struct
+					{
+						uint16_t pad0;			// internal padding, must be 0
+						uint32_t type;			// type index of pointer
+						int32_t offset;			// offset of virtual function table pointer
+					} LF_VFUNCOFF;
 #pragma pack(pop)
 				} data;
 			};
@@ -859,6 +909,16 @@ namespace PDB
 					{
 						FieldList list;
 					} LF_FIELD;
+
+					// virtual function table of a class
+					struct
+					{
+						uint32_t type;					// class or structure that owns the virtual function table
+						uint32_t baseVftable;			// virtual function table from which this one is derived
+						int32_t offsetInObjectLayout;	// offset of the virtual function table pointer in the object layout
+						uint32_t len;					// length of the names
+						PDB_FLEXIBLE_ARRAY_MEMBER(char, names);
+					} LF_VFTABLE;
 #pragma pack(pop)
 				} data;
 			};
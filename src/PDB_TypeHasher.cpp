@@ -0,0 +1,381 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_TypeHasher.h"
+#include "PDB_TypeTable.h"
+#include "PDB_FieldList.h"
+#include "PDB_Util.h"
+#include "Foundation/PDB_Hash.h"
+#include "Foundation/PDB_Memory.h"
+
+
+namespace
+{
+	// the high half of a hash uses a different seed than the low half, so that both halves are independent of each other
+	static constexpr const uint32_t HighHashSeed = 0x9E3779B9u;
+
+	// pointer modes of pointers to data members and member functions, which also refer to the containing class
+	static constexpr const uint32_t PointerModeDataMember = 2u;
+	static constexpr const uint32_t PointerModeMemberFunction = 3u;
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	static inline void HashBytes(PDB::TypeHash& hash, const void* data, size_t size) PDB_NO_EXCEPT
+	{
+		hash.low = PDB::Hash::FNV1a(data, size, hash.low);
+		hash.high = PDB::Hash::FNV1a(data, size, hash.high);
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static inline PDB::TypeHash HashTypeIndex(uint32_t typeIndex) PDB_NO_EXCEPT
+	{
+		PDB::TypeHash hash = { PDB::Hash::FNV1aOffsetBasis, HighHashSeed };
+		HashBytes(hash, &typeIndex, sizeof(uint32_t));
+
+		return hash;
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeHasher::TypeHasher(void) PDB_NO_EXCEPT
+	: m_hashes(nullptr)
+	, m_typeIndexBegin(0u)
+	, m_typeIndexEnd(0u)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeHasher::TypeHasher(TypeHasher&& other) PDB_NO_EXCEPT
+	: m_hashes(PDB_MOVE(other.m_hashes))
+	, m_typeIndexBegin(PDB_MOVE(other.m_typeIndexBegin))
+	, m_typeIndexEnd(PDB_MOVE(other.m_typeIndexEnd))
+{
+	other.m_hashes = nullptr;
+	other.m_typeIndexBegin = 0u;
+	other.m_typeIndexEnd = 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeHasher& PDB::TypeHasher::operator=(TypeHasher&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		PDB_DELETE_ARRAY(m_hashes);
+
+		m_hashes = PDB_MOVE(other.m_hashes);
+		m_typeIndexBegin = PDB_MOVE(other.m_typeIndexBegin);
+		m_typeIndexEnd = PDB_MOVE(other.m_typeIndexEnd);
+
+		other.m_hashes = nullptr;
+		other.m_typeIndexBegin = 0u;
+		other.m_typeIndexEnd = 0u;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeHasher::TypeHasher(const TypeTable& typeTable) PDB_NO_EXCEPT
+	: TypeHasher()
+{
+	m_typeIndexBegin = typeTable.GetFirstTypeIndex();
+	m_typeIndexEnd = typeTable.GetLastTypeIndex();
+
+	const size_t typeCount = typeTable.GetTypeRecordCount();
+	if (typeCount == 0u)
+	{
+		return;
+	}
+
+	m_hashes = PDB_NEW_ARRAY(TypeHash, typeCount);
+
+	// the offsets of the type indices referenced by a record, grown on demand for long field lists
+	size_t offsetCapacity = 256u;
+	uint32_t* offsets = PDB_NEW_ARRAY(uint32_t, offsetCapacity);
+
+	for (uint32_t typeIndex = m_typeIndexBegin; typeIndex < m_typeIndexEnd; ++typeIndex)
+	{
+		const CodeView::TPI::Record* record = typeTable.GetTypeRecord(typeIndex);
+		if (!record)
+		{
+			m_hashes[typeIndex - m_typeIndexBegin] = HashTypeIndex(typeIndex);
+			continue;
+		}
+
+		size_t offsetCount = GetTypeIndexReferences(record, offsets, offsetCapacity);
+		if (offsetCount > offsetCapacity)
+		{
+			PDB_DELETE_ARRAY(offsets);
+			offsetCapacity = offsetCount;
+			offsets = PDB_NEW_ARRAY(uint32_t, offsetCapacity);
+			offsetCount = GetTypeIndexReferences(record, offsets, offsetCapacity);
+		}
+
+		// hash the record in pieces, replacing each referenced type index by the hash of the referenced type
+		const Byte* data = reinterpret_cast<const Byte*>(record);
+		const size_t size = sizeof(uint16_t) + record->header.size;
+
+		TypeHash hash = { Hash::FNV1aOffsetBasis, HighHashSeed };
+		size_t offset = 0u;
+		for (size_t i = 0u; i < offsetCount; ++i)
+		{
+			HashBytes(hash, data + offset, offsets[i] - offset);
+
+			const uint32_t referencedIndex = *reinterpret_cast<const uint32_t*>(data + offsets[i]);
+			const TypeHash referencedHash = (referencedIndex < typeIndex) ? GetHash(referencedIndex) : HashTypeIndex(referencedIndex);
+			HashBytes(hash, &referencedHash, sizeof(TypeHash));
+
+			offset = offsets[i] + sizeof(uint32_t);
+		}
+
+		HashBytes(hash, data + offset, size - offset);
+
+		m_hashes[typeIndex - m_typeIndexBegin] = hash;
+	}
+
+	PDB_DELETE_ARRAY(offsets);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeHasher::~TypeHasher(void) PDB_NO_EXCEPT
+{
+	PDB_DELETE_ARRAY(m_hashes);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::TypeHash PDB::TypeHasher::GetHash(uint32_t typeIndex) const PDB_NO_EXCEPT
+{
+	if ((typeIndex < m_typeIndexBegin) || (typeIndex >= m_typeIndexEnd))
+	{
+		return HashTypeIndex(typeIndex);
+	}
+
+	return m_hashes[typeIndex - m_typeIndexBegin];
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD size_t PDB::TypeHasher::GetAllocatedSize(void) const PDB_NO_EXCEPT
+{
+	return (m_typeIndexEnd - m_typeIndexBegin) * sizeof(TypeHash);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+size_t PDB::GetTypeIndexReferences(const CodeView::TPI::Record* record, uint32_t* offsets, size_t maxOffsetCount) PDB_NO_EXCEPT
+{
+	const Byte* start = reinterpret_cast<const Byte*>(record);
+	size_t count = 0u;
+	auto addReference = [start, offsets, maxOffsetCount, &count](const void* typeIndex)
+	{
+		if (count < maxOffsetCount)
+		{
+			offsets[count] = static_cast<uint32_t>(static_cast<const Byte*>(typeIndex) - start);
+		}
+
+		++count;
+	};
+
+	switch (record->header.kind)
+	{
+	case CodeView::TPI::TypeRecordKind::LF_MODIFIER:
+		addReference(&record->data.LF_MODIFIER.type);
+		break;
+
+	case CodeView::TPI::TypeRecordKind::LF_POINTER:
+		addReference(&record->data.LF_POINTER.utype);
+		if ((record->data.LF_POINTER.attr.ptrmode == PointerModeDataMember) || (record->data.LF_POINTER.attr.ptrmode == PointerModeMemberFunction))
+		{
+			addReference(&record->data.LF_POINTER.pbase.pm.pmclass);
+		}
+		break;
+
+	case CodeView::TPI::TypeRecordKind::LF_PROCEDURE:
+		addReference(&record->data.LF_PROCEDURE.rvtype);
+		addReference(&record->data.LF_PROCEDURE.arglist);
+		break;
+
+	case CodeView::TPI::TypeRecordKind::LF_MFUNCTION:
+		addReference(&record->data.LF_MFUNCTION.rvtype);
+		addReference(&record->data.LF_MFUNCTION.classtype);
+		addReference(&record->data.LF_MFUNCTION.thistype);
+		addReference(&record->data.LF_MFUNCTION.arglist);
+		break;
+
+	case CodeView::TPI::TypeRecordKind::LF_ARGLIST:
+		for (uint32_t i = 0u; i < record->data.LF_ARGLIST.count; ++i)
+		{
+			addReference(&record->data.LF_ARGLIST.arg[i]);
+		}
+		break;
+
+	case CodeView::TPI::TypeRecordKind::LF_BITFIELD:
+		addReference(&record->data.LF_BITFIELD.type);
+		break;
+
+	case CodeView::TPI::TypeRecordKind::LF_ARRAY:
+		addReference(&record->data.LF_ARRAY.elemtype);
+		addReference(&record->data.LF_ARRAY.idxtype);
+		break;
+
+	case CodeView::TPI::TypeRecordKind::LF_CLASS:
+	case CodeView::TPI::TypeRecordKind::LF_STRUCTURE:
+	case CodeView::TPI::TypeRecordKind::LF_INTERFACE:
+		addReference(&record->data.LF_CLASS.field);
+		addReference(&record->data.LF_CLASS.derived);
+		addReference(&record->data.LF_CLASS.vshape);
+		break;
+
+	case CodeView::TPI::TypeRecordKind::LF_CLASS2:
+	case CodeView::TPI::TypeRecordKind::LF_STRUCTURE2:
+		addReference(&record->data.LF_CLASS2.field);
+		addReference(&record->data.LF_CLASS2.derived);
+		addReference(&record->data.LF_CLASS2.vshape);
+		break;
+
+	case CodeView::TPI::TypeRecordKind::LF_UNION:
+		addReference(&record->data.LF_UNION.field);
+		break;
+
+	case CodeView::TPI::TypeRecordKind::LF_ENUM:
+		addReference(&record->data.LF_ENUM.utype);
+		addReference(&record->data.LF_ENUM.field);
+		break;
+
+	case CodeView::TPI::TypeRecordKind::LF_VFTABLE:
+		addReference(&record->data.LF_VFTABLE.type);
+		addReference(&record->data.LF_VFTABLE.baseVftable);
+		break;
+
+	case CodeView::TPI::TypeRecordKind::LF_METHODLIST:
+	{
+		// entries of introducing virtual methods store an additional offset into the virtual function table
+		const size_t size = GetCodeViewRecordSize(record);
+		for (size_t i = 0u; i + sizeof(CodeView::TPI::MethodListEntry) <= size; /* nothing */)
+		{
+			const CodeView::TPI::MethodListEntry* entry = reinterpret_cast<const CodeView::TPI::MethodListEntry*>(record->data.LF_METHODLIST.mList + i);
+			addReference(&entry->index);
+
+			const CodeView::TPI::MethodProperty property = static_cast<CodeView::TPI::MethodProperty>(entry->attributes.mprop);
+			const bool isIntro = (property == CodeView::TPI::MethodProperty::Intro) || (property == CodeView::TPI::MethodProperty::PureIntro);
+			i += sizeof(CodeView::TPI::MethodListEntry) + (isIntro ? sizeof(uint32_t) : 0u);
+		}
+		break;
+	}
+
+	case CodeView::TPI::TypeRecordKind::LF_FIELDLIST:
+	{
+		const char* fields = reinterpret_cast<const char*>(&record->data.LF_FIELD.list);
+		const size_t size = GetCodeViewRecordSize(record);
+		for (size_t i = 0u; i + sizeof(CodeView::TPI::TypeRecordKind) <= size; /* nothing */)
+		{
+			const CodeView::TPI::FieldList* field = reinterpret_cast<const CodeView::TPI::FieldList*>(fields + i);
+			switch (field->kind)
+			{
+			case CodeView::TPI::TypeRecordKind::LF_BCLASS:
+				addReference(&field->data.LF_BCLASS.index);
+				break;
+
+			case CodeView::TPI::TypeRecordKind::LF_VBCLASS:
+			case CodeView::TPI::TypeRecordKind::LF_IVBCLASS:
+				addReference(&field->data.LF_VBCLASS.index);
+				addReference(&field->data.LF_VBCLASS.vbpIndex);
+				break;
+
+			case CodeView::TPI::TypeRecordKind::LF_INDEX:
+				addReference(&field->data.LF_INDEX.type);
+				break;
+
+			case CodeView::TPI::TypeRecordKind::LF_VFUNCTAB:
+				addReference(&field->data.LF_VFUNCTAB.type);
+				break;
+
+			case CodeView::TPI::TypeRecordKind::LF_MEMBER:
+				addReference(&field->data.LF_MEMBER.index);
+				break;
+
+			case CodeView::TPI::TypeRecordKind::LF_STMEMBER:
+				addReference(&field->data.LF_STMEMBER.index);
+				break;
+
+			case CodeView::TPI::TypeRecordKind::LF_METHOD:
+				addReference(&field->data.LF_METHOD.mList);
+				break;
+
+			case CodeView::TPI::TypeRecordKind::LF_NESTTYPE:
+				addReference(&field->data.LF_NESTTYPE.index);
+				break;
+
+			case CodeView::TPI::TypeRecordKind::LF_ONEMETHOD:
+				addReference(&field->data.LF_ONEMETHOD.index);
+				break;
+
+			case CodeView::TPI::TypeRecordKind::LF_FRIENDCLS:
+				addReference(&field->data.LF_FRIENDCLS.index);
+				break;
+
+			case CodeView::TPI::TypeRecordKind::LF_FRIENDFCN:
+				addReference(&field->data.LF_FRIENDFCN.index);
+				break;
+
+			case CodeView::TPI::TypeRecordKind::LF_NESTTYPEEX:
+				addReference(&field->data.LF_NESTTYPEEX.index);
+				break;
+
+			case CodeView::TPI::TypeRecordKind::LF_MEMBERMODIFY:
+				addReference(&field->data.LF_MEMBERMODIFY.index);
+				break;
+
+			case CodeView::TPI::TypeRecordKind::LF_VFUNCOFF:
+				addReference(&field->data.LF_VFUNCOFF.type);
+				break;
+
+			default:
+				break;
+			}
+
+			const size_t fieldSize = GetFieldSize(field);
+			if (fieldSize == 0u)
+			{
+				// the remaining fields cannot be walked
+				break;
+			}
+
+			// fields are padded to 4 bytes
+			i = BitUtil::RoundUpToMultiple<size_t>(i + fieldSize, 4u);
+		}
+		break;
+	}
+
+	default:
+		break;
+	}
+
+	return count;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::TypeHasher PDB::CreateTypeHasher(const TypeTable& typeTable) PDB_NO_EXCEPT
+{
+	return TypeHasher { typeTable };
+}
@@ -0,0 +1,77 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_ArrayView.h"
+#include "PDB_TPITypes.h"
+
+
+namespace PDB
+{
+	class TypeTable;
+
+
+	// A 64-bit structural hash of a type, stored as two 32-bit halves.
+	struct TypeHash
+	{
+		uint32_t low;
+		uint32_t high;
+	};
+
+	PDB_NO_DISCARD inline bool operator==(const TypeHash& lhs, const TypeHash& rhs) PDB_NO_EXCEPT
+	{
+		return (lhs.low == rhs.low) && (lhs.high == rhs.high);
+	}
+
+	PDB_NO_DISCARD inline bool operator!=(const TypeHash& lhs, const TypeHash& rhs) PDB_NO_EXCEPT
+	{
+		return !(lhs == rhs);
+	}
+
+
+	// Computes hashes of TPI records that do not depend on type indices, and are therefore stable across PDBs.
+	// each record is hashed with all type indices it refers to replaced by the hash of the referenced record, so two
+	// records get the same hash if they have the same contents and refer to types with the same hashes.
+	// records only refer to records with a lower type index, so all hashes are computed in a single pass in type index
+	// order, with the hashes of referenced records already known. forward references are hashed by their name, which
+	// breaks the cycles of self-referential types.
+	class PDB_NO_DISCARD TypeHasher
+	{
+	public:
+		TypeHasher(void) PDB_NO_EXCEPT;
+		TypeHasher(TypeHasher&& other) PDB_NO_EXCEPT;
+		TypeHasher& operator=(TypeHasher&& other) PDB_NO_EXCEPT;
+
+		explicit TypeHasher(const TypeTable& typeTable) PDB_NO_EXCEPT;
+		~TypeHasher(void) PDB_NO_EXCEPT;
+
+		// Returns the hash of the type with the given index. Built-in types are hashed by their index, which is the same in all PDBs.
+		PDB_NO_DISCARD TypeHash GetHash(uint32_t typeIndex) const PDB_NO_EXCEPT;
+
+		// Returns the hashes of all records, indexed by type index - first type index.
+		PDB_NO_DISCARD inline ArrayView<TypeHash> GetHashes(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<TypeHash>(m_hashes, m_typeIndexEnd - m_typeIndexBegin);
+		}
+
+		// Returns the number of bytes allocated by the hasher.
+		PDB_NO_DISCARD size_t GetAllocatedSize(void) const PDB_NO_EXCEPT;
+
+	private:
+		TypeHash* m_hashes;
+		uint32_t m_typeIndexBegin;
+		uint32_t m_typeIndexEnd;
+
+		PDB_DISABLE_COPY(TypeHasher);
+	};
+
+	// Stores the offsets of all type indices a record refers to, relative to the start of the record, in ascending order.
+	// unknown records and fields are treated as not referring to any type.
+	// Returns the number of type indices found, which can be larger than the given maximum number of offsets.
+	size_t GetTypeIndexReferences(const CodeView::TPI::Record* record, uint32_t* offsets, size_t maxOffsetCount) PDB_NO_EXCEPT;
+
+	// Creates a hasher, computing the hashes of all records in the type table.
+	PDB_NO_DISCARD TypeHasher CreateTypeHasher(const TypeTable& typeTable) PDB_NO_EXCEPT;
+}
@@ -0,0 +1,600 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_TypeLayoutEngine.h"
+#include "PDB_TypeTable.h"
+#include "PDB_ForwardReferenceMap.h"
+#include "PDB_FieldList.h"
+#include "PDB_Util.h"
+#include "Foundation/PDB_Memory.h"
+#include "Foundation/PDB_CRT.h"
+
+
+namespace
+{
+	// marks a layout that is currently being computed, which breaks cycles in malformed type information
+	static constexpr const uint32_t LayoutInProgress = 0xFFFFFFFFu;
+
+	// the maximum number of records followed when resolving modifiers, enums and bitfields to a sized type
+	static constexpr const uint32_t MaxTypeChainLength = 64u;
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	template <typename T>
+	static void Grow(T*& array, size_t count, size_t& capacity, size_t requiredCapacity) PDB_NO_EXCEPT
+	{
+		if (requiredCapacity <= capacity)
+		{
+			return;
+		}
+
+		size_t newCapacity = (capacity < 256u) ? 256u : capacity * 2u;
+		while (newCapacity < requiredCapacity)
+		{
+			newCapacity *= 2u;
+		}
+
+		T* newArray = PDB_NEW_ARRAY(T, newCapacity);
+		if (count != 0u)
+		{
+			memcpy(newArray, array, sizeof(T) * count);
+		}
+
+		PDB_DELETE_ARRAY(array);
+		array = newArray;
+		capacity = newCapacity;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	template <typename T>
+	static void Shrink(T*& array, size_t count, size_t& capacity) PDB_NO_EXCEPT
+	{
+		if (count == capacity)
+		{
+			return;
+		}
+
+		T* newArray = nullptr;
+		if (count != 0u)
+		{
+			newArray = PDB_NEW_ARRAY(T, count);
+			memcpy(newArray, array, sizeof(T) * count);
+		}
+
+		PDB_DELETE_ARRAY(array);
+		array = newArray;
+		capacity = count;
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static bool IsLayoutRecord(const PDB::CodeView::TPI::Record* record) PDB_NO_EXCEPT
+	{
+		using namespace PDB::CodeView::TPI;
+
+		switch (record->header.kind)
+		{
+		case TypeRecordKind::LF_CLASS:
+		case TypeRecordKind::LF_STRUCTURE:
+		case TypeRecordKind::LF_INTERFACE:
+		case TypeRecordKind::LF_CLASS2:
+		case TypeRecordKind::LF_STRUCTURE2:
+		case TypeRecordKind::LF_UNION:
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static uint32_t GetLayoutRecordSize(const PDB::CodeView::TPI::Record* record) PDB_NO_EXCEPT
+	{
+		using namespace PDB::CodeView::TPI;
+
+		switch (record->header.kind)
+		{
+		case TypeRecordKind::LF_CLASS2:
+		case TypeRecordKind::LF_STRUCTURE2:
+			return PDB::GetNumericLeafValue(record->data.LF_CLASS2.data);
+
+		case TypeRecordKind::LF_UNION:
+			return PDB::GetNumericLeafValue(record->data.LF_UNION.data);
+
+		default:
+			return PDB::GetNumericLeafValue(record->data.LF_CLASS.data);
+		}
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static uint32_t GetLayoutRecordFieldList(const PDB::CodeView::TPI::Record* record) PDB_NO_EXCEPT
+	{
+		using namespace PDB::CodeView::TPI;
+
+		switch (record->header.kind)
+		{
+		case TypeRecordKind::LF_CLASS2:
+		case TypeRecordKind::LF_STRUCTURE2:
+			return record->data.LF_CLASS2.field;
+
+		case TypeRecordKind::LF_UNION:
+			return record->data.LF_UNION.field;
+
+		default:
+			return record->data.LF_CLASS.field;
+		}
+	}
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	PDB_NO_DISCARD static uint32_t GetSimpleTypeSize(uint32_t typeIndex) PDB_NO_EXCEPT
+	{
+		using namespace PDB::CodeView::TPI;
+
+		// https://llvm.org/docs/PDB/TpiStream.html#type-indices
+		// bits 8-11 store the pointer mode, bits 0-7 the kind of simple type
+		switch ((typeIndex >> 8u) & 0xFu)
+		{
+		case 0u:
+			break;
+
+		case 1u:
+			return 2u;
+
+		case 2u:
+		case 3u:
+		case 4u:
+			return 4u;
+
+		case 5u:
+			return 6u;
+
+		case 6u:
+			return 8u;
+
+		default:
+			return 0u;
+		}
+
+		switch (static_cast<TypeIndexKind>(typeIndex & 0xFFu))
+		{
+		case TypeIndexKind::T_CHAR:
+		case TypeIndexKind::T_UCHAR:
+		case TypeIndexKind::T_RCHAR:
+		case TypeIndexKind::T_CHAR8:
+		case TypeIndexKind::T_INT1:
+		case TypeIndexKind::T_UINT1:
+		case TypeIndexKind::T_BOOL08:
+			return 1u;
+
+		case TypeIndexKind::T_SHORT:
+		case TypeIndexKind::T_USHORT:
+		case TypeIndexKind::T_WCHAR:
+		case TypeIndexKind::T_CHAR16:
+		case TypeIndexKind::T_INT2:
+		case TypeIndexKind::T_UINT2:
+		case TypeIndexKind::T_BOOL16:
+			return 2u;
+
+		case TypeIndexKind::T_HRESULT:
+		case TypeIndexKind::T_LONG:
+		case TypeIndexKind::T_ULONG:
+		case TypeIndexKind::T_CHAR32:
+		case TypeIndexKind::T_INT4:
+		case TypeIndexKind::T_UINT4:
+		case TypeIndexKind::T_REAL32:
+		case TypeIndexKind::T_BOOL32:
+		case TypeIndexKind::T_BOOL32FF:
+			return 4u;
+
+		case TypeIndexKind::T_REAL48:
+			return 6u;
+
+		case TypeIndexKind::T_QUAD:
+		case TypeIndexKind::T_UQUAD:
+		case TypeIndexKind::T_INT8:
+		case TypeIndexKind::T_UINT8:
+		case TypeIndexKind::T_REAL64:
+		case TypeIndexKind::T_BOOL64:
+		case TypeIndexKind::T_CURRENCY:
+		case TypeIndexKind::T_CPLX32:
+			return 8u;
+
+		case TypeIndexKind::T_REAL80:
+			return 10u;
+
+		case TypeIndexKind::T_OCT:
+		case TypeIndexKind::T_UOCT:
+		case TypeIndexKind::T_INT16:
+		case TypeIndexKind::T_UINT16:
+		case TypeIndexKind::T_REAL128:
+		case TypeIndexKind::T_CPLX64:
+			return 16u;
+
+		case TypeIndexKind::T_CPLX80:
+			return 20u;
+
+		case TypeIndexKind::T_CPLX128:
+			return 32u;
+
+		default:
+			return 0u;
+		}
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeLayoutEngine::TypeLayoutEngine(void) PDB_NO_EXCEPT
+	: m_typeTable(nullptr)
+	, m_layoutIndices(nullptr)
+	, m_typeIndexBegin(0u)
+	, m_typeIndexEnd(0u)
+	, m_layouts(nullptr)
+	, m_layoutCount(0u)
+	, m_layoutCapacity(0u)
+	, m_members(nullptr)
+	, m_memberCount(0u)
+	, m_memberCapacity(0u)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeLayoutEngine::TypeLayoutEngine(TypeLayoutEngine&& other) PDB_NO_EXCEPT
+	: m_typeTable(PDB_MOVE(other.m_typeTable))
+	, m_layoutIndices(PDB_MOVE(other.m_layoutIndices))
+	, m_typeIndexBegin(PDB_MOVE(other.m_typeIndexBegin))
+	, m_typeIndexEnd(PDB_MOVE(other.m_typeIndexEnd))
+	, m_layouts(PDB_MOVE(other.m_layouts))
+	, m_layoutCount(PDB_MOVE(other.m_layoutCount))
+	, m_layoutCapacity(PDB_MOVE(other.m_layoutCapacity))
+	, m_members(PDB_MOVE(other.m_members))
+	, m_memberCount(PDB_MOVE(other.m_memberCount))
+	, m_memberCapacity(PDB_MOVE(other.m_memberCapacity))
+{
+	other.m_typeTable = nullptr;
+	other.m_layoutIndices = nullptr;
+	other.m_typeIndexBegin = 0u;
+	other.m_typeIndexEnd = 0u;
+	other.m_layouts = nullptr;
+	other.m_layoutCount = 0u;
+	other.m_layoutCapacity = 0u;
+	other.m_members = nullptr;
+	other.m_memberCount = 0u;
+	other.m_memberCapacity = 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeLayoutEngine& PDB::TypeLayoutEngine::operator=(TypeLayoutEngine&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		PDB_DELETE_ARRAY(m_layoutIndices);
+		PDB_DELETE_ARRAY(m_layouts);
+		PDB_DELETE_ARRAY(m_members);
+
+		m_typeTable = PDB_MOVE(other.m_typeTable);
+		m_layoutIndices = PDB_MOVE(other.m_layoutIndices);
+		m_typeIndexBegin = PDB_MOVE(other.m_typeIndexBegin);
+		m_typeIndexEnd = PDB_MOVE(other.m_typeIndexEnd);
+		m_layouts = PDB_MOVE(other.m_layouts);
+		m_layoutCount = PDB_MOVE(other.m_layoutCount);
+		m_layoutCapacity = PDB_MOVE(other.m_layoutCapacity);
+		m_members = PDB_MOVE(other.m_members);
+		m_memberCount = PDB_MOVE(other.m_memberCount);
+		m_memberCapacity = PDB_MOVE(other.m_memberCapacity);
+
+		other.m_typeTable = nullptr;
+		other.m_layoutIndices = nullptr;
+		other.m_typeIndexBegin = 0u;
+		other.m_typeIndexEnd = 0u;
+		other.m_layouts = nullptr;
+		other.m_layoutCount = 0u;
+		other.m_layoutCapacity = 0u;
+		other.m_members = nullptr;
+		other.m_memberCount = 0u;
+		other.m_memberCapacity = 0u;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeLayoutEngine::TypeLayoutEngine(const TypeTable& typeTable, const ForwardReferenceMap& forwardReferenceMap) PDB_NO_EXCEPT
+	: TypeLayoutEngine()
+{
+	m_typeTable = &typeTable;
+	m_typeIndexBegin = typeTable.GetFirstTypeIndex();
+	m_typeIndexEnd = typeTable.GetLastTypeIndex();
+
+	const size_t recordCount = typeTable.GetTypeRecordCount();
+	m_layoutIndices = PDB_NEW_ARRAY(uint32_t, recordCount);
+	memset(m_layoutIndices, 0, sizeof(uint32_t) * recordCount);
+
+	// layouts are memoized, so base classes are only computed once no matter how many classes derive from them
+	for (uint32_t typeIndex = m_typeIndexBegin; typeIndex < m_typeIndexEnd; ++typeIndex)
+	{
+		(void)ComputeLayout(forwardReferenceMap, typeIndex);
+	}
+
+	// the arrays are not grown any further, so only keep as much memory as needed
+	Shrink(m_layouts, m_layoutCount, m_layoutCapacity);
+	Shrink(m_members, m_memberCount, m_memberCapacity);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeLayoutEngine::~TypeLayoutEngine(void) PDB_NO_EXCEPT
+{
+	PDB_DELETE_ARRAY(m_layoutIndices);
+	PDB_DELETE_ARRAY(m_layouts);
+	PDB_DELETE_ARRAY(m_members);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::TypeLayoutEngine::ComputeLayout(const ForwardReferenceMap& forwardReferenceMap, uint32_t typeIndex) PDB_NO_EXCEPT
+{
+	if ((typeIndex < m_typeIndexBegin) || (typeIndex >= m_typeIndexEnd))
+	{
+		return 0u;
+	}
+
+	uint32_t& layoutIndex = m_layoutIndices[typeIndex - m_typeIndexBegin];
+	if (layoutIndex == LayoutInProgress)
+	{
+		return 0u;
+	}
+	else if (layoutIndex != 0u)
+	{
+		return layoutIndex;
+	}
+
+	const CodeView::TPI::Record* record = m_typeTable->GetTypeRecord(typeIndex);
+	CodeView::TPI::TypeProperty property = {};
+	if (!record || !IsLayoutRecord(record) || !GetUDTProperty(record, property))
+	{
+		return 0u;
+	}
+
+	layoutIndex = LayoutInProgress;
+
+	if (property.fwdref)
+	{
+		// use the layout of the definition, if any
+		const uint32_t definitionIndex = forwardReferenceMap.Resolve(typeIndex);
+		const uint32_t definitionLayoutIndex = (definitionIndex != typeIndex) ? ComputeLayout(forwardReferenceMap, definitionIndex) : 0u;
+		layoutIndex = definitionLayoutIndex;
+
+		return definitionLayoutIndex;
+	}
+
+	// compute the layouts of all base classes first, so that the members of this layout are stored contiguously
+	const uint32_t fieldListIndex = GetLayoutRecordFieldList(record);
+	ForEachField(*m_typeTable, fieldListIndex, [this, &forwardReferenceMap](const CodeView::TPI::FieldList* field)
+	{
+		if (field->kind == CodeView::TPI::TypeRecordKind::LF_BCLASS)
+		{
+			(void)ComputeLayout(forwardReferenceMap, field->data.LF_BCLASS.index);
+		}
+	});
+
+	Grow(m_layouts, m_layoutCount, m_layoutCapacity, m_layoutCount + 1u);
+
+	const size_t newLayoutIndex = m_layoutCount++;
+	const size_t firstMember = m_memberCount;
+	AppendMembers(fieldListIndex);
+
+	Layout& layout = m_layouts[newLayoutIndex];
+	layout.name = GetUDTName(record);
+	layout.typeIndex = typeIndex;
+	layout.size = GetLayoutRecordSize(record);
+	layout.firstMember = static_cast<uint32_t>(firstMember);
+	layout.memberCount = static_cast<uint32_t>(m_memberCount - firstMember);
+
+	layoutIndex = static_cast<uint32_t>(newLayoutIndex + 1u);
+
+	return layoutIndex;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::TypeLayoutEngine::AppendMembers(uint32_t fieldListIndex) PDB_NO_EXCEPT
+{
+	ForEachField(*m_typeTable, fieldListIndex, [this](const CodeView::TPI::FieldList* field)
+	{
+		switch (field->kind)
+		{
+		case CodeView::TPI::TypeRecordKind::LF_BCLASS:
+		{
+			const uint32_t baseIndex = field->data.LF_BCLASS.index;
+			if ((baseIndex < m_typeIndexBegin) || (baseIndex >= m_typeIndexEnd))
+			{
+				break;
+			}
+
+			const uint32_t baseLayoutIndex = m_layoutIndices[baseIndex - m_typeIndexBegin];
+			if ((baseLayoutIndex == 0u) || (baseLayoutIndex == LayoutInProgress))
+			{
+				break;
+			}
+
+			// flatten the base class. its members are copied by index, because adding members can grow the array.
+			const uint32_t baseOffset = GetNumericLeafValue(field->data.LF_BCLASS.offset);
+			const Layout baseLayout = m_layouts[baseLayoutIndex - 1u];
+			for (uint32_t i = 0u; i < baseLayout.memberCount; ++i)
+			{
+				Member member = m_members[baseLayout.firstMember + i];
+				member.offset += baseOffset;
+				AddMember(member);
+			}
+			break;
+		}
+
+		case CodeView::TPI::TypeRecordKind::LF_VBCLASS:
+		{
+			// the location of a virtual base depends on the most derived class, so only its pointer is known
+			const uint32_t baseIndex = field->data.LF_VBCLASS.index;
+			const CodeView::TPI::Record* baseRecord = m_typeTable->GetTypeRecord(baseIndex);
+
+			Member member = {};
+			member.name = baseRecord ? GetUDTName(baseRecord) : nullptr;
+			member.typeIndex = baseIndex;
+			member.offset = GetNumericLeafValue(field->data.LF_VBCLASS.vbpOffset);
+			member.kind = MemberKind::VirtualBaseClass;
+			AddMember(member);
+			break;
+		}
+
+		case CodeView::TPI::TypeRecordKind::LF_VFUNCTAB:
+		{
+			Member member = {};
+			member.typeIndex = field->data.LF_VFUNCTAB.type;
+			member.kind = MemberKind::VirtualFunctionTablePointer;
+			AddMember(member);
+			break;
+		}
+
+		case CodeView::TPI::TypeRecordKind::LF_MEMBER:
+		{
+			Member member = {};
+			member.name = GetFieldName(field);
+			member.typeIndex = field->data.LF_MEMBER.index;
+			member.offset = GetNumericLeafValue(field->data.LF_MEMBER.offset);
+			member.kind = MemberKind::DataMember;
+
+			const CodeView::TPI::Record* typeRecord = m_typeTable->GetTypeRecord(member.typeIndex);
+			if (typeRecord && (typeRecord->header.kind == CodeView::TPI::TypeRecordKind::LF_BITFIELD))
+			{
+				member.typeIndex = typeRecord->data.LF_BITFIELD.type;
+				member.bitPosition = typeRecord->data.LF_BITFIELD.position;
+				member.bitLength = typeRecord->data.LF_BITFIELD.length;
+			}
+
+			AddMember(member);
+			break;
+		}
+
+		default:
+			// static members, methods and nested types do not contribute to the layout
+			break;
+		}
+	});
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::TypeLayoutEngine::AddMember(const Member& member) PDB_NO_EXCEPT
+{
+	Grow(m_members, m_memberCount, m_memberCapacity, m_memberCount + 1u);
+	m_members[m_memberCount++] = member;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const PDB::TypeLayoutEngine::Layout* PDB::TypeLayoutEngine::GetLayout(uint32_t typeIndex) const PDB_NO_EXCEPT
+{
+	if ((typeIndex < m_typeIndexBegin) || (typeIndex >= m_typeIndexEnd))
+	{
+		return nullptr;
+	}
+
+	const uint32_t layoutIndex = m_layoutIndices[typeIndex - m_typeIndexBegin];
+	if ((layoutIndex == 0u) || (layoutIndex == LayoutInProgress))
+	{
+		return nullptr;
+	}
+
+	return &m_layouts[layoutIndex - 1u];
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::TypeLayoutEngine::GetTypeSize(uint32_t typeIndex) const PDB_NO_EXCEPT
+{
+	// follow modifiers, enums and bitfields to the type that determines the size
+	for (uint32_t i = 0u; i < MaxTypeChainLength; ++i)
+	{
+		if (typeIndex < m_typeIndexBegin)
+		{
+			return GetSimpleTypeSize(typeIndex);
+		}
+
+		const Layout* layout = GetLayout(typeIndex);
+		if (layout)
+		{
+			return layout->size;
+		}
+
+		const CodeView::TPI::Record* record = m_typeTable ? m_typeTable->GetTypeRecord(typeIndex) : nullptr;
+		if (!record)
+		{
+			return 0u;
+		}
+
+		switch (record->header.kind)
+		{
+		case CodeView::TPI::TypeRecordKind::LF_MODIFIER:
+			typeIndex = record->data.LF_MODIFIER.type;
+			break;
+
+		case CodeView::TPI::TypeRecordKind::LF_ENUM:
+			typeIndex = record->data.LF_ENUM.utype;
+			break;
+
+		case CodeView::TPI::TypeRecordKind::LF_BITFIELD:
+			typeIndex = record->data.LF_BITFIELD.type;
+			break;
+
+		case CodeView::TPI::TypeRecordKind::LF_POINTER:
+			return record->data.LF_POINTER.attr.size;
+
+		case CodeView::TPI::TypeRecordKind::LF_ARRAY:
+			return GetNumericLeafValue(record->data.LF_ARRAY.data);
+
+		default:
+			return 0u;
+		}
+	}
+
+	return 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD size_t PDB::TypeLayoutEngine::GetAllocatedSize(void) const PDB_NO_EXCEPT
+{
+	return (m_typeIndexEnd - m_typeIndexBegin) * sizeof(uint32_t) + m_layoutCapacity * sizeof(Layout) + m_memberCapacity * sizeof(Member);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::TypeLayoutEngine PDB::CreateTypeLayoutEngine(const TypeTable& typeTable, const ForwardReferenceMap& forwardReferenceMap) PDB_NO_EXCEPT
+{
+	return TypeLayoutEngine { typeTable, forwardReferenceMap };
+}
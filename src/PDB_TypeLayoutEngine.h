@@ -0,0 +1,112 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_ArrayView.h"
+
+
+namespace PDB
+{
+	class TypeTable;
+	class ForwardReferenceMap;
+
+
+	// Computes the memory layout of all user-defined types in the TPI stream.
+	// layouts are flattened: members of base classes are stored with the members of the derived class, using offsets
+	// relative to the start of the derived class. members of embedded user-defined types are not flattened, their layout
+	// can be retrieved using the member's type index.
+	// forward references are resolved to their definition using a ForwardReferenceMap, and each layout is only computed
+	// once, even if it is inherited by many other types. all layouts are computed upon construction and stored in two compact arrays, so
+	// querying the engine is trivially thread-safe.
+	// the type table must outlive the engine, because names are not copied.
+	class PDB_NO_DISCARD TypeLayoutEngine
+	{
+	public:
+		enum class PDB_NO_DISCARD MemberKind : uint8_t
+		{
+			DataMember,
+			VirtualBaseClass,					// the offset is the offset of the virtual base pointer
+			VirtualFunctionTablePointer
+		};
+
+		struct Member
+		{
+			const char* name;					// nullptr for virtual function table pointers
+			uint32_t typeIndex;					// the underlying type in case of bitfields
+			uint32_t offset;					// relative to the start of the type the layout belongs to
+			uint8_t bitPosition;
+			uint8_t bitLength;					// zero if the member is not a bitfield
+			MemberKind kind;
+		};
+
+		struct Layout
+		{
+			const char* name;
+			uint32_t typeIndex;					// type index of the definition
+			uint32_t size;
+			uint32_t firstMember;
+			uint32_t memberCount;
+		};
+
+		TypeLayoutEngine(void) PDB_NO_EXCEPT;
+		TypeLayoutEngine(TypeLayoutEngine&& other) PDB_NO_EXCEPT;
+		TypeLayoutEngine& operator=(TypeLayoutEngine&& other) PDB_NO_EXCEPT;
+
+		explicit TypeLayoutEngine(const TypeTable& typeTable, const ForwardReferenceMap& forwardReferenceMap) PDB_NO_EXCEPT;
+		~TypeLayoutEngine(void) PDB_NO_EXCEPT;
+
+		// Returns the layout of the user-defined type with the given type index, or nullptr if the type is not a class,
+		// struct or union, or no definition could be found for a forward reference.
+		PDB_NO_DISCARD const Layout* GetLayout(uint32_t typeIndex) const PDB_NO_EXCEPT;
+
+		// Returns the flattened members of a layout in declaration order, with the members of base classes first.
+		PDB_NO_DISCARD inline ArrayView<Member> GetMembers(const Layout& layout) const PDB_NO_EXCEPT
+		{
+			return ArrayView<Member>(m_members + layout.firstMember, layout.memberCount);
+		}
+
+		// Returns the size of any type in bytes, including built-in types, pointers, arrays and enums.
+		// Returns zero if the size is unknown.
+		PDB_NO_DISCARD uint32_t GetTypeSize(uint32_t typeIndex) const PDB_NO_EXCEPT;
+
+		// Returns all computed layouts.
+		PDB_NO_DISCARD inline ArrayView<Layout> GetLayouts(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<Layout>(m_layouts, m_layoutCount);
+		}
+
+		// Returns the number of bytes allocated by the engine.
+		PDB_NO_DISCARD size_t GetAllocatedSize(void) const PDB_NO_EXCEPT;
+
+	private:
+		// Returns the index of the layout of the given type plus one, or zero if it has none. Computes the layout if necessary.
+		PDB_NO_DISCARD uint32_t ComputeLayout(const ForwardReferenceMap& forwardReferenceMap, uint32_t typeIndex) PDB_NO_EXCEPT;
+
+		// Appends the members of a field list to the member array, flattening base classes.
+		void AppendMembers(uint32_t fieldListIndex) PDB_NO_EXCEPT;
+
+		void AddMember(const Member& member) PDB_NO_EXCEPT;
+
+		const TypeTable* m_typeTable;
+
+		// the layout index plus one for each type index - first type index, zero for types without a layout
+		uint32_t* m_layoutIndices;
+		uint32_t m_typeIndexBegin;
+		uint32_t m_typeIndexEnd;
+
+		Layout* m_layouts;
+		size_t m_layoutCount;
+		size_t m_layoutCapacity;
+
+		Member* m_members;
+		size_t m_memberCount;
+		size_t m_memberCapacity;
+
+		PDB_DISABLE_COPY(TypeLayoutEngine);
+	};
+
+	// Creates a type layout engine, computing the layouts of all user-defined types.
+	PDB_NO_DISCARD TypeLayoutEngine CreateTypeLayoutEngine(const TypeTable& typeTable, const ForwardReferenceMap& forwardReferenceMap) PDB_NO_EXCEPT;
+}
@@ -0,0 +1,312 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_TypeStore.h"
+#include "PDB_TypeTable.h"
+#include "Foundation/PDB_BitUtil.h"
+#include "Foundation/PDB_Memory.h"
+#include "Foundation/PDB_CRT.h"
+
+
+namespace
+{
+	// the record offset of types that were added without a record
+	static constexpr const uint32_t NoRecord = 0xFFFFFFFFu;
+
+
+	// ------------------------------------------------------------------------------------------------
+	// ------------------------------------------------------------------------------------------------
+	template <typename T>
+	static void Grow(T*& array, size_t count, size_t& capacity, size_t requiredCapacity) PDB_NO_EXCEPT
+	{
+		if (requiredCapacity <= capacity)
+		{
+			return;
+		}
+
+		size_t newCapacity = (capacity < 256u) ? 256u : capacity * 2u;
+		while (newCapacity < requiredCapacity)
+		{
+			newCapacity *= 2u;
+		}
+
+		T* newArray = PDB_NEW_ARRAY(T, newCapacity);
+		if (count != 0u)
+		{
+			memcpy(newArray, array, sizeof(T) * count);
+		}
+
+		PDB_DELETE_ARRAY(array);
+		array = newArray;
+		capacity = newCapacity;
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeStore::TypeStore(void) PDB_NO_EXCEPT
+	: m_hashes(nullptr)
+	, m_recordOffsets(nullptr)
+	, m_typeCount(0u)
+	, m_typeCapacity(0u)
+	, m_records(nullptr)
+	, m_recordSize(0u)
+	, m_recordCapacity(0u)
+	, m_buckets(nullptr)
+	, m_bucketCount(0u)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeStore::TypeStore(TypeStore&& other) PDB_NO_EXCEPT
+	: m_hashes(PDB_MOVE(other.m_hashes))
+	, m_recordOffsets(PDB_MOVE(other.m_recordOffsets))
+	, m_typeCount(PDB_MOVE(other.m_typeCount))
+	, m_typeCapacity(PDB_MOVE(other.m_typeCapacity))
+	, m_records(PDB_MOVE(other.m_records))
+	, m_recordSize(PDB_MOVE(other.m_recordSize))
+	, m_recordCapacity(PDB_MOVE(other.m_recordCapacity))
+	, m_buckets(PDB_MOVE(other.m_buckets))
+	, m_bucketCount(PDB_MOVE(other.m_bucketCount))
+{
+	other.m_hashes = nullptr;
+	other.m_recordOffsets = nullptr;
+	other.m_typeCount = 0u;
+	other.m_typeCapacity = 0u;
+	other.m_records = nullptr;
+	other.m_recordSize = 0u;
+	other.m_recordCapacity = 0u;
+	other.m_buckets = nullptr;
+	other.m_bucketCount = 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeStore& PDB::TypeStore::operator=(TypeStore&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		PDB_DELETE_ARRAY(m_hashes);
+		PDB_DELETE_ARRAY(m_recordOffsets);
+		PDB_DELETE_ARRAY(m_records);
+		PDB_DELETE_ARRAY(m_buckets);
+
+		m_hashes = PDB_MOVE(other.m_hashes);
+		m_recordOffsets = PDB_MOVE(other.m_recordOffsets);
+		m_typeCount = PDB_MOVE(other.m_typeCount);
+		m_typeCapacity = PDB_MOVE(other.m_typeCapacity);
+		m_records = PDB_MOVE(other.m_records);
+		m_recordSize = PDB_MOVE(other.m_recordSize);
+		m_recordCapacity = PDB_MOVE(other.m_recordCapacity);
+		m_buckets = PDB_MOVE(other.m_buckets);
+		m_bucketCount = PDB_MOVE(other.m_bucketCount);
+
+		other.m_hashes = nullptr;
+		other.m_recordOffsets = nullptr;
+		other.m_typeCount = 0u;
+		other.m_typeCapacity = 0u;
+		other.m_records = nullptr;
+		other.m_recordSize = 0u;
+		other.m_recordCapacity = 0u;
+		other.m_buckets = nullptr;
+		other.m_bucketCount = 0u;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeStore::~TypeStore(void) PDB_NO_EXCEPT
+{
+	PDB_DELETE_ARRAY(m_hashes);
+	PDB_DELETE_ARRAY(m_recordOffsets);
+	PDB_DELETE_ARRAY(m_records);
+	PDB_DELETE_ARRAY(m_buckets);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+size_t PDB::TypeStore::AddTypes(const TypeTable& typeTable, const TypeHasher& typeHasher, uint32_t* globalTypeIndices) PDB_NO_EXCEPT
+{
+	const uint32_t typeIndexBegin = typeTable.GetFirstTypeIndex();
+	const uint32_t typeIndexEnd = typeTable.GetLastTypeIndex();
+	const size_t previousTypeCount = m_typeCount;
+
+	// assign global type indices to all types first, so that records can refer to types with a higher index
+	for (uint32_t typeIndex = typeIndexBegin; typeIndex < typeIndexEnd; ++typeIndex)
+	{
+		globalTypeIndices[typeIndex - typeIndexBegin] = FindOrAddType(typeHasher.GetHash(typeIndex));
+	}
+
+	// the offsets of the type indices referenced by a record, grown on demand for long field lists
+	size_t offsetCapacity = 256u;
+	uint32_t* offsets = PDB_NEW_ARRAY(uint32_t, offsetCapacity);
+
+	for (uint32_t typeIndex = typeIndexBegin; typeIndex < typeIndexEnd; ++typeIndex)
+	{
+		// only copy the records of new types, once
+		const size_t globalSlot = globalTypeIndices[typeIndex - typeIndexBegin] - FirstTypeIndex;
+		if ((globalSlot < previousTypeCount) || (m_recordOffsets[globalSlot] != NoRecord))
+		{
+			continue;
+		}
+
+		const CodeView::TPI::Record* record = typeTable.GetTypeRecord(typeIndex);
+		if (!record)
+		{
+			continue;
+		}
+
+		size_t offsetCount = GetTypeIndexReferences(record, offsets, offsetCapacity);
+		if (offsetCount > offsetCapacity)
+		{
+			PDB_DELETE_ARRAY(offsets);
+			offsetCapacity = offsetCount;
+			offsets = PDB_NEW_ARRAY(uint32_t, offsetCapacity);
+			offsetCount = GetTypeIndexReferences(record, offsets, offsetCapacity);
+		}
+
+		const size_t size = sizeof(uint16_t) + record->header.size;
+		const size_t alignedSize = BitUtil::RoundUpToMultiple<size_t>(size, 4u);
+		Grow(m_records, m_recordSize, m_recordCapacity, m_recordSize + alignedSize);
+
+		Byte* copy = m_records + m_recordSize;
+		memcpy(copy, record, size);
+		memset(copy + size, 0, alignedSize - size);
+
+		// built-in types keep their index
+		for (size_t i = 0u; i < offsetCount; ++i)
+		{
+			uint32_t* referencedIndex = reinterpret_cast<uint32_t*>(copy + offsets[i]);
+			if ((*referencedIndex >= typeIndexBegin) && (*referencedIndex < typeIndexEnd))
+			{
+				*referencedIndex = globalTypeIndices[*referencedIndex - typeIndexBegin];
+			}
+		}
+
+		m_recordOffsets[globalSlot] = static_cast<uint32_t>(m_recordSize);
+		m_recordSize += alignedSize;
+	}
+
+	PDB_DELETE_ARRAY(offsets);
+
+	return m_typeCount - previousTypeCount;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::TypeStore::FindType(const TypeHash& hash) const PDB_NO_EXCEPT
+{
+	if (m_bucketCount == 0u)
+	{
+		return 0u;
+	}
+
+	for (size_t bucket = hash.low & (m_bucketCount - 1u); m_buckets[bucket] != 0u; bucket = (bucket + 1u) & (m_bucketCount - 1u))
+	{
+		const uint32_t globalTypeIndex = m_buckets[bucket];
+		if (m_hashes[globalTypeIndex - FirstTypeIndex] == hash)
+		{
+			return globalTypeIndex;
+		}
+	}
+
+	return 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const PDB::CodeView::TPI::Record* PDB::TypeStore::GetTypeRecord(uint32_t globalTypeIndex) const PDB_NO_EXCEPT
+{
+	if ((globalTypeIndex < FirstTypeIndex) || (globalTypeIndex >= GetLastTypeIndex()))
+	{
+		return nullptr;
+	}
+
+	const uint32_t offset = m_recordOffsets[globalTypeIndex - FirstTypeIndex];
+	if (offset == NoRecord)
+	{
+		return nullptr;
+	}
+
+	return reinterpret_cast<const CodeView::TPI::Record*>(m_records + offset);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD size_t PDB::TypeStore::GetAllocatedSize(void) const PDB_NO_EXCEPT
+{
+	return m_typeCapacity * (sizeof(TypeHash) + sizeof(uint32_t)) + m_recordCapacity + m_bucketCount * sizeof(uint32_t);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::TypeStore::FindOrAddType(const TypeHash& hash) PDB_NO_EXCEPT
+{
+	// keep the hash table at most half full
+	if ((m_typeCount + 1u) * 2u > m_bucketCount)
+	{
+		GrowHashTable();
+	}
+
+	size_t bucket = hash.low & (m_bucketCount - 1u);
+	for (/* nothing */; m_buckets[bucket] != 0u; bucket = (bucket + 1u) & (m_bucketCount - 1u))
+	{
+		const uint32_t globalTypeIndex = m_buckets[bucket];
+		if (m_hashes[globalTypeIndex - FirstTypeIndex] == hash)
+		{
+			return globalTypeIndex;
+		}
+	}
+
+	// both arrays share the same capacity, so grow them in lockstep
+	size_t hashCapacity = m_typeCapacity;
+	Grow(m_hashes, m_typeCount, hashCapacity, m_typeCount + 1u);
+	Grow(m_recordOffsets, m_typeCount, m_typeCapacity, m_typeCount + 1u);
+
+	const uint32_t globalTypeIndex = FirstTypeIndex + static_cast<uint32_t>(m_typeCount);
+	m_hashes[m_typeCount] = hash;
+	m_recordOffsets[m_typeCount] = NoRecord;
+	++m_typeCount;
+
+	m_buckets[bucket] = globalTypeIndex;
+
+	return globalTypeIndex;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::TypeStore::GrowHashTable(void) PDB_NO_EXCEPT
+{
+	const size_t bucketCount = (m_bucketCount < 1024u) ? 1024u : m_bucketCount * 2u;
+	uint32_t* buckets = PDB_NEW_ARRAY(uint32_t, bucketCount);
+	memset(buckets, 0, sizeof(uint32_t) * bucketCount);
+
+	for (size_t i = 0u; i < m_typeCount; ++i)
+	{
+		size_t bucket = m_hashes[i].low & (bucketCount - 1u);
+		while (buckets[bucket] != 0u)
+		{
+			bucket = (bucket + 1u) & (bucketCount - 1u);
+		}
+
+		buckets[bucket] = FirstTypeIndex + static_cast<uint32_t>(i);
+	}
+
+	PDB_DELETE_ARRAY(m_buckets);
+	m_buckets = buckets;
+	m_bucketCount = bucketCount;
+}
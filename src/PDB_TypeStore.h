@@ -0,0 +1,82 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "PDB_Types.h"
+#include "PDB_TPITypes.h"
+#include "PDB_TypeHasher.h"
+
+
+namespace PDB
+{
+	class TypeTable;
+
+
+	// Stores the types of many PDBs in one global table, storing each distinct type only once.
+	// types are identified by their structural hash, see TypeHasher. records are copied into the store, and all type indices
+	// they refer to are rewritten to global type indices, so the records of the store form a type index space of their own.
+	// global type indices start at the same index as in a TPI stream, so built-in types keep their index.
+	// the store is not thread-safe. types of several PDBs can be hashed concurrently, and then added one after another.
+	class PDB_NO_DISCARD TypeStore
+	{
+	public:
+		static constexpr const uint32_t FirstTypeIndex = 0x1000u;
+
+		TypeStore(void) PDB_NO_EXCEPT;
+		TypeStore(TypeStore&& other) PDB_NO_EXCEPT;
+		TypeStore& operator=(TypeStore&& other) PDB_NO_EXCEPT;
+		~TypeStore(void) PDB_NO_EXCEPT;
+
+		// Adds all types of a type table that are not stored yet, using the hashes computed for the same table.
+		// stores the global type index of each type in the given array, indexed by type index - first type index.
+		// Returns the number of types that were added.
+		size_t AddTypes(const TypeTable& typeTable, const TypeHasher& typeHasher, uint32_t* globalTypeIndices) PDB_NO_EXCEPT;
+
+		// Returns the global type index of the type with the given hash, or zero if no such type is stored.
+		PDB_NO_DISCARD uint32_t FindType(const TypeHash& hash) const PDB_NO_EXCEPT;
+
+		// Returns the record with the given global type index, or nullptr if the index does not refer to a stored record.
+		PDB_NO_DISCARD const CodeView::TPI::Record* GetTypeRecord(uint32_t globalTypeIndex) const PDB_NO_EXCEPT;
+
+		// Returns the index one past the last global type.
+		PDB_NO_DISCARD inline uint32_t GetLastTypeIndex(void) const PDB_NO_EXCEPT
+		{
+			return FirstTypeIndex + static_cast<uint32_t>(m_typeCount);
+		}
+
+		// Returns the number of stored types.
+		PDB_NO_DISCARD inline size_t GetTypeCount(void) const PDB_NO_EXCEPT
+		{
+			return m_typeCount;
+		}
+
+		// Returns the number of bytes allocated by the store.
+		PDB_NO_DISCARD size_t GetAllocatedSize(void) const PDB_NO_EXCEPT;
+
+	private:
+		// Returns the global type index of a hash, adding a type without a record if the hash is not stored yet.
+		PDB_NO_DISCARD uint32_t FindOrAddType(const TypeHash& hash) PDB_NO_EXCEPT;
+
+		// Rebuilds the hash table with twice as many buckets.
+		void GrowHashTable(void) PDB_NO_EXCEPT;
+
+		// the hash and the offset of the record of each type, indexed by global type index - first type index
+		TypeHash* m_hashes;
+		uint32_t* m_recordOffsets;
+		size_t m_typeCount;
+		size_t m_typeCapacity;
+
+		// records of all types, 4-byte aligned
+		Byte* m_records;
+		size_t m_recordSize;
+		size_t m_recordCapacity;
+
+		// open-addressing hash table storing global type indices, zero denotes an empty bucket
+		uint32_t* m_buckets;
+		size_t m_bucketCount;
+
+		PDB_DISABLE_COPY(TypeStore);
+	};
+}
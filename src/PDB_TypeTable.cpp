@@ -0,0 +1,279 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_TypeTable.h"
+#include "PDB_TPIStream.h"
+#include "PDB_DirectMSFStream.h"
+#include "Foundation/PDB_BitUtil.h"
+#include "Foundation/PDB_Memory.h"
+#include "Foundation/PDB_CRT.h"
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeTable::TypeTable(void) PDB_NO_EXCEPT
+	: m_directStream(nullptr)
+	, m_stream()
+	, m_offsets(nullptr)
+	, m_cache(nullptr)
+	, m_cacheSize(0u)
+	, m_typeIndexBegin(0u)
+	, m_typeIndexEnd(0u)
+	, m_mode(Mode::Coalesced)
+	, m_segmentCacheOffsets(nullptr)
+	, m_segmentCount(0u)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeTable::TypeTable(TypeTable&& other) PDB_NO_EXCEPT
+	: m_directStream(PDB_MOVE(other.m_directStream))
+	, m_stream(PDB_MOVE(other.m_stream))
+	, m_offsets(PDB_MOVE(other.m_offsets))
+	, m_cache(PDB_MOVE(other.m_cache))
+	, m_cacheSize(PDB_MOVE(other.m_cacheSize))
+	, m_typeIndexBegin(PDB_MOVE(other.m_typeIndexBegin))
+	, m_typeIndexEnd(PDB_MOVE(other.m_typeIndexEnd))
+	, m_mode(PDB_MOVE(other.m_mode))
+	, m_segmentCacheOffsets(nullptr)
+	, m_segmentCount(0u)
+{
+	other.m_directStream = nullptr;
+	other.m_offsets = nullptr;
+	other.m_cache = nullptr;
+	other.m_cacheSize = 0u;
+	other.m_typeIndexBegin = 0u;
+	other.m_typeIndexEnd = 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeTable& PDB::TypeTable::operator=(TypeTable&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		PDB_DELETE_ARRAY(m_offsets);
+		PDB_DELETE_ARRAY(m_cache);
+
+		m_directStream = PDB_MOVE(other.m_directStream);
+		m_stream = PDB_MOVE(other.m_stream);
+		m_offsets = PDB_MOVE(other.m_offsets);
+		m_cache = PDB_MOVE(other.m_cache);
+		m_cacheSize = PDB_MOVE(other.m_cacheSize);
+		m_typeIndexBegin = PDB_MOVE(other.m_typeIndexBegin);
+		m_typeIndexEnd = PDB_MOVE(other.m_typeIndexEnd);
+		m_mode = PDB_MOVE(other.m_mode);
+
+		other.m_directStream = nullptr;
+		other.m_offsets = nullptr;
+		other.m_cache = nullptr;
+		other.m_cacheSize = 0u;
+		other.m_typeIndexBegin = 0u;
+		other.m_typeIndexEnd = 0u;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeTable::TypeTable(const TPIStream& tpiStream, Mode mode) PDB_NO_EXCEPT
+	: TypeTable()
+{
+	if (!BeginBuild(tpiStream, mode))
+	{
+		return;
+	}
+
+	for (size_t i = 0u; i < m_segmentCount; ++i)
+	{
+		IndexSegment(tpiStream, i);
+	}
+
+	if (PrepareCache())
+	{
+		for (size_t i = 0u; i < m_segmentCount; ++i)
+		{
+			CacheSegment(tpiStream, i);
+		}
+	}
+
+	EndBuild();
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::TypeTable::~TypeTable(void) PDB_NO_EXCEPT
+{
+	PDB_DELETE_ARRAY(m_offsets);
+	PDB_DELETE_ARRAY(m_cache);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD bool PDB::TypeTable::BeginBuild(const TPIStream& tpiStream, Mode mode) PDB_NO_EXCEPT
+{
+	m_directStream = &tpiStream.GetDirectMSFStream();
+	m_typeIndexBegin = tpiStream.GetFirstTypeIndex();
+	m_typeIndexEnd = tpiStream.GetLastTypeIndex();
+	m_mode = mode;
+
+	const size_t recordCount = tpiStream.GetTypeRecordCount();
+	if (recordCount == 0u)
+	{
+		return false;
+	}
+
+	PDB_ASSERT(m_directStream->GetSize() < CachedRecordBit, "TPI stream size %u is too large to be stored in a type table.", m_directStream->GetSize());
+
+	// records that are not found while walking the stream keep a zero offset
+	m_offsets = PDB_NEW_ARRAY(uint32_t, recordCount);
+	memset(m_offsets, 0, sizeof(uint32_t) * recordCount);
+
+	m_segmentCount = tpiStream.GetRecordSegmentCount();
+	m_segmentCacheOffsets = PDB_NEW_ARRAY(size_t, m_segmentCount + 1u);
+	memset(m_segmentCacheOffsets, 0, sizeof(size_t) * (m_segmentCount + 1u));
+
+	return true;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::TypeTable::IndexSegment(const TPIStream& tpiStream, size_t segmentIndex) PDB_NO_EXCEPT
+{
+	// each segment only writes to the offsets of its own records, and its own cache size
+	size_t cacheSize = 0u;
+	tpiStream.ForEachTypeRecordInSegment(segmentIndex, [this, &cacheSize](uint32_t typeIndex, const CodeView::TPI::RecordHeader& header, size_t offset)
+	{
+		m_offsets[typeIndex - m_typeIndexBegin] = static_cast<uint32_t>(offset);
+
+		const size_t recordSize = header.size + sizeof(uint16_t);
+		if ((m_mode == Mode::Lazy) && !m_directStream->GetContiguousDataAtOffset(offset, recordSize))
+		{
+			// keep copied records 4-byte aligned, same as in the stream
+			cacheSize += BitUtil::RoundUpToMultiple<size_t>(recordSize, 4u);
+		}
+	});
+
+	m_segmentCacheOffsets[segmentIndex + 1u] = cacheSize;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD bool PDB::TypeTable::PrepareCache(void) PDB_NO_EXCEPT
+{
+	if (m_mode == Mode::Coalesced)
+	{
+		m_stream = CoalescedMSFStream(*m_directStream, m_directStream->GetSize(), 0u);
+		return false;
+	}
+
+	// turn the cache size of each segment into its offset into the cache
+	for (size_t i = 0u; i < m_segmentCount; ++i)
+	{
+		m_segmentCacheOffsets[i + 1u] += m_segmentCacheOffsets[i];
+	}
+
+	m_cacheSize = m_segmentCacheOffsets[m_segmentCount];
+	if (m_cacheSize == 0u)
+	{
+		return false;
+	}
+
+	m_cache = PDB_NEW_ARRAY(Byte, m_cacheSize);
+
+	return true;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::TypeTable::CacheSegment(const TPIStream& tpiStream, size_t segmentIndex) PDB_NO_EXCEPT
+{
+	size_t cacheOffset = m_segmentCacheOffsets[segmentIndex];
+	tpiStream.ForEachTypeRecordInSegment(segmentIndex, [this, &cacheOffset](uint32_t typeIndex, const CodeView::TPI::RecordHeader& header, size_t offset)
+	{
+		const size_t recordSize = header.size + sizeof(uint16_t);
+		if (m_directStream->GetContiguousDataAtOffset(offset, recordSize))
+		{
+			return;
+		}
+
+		m_directStream->ReadAtOffset(m_cache + cacheOffset, recordSize, offset);
+		m_offsets[typeIndex - m_typeIndexBegin] = static_cast<uint32_t>(cacheOffset) | CachedRecordBit;
+
+		cacheOffset += BitUtil::RoundUpToMultiple<size_t>(recordSize, 4u);
+	});
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::TypeTable::EndBuild(void) PDB_NO_EXCEPT
+{
+	PDB_DELETE_ARRAY(m_segmentCacheOffsets);
+	m_segmentCacheOffsets = nullptr;
+	m_segmentCount = 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const PDB::CodeView::TPI::Record* PDB::TypeTable::GetTypeRecord(uint32_t typeIndex) const PDB_NO_EXCEPT
+{
+	if ((typeIndex < m_typeIndexBegin) || (typeIndex >= m_typeIndexEnd))
+	{
+		return nullptr;
+	}
+
+	const uint32_t offset = m_offsets[typeIndex - m_typeIndexBegin];
+	if (offset == 0u)
+	{
+		return nullptr;
+	}
+
+	if (m_mode == Mode::Coalesced)
+	{
+		return m_stream.GetDataAtOffset<const CodeView::TPI::Record>(offset);
+	}
+
+	if ((offset & CachedRecordBit) != 0u)
+	{
+		return reinterpret_cast<const CodeView::TPI::Record*>(m_cache + (offset & ~CachedRecordBit));
+	}
+
+	// records that are not cached are known to be stored contiguously
+	return static_cast<const CodeView::TPI::Record*>(m_directStream->GetContiguousDataAtOffset(offset, sizeof(CodeView::TPI::RecordHeader)));
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD size_t PDB::TypeTable::GetAllocatedSize(void) const PDB_NO_EXCEPT
+{
+	size_t size = GetTypeRecordCount() * sizeof(uint32_t) + m_cacheSize;
+	if (m_mode == Mode::Coalesced)
+	{
+		// this overestimates the size in the rare case that all of the stream's blocks are contiguous, which needs no copy
+		size += m_stream.GetSize();
+	}
+
+	return size;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::TypeTable PDB::CreateTypeTable(const TPIStream& tpiStream, TypeTable::Mode mode) PDB_NO_EXCEPT
+{
+	return TypeTable { tpiStream, mode };
+}
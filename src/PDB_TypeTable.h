@@ -0,0 +1,151 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "PDB_Types.h"
+#include "PDB_TPITypes.h"
+#include "PDB_CoalescedMSFStream.h"
+
+
+namespace PDB
+{
+	class TPIStream;
+	class DirectMSFStream;
+
+
+	// Provides O(1) access to TPI records by their type index.
+	// types are not stored with their index in the TPI stream, so the table walks the stream once and stores the offset of each record.
+	// in coalesced mode, the whole stream is coalesced upon construction, which makes accessing records as fast as possible.
+	// in lazy mode, records are accessed directly in the memory-mapped file. only records that cross a block boundary are copied
+	// upon construction, which uses a fraction of the memory needed by the coalesced mode.
+	// the TPI stream must outlive a table in lazy mode.
+	class PDB_NO_DISCARD TypeTable
+	{
+	public:
+		enum class PDB_NO_DISCARD Mode : uint8_t
+		{
+			Coalesced,
+			Lazy
+		};
+
+		TypeTable(void) PDB_NO_EXCEPT;
+		TypeTable(TypeTable&& other) PDB_NO_EXCEPT;
+		TypeTable& operator=(TypeTable&& other) PDB_NO_EXCEPT;
+
+		explicit TypeTable(const TPIStream& tpiStream, Mode mode) PDB_NO_EXCEPT;
+
+		// Builds the table by walking the record segments of the TPI stream concurrently, see TPIStream::ForEachTypeRecordInSegment().
+		// the given functor is called with a number of tasks and a task, and must call the task once for each index in [0, count),
+		// e.g. by distributing the calls across a thread pool. it must not return before all tasks have finished.
+		template <typename ParallelFor>
+		explicit TypeTable(const TPIStream& tpiStream, Mode mode, ParallelFor&& parallelFor) PDB_NO_EXCEPT
+			: TypeTable()
+		{
+			if (!BeginBuild(tpiStream, mode))
+			{
+				return;
+			}
+
+			parallelFor(m_segmentCount, [this, &tpiStream](size_t segmentIndex)
+			{
+				IndexSegment(tpiStream, segmentIndex);
+			});
+
+			if (PrepareCache())
+			{
+				parallelFor(m_segmentCount, [this, &tpiStream](size_t segmentIndex)
+				{
+					CacheSegment(tpiStream, segmentIndex);
+				});
+			}
+
+			EndBuild();
+		}
+
+		~TypeTable(void) PDB_NO_EXCEPT;
+
+		// Returns the record with the given type index, or nullptr if the index does not refer to a record in the TPI stream.
+		PDB_NO_DISCARD const CodeView::TPI::Record* GetTypeRecord(uint32_t typeIndex) const PDB_NO_EXCEPT;
+
+		// Iterates all records in type index order.
+		template <typename F>
+		void ForEachTypeRecord(F&& functor) const PDB_NO_EXCEPT
+		{
+			for (uint32_t typeIndex = m_typeIndexBegin; typeIndex < m_typeIndexEnd; ++typeIndex)
+			{
+				functor(typeIndex, GetTypeRecord(typeIndex));
+			}
+		}
+
+		// Returns the index of the first type, which is not necessarily zero.
+		PDB_NO_DISCARD inline uint32_t GetFirstTypeIndex(void) const PDB_NO_EXCEPT
+		{
+			return m_typeIndexBegin;
+		}
+
+		// Returns the index one past the last type.
+		PDB_NO_DISCARD inline uint32_t GetLastTypeIndex(void) const PDB_NO_EXCEPT
+		{
+			return m_typeIndexEnd;
+		}
+
+		// Returns the number of type records.
+		PDB_NO_DISCARD inline size_t GetTypeRecordCount(void) const PDB_NO_EXCEPT
+		{
+			return m_typeIndexEnd - m_typeIndexBegin;
+		}
+
+		// Returns the mode the table was built with.
+		PDB_NO_DISCARD inline Mode GetMode(void) const PDB_NO_EXCEPT
+		{
+			return m_mode;
+		}
+
+		// Returns the number of bytes allocated by the table.
+		PDB_NO_DISCARD size_t GetAllocatedSize(void) const PDB_NO_EXCEPT;
+
+	private:
+		// in lazy mode, offsets with this bit set refer to the copy of a record in the cache rather than the stream
+		static constexpr const uint32_t CachedRecordBit = 0x80000000u;
+
+		// Allocates the offsets and build data. Returns false if there is nothing to build.
+		PDB_NO_DISCARD bool BeginBuild(const TPIStream& tpiStream, Mode mode) PDB_NO_EXCEPT;
+
+		// Stores the offsets of all records in a segment, and the size needed for caching its records in lazy mode.
+		void IndexSegment(const TPIStream& tpiStream, size_t segmentIndex) PDB_NO_EXCEPT;
+
+		// Coalesces the stream or allocates the cache. Returns true if records need to be cached.
+		PDB_NO_DISCARD bool PrepareCache(void) PDB_NO_EXCEPT;
+
+		// Copies all records of a segment that cross a block boundary into the cache.
+		void CacheSegment(const TPIStream& tpiStream, size_t segmentIndex) PDB_NO_EXCEPT;
+
+		// Frees all build data.
+		void EndBuild(void) PDB_NO_EXCEPT;
+
+		const DirectMSFStream* m_directStream;
+		CoalescedMSFStream m_stream;
+
+		// the offset of each record, indexed by type index - first type index
+		uint32_t* m_offsets;
+
+		// copies of records crossing block boundaries, only used in lazy mode
+		Byte* m_cache;
+		size_t m_cacheSize;
+
+		uint32_t m_typeIndexBegin;
+		uint32_t m_typeIndexEnd;
+		Mode m_mode;
+
+		// the offset of each segment's records in the cache, only needed while building
+		size_t* m_segmentCacheOffsets;
+		size_t m_segmentCount;
+
+		PDB_DISABLE_COPY(TypeTable);
+	};
+
+	// Creates a type table from the TPI stream.
+	PDB_NO_DISCARD TypeTable CreateTypeTable(const TPIStream& tpiStream, TypeTable::Mode mode) PDB_NO_EXCEPT;
+}
@@ -0,0 +1,203 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "PDB_PCH.h"
+#include "PDB_UDTSourceIndex.h"
+#include "PDB_IPIStream.h"
+#include "PDB_NamesStream.h"
+#include "Foundation/PDB_RadixSort.h"
+#include "Foundation/PDB_Memory.h"
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::UDTSourceIndex::UDTSourceIndex(void) PDB_NO_EXCEPT
+	: m_entries(nullptr)
+	, m_entryCount(0u)
+{
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::UDTSourceIndex::UDTSourceIndex(UDTSourceIndex&& other) PDB_NO_EXCEPT
+	: m_entries(PDB_MOVE(other.m_entries))
+	, m_entryCount(PDB_MOVE(other.m_entryCount))
+{
+	other.m_entries = nullptr;
+	other.m_entryCount = 0u;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::UDTSourceIndex& PDB::UDTSourceIndex::operator=(UDTSourceIndex&& other) PDB_NO_EXCEPT
+{
+	if (this != &other)
+	{
+		PDB_DELETE_ARRAY(m_entries);
+
+		m_entries = PDB_MOVE(other.m_entries);
+		m_entryCount = PDB_MOVE(other.m_entryCount);
+
+		other.m_entries = nullptr;
+		other.m_entryCount = 0u;
+	}
+
+	return *this;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::UDTSourceIndex::UDTSourceIndex(const IPIStream& ipiStream) PDB_NO_EXCEPT
+	: m_entries(nullptr)
+	, m_entryCount(0u)
+{
+	// the records of a lazy IPI stream are not indexed, so the index would silently be empty
+	PDB_ASSERT(ipiStream.GetMode() == IPIStream::Mode::Eager, "The IPI stream must have been created in eager mode.");
+
+	const ArrayView<const CodeView::IPI::Record*> records = ipiStream.GetTypeRecords();
+
+	size_t count = 0u;
+	for (const CodeView::IPI::Record* record : records)
+	{
+		if ((record->header.kind == CodeView::IPI::TypeRecordKind::LF_UDT_SRC_LINE) || (record->header.kind == CodeView::IPI::TypeRecordKind::LF_UDT_MOD_SRC_LINE))
+		{
+			++count;
+		}
+	}
+
+	if (count == 0u)
+	{
+		return;
+	}
+
+	Entry* entries = PDB_NEW_ARRAY(Entry, count);
+	uint32_t* keys = PDB_NEW_ARRAY(uint32_t, count);
+	size_t entryCount = 0u;
+	for (const CodeView::IPI::Record* record : records)
+	{
+		Entry& entry = entries[entryCount];
+		if (record->header.kind == CodeView::IPI::TypeRecordKind::LF_UDT_SRC_LINE)
+		{
+			entry.typeIndex = record->data.LF_UDT_SRC_LINE.typeIndex;
+			entry.file = record->data.LF_UDT_SRC_LINE.stringIndex;
+			entry.line = record->data.LF_UDT_SRC_LINE.line;
+			entry.moduleIndex = 0u;
+			entry.fileKind = FileKind::StringId;
+		}
+		else if (record->header.kind == CodeView::IPI::TypeRecordKind::LF_UDT_MOD_SRC_LINE)
+		{
+			entry.typeIndex = record->data.LF_UDT_MOD_SRC_LINE.typeIndex;
+			entry.file = record->data.LF_UDT_MOD_SRC_LINE.stringIndex;
+			entry.line = record->data.LF_UDT_MOD_SRC_LINE.line;
+			entry.moduleIndex = record->data.LF_UDT_MOD_SRC_LINE.moduleIndex;
+			entry.fileKind = FileKind::NamesOffset;
+		}
+		else
+		{
+			continue;
+		}
+
+		keys[entryCount] = entry.typeIndex;
+		++entryCount;
+	}
+
+	// sort by type index. the radix sort is stable, so locations of the same type keep their order in the stream.
+	uint32_t* order = PDB_NEW_ARRAY(uint32_t, count);
+	uint32_t* scratch = PDB_NEW_ARRAY(uint32_t, count);
+	for (size_t i = 0u; i < count; ++i)
+	{
+		order[i] = static_cast<uint32_t>(i);
+	}
+
+	RadixSort::SortIndices(keys, order, scratch, count);
+
+	m_entries = PDB_NEW_ARRAY(Entry, count);
+	m_entryCount = count;
+	for (size_t i = 0u; i < count; ++i)
+	{
+		m_entries[i] = entries[order[i]];
+	}
+
+	PDB_DELETE_ARRAY(scratch);
+	PDB_DELETE_ARRAY(order);
+	PDB_DELETE_ARRAY(keys);
+	PDB_DELETE_ARRAY(entries);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB::UDTSourceIndex::~UDTSourceIndex(void) PDB_NO_EXCEPT
+{
+	PDB_DELETE_ARRAY(m_entries);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::ArrayView<PDB::UDTSourceIndex::Entry> PDB::UDTSourceIndex::Find(uint32_t typeIndex) const PDB_NO_EXCEPT
+{
+	// find the first entry not ordered before the type index
+	size_t first = 0u;
+	size_t count = m_entryCount;
+	while (count != 0u)
+	{
+		const size_t step = count / 2u;
+		const size_t middle = first + step;
+		if (m_entries[middle].typeIndex < typeIndex)
+		{
+			first = middle + 1u;
+			count -= step + 1u;
+		}
+		else
+		{
+			count = step;
+		}
+	}
+
+	size_t last = first;
+	while ((last < m_entryCount) && (m_entries[last].typeIndex == typeIndex))
+	{
+		++last;
+	}
+
+	return ArrayView<Entry>(m_entries + first, last - first);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD const char* PDB::UDTSourceIndex::GetFilename(const Entry& entry, const IPIStream& ipiStream, const NamesStream& namesStream) PDB_NO_EXCEPT
+{
+	if (entry.fileKind == FileKind::NamesOffset)
+	{
+		return namesStream.GetFilename(entry.file);
+	}
+
+	PDB_ASSERT(ipiStream.GetMode() == IPIStream::Mode::Eager, "The IPI stream must have been created in eager mode.");
+
+	const ArrayView<const CodeView::IPI::Record*> records = ipiStream.GetTypeRecords();
+	if ((entry.file < ipiStream.GetFirstTypeIndex()) || (entry.file - ipiStream.GetFirstTypeIndex() >= records.GetLength()))
+	{
+		return nullptr;
+	}
+
+	const CodeView::IPI::Record* record = records[entry.file - ipiStream.GetFirstTypeIndex()];
+	if (record->header.kind != CodeView::IPI::TypeRecordKind::LF_STRING_ID)
+	{
+		return nullptr;
+	}
+
+	return record->data.LF_STRING_ID.name;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD PDB::UDTSourceIndex PDB::CreateUDTSourceIndex(const IPIStream& ipiStream) PDB_NO_EXCEPT
+{
+	return UDTSourceIndex { ipiStream };
+}
@@ -0,0 +1,70 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_ArrayView.h"
+
+
+namespace PDB
+{
+	class IPIStream;
+	class NamesStream;
+
+
+	// An index of the source locations of user-defined types, built from the LF_UDT_SRC_LINE and LF_UDT_MOD_SRC_LINE
+	// records of the IPI stream. entries are sorted by TPI type index, so finding where a type is defined is a binary
+	// search rather than a walk over the IPI stream.
+	// filenames are not resolved upon construction. compiler-generated records refer to an LF_STRING_ID record, linker-generated
+	// records refer to the "/names" stream, see GetFilename().
+	class PDB_NO_DISCARD UDTSourceIndex
+	{
+	public:
+		enum class PDB_NO_DISCARD FileKind : uint8_t
+		{
+			StringId,						// the file is the IPI type index of an LF_STRING_ID record
+			NamesOffset						// the file is an offset into the "/names" stream
+		};
+
+		struct Entry
+		{
+			uint32_t typeIndex;				// TPI type index of the user-defined type
+			uint32_t file;					// see FileKind
+			uint32_t line;
+			uint16_t moduleIndex;			// the module contributing the definition, zero for compiler-generated records
+			FileKind fileKind;
+		};
+
+		UDTSourceIndex(void) PDB_NO_EXCEPT;
+		UDTSourceIndex(UDTSourceIndex&& other) PDB_NO_EXCEPT;
+		UDTSourceIndex& operator=(UDTSourceIndex&& other) PDB_NO_EXCEPT;
+
+		// Builds the index from all records of an IPI stream created in eager mode.
+		explicit UDTSourceIndex(const IPIStream& ipiStream) PDB_NO_EXCEPT;
+		~UDTSourceIndex(void) PDB_NO_EXCEPT;
+
+		// Returns all source locations of the given type, e.g. one for each module in case of linker-generated records.
+		// The view is empty if no location is known.
+		PDB_NO_DISCARD ArrayView<Entry> Find(uint32_t typeIndex) const PDB_NO_EXCEPT;
+
+		// Returns the filename of an entry, or nullptr if it cannot be resolved.
+		// the IPI stream must have been created in eager mode.
+		PDB_NO_DISCARD static const char* GetFilename(const Entry& entry, const IPIStream& ipiStream, const NamesStream& namesStream) PDB_NO_EXCEPT;
+
+		// Returns a view of all entries in the index.
+		PDB_NO_DISCARD inline ArrayView<Entry> GetEntries(void) const PDB_NO_EXCEPT
+		{
+			return ArrayView<Entry>(m_entries, m_entryCount);
+		}
+
+	private:
+		Entry* m_entries;
+		size_t m_entryCount;
+
+		PDB_DISABLE_COPY(UDTSourceIndex);
+	};
+
+	// Creates a source location index of all user-defined types. The IPI stream must have been created in eager mode.
+	PDB_NO_DISCARD UDTSourceIndex CreateUDTSourceIndex(const IPIStream& ipiStream) PDB_NO_EXCEPT;
+}
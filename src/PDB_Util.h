@@ -4,6 +4,8 @@
 #pragma once
 
 #include "Foundation/PDB_Macros.h"
+#include "Foundation/PDB_CRT.h"
+#include "PDB_TPITypes.h"
 
 
 namespace PDB
@@ -53,4 +55,162 @@ namespace PDB
 		const size_t length = estimatedLength - nullTerminatorCount;
 		return length;
 	}
+
+	// Returns the size of a numeric leaf in bytes, including its 2-byte kind.
+	// values smaller than LF_NUMERIC are stored directly in place of the kind, larger values follow the kind.
+	PDB_NO_DISCARD inline size_t GetNumericLeafSize(const char* leaf) PDB_NO_EXCEPT
+	{
+		// size of the value following the kind, indexed by kind - LF_NUMERIC. strings have a variable size and are marked with 0xFF,
+		// unused kinds are treated as having no value.
+		static constexpr const uint8_t valueSizes[] =
+		{
+			1u, 2u, 2u, 4u, 4u,			// LF_CHAR, LF_SHORT, LF_USHORT, LF_LONG, LF_ULONG
+			4u, 8u, 10u, 16u,			// LF_REAL32, LF_REAL64, LF_REAL80, LF_REAL128
+			8u, 8u, 6u,					// LF_QUADWORD, LF_UQUADWORD, LF_REAL48
+			8u, 16u, 20u, 32u,			// LF_COMPLEX32, LF_COMPLEX64, LF_COMPLEX80, LF_COMPLEX128
+			0xFFu,						// LF_VARSTRING
+			0u, 0u, 0u, 0u, 0u, 0u,		// unused
+			16u, 16u, 16u, 8u,			// LF_OCTWORD, LF_UOCTWORD, LF_DECIMAL, LF_DATE
+			0xFFu,						// LF_UTF8STRING
+			2u							// LF_REAL16
+		};
+
+		const uint16_t kind = *reinterpret_cast<const uint16_t*>(leaf);
+		const uint16_t tableIndex = static_cast<uint16_t>(kind - static_cast<uint16_t>(CodeView::TPI::TypeRecordKind::LF_NUMERIC));
+		if (kind < static_cast<uint16_t>(CodeView::TPI::TypeRecordKind::LF_NUMERIC) || tableIndex >= sizeof(valueSizes))
+		{
+			return sizeof(CodeView::TPI::TypeRecordKind);
+		}
+
+		const uint8_t valueSize = valueSizes[tableIndex];
+		if (valueSize != 0xFFu)
+		{
+			return sizeof(CodeView::TPI::TypeRecordKind) + valueSize;
+		}
+
+		if (kind == static_cast<uint16_t>(CodeView::TPI::TypeRecordKind::LF_VARSTRING))
+		{
+			// 2-byte length followed by the string
+			const uint16_t length = *reinterpret_cast<const uint16_t*>(leaf + sizeof(CodeView::TPI::TypeRecordKind));
+			return sizeof(CodeView::TPI::TypeRecordKind) + sizeof(uint16_t) + length;
+		}
+
+		// null-terminated string
+		size_t size = sizeof(CodeView::TPI::TypeRecordKind);
+		while (leaf[size] != '\0')
+		{
+			++size;
+		}
+
+		return size + 1u;
+	}
+
+	// Returns the value of a numeric leaf as used for sizes and offsets, truncated to 32 bits.
+	// Returns zero for leaves that do not store an integer.
+	PDB_NO_DISCARD inline uint32_t GetNumericLeafValue(const char* leaf) PDB_NO_EXCEPT
+	{
+		const CodeView::TPI::TypeRecordKind kind = *reinterpret_cast<const CodeView::TPI::TypeRecordKind*>(leaf);
+		if (kind < CodeView::TPI::TypeRecordKind::LF_NUMERIC)
+		{
+			// small values are stored directly in place of the leaf kind
+			return static_cast<uint32_t>(kind);
+		}
+
+		const char* value = leaf + sizeof(CodeView::TPI::TypeRecordKind);
+		switch (kind)
+		{
+		case CodeView::TPI::TypeRecordKind::LF_CHAR:
+			return static_cast<uint32_t>(*reinterpret_cast<const signed char*>(value));
+
+		case CodeView::TPI::TypeRecordKind::LF_SHORT:
+			return static_cast<uint32_t>(*reinterpret_cast<const short*>(value));
+
+		case CodeView::TPI::TypeRecordKind::LF_USHORT:
+			return *reinterpret_cast<const uint16_t*>(value);
+
+		case CodeView::TPI::TypeRecordKind::LF_LONG:
+		case CodeView::TPI::TypeRecordKind::LF_ULONG:
+		case CodeView::TPI::TypeRecordKind::LF_QUADWORD:
+		case CodeView::TPI::TypeRecordKind::LF_UQUADWORD:
+			// 64-bit values are stored in little-endian order, so the lower 32 bits come first
+			return *reinterpret_cast<const uint32_t*>(value);
+
+		default:
+			return 0u;
+		}
+	}
+
+	// Returns the name of a user-defined type record (class, struct, interface, union or enum), or nullptr for any other record.
+	PDB_NO_DISCARD inline const char* GetUDTName(const CodeView::TPI::Record* record) PDB_NO_EXCEPT
+	{
+		switch (record->header.kind)
+		{
+		case CodeView::TPI::TypeRecordKind::LF_CLASS:
+		case CodeView::TPI::TypeRecordKind::LF_STRUCTURE:
+		case CodeView::TPI::TypeRecordKind::LF_INTERFACE:
+			return record->data.LF_CLASS.data + GetNumericLeafSize(record->data.LF_CLASS.data);
+
+		case CodeView::TPI::TypeRecordKind::LF_CLASS2:
+		case CodeView::TPI::TypeRecordKind::LF_STRUCTURE2:
+			return record->data.LF_CLASS2.data + GetNumericLeafSize(record->data.LF_CLASS2.data);
+
+		case CodeView::TPI::TypeRecordKind::LF_UNION:
+			return record->data.LF_UNION.data + GetNumericLeafSize(record->data.LF_UNION.data);
+
+		case CodeView::TPI::TypeRecordKind::LF_ENUM:
+			return record->data.LF_ENUM.name;
+
+		default:
+			return nullptr;
+		}
+	}
+
+	// Returns the decorated unique name of a user-defined type record, or nullptr if the record does not store one.
+	PDB_NO_DISCARD inline const char* GetUDTUniqueName(const CodeView::TPI::Record* record, const CodeView::TPI::TypeProperty& property) PDB_NO_EXCEPT
+	{
+		const char* name = GetUDTName(record);
+		if (!name || !property.hasuniquename)
+		{
+			return nullptr;
+		}
+
+		// the unique name directly follows the regular name
+		while (*name != '\0')
+		{
+			++name;
+		}
+
+		return name + 1u;
+	}
+
+	// Retrieves the properties of a user-defined type record. Returns false if the record is not a user-defined type.
+	PDB_NO_DISCARD inline bool GetUDTProperty(const CodeView::TPI::Record* record, CodeView::TPI::TypeProperty& property) PDB_NO_EXCEPT
+	{
+		switch (record->header.kind)
+		{
+		case CodeView::TPI::TypeRecordKind::LF_CLASS:
+		case CodeView::TPI::TypeRecordKind::LF_STRUCTURE:
+		case CodeView::TPI::TypeRecordKind::LF_INTERFACE:
+			property = record->data.LF_CLASS.property;
+			return true;
+
+		case CodeView::TPI::TypeRecordKind::LF_CLASS2:
+		case CodeView::TPI::TypeRecordKind::LF_STRUCTURE2:
+			// the lower 16 bits of the extended property field match the regular properties
+			static_assert(sizeof(CodeView::TPI::TypeProperty) == sizeof(uint16_t), "Size mismatch.");
+			memcpy(&property, &record->data.LF_CLASS2.property, sizeof(CodeView::TPI::TypeProperty));
+			return true;
+
+		case CodeView::TPI::TypeRecordKind::LF_UNION:
+			property = record->data.LF_UNION.property;
+			return true;
+
+		case CodeView::TPI::TypeRecordKind::LF_ENUM:
+			property = record->data.LF_ENUM.property;
+			return true;
+
+		default:
+			return false;
+		}
+	}
 }
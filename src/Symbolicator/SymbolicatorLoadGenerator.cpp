@@ -0,0 +1,324 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "Examples_PCH.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "SymbolicatorProtocol.h"
+#include "ExampleMemoryMappedFile.h"
+#include "PDB.h"
+#include "PDB_RawFile.h"
+#include "PDB_InfoStream.h"
+#include "PDB_DBIStream.h"
+#include "PDB_SymbolIndexCache.h"
+#include "PDB_SymbolIndexCacheWriter.h"
+
+
+namespace
+{
+	struct Options
+	{
+		const char* socketPath;
+		const char* pdbPath;
+		unsigned int connectionCount;
+		unsigned int requestCount;
+		unsigned int batchSize;
+	};
+
+	// the PDB to request, along with the RVAs to pick from
+	struct Target
+	{
+		PDB::GUID guid;
+		uint32_t age;
+		std::vector<uint32_t> rvas;
+	};
+
+	struct ConnectionResult
+	{
+		std::vector<double> latencies;
+		uint64_t frameCount;
+		uint64_t unresolvedCount;
+		bool failed;
+	};
+
+
+	static bool LoadTarget(const char* path, Target& target)
+	{
+		MemoryMappedFile::Handle file = MemoryMappedFile::Open(path);
+		if (!file.baseAddress)
+		{
+			printf("Cannot memory-map file \"%s\"\n", path);
+			return false;
+		}
+
+		if (PDB::ValidateFile(file.baseAddress, file.len) != PDB::ErrorCode::Success)
+		{
+			printf("File \"%s\" is not a valid PDB\n", path);
+			MemoryMappedFile::Close(file);
+			return false;
+		}
+
+		{
+			const PDB::RawFile rawFile = PDB::CreateRawFile(file.baseAddress);
+			if (PDB::HasValidDBIStream(rawFile) != PDB::ErrorCode::Success)
+			{
+				printf("PDB \"%s\" has no valid DBI stream\n", path);
+				MemoryMappedFile::Close(file);
+				return false;
+			}
+
+			const PDB::InfoStream infoStream(rawFile);
+			const PDB::DBIStream dbiStream = PDB::CreateDBIStream(rawFile);
+			target.guid = infoStream.GetHeader()->guid;
+			target.age = infoStream.GetHeader()->age;
+
+			// request addresses in the middle of functions, which exercises lines and inline sites the same way real
+			// call stacks do
+			const PDB::SymbolIndexCacheWriter writer = PDB::CreateSymbolIndexCacheWriter(rawFile, infoStream, dbiStream);
+			if (writer.GetData().GetLength() == 0u)
+			{
+				printf("PDB \"%s\" is too large for a symbol index cache\n", path);
+				MemoryMappedFile::Close(file);
+				return false;
+			}
+
+			const PDB::SymbolIndexCache cache = PDB::CreateSymbolIndexCache(writer.GetData().Decay());
+			for (const PDB::SymbolIndexCache::Function& function : cache.GetFunctions())
+			{
+				target.rvas.push_back(function.rva + function.size / 2u);
+			}
+		}
+
+		MemoryMappedFile::Close(file);
+
+		if (target.rvas.empty())
+		{
+			printf("PDB \"%s\" does not contain any functions\n", path);
+			return false;
+		}
+
+		return true;
+	}
+
+
+	static int Connect(const char* socketPath)
+	{
+		sockaddr_un address = {};
+		address.sun_family = AF_UNIX;
+		if (strlen(socketPath) >= sizeof(address.sun_path))
+		{
+			return -1;
+		}
+
+		strcpy(address.sun_path, socketPath);
+
+		const int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (connection < 0)
+		{
+			return -1;
+		}
+
+		if (connect(connection, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+		{
+			close(connection);
+			return -1;
+		}
+
+		return connection;
+	}
+
+
+	static void RunConnection(const Options& options, const Target& target, unsigned int seed, ConnectionResult& result)
+	{
+		result.frameCount = 0u;
+		result.unresolvedCount = 0u;
+		result.failed = true;
+
+		const int connection = Connect(options.socketPath);
+		if (connection < 0)
+		{
+			return;
+		}
+
+		std::mt19937 random(seed);
+		std::uniform_int_distribution<size_t> distribution(0u, target.rvas.size() - 1u);
+
+		Protocol::RequestHeader request = { Protocol::RequestMagic, options.batchSize, target.guid, target.age };
+		std::vector<uint32_t> rvas(options.batchSize);
+		std::vector<Protocol::Frame> frames;
+		std::vector<char> strings;
+
+		result.latencies.reserve(options.requestCount);
+		for (unsigned int i = 0u; i < options.requestCount; ++i)
+		{
+			for (uint32_t& rva : rvas)
+			{
+				rva = target.rvas[distribution(random)];
+			}
+
+			const std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+
+			Protocol::ResponseHeader response = {};
+			if (!Protocol::Send(connection, &request, sizeof(request)) ||
+				!Protocol::Send(connection, rvas.data(), rvas.size() * sizeof(uint32_t)) ||
+				!Protocol::Receive(connection, &response, sizeof(response)))
+			{
+				close(connection);
+				return;
+			}
+
+			if ((response.magic != Protocol::ResponseMagic) || (response.status != Protocol::Status::Success))
+			{
+				printf("Server answered with status %u\n", static_cast<unsigned int>(response.status));
+				close(connection);
+				return;
+			}
+
+			frames.resize(response.frameCount);
+			strings.resize(response.stringSize);
+			if (!Protocol::Receive(connection, frames.data(), frames.size() * sizeof(Protocol::Frame)) ||
+				!Protocol::Receive(connection, strings.data(), strings.size()))
+			{
+				close(connection);
+				return;
+			}
+
+			const std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+			result.latencies.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+
+			result.frameCount += response.frameCount;
+			for (const Protocol::Frame& frame : frames)
+			{
+				if (frame.functionOffset == Protocol::NoString)
+				{
+					++result.unresolvedCount;
+				}
+			}
+		}
+
+		close(connection);
+		result.failed = false;
+	}
+
+
+	static double GetPercentile(const std::vector<double>& sortedValues, double percentile)
+	{
+		const size_t index = static_cast<size_t>(percentile / 100.0 * static_cast<double>(sortedValues.size() - 1u) + 0.5);
+		return sortedValues[index];
+	}
+
+
+	static void PrintUsage(void)
+	{
+		printf("Usage: SymbolicatorLoadGenerator <socket path> <PDB path> [--connections <count>] [--requests <count>] [--batch <count>]\n");
+		printf("  --connections  number of concurrent connections (default: 8)\n");
+		printf("  --requests     number of requests sent on each connection (default: 1000)\n");
+		printf("  --batch        number of RVAs in each request (default: 64)\n");
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	Options options = { argv[1], argv[2], 8u, 1000u, 64u };
+	for (int i = 3; i + 1 < argc; i += 2)
+	{
+		const unsigned int value = static_cast<unsigned int>(strtoul(argv[i + 1], nullptr, 10));
+		if (strcmp(argv[i], "--connections") == 0)
+		{
+			options.connectionCount = value;
+		}
+		else if (strcmp(argv[i], "--requests") == 0)
+		{
+			options.requestCount = value;
+		}
+		else if (strcmp(argv[i], "--batch") == 0)
+		{
+			options.batchSize = value;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if ((options.connectionCount == 0u) || (options.requestCount == 0u) || (options.batchSize == 0u) || (options.batchSize > Protocol::MaxRVACount))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	Target target = {};
+	if (!LoadTarget(options.pdbPath, target))
+	{
+		return 2;
+	}
+
+	printf("Sending %u requests of %u RVAs on each of %u connections, picking from %zu functions\n",
+		options.requestCount, options.batchSize, options.connectionCount, target.rvas.size());
+
+	std::vector<ConnectionResult> results(options.connectionCount);
+	std::vector<std::thread> threads;
+
+	const std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+	for (unsigned int i = 0u; i < options.connectionCount; ++i)
+	{
+		threads.emplace_back(RunConnection, std::cref(options), std::cref(target), i + 1u, std::ref(results[i]));
+	}
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	const std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+	const double seconds = std::chrono::duration<double>(end - begin).count();
+
+	std::vector<double> latencies;
+	uint64_t frameCount = 0u;
+	uint64_t unresolvedCount = 0u;
+	unsigned int failedCount = 0u;
+	for (const ConnectionResult& result : results)
+	{
+		latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+		frameCount += result.frameCount;
+		unresolvedCount += result.unresolvedCount;
+		failedCount += result.failed ? 1u : 0u;
+	}
+
+	if (failedCount != 0u)
+	{
+		printf("%u of %u connections failed\n", failedCount, options.connectionCount);
+	}
+
+	if (latencies.empty())
+	{
+		return 3;
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+
+	const double requestCount = static_cast<double>(latencies.size());
+	printf("Completed %zu requests in %.3fs\n", latencies.size(), seconds);
+	printf("  Throughput:  %.0f requests/s, %.0f RVAs/s\n", requestCount / seconds, requestCount * options.batchSize / seconds);
+	printf("  Frames:      %llu (%llu unresolved)\n", static_cast<unsigned long long>(frameCount), static_cast<unsigned long long>(unresolvedCount));
+	printf("  Latency:     p50 %.1fus, p90 %.1fus, p99 %.1fus, p99.9 %.1fus, max %.1fus\n",
+		GetPercentile(latencies, 50.0), GetPercentile(latencies, 90.0), GetPercentile(latencies, 99.0), GetPercentile(latencies, 99.9), latencies.back());
+
+	return (failedCount != 0u) ? 3 : 0;
+}
@@ -0,0 +1,509 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "Examples_PCH.h"
+
+#include <cstdio>
+
+#include "SymbolicatorPdb.h"
+#include "Foundation/PDB_PointerUtil.h"
+#include "PDB.h"
+#include "PDB_InfoStream.h"
+#include "PDB_DBIStream.h"
+#include "PDB_IPIStream.h"
+
+
+namespace
+{
+	// https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h#L4391
+	enum class BinaryAnnotationOpcode : uint32_t
+	{
+		Invalid = 0u,
+		CodeOffset,
+		ChangeCodeOffsetBase,
+		ChangeCodeOffset,
+		ChangeCodeLength,
+		ChangeFile,
+		ChangeLineOffset,
+		ChangeLineEndDelta,
+		ChangeRangeKind,
+		ChangeColumnStart,
+		ChangeColumnEndDelta,
+		ChangeCodeOffsetAndLineOffset,
+		ChangeCodeLengthAndCodeOffset,
+		ChangeColumnEnd
+	};
+
+
+	// Reads a compressed unsigned integer from binary annotations. Returns false if the data is malformed.
+	// https://github.com/microsoft/microsoft-pdb/blob/master/include/cvinfo.h#L4455
+	static bool ReadCompressedValue(const uint8_t*& data, const uint8_t* end, uint32_t& value)
+	{
+		if (data >= end)
+		{
+			return false;
+		}
+
+		const uint32_t first = *data;
+		if ((first & 0x80u) == 0u)
+		{
+			value = first;
+			data += 1;
+			return true;
+		}
+		else if ((first & 0xC0u) == 0x80u)
+		{
+			if (end - data < 2)
+			{
+				return false;
+			}
+
+			value = ((first & 0x3Fu) << 8u) | data[1];
+			data += 2;
+			return true;
+		}
+		else if ((first & 0xE0u) == 0xC0u)
+		{
+			if (end - data < 4)
+			{
+				return false;
+			}
+
+			value = ((first & 0x1Fu) << 24u) | (static_cast<uint32_t>(data[1]) << 16u) | (static_cast<uint32_t>(data[2]) << 8u) | data[3];
+			data += 4;
+			return true;
+		}
+
+		return false;
+	}
+
+
+	// signed values have their sign stored in the lowest bit
+	static int32_t DecodeSignedValue(uint32_t value)
+	{
+		return (value & 1u) ? -static_cast<int32_t>(value >> 1u) : static_cast<int32_t>(value >> 1u);
+	}
+
+
+	// Decodes the code ranges described by the binary annotations of an inline site, calling the functor with the
+	// begin and end code offset, the line and the file checksum offset of each range.
+	// code offsets are relative to the start of the function containing the inline site.
+	template <typename F>
+	static void DecodeInlineSiteRanges(const uint8_t* data, const uint8_t* end, uint32_t line, uint32_t fileChecksumOffset, F&& functor)
+	{
+		uint32_t codeOffset = 0u;
+
+		// a range starts whenever the code offset changes, and ends with the next change or once its length is known
+		bool isRangeOpen = false;
+		uint32_t rangeBegin = 0u;
+		uint32_t rangeLine = 0u;
+		uint32_t rangeFileChecksumOffset = 0u;
+
+		const auto beginRange = [&]()
+		{
+			if (isRangeOpen && (codeOffset > rangeBegin))
+			{
+				functor(rangeBegin, codeOffset, rangeLine, rangeFileChecksumOffset);
+			}
+
+			isRangeOpen = true;
+			rangeBegin = codeOffset;
+			rangeLine = line;
+			rangeFileChecksumOffset = fileChecksumOffset;
+		};
+
+		const auto endRange = [&](uint32_t length)
+		{
+			if (isRangeOpen)
+			{
+				functor(rangeBegin, rangeBegin + length, rangeLine, rangeFileChecksumOffset);
+				isRangeOpen = false;
+				codeOffset = rangeBegin + length;
+			}
+		};
+
+		uint32_t opcode = 0u;
+		while (ReadCompressedValue(data, end, opcode))
+		{
+			uint32_t value = 0u;
+			uint32_t secondValue = 0u;
+			switch (static_cast<BinaryAnnotationOpcode>(opcode))
+			{
+			case BinaryAnnotationOpcode::Invalid:
+				// the annotations are padded with zeros
+				return;
+
+			case BinaryAnnotationOpcode::CodeOffset:
+				if (!ReadCompressedValue(data, end, value))
+				{
+					return;
+				}
+				codeOffset = value;
+				beginRange();
+				break;
+
+			case BinaryAnnotationOpcode::ChangeCodeOffset:
+				if (!ReadCompressedValue(data, end, value))
+				{
+					return;
+				}
+				codeOffset += value;
+				beginRange();
+				break;
+
+			case BinaryAnnotationOpcode::ChangeCodeLength:
+				if (!ReadCompressedValue(data, end, value))
+				{
+					return;
+				}
+				endRange(value);
+				break;
+
+			case BinaryAnnotationOpcode::ChangeFile:
+				if (!ReadCompressedValue(data, end, value))
+				{
+					return;
+				}
+				fileChecksumOffset = value;
+				break;
+
+			case BinaryAnnotationOpcode::ChangeLineOffset:
+				if (!ReadCompressedValue(data, end, value))
+				{
+					return;
+				}
+				line = static_cast<uint32_t>(static_cast<int32_t>(line) + DecodeSignedValue(value));
+				break;
+
+			case BinaryAnnotationOpcode::ChangeCodeOffsetAndLineOffset:
+				// the code offset delta is stored in the lower 4 bits, the line delta in the remaining bits
+				if (!ReadCompressedValue(data, end, value))
+				{
+					return;
+				}
+				line = static_cast<uint32_t>(static_cast<int32_t>(line) + DecodeSignedValue(value >> 4u));
+				codeOffset += value & 0xFu;
+				beginRange();
+				break;
+
+			case BinaryAnnotationOpcode::ChangeCodeLengthAndCodeOffset:
+				if (!ReadCompressedValue(data, end, value) || !ReadCompressedValue(data, end, secondValue))
+				{
+					return;
+				}
+				codeOffset += secondValue;
+				beginRange();
+				endRange(value);
+				break;
+
+			case BinaryAnnotationOpcode::ChangeCodeOffsetBase:
+			case BinaryAnnotationOpcode::ChangeLineEndDelta:
+			case BinaryAnnotationOpcode::ChangeRangeKind:
+			case BinaryAnnotationOpcode::ChangeColumnStart:
+			case BinaryAnnotationOpcode::ChangeColumnEndDelta:
+			case BinaryAnnotationOpcode::ChangeColumnEnd:
+				// these don't affect code ranges or lines
+				if (!ReadCompressedValue(data, end, value))
+				{
+					return;
+				}
+				break;
+
+			default:
+				return;
+			}
+		}
+	}
+}
+
+
+SymbolicatorPdb::SymbolicatorPdb(MemoryMappedFile::Handle file, PDB::RawFile&& rawFile)
+	: m_file(file)
+	, m_rawFile(std::move(rawFile))
+	, m_namesStream()
+	, m_hasNamesStream(false)
+	, m_cacheData()
+	, m_cache()
+	, m_inlineSites()
+	, m_inlineSitesByFunction()
+	, m_inlineeNames()
+{
+}
+
+
+SymbolicatorPdb::~SymbolicatorPdb(void)
+{
+	MemoryMappedFile::Close(m_file);
+}
+
+
+std::unique_ptr<SymbolicatorPdb> SymbolicatorPdb::Open(const char* path)
+{
+	MemoryMappedFile::Handle file = MemoryMappedFile::Open(path);
+	if (!file.baseAddress)
+	{
+		return nullptr;
+	}
+
+	if (PDB::ValidateFile(file.baseAddress, file.len) != PDB::ErrorCode::Success)
+	{
+		MemoryMappedFile::Close(file);
+		return nullptr;
+	}
+
+	// from here on, the file is owned by the PDB and closed by its destructor
+	std::unique_ptr<SymbolicatorPdb> pdb(new SymbolicatorPdb(file, PDB::CreateRawFile(file.baseAddress)));
+	const PDB::RawFile& rawFile = pdb->m_rawFile;
+
+	if (PDB::HasValidDBIStream(rawFile) != PDB::ErrorCode::Success)
+	{
+		return nullptr;
+	}
+
+	const PDB::InfoStream infoStream(rawFile);
+	if (infoStream.UsesDebugFastLink())
+	{
+		return nullptr;
+	}
+
+	const PDB::DBIStream dbiStream = PDB::CreateDBIStream(rawFile);
+	const bool hasValidStreams =
+		(dbiStream.HasValidSymbolRecordStream(rawFile) == PDB::ErrorCode::Success) &&
+		(dbiStream.HasValidPublicSymbolStream(rawFile) == PDB::ErrorCode::Success) &&
+		(dbiStream.HasValidImageSectionStream(rawFile) == PDB::ErrorCode::Success) &&
+		(dbiStream.HasValidSectionContributionStream(rawFile) == PDB::ErrorCode::Success);
+	if (!hasValidStreams)
+	{
+		return nullptr;
+	}
+
+	// the cache is left empty if the PDB is too large for it
+	pdb->m_cacheData = PDB::CreateSymbolIndexCacheWriter(rawFile, infoStream, dbiStream);
+	if (pdb->m_cacheData.GetData().GetLength() == 0u)
+	{
+		return nullptr;
+	}
+
+	pdb->m_cache = PDB::CreateSymbolIndexCache(pdb->m_cacheData.GetData().Decay());
+
+	if (infoStream.HasNamesStream())
+	{
+		pdb->m_namesStream = infoStream.CreateNamesStream(rawFile);
+		pdb->m_hasNamesStream = true;
+	}
+
+	pdb->BuildInlineSites(dbiStream, infoStream);
+
+	return pdb;
+}
+
+
+size_t SymbolicatorPdb::GetMemorySize(void) const
+{
+	size_t size = m_cacheData.GetData().GetLength() + m_inlineSites.size() * sizeof(InlineSite);
+	for (const std::string& name : m_inlineeNames)
+	{
+		size += name.size() + 1u;
+	}
+
+	return size;
+}
+
+
+const char* SymbolicatorPdb::GetFilename(uint32_t filenameOffset) const
+{
+	if (!m_hasNamesStream || (filenameOffset == 0u))
+	{
+		return nullptr;
+	}
+
+	return m_namesStream.GetFilename(filenameOffset);
+}
+
+
+void SymbolicatorPdb::BuildInlineSites(const PDB::DBIStream& dbiStream, const PDB::InfoStream& infoStream)
+{
+	const PDB::ImageSectionStream imageSectionStream = dbiStream.CreateImageSectionStream(m_rawFile);
+	const PDB::ModuleInfoStream moduleInfoStream = dbiStream.CreateModuleInfoStream(m_rawFile);
+
+	// the names of inlined functions are stored in the IPI stream
+	PDB::IPIStream ipiStream;
+	const bool hasIPIStream = infoStream.HasIPIStream() && (PDB::HasValidIPIStream(m_rawFile) == PDB::ErrorCode::Success);
+	if (hasIPIStream)
+	{
+		ipiStream = PDB::CreateIPIStream(m_rawFile);
+	}
+
+	std::unordered_map<uint32_t, uint32_t> inlineeNameIndices;
+	const auto getInlineeNameIndex = [this, &ipiStream, hasIPIStream, &inlineeNameIndices](uint32_t inlinee) -> uint32_t
+	{
+		const auto it = inlineeNameIndices.find(inlinee);
+		if (it != inlineeNameIndices.end())
+		{
+			return it->second;
+		}
+
+		std::string name;
+		if (hasIPIStream && (inlinee >= ipiStream.GetFirstTypeIndex()) && (inlinee < ipiStream.GetLastTypeIndex()))
+		{
+			const PDB::CodeView::IPI::Record* record = ipiStream.GetTypeRecords()[inlinee - ipiStream.GetFirstTypeIndex()];
+			if (record->header.kind == PDB::CodeView::IPI::TypeRecordKind::LF_FUNC_ID)
+			{
+				name = record->data.LF_FUNC_ID.name;
+			}
+			else if (record->header.kind == PDB::CodeView::IPI::TypeRecordKind::LF_MFUNC_ID)
+			{
+				name = record->data.LF_MFUNC_ID.name;
+			}
+		}
+
+		if (name.empty())
+		{
+			char buffer[32];
+			snprintf(buffer, sizeof(buffer), "<inlinee 0x%X>", inlinee);
+			name = buffer;
+		}
+
+		const uint32_t index = static_cast<uint32_t>(m_inlineeNames.size());
+		m_inlineeNames.push_back(std::move(name));
+		inlineeNameIndices.emplace(inlinee, index);
+
+		return index;
+	};
+
+	struct FunctionInlineSite
+	{
+		uint32_t functionRva;
+		InlineSite site;
+	};
+
+	std::vector<FunctionInlineSite> sites;
+
+	for (const PDB::ModuleInfoStream::Module& module : moduleInfoStream.GetModules())
+	{
+		if (!module.HasSymbolStream())
+		{
+			continue;
+		}
+
+		// the line an inlined function starts at, and the file it is stored in, are stored in the module's line stream
+		struct InlineeLine
+		{
+			uint32_t fileChecksumOffset;
+			uint32_t line;
+		};
+
+		std::unordered_map<uint32_t, InlineeLine> inlineeLines;
+		const PDB::CodeView::DBI::FileChecksumHeader* checksums = nullptr;
+
+		PDB::ModuleLineStream lineStream;
+		if (module.HasLineStream())
+		{
+			lineStream = module.CreateLineStream(m_rawFile);
+			lineStream.ForEachSection([&lineStream, &inlineeLines, &checksums](const PDB::CodeView::DBI::LineSection* section)
+			{
+				if (section->header.kind == PDB::CodeView::DBI::DebugSubsectionKind::S_FILECHECKSUMS)
+				{
+					checksums = &section->checksumHeader;
+				}
+				else if (section->header.kind == PDB::CodeView::DBI::DebugSubsectionKind::S_INLINEELINES)
+				{
+					if (section->inlineeHeader.kind == PDB::CodeView::DBI::InlineeSourceLineKind::Signature)
+					{
+						lineStream.ForEachInlineeSourceLine(section, [&inlineeLines](const PDB::CodeView::DBI::InlineeSourceLine* inlineeLine)
+						{
+							inlineeLines[inlineeLine->inlinee] = InlineeLine { inlineeLine->fileChecksumOffset, inlineeLine->lineNumber };
+						});
+					}
+					else
+					{
+						lineStream.ForEachInlineeSourceLineEx(section, [&inlineeLines](const PDB::CodeView::DBI::InlineeSourceLineEx* inlineeLine)
+						{
+							inlineeLines[inlineeLine->inlinee] = InlineeLine { inlineeLine->fileChecksumOffset, inlineeLine->lineNumber };
+						});
+					}
+				}
+			});
+		}
+
+		const auto getFilenameOffset = [checksums](uint32_t fileChecksumOffset) -> uint32_t
+		{
+			if (!checksums)
+			{
+				return 0u;
+			}
+
+			return PDB::Pointer::Offset<const PDB::CodeView::DBI::FileChecksumHeader*>(checksums, fileChecksumOffset)->filenameOffset;
+		};
+
+		uint32_t functionRva = 0u;
+		uint32_t depth = 0u;
+
+		const PDB::ModuleSymbolStream moduleSymbolStream = module.CreateSymbolStream(m_rawFile);
+		moduleSymbolStream.ForEachSymbol([&](const PDB::CodeView::DBI::Record* record)
+		{
+			const PDB::CodeView::DBI::SymbolRecordKind kind = record->header.kind;
+			if (kind == PDB::CodeView::DBI::SymbolRecordKind::S_LPROC32 || kind == PDB::CodeView::DBI::SymbolRecordKind::S_GPROC32 ||
+				kind == PDB::CodeView::DBI::SymbolRecordKind::S_LPROC32_ID || kind == PDB::CodeView::DBI::SymbolRecordKind::S_GPROC32_ID)
+			{
+				// all kinds of procedures share the same layout
+				functionRva = imageSectionStream.ConvertSectionOffsetToRVA(record->data.S_GPROC32.section, record->data.S_GPROC32.offset);
+				depth = 0u;
+			}
+			else if (kind == PDB::CodeView::DBI::SymbolRecordKind::S_INLINESITE || kind == PDB::CodeView::DBI::SymbolRecordKind::S_INLINESITE2)
+			{
+				++depth;
+				if (functionRva == 0u)
+				{
+					return;
+				}
+
+				// S_INLINESITE2 additionally stores the number of invocations before the annotations
+				const uint8_t* annotations = record->data.S_INLINESITE.binaryAnnotations;
+				if (kind == PDB::CodeView::DBI::SymbolRecordKind::S_INLINESITE2)
+				{
+					annotations += sizeof(uint32_t);
+				}
+
+				// the record size does not include the size field itself
+				const uint8_t* annotationsEnd = PDB::Pointer::Offset<const uint8_t*>(record, sizeof(uint16_t) + record->header.size);
+
+				const uint32_t inlinee = record->data.S_INLINESITE.inlinee;
+				const auto inlineeLine = inlineeLines.find(inlinee);
+				const uint32_t baseLine = (inlineeLine != inlineeLines.end()) ? inlineeLine->second.line : 0u;
+				const uint32_t baseFileChecksumOffset = (inlineeLine != inlineeLines.end()) ? inlineeLine->second.fileChecksumOffset : 0u;
+				const uint32_t nameIndex = getInlineeNameIndex(inlinee);
+
+				DecodeInlineSiteRanges(annotations, annotationsEnd, baseLine, baseFileChecksumOffset, [&](uint32_t begin, uint32_t end, uint32_t line, uint32_t fileChecksumOffset)
+				{
+					const InlineSite site = { functionRva + begin, functionRva + end, depth, nameIndex, getFilenameOffset(fileChecksumOffset), line };
+					sites.push_back(FunctionInlineSite { functionRva, site });
+				});
+			}
+			else if (kind == PDB::CodeView::DBI::SymbolRecordKind::S_INLINESITE_END)
+			{
+				depth = (depth != 0u) ? depth - 1u : 0u;
+			}
+		});
+	}
+
+	// group the sites by function, ordered by depth so that lookups can easily start with the innermost site
+	std::sort(sites.begin(), sites.end(), [](const FunctionInlineSite& lhs, const FunctionInlineSite& rhs)
+	{
+		if (lhs.functionRva != rhs.functionRva)
+		{
+			return lhs.functionRva < rhs.functionRva;
+		}
+
+		return (lhs.site.depth != rhs.site.depth) ? (lhs.site.depth < rhs.site.depth) : (lhs.site.rvaBegin < rhs.site.rvaBegin);
+	});
+
+	m_inlineSites.reserve(sites.size());
+	for (const FunctionInlineSite& site : sites)
+	{
+		InlineSiteRange& range = m_inlineSitesByFunction.emplace(site.functionRva, InlineSiteRange { static_cast<uint32_t>(m_inlineSites.size()), 0u }).first->second;
+		++range.count;
+
+		m_inlineSites.push_back(site.site);
+	}
+}
@@ -0,0 +1,111 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "ExampleMemoryMappedFile.h"
+#include "PDB_RawFile.h"
+#include "PDB_InfoStream.h"
+#include "PDB_DBIStream.h"
+#include "PDB_NamesStream.h"
+#include "PDB_SymbolIndexCache.h"
+#include "PDB_SymbolIndexCacheWriter.h"
+
+
+// A PDB opened by the symbolication server, holding everything needed for resolving RVAs.
+// functions, lines and contributions are looked up in a symbol index cache built when the PDB is opened, and inlined
+// functions are looked up in the code ranges decoded from the binary annotations of all S_INLINESITE records.
+// once opened, a PDB is immutable and can be queried from any number of threads.
+class SymbolicatorPdb
+{
+public:
+	// Opens the PDB at the given path. Returns nullptr if the PDB is invalid.
+	static std::unique_ptr<SymbolicatorPdb> Open(const char* path);
+
+	~SymbolicatorPdb(void);
+
+	// Calls the functor for each frame at the given RVA, starting with the innermost inlined function.
+	// the functor is called with the function name, the filename and the line, each of which can be unknown.
+	template <typename F>
+	void ForEachFrame(uint32_t rva, F&& functor) const
+	{
+		const PDB::SymbolIndexCache::Function* function = m_cache.FindFunction(rva);
+		if (!function)
+		{
+			functor(nullptr, nullptr, 0u, false);
+			return;
+		}
+
+		// inline sites are stored ordered by depth, so walk them backwards to start with the innermost one
+		const auto it = m_inlineSitesByFunction.find(function->rva);
+		if (it != m_inlineSitesByFunction.end())
+		{
+			for (uint32_t i = it->second.count; i > 0u; --i)
+			{
+				const InlineSite& site = m_inlineSites[it->second.first + i - 1u];
+				if ((rva >= site.rvaBegin) && (rva < site.rvaEnd))
+				{
+					functor(m_inlineeNames[site.inlineeNameIndex].c_str(), GetFilename(site.filenameOffset), site.line, true);
+				}
+			}
+		}
+
+		PDB::LineIndex::Line line = {};
+		if (m_cache.GetLineIndex().FindLine(rva, line))
+		{
+			functor(m_cache.GetFunctionName(*function), (line.filenameOffset != 0u) ? m_cache.GetFilename(line) : nullptr, line.lineNumber, false);
+		}
+		else
+		{
+			functor(m_cache.GetFunctionName(*function), nullptr, 0u, false);
+		}
+	}
+
+	// Returns the number of bytes held in memory for this PDB, not counting the memory-mapped file.
+	size_t GetMemorySize(void) const;
+
+private:
+	// a code range of an inlined function, along with the line it stems from
+	struct InlineSite
+	{
+		uint32_t rvaBegin;
+		uint32_t rvaEnd;
+		uint32_t depth;
+		uint32_t inlineeNameIndex;
+		uint32_t filenameOffset;
+		uint32_t line;
+	};
+
+	struct InlineSiteRange
+	{
+		uint32_t first;
+		uint32_t count;
+	};
+
+	SymbolicatorPdb(MemoryMappedFile::Handle file, PDB::RawFile&& rawFile);
+
+	// Returns the filename of an inline site, which refers to the "/names" stream.
+	const char* GetFilename(uint32_t filenameOffset) const;
+
+	void BuildInlineSites(const PDB::DBIStream& dbiStream, const PDB::InfoStream& infoStream);
+
+	MemoryMappedFile::Handle m_file;
+	PDB::RawFile m_rawFile;
+	PDB::NamesStream m_namesStream;
+	bool m_hasNamesStream;
+
+	PDB::SymbolIndexCacheWriter m_cacheData;
+	PDB::SymbolIndexCache m_cache;
+
+	// inline sites of all functions, grouped by function and ordered by depth within each function
+	std::vector<InlineSite> m_inlineSites;
+	std::unordered_map<uint32_t, InlineSiteRange> m_inlineSitesByFunction;
+	std::vector<std::string> m_inlineeNames;
+
+	PDB_DISABLE_COPY_MOVE(SymbolicatorPdb);
+};
@@ -0,0 +1,126 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "Examples_PCH.h"
+#include "SymbolicatorPdbPool.h"
+#include "SymbolicatorPdb.h"
+#include "ExampleMemoryMappedFile.h"
+#include "Foundation/PDB_Hash.h"
+#include "PDB.h"
+#include "PDB_RawFile.h"
+#include "PDB_InfoStream.h"
+
+
+size_t SymbolicatorPdbPool::KeyHash::operator()(const Key& key) const
+{
+	return PDB::Hash::FNV1a(&key.age, sizeof(key.age), PDB::Hash::FNV1a(&key.guid, sizeof(key.guid)));
+}
+
+
+SymbolicatorPdbPool::SymbolicatorPdbPool(size_t capacity)
+	: m_capacity((capacity != 0u) ? capacity : 1u)
+{
+}
+
+
+bool SymbolicatorPdbPool::Register(const char* path)
+{
+	// only the info stream is needed for identifying the PDB, so registering even large PDBs is cheap
+	MemoryMappedFile::Handle file = MemoryMappedFile::Open(path);
+	if (!file.baseAddress)
+	{
+		return false;
+	}
+
+	if (PDB::ValidateFile(file.baseAddress, file.len) != PDB::ErrorCode::Success)
+	{
+		MemoryMappedFile::Close(file);
+		return false;
+	}
+
+	Key key = {};
+	{
+		const PDB::RawFile rawFile = PDB::CreateRawFile(file.baseAddress);
+		const PDB::InfoStream infoStream(rawFile);
+		key.guid = infoStream.GetHeader()->guid;
+		key.age = infoStream.GetHeader()->age;
+	}
+
+	MemoryMappedFile::Close(file);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_paths[key] = path;
+
+	return true;
+}
+
+
+std::shared_ptr<const SymbolicatorPdb> SymbolicatorPdbPool::Acquire(const PDB::GUID& guid, uint32_t age)
+{
+	const Key key = { guid, age };
+
+	std::promise<std::shared_ptr<const SymbolicatorPdb>> promise;
+	std::string path;
+	PdbFuture existingPdb;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		const auto it = m_entryLookup.find(key);
+		if (it != m_entryLookup.end())
+		{
+			// mark the PDB as most recently used
+			m_entries.splice(m_entries.begin(), m_entries, it->second);
+			existingPdb = it->second->pdb;
+		}
+		else
+		{
+			const auto pathIt = m_paths.find(key);
+			if (pathIt == m_paths.end())
+			{
+				return nullptr;
+			}
+
+			path = pathIt->second;
+
+			m_entries.push_front(Entry { key, promise.get_future().share() });
+			m_entryLookup.emplace(key, m_entries.begin());
+
+			// evict the least recently used PDBs. requests still using them keep them alive.
+			while (m_entries.size() > m_capacity)
+			{
+				m_entryLookup.erase(m_entries.back().key);
+				m_entries.pop_back();
+			}
+		}
+	}
+
+	// wait for a PDB that is being opened by another request without holding the lock
+	if (existingPdb.valid())
+	{
+		return existingPdb.get();
+	}
+
+	// open the PDB without holding the lock, so that other PDBs can be used in the meantime
+	std::shared_ptr<const SymbolicatorPdb> pdb(SymbolicatorPdb::Open(path.c_str()));
+	promise.set_value(pdb);
+
+	// don't keep a PDB that could not be opened, so that later requests try again instead of failing for good.
+	// the entry may have been evicted and replaced in the meantime, in which case the new entry is left alone.
+	if (!pdb)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		const auto it = m_entryLookup.find(key);
+		if (it != m_entryLookup.end())
+		{
+			const PdbFuture& entryPdb = it->second->pdb;
+			if ((entryPdb.wait_for(std::chrono::seconds(0)) == std::future_status::ready) && !entryPdb.get())
+			{
+				m_entries.erase(it->second);
+				m_entryLookup.erase(it);
+			}
+		}
+	}
+
+	return pdb;
+}
@@ -0,0 +1,68 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include <cstring>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "PDB_Types.h"
+
+class SymbolicatorPdb;
+
+
+// A pool of opened PDBs, identified by their GUID and age.
+// PDBs are registered by path up front, but only opened once they are first requested. at most a given number of PDBs
+// are kept open, evicting the least recently used one when another PDB needs to be opened. evicted PDBs stay alive
+// until the last request using them has finished.
+class SymbolicatorPdbPool
+{
+public:
+	explicit SymbolicatorPdbPool(size_t capacity);
+
+	// Registers the PDB at the given path, reading its GUID and age. Returns false if the PDB is invalid.
+	bool Register(const char* path);
+
+	// Returns the PDB with the given GUID and age, opening it if necessary. Returns nullptr if no such PDB is known.
+	// concurrent requests for a PDB that is being opened wait for it instead of opening it again.
+	std::shared_ptr<const SymbolicatorPdb> Acquire(const PDB::GUID& guid, uint32_t age);
+
+private:
+	struct Key
+	{
+		PDB::GUID guid;
+		uint32_t age;
+
+		inline bool operator==(const Key& other) const
+		{
+			return (memcmp(&guid, &other.guid, sizeof(PDB::GUID)) == 0) && (age == other.age);
+		}
+	};
+
+	struct KeyHash
+	{
+		size_t operator()(const Key& key) const;
+	};
+
+	using PdbFuture = std::shared_future<std::shared_ptr<const SymbolicatorPdb>>;
+
+	struct Entry
+	{
+		Key key;
+		PdbFuture pdb;
+	};
+
+	const size_t m_capacity;
+
+	std::mutex m_mutex;
+	std::unordered_map<Key, std::string, KeyHash> m_paths;
+
+	// the most recently used PDB is stored at the front
+	std::list<Entry> m_entries;
+	std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_entryLookup;
+};
@@ -0,0 +1,120 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cerrno>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "PDB_Types.h"
+
+
+// The protocol spoken between the symbolication server and its clients over a Unix domain socket.
+// a client sends any number of requests over one connection, and the server answers each request in order.
+// all values are stored in the byte order of the machine, since both ends always run on the same machine.
+//
+// request:
+//	RequestHeader header;
+//	uint32_t rvas[header.rvaCount];
+//
+// response:
+//	ResponseHeader header;
+//	Frame frames[header.frameCount];
+//	char strings[header.stringSize];		// null-terminated strings referred to by the frames
+namespace Protocol
+{
+	static constexpr const uint32_t RequestMagic = 0x51535052u;		// "RPSQ"
+	static constexpr const uint32_t ResponseMagic = 0x53535052u;	// "RPSS"
+
+	// the maximum number of RVAs in a single request, protecting the server against bogus requests
+	static constexpr const uint32_t MaxRVACount = 1u << 20u;
+
+	// string offset denoting that a string is not known
+	static constexpr const uint32_t NoString = 0xFFFFFFFFu;
+
+	struct RequestHeader
+	{
+		uint32_t magic;
+		uint32_t rvaCount;
+		PDB::GUID guid;
+		uint32_t age;
+	};
+
+	enum class Status : uint32_t
+	{
+		Success = 0u,
+		UnknownPDB,				// the server does not know a PDB with the requested GUID and age
+		InvalidRequest			// the request is malformed, and the server closes the connection
+	};
+
+	struct ResponseHeader
+	{
+		uint32_t magic;
+		Status status;
+		uint32_t frameCount;
+		uint32_t stringSize;
+	};
+
+	// each RVA is answered by one or more frames, starting with the innermost inlined function.
+	// the last frame of an RVA is the function that contains it, and an RVA that cannot be resolved yields a single frame
+	// without a function.
+	struct Frame
+	{
+		uint32_t rvaIndex;			// index of the RVA in the request
+		uint32_t functionOffset;	// offset into strings
+		uint32_t filenameOffset;	// offset into strings
+		uint32_t line;				// zero if unknown
+		uint32_t isInlined;
+	};
+
+
+	// Receives exactly the given number of bytes. Returns false if the connection was closed or an error occurred.
+	inline bool Receive(int socket, void* data, size_t size)
+	{
+		char* bytes = static_cast<char*>(data);
+		while (size != 0u)
+		{
+			const ssize_t result = recv(socket, bytes, size, 0);
+			if (result < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			else if (result <= 0)
+			{
+				return false;
+			}
+
+			bytes += result;
+			size -= static_cast<size_t>(result);
+		}
+
+		return true;
+	}
+
+
+	// Sends exactly the given number of bytes. Returns false if the connection was closed or an error occurred.
+	inline bool Send(int socket, const void* data, size_t size)
+	{
+		const char* bytes = static_cast<const char*>(data);
+		while (size != 0u)
+		{
+			const ssize_t result = send(socket, bytes, size, 0);
+			if (result < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			else if (result <= 0)
+			{
+				return false;
+			}
+
+			bytes += result;
+			size -= static_cast<size_t>(result);
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,437 @@
+// Copyright 2011-2022, Molecular Matters GmbH <office@molecular-matters.com>
+// See LICENSE.txt for licensing details (2-clause BSD License: https://opensource.org/licenses/BSD-2-Clause)
+
+#include "Examples_PCH.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "SymbolicatorProtocol.h"
+#include "SymbolicatorPdb.h"
+#include "SymbolicatorPdbPool.h"
+
+
+namespace
+{
+	// a thread-safe queue handing work items from one thread to another
+	template <typename T>
+	class WorkQueue
+	{
+	public:
+		void Push(T&& item)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_items.push_back(std::move(item));
+			}
+
+			m_condition.notify_one();
+		}
+
+		// Waits until an item is available and removes it from the queue.
+		T Pop(void)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return !m_items.empty(); });
+
+			T item = std::move(m_items.front());
+			m_items.pop_front();
+
+			return item;
+		}
+
+		// Removes an item from the queue without waiting. Returns false if the queue is empty.
+		bool TryPop(T& item)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_items.empty())
+			{
+				return false;
+			}
+
+			item = std::move(m_items.front());
+			m_items.pop_front();
+
+			return true;
+		}
+
+	private:
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		std::deque<T> m_items;
+	};
+
+
+	// a request received by the main thread, waiting to be answered by a worker thread
+	struct Request
+	{
+		int connection;
+		Protocol::RequestHeader header;
+		std::vector<uint32_t> rvas;
+	};
+
+
+	// a connection whose request has been answered by a worker thread, handed back to the main thread
+	struct AnsweredConnection
+	{
+		int connection;
+		bool isOpen;
+	};
+
+
+	// builds a response, storing each distinct string only once
+	class ResponseBuilder
+	{
+	public:
+		void Reset(void)
+		{
+			m_frames.clear();
+			m_strings.clear();
+			m_stringOffsets.clear();
+		}
+
+		void AddFrame(uint32_t rvaIndex, const char* function, const char* filename, uint32_t line, bool isInlined)
+		{
+			const Protocol::Frame frame = { rvaIndex, AddString(function), AddString(filename), line, isInlined ? 1u : 0u };
+			m_frames.push_back(frame);
+		}
+
+		bool Send(int connection, Protocol::Status status) const
+		{
+			const Protocol::ResponseHeader header =
+			{
+				Protocol::ResponseMagic,
+				status,
+				static_cast<uint32_t>(m_frames.size()),
+				static_cast<uint32_t>(m_strings.size())
+			};
+
+			return Protocol::Send(connection, &header, sizeof(header)) &&
+				Protocol::Send(connection, m_frames.data(), m_frames.size() * sizeof(Protocol::Frame)) &&
+				Protocol::Send(connection, m_strings.data(), m_strings.size());
+		}
+
+	private:
+		uint32_t AddString(const char* string)
+		{
+			if (!string)
+			{
+				return Protocol::NoString;
+			}
+
+			// strings handed out by a PDB are stable for as long as the PDB is alive, so they can be keyed by address
+			const auto it = m_stringOffsets.find(string);
+			if (it != m_stringOffsets.end())
+			{
+				return it->second;
+			}
+
+			const uint32_t offset = static_cast<uint32_t>(m_strings.size());
+			m_strings.insert(m_strings.end(), string, string + strlen(string) + 1u);
+			m_stringOffsets.emplace(string, offset);
+
+			return offset;
+		}
+
+		std::vector<Protocol::Frame> m_frames;
+		std::vector<char> m_strings;
+		std::unordered_map<const char*, uint32_t> m_stringOffsets;
+	};
+
+
+	// answers a single request. Returns false if the response could not be sent.
+	static bool AnswerRequest(SymbolicatorPdbPool& pool, const Request& request, ResponseBuilder& response)
+	{
+		response.Reset();
+
+		const std::shared_ptr<const SymbolicatorPdb> pdb = pool.Acquire(request.header.guid, request.header.age);
+		if (!pdb)
+		{
+			return response.Send(request.connection, Protocol::Status::UnknownPDB);
+		}
+
+		for (uint32_t i = 0u; i < request.header.rvaCount; ++i)
+		{
+			pdb->ForEachFrame(request.rvas[i], [&response, i](const char* function, const char* filename, uint32_t line, bool isInlined)
+			{
+				response.AddFrame(i, function, filename, line, isInlined);
+			});
+		}
+
+		return response.Send(request.connection, Protocol::Status::Success);
+	}
+
+
+	// receives the next request of a connection. Returns false if the connection needs to be closed.
+	static bool ReceiveRequest(int connection, Request& request)
+	{
+		request.connection = connection;
+		if (!Protocol::Receive(connection, &request.header, sizeof(request.header)))
+		{
+			return false;
+		}
+
+		if ((request.header.magic != Protocol::RequestMagic) || (request.header.rvaCount > Protocol::MaxRVACount))
+		{
+			ResponseBuilder response;
+			response.Send(connection, Protocol::Status::InvalidRequest);
+			return false;
+		}
+
+		request.rvas.resize(request.header.rvaCount);
+		return Protocol::Receive(connection, request.rvas.data(), request.rvas.size() * sizeof(uint32_t));
+	}
+
+
+	static void PrintUsage(void)
+	{
+		printf("Usage: Symbolicator <socket path> [--threads <count>] [--capacity <count>] <PDB paths...>\n");
+		printf("  --threads   number of worker threads answering requests (default: number of cores)\n");
+		printf("  --capacity  maximum number of PDBs kept open at the same time (default: 16)\n");
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	const char* socketPath = argv[1];
+	unsigned int threadCount = std::thread::hardware_concurrency();
+	size_t capacity = 16u;
+	std::vector<const char*> pdbPaths;
+
+	for (int i = 2; i < argc; ++i)
+	{
+		if ((strcmp(argv[i], "--threads") == 0) && (i + 1 < argc))
+		{
+			threadCount = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+		}
+		else if ((strcmp(argv[i], "--capacity") == 0) && (i + 1 < argc))
+		{
+			capacity = static_cast<size_t>(strtoul(argv[++i], nullptr, 10));
+		}
+		else
+		{
+			pdbPaths.push_back(argv[i]);
+		}
+	}
+
+	if (threadCount == 0u)
+	{
+		threadCount = 1u;
+	}
+
+	SymbolicatorPdbPool pool(capacity);
+	for (const char* path : pdbPaths)
+	{
+		if (pool.Register(path))
+		{
+			printf("Registered PDB \"%s\"\n", path);
+		}
+		else
+		{
+			printf("Cannot register PDB \"%s\", skipping\n", path);
+		}
+	}
+
+	// clients closing their connection early must not take the server down
+	signal(SIGPIPE, SIG_IGN);
+
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if (strlen(socketPath) >= sizeof(address.sun_path))
+	{
+		printf("Socket path \"%s\" is too long\n", socketPath);
+		return 1;
+	}
+
+	strcpy(address.sun_path, socketPath);
+
+	const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0)
+	{
+		perror("socket");
+		return 1;
+	}
+
+	// a socket left behind by a previous run would make bind fail. anything else at that path is left alone.
+	struct stat status = {};
+	if (lstat(socketPath, &status) == 0)
+	{
+		if (!S_ISSOCK(status.st_mode))
+		{
+			printf("Socket path \"%s\" exists and is not a socket\n", socketPath);
+			return 1;
+		}
+
+		unlink(socketPath);
+	}
+	else if (errno != ENOENT)
+	{
+		perror("lstat");
+		return 1;
+	}
+
+	if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+	{
+		perror("bind");
+		return 1;
+	}
+
+	if (listen(listener, SOMAXCONN) != 0)
+	{
+		perror("listen");
+		return 1;
+	}
+
+	printf("Listening on \"%s\" with %u worker threads\n", socketPath, threadCount);
+
+	// the main thread polls all connections and receives their requests, which are answered by the worker threads.
+	// workers therefore serve requests rather than connections, so that any number of clients can stay connected.
+	// a connection is not polled while one of its requests is being answered, which keeps its responses in order.
+	int wakeup[2] = {};
+	if (pipe(wakeup) != 0)
+	{
+		perror("pipe");
+		return 1;
+	}
+
+	WorkQueue<Request> requests;
+	WorkQueue<AnsweredConnection> answeredConnections;
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0u; i < threadCount; ++i)
+	{
+		workers.emplace_back([&pool, &requests, &answeredConnections, &wakeup]()
+		{
+			ResponseBuilder response;
+			for (;;)
+			{
+				const Request request = requests.Pop();
+				const bool isOpen = AnswerRequest(pool, request, response);
+				answeredConnections.Push(AnsweredConnection { request.connection, isOpen });
+
+				// wake up the main thread so that it polls the connection again
+				const char byte = 0;
+				if (write(wakeup[1], &byte, 1u) < 0)
+				{
+					perror("write");
+				}
+			}
+		});
+	}
+
+	// a client that stops sending in the middle of a request must not stall the main thread for long
+	const timeval receiveTimeout = { 1, 0 };
+
+	std::vector<int> idleConnections;
+	std::vector<pollfd> pollDescriptors;
+	for (;;)
+	{
+		pollDescriptors.clear();
+		pollDescriptors.push_back(pollfd { listener, POLLIN, 0 });
+		pollDescriptors.push_back(pollfd { wakeup[0], POLLIN, 0 });
+		for (int connection : idleConnections)
+		{
+			pollDescriptors.push_back(pollfd { connection, POLLIN, 0 });
+		}
+
+		if (poll(pollDescriptors.data(), pollDescriptors.size(), -1) < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			perror("poll");
+			break;
+		}
+
+		// hand the requests of all connections that sent one to the workers
+		idleConnections.clear();
+		for (size_t i = 2u; i < pollDescriptors.size(); ++i)
+		{
+			const int connection = pollDescriptors[i].fd;
+			if (pollDescriptors[i].revents == 0)
+			{
+				idleConnections.push_back(connection);
+				continue;
+			}
+
+			Request request = {};
+			if (!ReceiveRequest(connection, request))
+			{
+				close(connection);
+				continue;
+			}
+
+			requests.Push(std::move(request));
+		}
+
+		if ((pollDescriptors[1].revents & POLLIN) != 0)
+		{
+			char bytes[256];
+			if (read(wakeup[0], bytes, sizeof(bytes)) < 0)
+			{
+				perror("read");
+			}
+
+			AnsweredConnection answered = {};
+			while (answeredConnections.TryPop(answered))
+			{
+				if (answered.isOpen)
+				{
+					idleConnections.push_back(answered.connection);
+				}
+				else
+				{
+					close(answered.connection);
+				}
+			}
+		}
+
+		if ((pollDescriptors[0].revents & POLLIN) != 0)
+		{
+			const int connection = accept(listener, nullptr, nullptr);
+			if (connection < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+
+				perror("accept");
+				break;
+			}
+
+			setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &receiveTimeout, sizeof(receiveTimeout));
+			idleConnections.push_back(connection);
+		}
+	}
+
+	close(listener);
+	unlink(socketPath);
+
+	// workers never return, so do not wait for them
+	for (std::thread& worker : workers)
+	{
+		worker.detach();
+	}
+
+	return 0;
+}